@@ -22,12 +22,18 @@ typedef struct m68000_memory_result_t
      * If used as the return value of `m68000_*_peek_next_word`, this field contains the exception vector that occured when trying to read the next word.
      */
     m68000_vector_t exception;
+    /**
+     * Set to the number of extra cycles (wait states) taken by the access, they are added to the execution time of the instruction.
+     * Unused with `m68000_*_peek_next_word` and `m68000_*_get_next_*`.
+     */
+    uint32_t wait_cycles;
 } m68000_memory_result_t;
 
 /**
  * Memory callbacks sent to the interpreter methods.
  *
  * Every member must be a valid function pointer, no pointer checks are done when calling the callbacks.
+ * The exception is `get_block` and `set_block` which can be NULL, in which case the long (`get_block`) and word (`set_block`) callbacks are used instead.
  *
  * The void* argument passed on each callback is the [user_data](Self::user_data) member,
  * and its usage is let to the user of this library. For example, this can be used to allow the usage of C++ objects,
@@ -43,6 +49,18 @@ typedef struct m68000_callbacks_t
     struct m68000_memory_result_t (*set_long)(uint32_t addr, uint32_t data, void *user_data);
     void (*reset_instruction)(void *user_data);
     void *user_data;
+    /**
+     * Reads `len` bytes starting at `addr` in `data`, for the instructions that transfer several values at once (MOVEM).
+     * `addr` and `len` are even and `len` is not 0. Can be NULL.
+     *
+     * The block callbacks are the last members so the initializers written before they existed stay valid.
+     */
+    struct m68000_memory_result_t (*get_block)(uint32_t addr, uint8_t *data, size_t len, void *user_data);
+    /**
+     * Writes the `len` bytes of `data` starting at `addr`, for the instructions that transfer several values at once (MOVEM).
+     * `addr` and `len` are even and `len` is not 0. Can be NULL.
+     */
+    struct m68000_memory_result_t (*set_block)(uint32_t addr, const uint8_t *data, size_t len, void *user_data);
 } m68000_callbacks_t;
 
 /**
@@ -95,10 +113,269 @@ typedef struct m68000_disassembler_exception_result_t
     m68000_vector_t exception;
 } m68000_disassembler_exception_result_t;
 
+/**
+ * A slice of execution given to `m68000_*_run_schedule`.
+ */
+typedef struct m68000_schedule_event_t
+{
+    /**
+     * The number of cycles to execute in this slice.
+     */
+    size_t cycles;
+    /**
+     * 0 for no interrupt, the vector number of the exception to request before executing the slice otherwise.
+     */
+    m68000_vector_t interrupt;
+} m68000_schedule_event_t;
+
+/**
+ * Result of a slice executed by `m68000_*_run_schedule`.
+ */
+typedef struct m68000_schedule_result_t
+{
+    /**
+     * The number of cycles executed.
+     */
+    size_t cycles;
+    /**
+     * 0 if no exception occured, the vector number that occured otherwise.
+     */
+    m68000_vector_t exception;
+    /**
+     * True if the CPU is stopped by a STOP instruction at the end of the slice.
+     */
+    bool stop;
+    /**
+     * True if a hook stopped the CPU during the slice, see `m68000_*_hook_event`.
+     */
+    bool hook;
+} m68000_schedule_result_t;
+
+/**
+ * The size in bytes of the buffers used by `m68000_*_save_state` and `m68000_*_load_state`.
+ */
+#define M68000_STATE_SIZE 128
+
+/**
+ * Version of the layout of the states written by `m68000_*_save_state`.
+ */
+#define M68000_STATE_VERSION 1
+
+/**
+ * Number of exception counters of `m68000_counters_t`, indexed by vector number.
+ */
+#define M68000_COUNTERS_VECTORS 65
+
+#if defined(M68000_PROFILER)
+/**
+ * Number of ISA counters of the profiler, in the order of the `m68000::isa::Isa` enum.
+ */
+#define M68000_PROFILE_ISA_COUNT 85
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Number of address bucket counters of the profiler. Each bucket contains 256 bytes of the 24-bits address space.
+ */
+#define M68000_PROFILE_PC_BUCKETS 65536
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Number of exception vector counters of the profiler, indexed by vector number.
+ */
+#define M68000_PROFILE_VECTORS 256
+#endif
+
+/**
+ * An execution counter.
+ */
+typedef struct m68000_profile_counter_t
+{
+    /**
+     * The number of instructions executed.
+     */
+    uint64_t count;
+    /**
+     * The number of cycles executed by the instructions.
+     */
+    uint64_t cycles;
+} m68000_profile_counter_t;
+
+/**
+ * The number of calls to each [MemoryAccess] method.
+ */
+typedef struct m68000_memory_counters_t
+{
+    /**
+     * Calls to [MemoryAccess::get_byte].
+     */
+    uint64_t byte_reads;
+    /**
+     * Calls to [MemoryAccess::get_word].
+     */
+    uint64_t word_reads;
+    /**
+     * Calls to [MemoryAccess::get_long].
+     */
+    uint64_t long_reads;
+    /**
+     * Calls to [MemoryAccess::get_block].
+     */
+    uint64_t block_reads;
+    /**
+     * Calls to [MemoryAccess::set_byte].
+     */
+    uint64_t byte_writes;
+    /**
+     * Calls to [MemoryAccess::set_word].
+     */
+    uint64_t word_writes;
+    /**
+     * Calls to [MemoryAccess::set_long].
+     */
+    uint64_t long_writes;
+    /**
+     * Calls to [MemoryAccess::set_block].
+     */
+    uint64_t block_writes;
+} m68000_memory_counters_t;
+
+/**
+ * The performance counters of a core.
+ */
+typedef struct m68000_counters_t
+{
+    /**
+     * The number of cycles executed.
+     */
+    uint64_t cycles;
+    /**
+     * The number of instructions executed, including the ones that raised an exception.
+     */
+    uint64_t instructions;
+    /**
+     * The number of cycles spent stopped by a STOP instruction.
+     */
+    uint64_t stopped_cycles;
+    /**
+     * The number of times each exception has been processed, indexed by vector number.
+     */
+    uint64_t exceptions[M68000_COUNTERS_VECTORS];
+    /**
+     * The memory calls.
+     */
+    struct m68000_memory_counters_t memory;
+} m68000_counters_t;
+
+/**
+ * Return type of the `m68000_*_trace_interpreter_exception` functions.
+ */
+typedef struct m68000_trace_result_t
+{
+    /**
+     * The number of cycles executed.
+     */
+    size_t cycles;
+    /**
+     * 0 if no exception occured, the vector number that occured otherwise.
+     */
+    m68000_vector_t exception;
+    /**
+     * True if an instruction has been executed and written to the given instruction.
+     */
+    bool executed;
+} m68000_trace_result_t;
+
+/**
+ * Handler called by `m68000_*_run_pool` when a job stops on an exception or a STOP instruction.
+ *
+ * `job` is the index of the job, `exception` is 0 on a STOP instruction, the vector number that occured otherwise.
+ * Returns true to continue running the job, false when the job is finished.
+ */
+typedef bool (*m68000_pool_handler_t)(size_t job, m68000_vector_t exception, void *user_data);
+
+/**
+ * Instruction hook set with `m68000_*_set_instruction_hook`, called with the registers before each instruction.
+ * Returns false to break the execution before the instruction.
+ */
+typedef bool (*m68000_instruction_hook_t)(const m68000_registers_t *regs, void *user_data);
+
+/**
+ * No hook stopped the core.
+ */
+#define M68000_HOOK_NONE 0
+
+/**
+ * The core stopped on a breakpoint.
+ */
+#define M68000_HOOK_BREAKPOINT 1
+
+/**
+ * The instruction hook requested a break.
+ */
+#define M68000_HOOK_INSTRUCTION 2
+
+/**
+ * A watched address has been accessed.
+ */
+#define M68000_HOOK_WATCHPOINT 3
+
+/**
+ * Return type of `m68000_*_hook_event` and `m68000_*_resume_from_hook`.
+ */
+typedef struct m68000_hook_event_t
+{
+    /**
+     * The kind of event, one of the `M68000_HOOK_*` constants.
+     */
+    uint8_t kind;
+    /**
+     * The address of the instruction that triggered the event.
+     *
+     * The instruction has not been executed on breakpoints and instruction hooks, and has been executed on watchpoints.
+     */
+    uint32_t pc;
+    /**
+     * The watched address accessed, 0 for other events.
+     */
+    uint32_t addr;
+    /**
+     * True if the watched access is a write.
+     */
+    bool write;
+} m68000_hook_event_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * Memory handlers called by the `m68000_*_static_*` functions, to be defined by the application.
+ *
+ * They have the same semantics as the members of `m68000_callbacks_t`, and receive the `user_data` given to the
+ * interpreter function. `m68000_static_get_block` and `m68000_static_set_block` are always called for block transfers.
+ */
+struct m68000_memory_result_t m68000_static_get_byte(uint32_t addr, void *user_data);
+struct m68000_memory_result_t m68000_static_get_word(uint32_t addr, void *user_data);
+struct m68000_memory_result_t m68000_static_get_long(uint32_t addr, void *user_data);
+struct m68000_memory_result_t m68000_static_set_byte(uint32_t addr, uint8_t data, void *user_data);
+struct m68000_memory_result_t m68000_static_set_word(uint32_t addr, uint16_t data, void *user_data);
+struct m68000_memory_result_t m68000_static_set_long(uint32_t addr, uint32_t data, void *user_data);
+struct m68000_memory_result_t m68000_static_get_block(uint32_t addr, uint8_t *data, size_t len, void *user_data);
+struct m68000_memory_result_t m68000_static_set_block(uint32_t addr, const uint8_t *data, size_t len, void *user_data);
+void m68000_static_reset_instruction(void *user_data);
+#endif
+
+/**
+ * Disassembles the given instruction.
+ *
+ * `str` is a pointer to a C string buffer where the disassembled instruction will be written.
+ * `len` is the maximum size of the buffer, null-charactere included.
+ */
+void m68000_instruction_disassemble(const m68000_instruction_t *instruction, char *str, size_t len);
+
 /**
  * Allocates a new core and returns the pointer to it.
  *
@@ -149,6 +426,76 @@ struct m68000_exception_result_t m68000_mc68000_cycle_until_exception(m68000_mc6
  */
 struct m68000_exception_result_t m68000_mc68000_loop_until_exception_stop(m68000_mc68000_t *m68000, struct m68000_callbacks_t *memory);
 
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_cycle` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+size_t m68000_mc68000_static_cycle(m68000_mc68000_t *m68000, void *user_data, size_t cycles);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_cycle_until_exception` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_mc68000_static_cycle_until_exception(m68000_mc68000_t *m68000, void *user_data, size_t cycles);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_loop_until_exception_stop` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_mc68000_static_loop_until_exception_stop(m68000_mc68000_t *m68000, void *user_data);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_interpreter` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+size_t m68000_mc68000_static_interpreter(m68000_mc68000_t *m68000, void *user_data);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_interpreter_exception` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_mc68000_static_interpreter_exception(m68000_mc68000_t *m68000, void *user_data);
+#endif
+
+/**
+ * Runs the `count` slices of `events` and stores their result in `results`, which must be `count` long.
+ *
+ * Before each slice, the interrupt of the event is requested if it is not 0.
+ * Then the slice is executed like `m68000_*_cycle_until_exception`, except that a stopped mc68000 consumes
+ * the whole cycle budget of the slice like `m68000_*_cycle`.
+ *
+ * Stops after the first slice ending with an exception or a hook break, so the application can handle it
+ * and resume the schedule by calling this function with the remaining events. A slice ending with a hook
+ * break is not padded to its cycle budget.
+ * Returns the number of slices executed.
+ */
+size_t m68000_mc68000_run_schedule(m68000_mc68000_t *m68000, struct m68000_callbacks_t *memory, const struct m68000_schedule_event_t *events, struct m68000_schedule_result_t *results, size_t count);
+
+/**
+ * Runs the `count` independent jobs made of `cores[i]` and `memories[i]` on `threads` worker threads
+ * (0 for the available parallelism of the host), and returns when they are all finished.
+ *
+ * Each job runs like `m68000_*_loop_until_exception_stop`. When it stops, `handler` is called from the worker
+ * thread with the index of the job and the vector of the exception (0 on a STOP instruction). It can handle the
+ * exception (for example a TRAP used as a syscall) through `cores[job]`, and returns true to continue running
+ * the job or false when it is finished. If `handler` is NULL, each job finishes at its first exception or STOP.
+ *
+ * `results[i]` receives the total number of cycles executed by job `i` and its last exception.
+ *
+ * The memory callbacks and the handler are called concurrently from several threads and must be thread-safe.
+ * Read-only data like a ROM image can be shared by the memories of all the jobs.
+ */
+void m68000_mc68000_run_pool(m68000_mc68000_t *const *cores, struct m68000_callbacks_t *memories, struct m68000_exception_result_t *results, size_t count, size_t threads, m68000_pool_handler_t handler, void *user_data);
+
 /**
  * Executes the next instruction, returning the cycle count necessary to execute it.
  */
@@ -181,11 +528,173 @@ struct m68000_disassembler_result_t m68000_mc68000_disassembler_interpreter(m680
  */
 struct m68000_disassembler_exception_result_t m68000_mc68000_disassembler_interpreter_exception(m68000_mc68000_t *m68000, struct m68000_callbacks_t *memory, char *str, size_t len);
 
+/**
+ * Executes the next instruction and copies it in `instruction` without disassembling it, returning the cycle count
+ * necessary to execute it, and the vector of the exception that occured during the execution if any.
+ *
+ * `instruction` is written only if an instruction has been executed, which is indicated by the `executed` member.
+ * It can be disassembled later with `m68000_instruction_disassemble`.
+ *
+ * To process the returned exception, call `m68000_*_exception`.
+ */
+struct m68000_trace_result_t m68000_mc68000_trace_interpreter_exception(m68000_mc68000_t *m68000, struct m68000_callbacks_t *memory, m68000_instruction_t *instruction);
+
 /**
  * Requests the CPU to process the given exception vector.
  */
 void m68000_mc68000_exception(m68000_mc68000_t *m68000, m68000_vector_t vector);
 
+/**
+ * Enables or disables the pre-decoded instruction cache.
+ *
+ * Only enable it if instruction fetches have no side effects on your memory system.
+ * See the `m68000::instruction_cache` module documentation for more details.
+ */
+void m68000_mc68000_set_instruction_cache(m68000_mc68000_t *m68000, bool enabled);
+
+/**
+ * Discards the cached instructions in the given address range.
+ *
+ * Call this function after the memory has been modified by something else than the core.
+ */
+void m68000_mc68000_invalidate_instruction_cache(m68000_mc68000_t *m68000, uint32_t addr, uint32_t len);
+
+/**
+ * Discards every cached instruction.
+ */
+void m68000_mc68000_clear_instruction_cache(m68000_mc68000_t *m68000);
+
+/**
+ * Enables or disables the prefetch window.
+ *
+ * Only enable it if instruction fetches have no side effects on your memory system.
+ * See the `m68000::prefetch` module documentation for more details.
+ */
+void m68000_mc68000_set_prefetch(m68000_mc68000_t *m68000, bool enabled);
+
+/**
+ * Discards the prefetched words.
+ *
+ * Call this function after the memory has been modified by something else than the core.
+ */
+void m68000_mc68000_invalidate_prefetch(m68000_mc68000_t *m68000);
+
+/**
+ * Enables or disables the detection of idle loops (branches to self, DBcc and polling loops), which are
+ * skipped up to the cycle budget by `m68000_*_cycle`, `m68000_*_cycle_until_exception` and `m68000_*_run_schedule`.
+ *
+ * Must only be enabled if memory reads have no side effects and the memory is not modified during the calls.
+ */
+void m68000_mc68000_set_idle_loop_detection(m68000_mc68000_t *m68000, bool enabled);
+
+/**
+ * Maps `len` bytes of host memory starting at `data` to the addresses starting at `addr`.
+ *
+ * `data` is stored in big-endian format. If `writable` is false, writes are sent to the memory callbacks.
+ * `data` must stay valid until it is unmapped or the core is deleted.
+ *
+ * Returns false and maps nothing if `addr` is not a multiple of 64 KiB or if the range overflows the address space.
+ */
+bool m68000_mc68000_map_memory(m68000_mc68000_t *m68000, uint32_t addr, uint8_t *data, size_t len, bool writable);
+
+/**
+ * Unmaps the pages containing the given address range, so they are accessed through the memory callbacks again.
+ * The range is clamped to the end of the address space, so `len` can be `SIZE_MAX` to unmap everything after `addr`.
+ */
+void m68000_mc68000_unmap_memory(m68000_mc68000_t *m68000, uint32_t addr, size_t len);
+
+/**
+ * Adds a breakpoint at the given address.
+ */
+void m68000_mc68000_add_breakpoint(m68000_mc68000_t *m68000, uint32_t addr);
+
+/**
+ * Removes the breakpoint at the given address if any.
+ */
+void m68000_mc68000_remove_breakpoint(m68000_mc68000_t *m68000, uint32_t addr);
+
+/**
+ * Removes all the breakpoints.
+ */
+void m68000_mc68000_clear_breakpoints(m68000_mc68000_t *m68000);
+
+/**
+ * Adds a watchpoint on the `len` bytes starting at `addr`, breaking on reads (including instruction fetches)
+ * if `read` is true and on writes if `write` is true.
+ */
+void m68000_mc68000_add_watchpoint(m68000_mc68000_t *m68000, uint32_t addr, uint32_t len, bool read, bool write);
+
+/**
+ * Removes all the watchpoints.
+ */
+void m68000_mc68000_clear_watchpoints(m68000_mc68000_t *m68000);
+
+/**
+ * Sets the instruction hook called before each instruction with `user_data`, or removes it if `hook` is NULL.
+ */
+void m68000_mc68000_set_instruction_hook(m68000_mc68000_t *m68000, m68000_instruction_hook_t hook, void *user_data);
+
+/**
+ * Enables or disables the coverage collection. Disabling it discards the addresses recorded.
+ */
+void m68000_mc68000_set_coverage(m68000_mc68000_t *m68000, bool enabled);
+
+/**
+ * Returns true if the instruction at the given address has been executed since coverage collection is enabled.
+ */
+bool m68000_mc68000_is_covered(const m68000_mc68000_t *m68000, uint32_t addr);
+
+/**
+ * Returns the event that stopped the core, with the kind `M68000_HOOK_NONE` if it has not been stopped by a hook.
+ */
+struct m68000_hook_event_t m68000_mc68000_hook_event(const m68000_mc68000_t *m68000);
+
+/**
+ * Resumes the execution after a hook stopped the core, and returns the event that stopped it.
+ *
+ * The breakpoint and the instruction hook are not checked on the next instruction.
+ * Does nothing and returns the kind `M68000_HOOK_NONE` if the core has not been stopped by a hook.
+ */
+struct m68000_hook_event_t m68000_mc68000_resume_from_hook(m68000_mc68000_t *m68000);
+
+#if defined(M68000_PROFILER)
+/**
+ * Enables or disables the profiler. Disabling it discards the counters.
+ */
+void m68000_mc68000_set_profiler(m68000_mc68000_t *m68000, bool enabled);
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Sets all the counters of the profiler to 0.
+ */
+void m68000_mc68000_reset_profile(m68000_mc68000_t *m68000);
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Copies the counters of the profiler in the given arrays.
+ *
+ * Each array receives at most its given length of counters, and can be NULL to be ignored.
+ * `isa` is indexed in the order of the `m68000::isa::Isa` enum ([M68000_PROFILE_ISA_COUNT] counters),
+ * `pc` by instruction address divided by 256 ([M68000_PROFILE_PC_BUCKETS] counters)
+ * and `vectors` by exception vector number ([M68000_PROFILE_VECTORS] counters).
+ *
+ * Returns false and copies nothing if the profiler is disabled.
+ */
+bool m68000_mc68000_profile_snapshot(const m68000_mc68000_t *m68000, m68000_profile_counter_t *isa, size_t isa_len, m68000_profile_counter_t *pc, size_t pc_len, uint64_t *vectors, size_t vectors_len);
+#endif
+
+/**
+ * Returns a copy of the performance counters.
+ */
+struct m68000_counters_t m68000_mc68000_counters(const m68000_mc68000_t *m68000);
+
+/**
+ * Sets all the performance counters to 0.
+ */
+void m68000_mc68000_reset_counters(m68000_mc68000_t *m68000);
+
 /**
  * Returns the 16-bits word at the current PC value of the given core and advances PC by 2.
  */
@@ -221,6 +730,20 @@ m68000_registers_t m68000_mc68000_get_registers(const m68000_mc68000_t *m68000);
  */
 void m68000_mc68000_set_registers(m68000_mc68000_t *m68000, m68000_registers_t regs);
 
+/**
+ * Writes the state of the core in `state`, which must be a buffer of `M68000_STATE_SIZE` bytes.
+ *
+ * The state contains the registers, the STOP state and the pending exceptions, but not the memory.
+ */
+void m68000_mc68000_save_state(const m68000_mc68000_t *m68000, uint8_t *state);
+
+/**
+ * Restores the state of the core from `state`, a buffer of `M68000_STATE_SIZE` bytes written by `m68000_*_save_state`.
+ *
+ * Returns false and does not modify the core if the version of the state is not supported.
+ */
+bool m68000_mc68000_load_state(m68000_mc68000_t *m68000, const uint8_t *state);
+
 /**
  * Allocates a new core and returns the pointer to it.
  *
@@ -271,6 +794,76 @@ struct m68000_exception_result_t m68000_scc68070_cycle_until_exception(m68000_sc
  */
 struct m68000_exception_result_t m68000_scc68070_loop_until_exception_stop(m68000_scc68070_t *m68000, struct m68000_callbacks_t *memory);
 
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_cycle` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+size_t m68000_scc68070_static_cycle(m68000_scc68070_t *m68000, void *user_data, size_t cycles);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_cycle_until_exception` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_scc68070_static_cycle_until_exception(m68000_scc68070_t *m68000, void *user_data, size_t cycles);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_loop_until_exception_stop` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_scc68070_static_loop_until_exception_stop(m68000_scc68070_t *m68000, void *user_data);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_interpreter` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+size_t m68000_scc68070_static_interpreter(m68000_scc68070_t *m68000, void *user_data);
+#endif
+
+#if defined(M68000_STATIC_MEMORY)
+/**
+ * `m68000_*_interpreter_exception` with the memory handlers defined by the application (`m68000_static_*`),
+ * called with `user_data`.
+ */
+struct m68000_exception_result_t m68000_scc68070_static_interpreter_exception(m68000_scc68070_t *m68000, void *user_data);
+#endif
+
+/**
+ * Runs the `count` slices of `events` and stores their result in `results`, which must be `count` long.
+ *
+ * Before each slice, the interrupt of the event is requested if it is not 0.
+ * Then the slice is executed like `m68000_*_cycle_until_exception`, except that a stopped scc68070 consumes
+ * the whole cycle budget of the slice like `m68000_*_cycle`.
+ *
+ * Stops after the first slice ending with an exception or a hook break, so the application can handle it
+ * and resume the schedule by calling this function with the remaining events. A slice ending with a hook
+ * break is not padded to its cycle budget.
+ * Returns the number of slices executed.
+ */
+size_t m68000_scc68070_run_schedule(m68000_scc68070_t *m68000, struct m68000_callbacks_t *memory, const struct m68000_schedule_event_t *events, struct m68000_schedule_result_t *results, size_t count);
+
+/**
+ * Runs the `count` independent jobs made of `cores[i]` and `memories[i]` on `threads` worker threads
+ * (0 for the available parallelism of the host), and returns when they are all finished.
+ *
+ * Each job runs like `m68000_*_loop_until_exception_stop`. When it stops, `handler` is called from the worker
+ * thread with the index of the job and the vector of the exception (0 on a STOP instruction). It can handle the
+ * exception (for example a TRAP used as a syscall) through `cores[job]`, and returns true to continue running
+ * the job or false when it is finished. If `handler` is NULL, each job finishes at its first exception or STOP.
+ *
+ * `results[i]` receives the total number of cycles executed by job `i` and its last exception.
+ *
+ * The memory callbacks and the handler are called concurrently from several threads and must be thread-safe.
+ * Read-only data like a ROM image can be shared by the memories of all the jobs.
+ */
+void m68000_scc68070_run_pool(m68000_scc68070_t *const *cores, struct m68000_callbacks_t *memories, struct m68000_exception_result_t *results, size_t count, size_t threads, m68000_pool_handler_t handler, void *user_data);
+
 /**
  * Executes the next instruction, returning the cycle count necessary to execute it.
  */
@@ -303,11 +896,173 @@ struct m68000_disassembler_result_t m68000_scc68070_disassembler_interpreter(m68
  */
 struct m68000_disassembler_exception_result_t m68000_scc68070_disassembler_interpreter_exception(m68000_scc68070_t *m68000, struct m68000_callbacks_t *memory, char *str, size_t len);
 
+/**
+ * Executes the next instruction and copies it in `instruction` without disassembling it, returning the cycle count
+ * necessary to execute it, and the vector of the exception that occured during the execution if any.
+ *
+ * `instruction` is written only if an instruction has been executed, which is indicated by the `executed` member.
+ * It can be disassembled later with `m68000_instruction_disassemble`.
+ *
+ * To process the returned exception, call `m68000_*_exception`.
+ */
+struct m68000_trace_result_t m68000_scc68070_trace_interpreter_exception(m68000_scc68070_t *m68000, struct m68000_callbacks_t *memory, m68000_instruction_t *instruction);
+
 /**
  * Requests the CPU to process the given exception vector.
  */
 void m68000_scc68070_exception(m68000_scc68070_t *m68000, m68000_vector_t vector);
 
+/**
+ * Enables or disables the pre-decoded instruction cache.
+ *
+ * Only enable it if instruction fetches have no side effects on your memory system.
+ * See the `m68000::instruction_cache` module documentation for more details.
+ */
+void m68000_scc68070_set_instruction_cache(m68000_scc68070_t *m68000, bool enabled);
+
+/**
+ * Discards the cached instructions in the given address range.
+ *
+ * Call this function after the memory has been modified by something else than the core.
+ */
+void m68000_scc68070_invalidate_instruction_cache(m68000_scc68070_t *m68000, uint32_t addr, uint32_t len);
+
+/**
+ * Discards every cached instruction.
+ */
+void m68000_scc68070_clear_instruction_cache(m68000_scc68070_t *m68000);
+
+/**
+ * Enables or disables the prefetch window.
+ *
+ * Only enable it if instruction fetches have no side effects on your memory system.
+ * See the `m68000::prefetch` module documentation for more details.
+ */
+void m68000_scc68070_set_prefetch(m68000_scc68070_t *m68000, bool enabled);
+
+/**
+ * Discards the prefetched words.
+ *
+ * Call this function after the memory has been modified by something else than the core.
+ */
+void m68000_scc68070_invalidate_prefetch(m68000_scc68070_t *m68000);
+
+/**
+ * Enables or disables the detection of idle loops (branches to self, DBcc and polling loops), which are
+ * skipped up to the cycle budget by `m68000_*_cycle`, `m68000_*_cycle_until_exception` and `m68000_*_run_schedule`.
+ *
+ * Must only be enabled if memory reads have no side effects and the memory is not modified during the calls.
+ */
+void m68000_scc68070_set_idle_loop_detection(m68000_scc68070_t *m68000, bool enabled);
+
+/**
+ * Maps `len` bytes of host memory starting at `data` to the addresses starting at `addr`.
+ *
+ * `data` is stored in big-endian format. If `writable` is false, writes are sent to the memory callbacks.
+ * `data` must stay valid until it is unmapped or the core is deleted.
+ *
+ * Returns false and maps nothing if `addr` is not a multiple of 64 KiB or if the range overflows the address space.
+ */
+bool m68000_scc68070_map_memory(m68000_scc68070_t *m68000, uint32_t addr, uint8_t *data, size_t len, bool writable);
+
+/**
+ * Unmaps the pages containing the given address range, so they are accessed through the memory callbacks again.
+ * The range is clamped to the end of the address space, so `len` can be `SIZE_MAX` to unmap everything after `addr`.
+ */
+void m68000_scc68070_unmap_memory(m68000_scc68070_t *m68000, uint32_t addr, size_t len);
+
+/**
+ * Adds a breakpoint at the given address.
+ */
+void m68000_scc68070_add_breakpoint(m68000_scc68070_t *m68000, uint32_t addr);
+
+/**
+ * Removes the breakpoint at the given address if any.
+ */
+void m68000_scc68070_remove_breakpoint(m68000_scc68070_t *m68000, uint32_t addr);
+
+/**
+ * Removes all the breakpoints.
+ */
+void m68000_scc68070_clear_breakpoints(m68000_scc68070_t *m68000);
+
+/**
+ * Adds a watchpoint on the `len` bytes starting at `addr`, breaking on reads (including instruction fetches)
+ * if `read` is true and on writes if `write` is true.
+ */
+void m68000_scc68070_add_watchpoint(m68000_scc68070_t *m68000, uint32_t addr, uint32_t len, bool read, bool write);
+
+/**
+ * Removes all the watchpoints.
+ */
+void m68000_scc68070_clear_watchpoints(m68000_scc68070_t *m68000);
+
+/**
+ * Sets the instruction hook called before each instruction with `user_data`, or removes it if `hook` is NULL.
+ */
+void m68000_scc68070_set_instruction_hook(m68000_scc68070_t *m68000, m68000_instruction_hook_t hook, void *user_data);
+
+/**
+ * Enables or disables the coverage collection. Disabling it discards the addresses recorded.
+ */
+void m68000_scc68070_set_coverage(m68000_scc68070_t *m68000, bool enabled);
+
+/**
+ * Returns true if the instruction at the given address has been executed since coverage collection is enabled.
+ */
+bool m68000_scc68070_is_covered(const m68000_scc68070_t *m68000, uint32_t addr);
+
+/**
+ * Returns the event that stopped the core, with the kind `M68000_HOOK_NONE` if it has not been stopped by a hook.
+ */
+struct m68000_hook_event_t m68000_scc68070_hook_event(const m68000_scc68070_t *m68000);
+
+/**
+ * Resumes the execution after a hook stopped the core, and returns the event that stopped it.
+ *
+ * The breakpoint and the instruction hook are not checked on the next instruction.
+ * Does nothing and returns the kind `M68000_HOOK_NONE` if the core has not been stopped by a hook.
+ */
+struct m68000_hook_event_t m68000_scc68070_resume_from_hook(m68000_scc68070_t *m68000);
+
+#if defined(M68000_PROFILER)
+/**
+ * Enables or disables the profiler. Disabling it discards the counters.
+ */
+void m68000_scc68070_set_profiler(m68000_scc68070_t *m68000, bool enabled);
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Sets all the counters of the profiler to 0.
+ */
+void m68000_scc68070_reset_profile(m68000_scc68070_t *m68000);
+#endif
+
+#if defined(M68000_PROFILER)
+/**
+ * Copies the counters of the profiler in the given arrays.
+ *
+ * Each array receives at most its given length of counters, and can be NULL to be ignored.
+ * `isa` is indexed in the order of the `m68000::isa::Isa` enum ([M68000_PROFILE_ISA_COUNT] counters),
+ * `pc` by instruction address divided by 256 ([M68000_PROFILE_PC_BUCKETS] counters)
+ * and `vectors` by exception vector number ([M68000_PROFILE_VECTORS] counters).
+ *
+ * Returns false and copies nothing if the profiler is disabled.
+ */
+bool m68000_scc68070_profile_snapshot(const m68000_scc68070_t *m68000, m68000_profile_counter_t *isa, size_t isa_len, m68000_profile_counter_t *pc, size_t pc_len, uint64_t *vectors, size_t vectors_len);
+#endif
+
+/**
+ * Returns a copy of the performance counters.
+ */
+struct m68000_counters_t m68000_scc68070_counters(const m68000_scc68070_t *m68000);
+
+/**
+ * Sets all the performance counters to 0.
+ */
+void m68000_scc68070_reset_counters(m68000_scc68070_t *m68000);
+
 /**
  * Returns the 16-bits word at the current PC value of the given core and advances PC by 2.
  */
@@ -343,6 +1098,20 @@ m68000_registers_t m68000_scc68070_get_registers(const m68000_scc68070_t *m68000
  */
 void m68000_scc68070_set_registers(m68000_scc68070_t *m68000, m68000_registers_t regs);
 
+/**
+ * Writes the state of the core in `state`, which must be a buffer of `M68000_STATE_SIZE` bytes.
+ *
+ * The state contains the registers, the STOP state and the pending exceptions, but not the memory.
+ */
+void m68000_scc68070_save_state(const m68000_scc68070_t *m68000, uint8_t *state);
+
+/**
+ * Restores the state of the core from `state`, a buffer of `M68000_STATE_SIZE` bytes written by `m68000_*_save_state`.
+ *
+ * Returns false and does not modify the core if the version of the state is not supported.
+ */
+bool m68000_scc68070_load_state(m68000_scc68070_t *m68000, const uint8_t *state);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -0,0 +1,263 @@
+#ifndef M68000_HPP
+#define M68000_HPP
+
+/**
+ * Header-only C++ layer over the C interface, using the memory handlers resolved at link time.
+ *
+ * Build m68000-ffi with the `static-memory` feature, define `M68000_STATIC_MEMORY` before including this header, and
+ * expand `M68000_STATIC_MEMORY_HANDLERS(MemoryT)` once in a source file of the application to define the
+ * `m68000_static_*` handlers. They forward the accesses to the `MemoryT` instance given to the `m68000::Core`, without
+ * function pointers, so with cross-language link-time optimization the accesses can be inlined in the interpreter.
+ *
+ * `MemoryT` must have the following member functions, with the same semantics as the members of `m68000_callbacks_t`:
+ *
+ * ```cpp
+ * m68000_memory_result_t get_byte(uint32_t addr);
+ * m68000_memory_result_t get_word(uint32_t addr);
+ * m68000_memory_result_t get_long(uint32_t addr);
+ * m68000_memory_result_t set_byte(uint32_t addr, uint8_t data);
+ * m68000_memory_result_t set_word(uint32_t addr, uint16_t data);
+ * m68000_memory_result_t set_long(uint32_t addr, uint32_t data);
+ * void reset_instruction();
+ * ```
+ *
+ * and optionally `get_block(uint32_t addr, uint8_t* data, size_t len)` and
+ * `set_block(uint32_t addr, const uint8_t* data, size_t len)`. When they are not defined, blocks are transferred with
+ * `get_long`/`get_word` and `set_word`.
+ *
+ * As the handlers are link-time symbols, a single memory type can be used in a program.
+ *
+ * ```cpp
+ * #include "m68000/m68000.hpp"
+ *
+ * struct Ram { ... };
+ * M68000_STATIC_MEMORY_HANDLERS(Ram)
+ *
+ * Ram ram;
+ * m68000::Core<m68000::Mc68000, Ram> core(ram);
+ * core.cycle(1000);
+ * ```
+ */
+
+#if !defined(M68000_STATIC_MEMORY)
+#define M68000_STATIC_MEMORY
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "m68000-ffi.h"
+
+namespace m68000
+{
+
+/**
+ * The functions of the C interface for the MC68000.
+ */
+struct Mc68000
+{
+    using Type = m68000_mc68000_t;
+
+    static Type* create(bool reset) { return reset ? m68000_mc68000_new() : m68000_mc68000_new_no_reset(); }
+    static void destroy(Type* core) { m68000_mc68000_delete(core); }
+    static size_t cycle(Type* core, void* memory, size_t cycles) { return m68000_mc68000_static_cycle(core, memory, cycles); }
+    static m68000_exception_result_t cycle_until_exception(Type* core, void* memory, size_t cycles) { return m68000_mc68000_static_cycle_until_exception(core, memory, cycles); }
+    static m68000_exception_result_t loop_until_exception_stop(Type* core, void* memory) { return m68000_mc68000_static_loop_until_exception_stop(core, memory); }
+    static size_t interpreter(Type* core, void* memory) { return m68000_mc68000_static_interpreter(core, memory); }
+    static m68000_exception_result_t interpreter_exception(Type* core, void* memory) { return m68000_mc68000_static_interpreter_exception(core, memory); }
+    static void exception(Type* core, m68000_vector_t vector) { m68000_mc68000_exception(core, vector); }
+    static m68000_registers_t* registers(Type* core) { return m68000_mc68000_registers_mut(core); }
+};
+
+/**
+ * The functions of the C interface for the SCC68070.
+ */
+struct Scc68070
+{
+    using Type = m68000_scc68070_t;
+
+    static Type* create(bool reset) { return reset ? m68000_scc68070_new() : m68000_scc68070_new_no_reset(); }
+    static void destroy(Type* core) { m68000_scc68070_delete(core); }
+    static size_t cycle(Type* core, void* memory, size_t cycles) { return m68000_scc68070_static_cycle(core, memory, cycles); }
+    static m68000_exception_result_t cycle_until_exception(Type* core, void* memory, size_t cycles) { return m68000_scc68070_static_cycle_until_exception(core, memory, cycles); }
+    static m68000_exception_result_t loop_until_exception_stop(Type* core, void* memory) { return m68000_scc68070_static_loop_until_exception_stop(core, memory); }
+    static size_t interpreter(Type* core, void* memory) { return m68000_scc68070_static_interpreter(core, memory); }
+    static m68000_exception_result_t interpreter_exception(Type* core, void* memory) { return m68000_scc68070_static_interpreter_exception(core, memory); }
+    static void exception(Type* core, m68000_vector_t vector) { m68000_scc68070_exception(core, vector); }
+    static m68000_registers_t* registers(Type* core) { return m68000_scc68070_registers_mut(core); }
+};
+
+/**
+ * A core owning its C interface instance, executing with the memory `MemoryT`.
+ *
+ * The memory must outlive the core.
+ */
+template<typename CpuT, typename MemoryT>
+class Core
+{
+public:
+    /**
+     * Allocates a new core. If `reset` is true, the reset vectors are fetched before the first instruction.
+     */
+    explicit Core(MemoryT& memory, bool reset = true) : m_core(CpuT::create(reset)), m_memory(&memory) {}
+
+    Core(const Core&) = delete;
+    Core& operator=(const Core&) = delete;
+
+    Core(Core&& other) noexcept : m_core(std::exchange(other.m_core, nullptr)), m_memory(other.m_memory) {}
+
+    Core& operator=(Core&& other) noexcept
+    {
+        std::swap(m_core, other.m_core);
+        std::swap(m_memory, other.m_memory);
+        return *this;
+    }
+
+    ~Core()
+    {
+        if(m_core != nullptr)
+            CpuT::destroy(m_core);
+    }
+
+    /**
+     * See `m68000_*_cycle`.
+     */
+    size_t cycle(size_t cycles) { return CpuT::cycle(m_core, m_memory, cycles); }
+
+    /**
+     * See `m68000_*_cycle_until_exception`.
+     */
+    m68000_exception_result_t cycle_until_exception(size_t cycles) { return CpuT::cycle_until_exception(m_core, m_memory, cycles); }
+
+    /**
+     * See `m68000_*_loop_until_exception_stop`.
+     */
+    m68000_exception_result_t loop_until_exception_stop() { return CpuT::loop_until_exception_stop(m_core, m_memory); }
+
+    /**
+     * See `m68000_*_interpreter`.
+     */
+    size_t interpreter() { return CpuT::interpreter(m_core, m_memory); }
+
+    /**
+     * See `m68000_*_interpreter_exception`.
+     */
+    m68000_exception_result_t interpreter_exception() { return CpuT::interpreter_exception(m_core, m_memory); }
+
+    /**
+     * Requests the core to process the given exception vector.
+     */
+    void exception(m68000_vector_t vector) { CpuT::exception(m_core, vector); }
+
+    /**
+     * The registers of the core, which stay at the same location during its lifetime.
+     */
+    m68000_registers_t& registers() { return *CpuT::registers(m_core); }
+
+    /**
+     * The C interface instance, to call the other `m68000_*` functions.
+     */
+    typename CpuT::Type* get() { return m_core; }
+
+    MemoryT& memory() { return *m_memory; }
+
+private:
+    typename CpuT::Type* m_core;
+    MemoryT* m_memory;
+};
+
+namespace detail
+{
+
+template<typename T, typename = void>
+struct HasGetBlock : std::false_type {};
+
+template<typename T>
+struct HasGetBlock<T, std::void_t<decltype(std::declval<T&>().get_block(uint32_t(), (uint8_t*)nullptr, size_t()))>> : std::true_type {};
+
+template<typename T, typename = void>
+struct HasSetBlock : std::false_type {};
+
+template<typename T>
+struct HasSetBlock<T, std::void_t<decltype(std::declval<T&>().set_block(uint32_t(), (const uint8_t*)nullptr, size_t()))>> : std::true_type {};
+
+/**
+ * Reads the block with the long and word handlers, adding their wait cycles.
+ */
+template<typename MemoryT>
+inline m68000_memory_result_t get_block(MemoryT& memory, uint32_t addr, uint8_t* data, size_t len)
+{
+    if constexpr(HasGetBlock<MemoryT>::value)
+    {
+        return memory.get_block(addr, data, len);
+    }
+    else
+    {
+        m68000_memory_result_t total = {};
+        for(size_t i = 0; i < len; i += 4)
+        {
+            const bool word = len - i < 4;
+            const m68000_memory_result_t res = word ? memory.get_word(addr + i) : memory.get_long(addr + i);
+            total.wait_cycles += res.wait_cycles;
+            if(res.exception != 0)
+            {
+                total.exception = res.exception;
+                return total;
+            }
+
+            for(size_t b = 0, n = word ? 2 : 4; b < n; b++)
+                data[i + b] = res.data >> (n - 1 - b) * 8;
+        }
+        return total;
+    }
+}
+
+/**
+ * Writes the block with the word handler, adding their wait cycles.
+ */
+template<typename MemoryT>
+inline m68000_memory_result_t set_block(MemoryT& memory, uint32_t addr, const uint8_t* data, size_t len)
+{
+    if constexpr(HasSetBlock<MemoryT>::value)
+    {
+        return memory.set_block(addr, data, len);
+    }
+    else
+    {
+        m68000_memory_result_t total = {};
+        for(size_t i = 0; i < len; i += 2)
+        {
+            const m68000_memory_result_t res = memory.set_word(addr + i, uint16_t(data[i] << 8 | data[i + 1]));
+            total.wait_cycles += res.wait_cycles;
+            if(res.exception != 0)
+            {
+                total.exception = res.exception;
+                return total;
+            }
+        }
+        return total;
+    }
+}
+
+} // namespace detail
+
+} // namespace m68000
+
+/**
+ * Defines the `m68000_static_*` memory handlers, forwarding the accesses to the `MemoryT` instance used by the core.
+ * Must be expanded once in the program, outside of any namespace.
+ */
+#define M68000_STATIC_MEMORY_HANDLERS(MemoryT) \
+    extern "C" m68000_memory_result_t m68000_static_get_byte(uint32_t addr, void* user_data) { return static_cast<MemoryT*>(user_data)->get_byte(addr); } \
+    extern "C" m68000_memory_result_t m68000_static_get_word(uint32_t addr, void* user_data) { return static_cast<MemoryT*>(user_data)->get_word(addr); } \
+    extern "C" m68000_memory_result_t m68000_static_get_long(uint32_t addr, void* user_data) { return static_cast<MemoryT*>(user_data)->get_long(addr); } \
+    extern "C" m68000_memory_result_t m68000_static_set_byte(uint32_t addr, uint8_t data, void* user_data) { return static_cast<MemoryT*>(user_data)->set_byte(addr, data); } \
+    extern "C" m68000_memory_result_t m68000_static_set_word(uint32_t addr, uint16_t data, void* user_data) { return static_cast<MemoryT*>(user_data)->set_word(addr, data); } \
+    extern "C" m68000_memory_result_t m68000_static_set_long(uint32_t addr, uint32_t data, void* user_data) { return static_cast<MemoryT*>(user_data)->set_long(addr, data); } \
+    extern "C" m68000_memory_result_t m68000_static_get_block(uint32_t addr, uint8_t* data, size_t len, void* user_data) { return m68000::detail::get_block(*static_cast<MemoryT*>(user_data), addr, data, len); } \
+    extern "C" m68000_memory_result_t m68000_static_set_block(uint32_t addr, const uint8_t* data, size_t len, void* user_data) { return m68000::detail::set_block(*static_cast<MemoryT*>(user_data), addr, data, len); } \
+    extern "C" void m68000_static_reset_instruction(void* user_data) { static_cast<MemoryT*>(user_data)->reset_instruction(); }
+
+#endif // M68000_HPP
@@ -0,0 +1,199 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Throughput benchmarks of the C interface, with the memory accessed through `m68000_callbacks_t`.
+//!
+//! Reports the number of instructions executed per second and the emulated frequency (cycles executed per second).
+//!
+//! Run with `cargo bench --bench callbacks`.
+//!
+//! The benchmarks use a small std-only harness that reports the best of [SAMPLES] samples, so the crates keep no
+//! dependencies.
+
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::instruction::{Direction, Size};
+use m68000_ffi::{m68000_callbacks_t, m68000_memory_result_t};
+use m68000_ffi::mc68000::*;
+
+use std::ffi::c_void;
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+/// Number of instructions executed in each sample.
+const INSTRUCTIONS: usize = 2_000_000;
+/// Number of samples. The fastest one is reported.
+const SAMPLES: usize = 5;
+
+const START: u32 = 0x1000;
+const SOURCE: u16 = 0x4000;
+const DESTINATION: u16 = 0x6000;
+const MEMORY_SIZE: usize = 0x1_0000;
+
+// The callbacks are never inlined to behave like functions defined in another language.
+
+fn memory<'a>(user_data: *mut c_void) -> &'a mut Vec<u8> {
+    unsafe { &mut *(user_data as *mut Vec<u8>) }
+}
+
+fn result(data: Option<u32>) -> m68000_memory_result_t {
+    match data {
+        Some(data) => m68000_memory_result_t { data, exception: unsafe { m68000::exception::Vector::from_raw(0) }, wait_cycles: 0 },
+        None => m68000_memory_result_t { data: 0, exception: m68000::exception::Vector::AccessError, wait_cycles: 0 },
+    }
+}
+
+#[inline(never)]
+extern "C" fn get_byte(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    result(memory(user_data).get(addr as usize).map(|&b| b as u32))
+}
+
+#[inline(never)]
+extern "C" fn get_word(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get(addr as usize..addr as usize + 2).map(|w| u16::from_be_bytes([w[0], w[1]]) as u32))
+}
+
+#[inline(never)]
+extern "C" fn get_long(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get(addr as usize..addr as usize + 4).map(|l| u32::from_be_bytes([l[0], l[1], l[2], l[3]])))
+}
+
+#[inline(never)]
+extern "C" fn set_byte(addr: u32, data: u8, user_data: *mut c_void) -> m68000_memory_result_t {
+    result(memory(user_data).get_mut(addr as usize).map(|b| { *b = data; 0 }))
+}
+
+#[inline(never)]
+extern "C" fn set_word(addr: u32, data: u16, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get_mut(addr as usize..addr as usize + 2).map(|w| { w.copy_from_slice(&data.to_be_bytes()); 0 }))
+}
+
+#[inline(never)]
+extern "C" fn set_long(addr: u32, data: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get_mut(addr as usize..addr as usize + 4).map(|l| { l.copy_from_slice(&data.to_be_bytes()); 0 }))
+}
+
+#[inline(never)]
+extern "C" fn reset_instruction(_: *mut c_void) {}
+
+/// Checksums and copies a buffer in an endless loop.
+fn rom_loop() -> Vec<u16> {
+    let mut code = asm::lea(0, AM::AbsShort(SOURCE));
+    code.extend(asm::lea(1, AM::AbsShort(DESTINATION)));
+    code.extend(asm::r#move(Size::Word, AM::Drd(1), AM::Immediate(63)));
+    code.push(asm::moveq(0, 0));
+    let inner = code.len();
+    code.extend(asm::r#move(Size::Byte, AM::Drd(2), AM::Ari(0)));
+    code.extend(asm::add(0, Direction::DstReg, Size::Long, AM::Drd(2)));
+    code.push(asm::ror(1, Direction::Left, Size::Long, false, 0));
+    code.extend(asm::r#move(Size::Byte, AM::Ariwpo(1), AM::Ariwpo(0)));
+    let disp = -(((code.len() - inner) * 2 + 2) as i16);
+    code.extend(asm::dbcc(CC::F, 1, disp));
+    code.extend(asm::r#move(Size::Long, AM::AbsShort(DESTINATION + 0x100), AM::Drd(0)));
+    let disp = -((code.len() * 2 + 2) as i16);
+    code.extend(asm::bra(disp));
+    code
+}
+
+/// How the instructions are executed.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Mode {
+    /// One call to `m68000_mc68000_interpreter` per instruction.
+    Interpreter,
+    /// One call to `m68000_mc68000_run_schedule` for all the instructions.
+    Schedule,
+    /// `Interpreter` with the memory mapped with `m68000_mc68000_map_memory`.
+    Mapped,
+}
+
+fn run(mode: Mode) -> (Duration, usize, usize) {
+    let mut memory = vec![0u8; MEMORY_SIZE];
+    for (i, word) in rom_loop().iter().enumerate() {
+        let addr = START as usize + i * 2;
+        memory[addr..addr + 2].copy_from_slice(&word.to_be_bytes());
+    }
+
+    let mut callbacks = m68000_callbacks_t {
+        get_byte,
+        get_word,
+        get_long,
+        set_byte,
+        set_word,
+        set_long,
+        reset_instruction,
+        user_data: &mut memory as *mut Vec<u8> as *mut c_void,
+        get_block: None,
+        set_block: None,
+    };
+
+    let core = m68000_mc68000_new_no_reset();
+    unsafe {
+        (*m68000_mc68000_registers_mut(core)).pc.0 = START;
+        (*m68000_mc68000_registers_mut(core)).ssp.0 = MEMORY_SIZE as u32;
+    }
+    if mode == Mode::Mapped {
+        assert!(m68000_mc68000_map_memory(core, 0, memory.as_mut_ptr(), memory.len(), true));
+    }
+
+    let mut best = (Duration::MAX, 0, 0);
+    for _ in 0..SAMPLES {
+        let mut cycles = 0;
+        let mut instructions = INSTRUCTIONS;
+        let start = Instant::now();
+        if mode == Mode::Schedule {
+            // Slices of 1000 cycles, like a host running the core along other chips.
+            let slices = INSTRUCTIONS / 100;
+            let events: Vec<_> = (0..slices).map(|_| m68000_ffi::m68000_schedule_event_t {
+                cycles: 1000,
+                interrupt: unsafe { m68000::exception::Vector::from_raw(0) },
+            }).collect();
+            let mut results: Vec<_> = (0..slices).map(|_| m68000_ffi::m68000_schedule_result_t {
+                cycles: 0,
+                exception: m68000::exception::Vector::AccessError,
+                stop: false,
+                hook: false,
+            }).collect();
+
+            let done = m68000_mc68000_run_schedule(core, &mut callbacks, events.as_ptr(), results.as_mut_ptr(), slices);
+            assert_eq!(done, slices);
+            cycles = results.iter().map(|r| r.cycles).sum();
+            // Estimate the instruction count with the average instruction time of the interpreter mode.
+            instructions = 0;
+        } else {
+            for _ in 0..INSTRUCTIONS {
+                cycles += m68000_mc68000_interpreter(core, black_box(&mut callbacks));
+            }
+        }
+        let elapsed = start.elapsed();
+
+        if elapsed < best.0 {
+            best = (elapsed, cycles, instructions);
+        }
+    }
+
+    m68000_mc68000_delete(core);
+    best
+}
+
+fn report(name: &str, (duration, cycles, instructions): (Duration, usize, usize)) {
+    let seconds = duration.as_secs_f64();
+    let mhz = cycles as f64 / seconds / 1_000_000.0;
+    if instructions != 0 {
+        let mips = instructions as f64 / seconds / 1_000_000.0;
+        println!("{name:<24} {mips:>9.2} Minstr/s {mhz:>9.2} MHz");
+    } else {
+        println!("{name:<24} {:>18} {mhz:>9.2} MHz", "");
+    }
+}
+
+fn main() {
+    report("callbacks_interpreter", run(Mode::Interpreter));
+    report("callbacks_run_schedule", run(Mode::Schedule));
+    report("callbacks_mapped", run(Mode::Mapped));
+}
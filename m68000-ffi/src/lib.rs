@@ -22,6 +22,20 @@
 //! [data](m68000_memory_result_t::data) member to the value to be returned if read. `data` is not used on write.
 //! If the address is out of range, set `exception` to 2 (Access Error).
 //!
+//! The `get_block` and `set_block` callbacks are optional and can be NULL. When set, MOVEM transfers all its
+//! registers with a single call to them instead of one call per register, and the prefetch window is filled with a
+//! single call. When `get_block` is NULL, blocks are read with the `get_long` callback.
+//!
+//! ## Static memory
+//!
+//! When built with the `static-memory` feature, the `m68000_*_static_*` interpreter functions do not take the
+//! memory callbacks but call functions defined by the application at link time: `m68000_static_get_byte`,
+//! `m68000_static_get_word`, `m68000_static_get_long`, `m68000_static_set_byte`, `m68000_static_set_word`,
+//! `m68000_static_set_long`, `m68000_static_get_block`, `m68000_static_set_block` and
+//! `m68000_static_reset_instruction`, with the same signatures and semantics as the members of [m68000_callbacks_t].
+//! There is no function pointer on the bus path, so with cross-language link-time optimization the memory accesses
+//! can be inlined in the interpreter. The C++ header `m68000.hpp` defines them from a C++ memory class.
+//!
 //! ## Interpreter functions
 //!
 //! There are several functions to execute instructions, see their individual documentation for more information:
@@ -32,13 +46,64 @@
 //! - `m68000_*_cycle` which runs the CPU for **at least** the given number of cycles.
 //! - `m68000_*_cycle_until_exception` which runs the CPU until either an exception occurs or **at least** the given number of cycles have been executed.
 //! - `m68000_*_loop_until_exception_stop` which runs the CPU indefinitely, until an exception or a STOP instruction occurs.
+//! - `m68000_*_run_schedule` which runs several slices of `m68000_*_cycle_until_exception` in a single call, requesting an interrupt before each slice.
+//! - `m68000_*_run_pool` which runs many independent cores with their own memory callbacks on several threads,
+//! calling a handler for each exception or STOP instruction.
 //! - `m68000_*_disassembler_interpreter` which behaves like `m68000_*_interpreter` and returns the address and disassembled string of the instruction executed.
 //! - `m68000_*_disassembler_interpreter_exception` which behaves like `m68000_*_interpreter_exception` and returns the address and disassembled string of the instruction executed.
+//! - `m68000_*_trace_interpreter_exception` which behaves like `m68000_*_interpreter_exception` and copies the instruction executed
+//! without disassembling it. Disassemble it later with `m68000_instruction_disassemble`.
 //!
 //! ## Exceptions processing
 //!
 //! To request the core to process an exception, call `m68000_*_exception` with the vector number of the exception to process.
 //!
+//! ## Instruction cache
+//!
+//! `m68000_*_set_instruction_cache` enables the pre-decoded instruction cache, so hot loops are not decoded again on each execution.
+//! Writes done by the core automatically invalidate the cache. If the memory is modified by the application,
+//! call `m68000_*_invalidate_instruction_cache` with the modified range or `m68000_*_clear_instruction_cache`.
+//!
+//! ## Prefetch
+//!
+//! `m68000_*_set_prefetch` enables the prefetch window, which reads the instruction stream ahead of the PC by blocks of
+//! 32 bytes, so the opcodes and extension words do not need a callback each. Writes done by the core automatically
+//! invalidate the window. If the memory is modified by the application, call `m68000_*_invalidate_prefetch`.
+//!
+//! ## Idle loops
+//!
+//! `m68000_*_set_idle_loop_detection` enables the detection of the loops that wait for an interrupt or a device
+//! (branches to self, DBcc and polling loops). They are skipped up to the end of the cycle budget instead of being
+//! interpreted, and the skipped cycles are returned like executed ones.
+//!
+//! ## Memory map
+//!
+//! `m68000_*_map_memory` maps a host memory buffer in the address space of the core, by pages of 64 KiB.
+//! The core then accesses it directly with big-endian loads and stores instead of calling the memory callbacks.
+//! Accesses to unmapped pages and writes to read-only pages still go through the callbacks.
+//! The buffer must stay valid until it is unmapped with `m68000_*_unmap_memory` or the core is deleted.
+//!
+//! ## Hooks
+//!
+//! Breakpoints (`m68000_*_add_breakpoint`), watchpoints (`m68000_*_add_watchpoint`) and the instruction hook
+//! (`m68000_*_set_instruction_hook`) stop the core like a STOP instruction, so the interpreter functions return.
+//! `m68000_*_hook_event` returns the reason, and `m68000_*_resume_from_hook` continues the execution.
+//! `m68000_*_set_coverage` records the address of each instruction executed, checked with `m68000_*_is_covered`.
+//! See the `m68000::hooks` module documentation for more details.
+//!
+//! ## Profiler
+//!
+//! When built with the `profiler` feature, `m68000_*_set_profiler` enables the execution profiler, which counts the
+//! instructions executed and their cycles per ISA and per 256-bytes bucket of addresses, and the exceptions processed.
+//! Copy the counters with `m68000_*_profile_snapshot` and set them to 0 with `m68000_*_reset_profile`.
+//!
+//! ## Performance counters
+//!
+//! Each core always counts the cycles and the instructions executed, the cycles spent stopped, the exceptions
+//! processed per vector number ([M68000_COUNTERS_VECTORS] counters) and the calls to the memory callbacks, for a few additions per instruction.
+//! `m68000_*_counters` returns a copy of them in a [Counters] structure and `m68000_*_reset_counters` sets them to 0.
+//! See the `m68000::counters` module documentation for what is counted.
+//!
 //! ## Accessing the registers
 //!
 //! There are 4 functions to read and write to the core's registers:
@@ -48,6 +113,12 @@
 //! - `m68000_*_get_registers` returns a copy of the registers. Writing to it does not modify the core's registers.
 //! - `m68000_*_set_registers` sets the core's registers to the value of the given [Registers] structure.
 //!
+//! ## Saving the state
+//!
+//! `m68000_*_save_state` writes the full state of the core (registers, STOP state and pending exceptions) in a buffer of
+//! `M68000_STATE_SIZE` bytes, and `m68000_*_load_state` restores it. No allocation is done, so they can be used to take
+//! many snapshots for rewinding. The state has a stable layout and a version number, so it can also be stored in files.
+//!
 //! ## C example
 //!
 //! The code below is a minimalist example showing a single function callback. See the README.md file for a complete example.
@@ -103,11 +174,24 @@
 
 pub mod mc68000;
 pub mod scc68070;
+#[cfg(feature = "static-memory")]
+mod static_memory;
 
 use m68000::{M68000, MemoryAccess, Registers};
+use m68000::counters::Counters;
 use m68000::exception::{Exception, Vector};
+use m68000::hooks::{HookEvent, Watchpoint};
+use m68000::instruction::Instruction;
+use m68000::pool::{Job, M68000Pool};
+use m68000::state::CpuState;
+#[cfg(feature = "static-memory")]
+use static_memory::StaticMemory;
 
-use std::ffi::{c_void, CString};
+use std::ffi::c_void;
+use std::fmt::Write;
+use std::sync::Arc;
+#[cfg(feature = "profiler")]
+use m68000::profiler::ProfileCounter;
 use std::os::raw::c_char;
 
 /// Return type of the `m68000_*_cycle_until_exception`, `m68000_*_loop_until_exception_stop` and
@@ -121,6 +205,144 @@ pub struct m68000_exception_result_t {
     pub exception: Vector,
 }
 
+/// A slice of execution given to `m68000_*_run_schedule`.
+#[allow(non_camel_case_types)]
+#[repr(C)]
+pub struct m68000_schedule_event_t {
+    /// The number of cycles to execute in this slice.
+    pub cycles: usize,
+    /// 0 for no interrupt, the vector number of the exception to request before executing the slice otherwise.
+    pub interrupt: Vector,
+}
+
+/// Result of a slice executed by `m68000_*_run_schedule`.
+#[allow(non_camel_case_types)]
+#[repr(C)]
+pub struct m68000_schedule_result_t {
+    /// The number of cycles executed.
+    pub cycles: usize,
+    /// 0 if no exception occured, the vector number that occured otherwise.
+    pub exception: Vector,
+    /// True if the CPU is stopped by a STOP instruction at the end of the slice.
+    pub stop: bool,
+    /// True if a hook stopped the CPU during the slice, see `m68000_*_hook_event`.
+    pub hook: bool,
+}
+
+/// Handler called by `m68000_*_run_pool` when a job stops on an exception or a STOP instruction.
+///
+/// `job` is the index of the job, `exception` is 0 on a STOP instruction, the vector number that occured otherwise.
+/// Returns true to continue running the job, false when the job is finished.
+#[allow(non_camel_case_types)]
+pub type m68000_pool_handler_t = extern "C" fn(job: usize, exception: Vector, user_data: *mut c_void) -> bool;
+
+/// The handler of `m68000_*_run_pool` and its user data, shared by the worker threads.
+struct PoolHandler {
+    handler: Option<m68000_pool_handler_t>,
+    user_data: *mut c_void,
+}
+
+/// The caller of `m68000_*_run_pool` guarantees the handler and its user data can be used from several threads.
+unsafe impl Sync for PoolHandler {}
+
+impl PoolHandler {
+    fn call(&self, job: usize, vector: Option<Vector>) -> bool {
+        self.handler.is_some_and(|handler| handler(job, vector.unwrap_or(NO_EXCEPTION), self.user_data))
+    }
+}
+
+/// Instruction hook set with `m68000_*_set_instruction_hook`, called with the registers before each instruction.
+/// Returns false to break the execution before the instruction.
+#[allow(non_camel_case_types)]
+pub type m68000_instruction_hook_t = extern "C" fn(regs: *const Registers, user_data: *mut c_void) -> bool;
+
+/// The instruction hook of a core and its user data.
+struct InstructionHook {
+    hook: m68000_instruction_hook_t,
+    user_data: *mut c_void,
+}
+
+/// The caller of `m68000_*_set_instruction_hook` guarantees the hook and its user data can be used from the threads
+/// running the core.
+unsafe impl Send for InstructionHook {}
+unsafe impl Sync for InstructionHook {}
+
+impl InstructionHook {
+    fn call(&self, regs: &Registers) -> bool {
+        (self.hook)(regs, self.user_data)
+    }
+}
+
+/// No hook stopped the core.
+pub const M68000_HOOK_NONE: u8 = 0;
+/// The core stopped on a breakpoint.
+pub const M68000_HOOK_BREAKPOINT: u8 = 1;
+/// The instruction hook requested a break.
+pub const M68000_HOOK_INSTRUCTION: u8 = 2;
+/// A watched address has been accessed.
+pub const M68000_HOOK_WATCHPOINT: u8 = 3;
+
+/// Return type of `m68000_*_hook_event` and `m68000_*_resume_from_hook`.
+#[allow(non_camel_case_types)]
+#[repr(C)]
+pub struct m68000_hook_event_t {
+    /// The kind of event, one of the `M68000_HOOK_*` constants.
+    pub kind: u8,
+    /// The address of the instruction that triggered the event.
+    ///
+    /// The instruction has not been executed on breakpoints and instruction hooks, and has been executed on watchpoints.
+    pub pc: u32,
+    /// The watched address accessed, 0 for other events.
+    pub addr: u32,
+    /// True if the watched access is a write.
+    pub write: bool,
+}
+
+impl From<Option<HookEvent>> for m68000_hook_event_t {
+    fn from(event: Option<HookEvent>) -> Self {
+        match event {
+            None => Self { kind: M68000_HOOK_NONE, pc: 0, addr: 0, write: false },
+            Some(HookEvent::Breakpoint(pc)) => Self { kind: M68000_HOOK_BREAKPOINT, pc, addr: 0, write: false },
+            Some(HookEvent::Instruction(pc)) => Self { kind: M68000_HOOK_INSTRUCTION, pc, addr: 0, write: false },
+            Some(HookEvent::Watchpoint { pc, addr, write }) => Self { kind: M68000_HOOK_WATCHPOINT, pc, addr, write },
+        }
+    }
+}
+
+/// The size in bytes of the buffers used by `m68000_*_save_state` and `m68000_*_load_state`.
+pub const M68000_STATE_SIZE: usize = 128;
+/// Version of the layout of the states written by `m68000_*_save_state`.
+pub const M68000_STATE_VERSION: u32 = 1;
+
+const _: () = assert!(M68000_STATE_SIZE == m68000::state::STATE_SIZE && M68000_STATE_VERSION == m68000::state::STATE_VERSION);
+
+/// Number of exception counters of `m68000_counters_t`, indexed by vector number.
+pub const M68000_COUNTERS_VECTORS: usize = 65;
+
+const _: () = assert!(M68000_COUNTERS_VECTORS == m68000::counters::EXCEPTION_COUNTERS);
+
+/// Number of ISA counters of the profiler, in the order of the `m68000::isa::Isa` enum.
+#[cfg(feature = "profiler")]
+pub const M68000_PROFILE_ISA_COUNT: usize = 85;
+/// Number of address bucket counters of the profiler. Each bucket contains 256 bytes of the 24-bits address space.
+#[cfg(feature = "profiler")]
+pub const M68000_PROFILE_PC_BUCKETS: usize = 65536;
+/// Number of exception vector counters of the profiler, indexed by vector number.
+#[cfg(feature = "profiler")]
+pub const M68000_PROFILE_VECTORS: usize = 256;
+
+#[cfg(feature = "profiler")]
+const _: () = assert!(M68000_PROFILE_ISA_COUNT == m68000::isa::Isa::_Size as usize && M68000_PROFILE_PC_BUCKETS == m68000::profiler::PC_BUCKETS);
+
+/// Copies the `len` first counters of `src` to `dst` if `dst` is not null.
+#[cfg(feature = "profiler")]
+unsafe fn copy_counters<T: Copy>(src: &[T], dst: *mut T, len: usize) {
+    if !dst.is_null() {
+        let len = len.min(src.len());
+        unsafe { std::ptr::copy_nonoverlapping(src.as_ptr(), dst, len); }
+    }
+}
+
 /// Return type of the `m68000_*_disassembler_interpreter` functions.
 #[allow(non_camel_case_types)]
 #[repr(C)]
@@ -143,6 +365,79 @@ pub struct m68000_disassembler_exception_result_t {
     pub exception: Vector,
 }
 
+/// Return type of the `m68000_*_trace_interpreter_exception` functions.
+#[allow(non_camel_case_types)]
+#[repr(C)]
+pub struct m68000_trace_result_t {
+    /// The number of cycles executed.
+    pub cycles: usize,
+    /// 0 if no exception occured, the vector number that occured otherwise.
+    pub exception: Vector,
+    /// True if an instruction has been executed and written to the given instruction.
+    pub executed: bool,
+}
+
+/// [Write] adapter that writes a null-terminated string in a C buffer, truncating what does not fit.
+struct CStrWriter {
+    str: *mut c_char,
+    /// The size of the buffer, null-character included.
+    len: usize,
+    /// The number of characters written, not including the null-character.
+    pos: usize,
+}
+
+impl CStrWriter {
+    /// # Safety
+    ///
+    /// `str` must be valid for writes of `len` bytes.
+    unsafe fn new(str: *mut c_char, len: usize) -> Self {
+        if len > 0 {
+            unsafe { *str = 0; }
+        }
+        Self { str, len, pos: 0 }
+    }
+}
+
+impl Write for CStrWriter {
+    fn write_str(&mut self, s: &str) -> std::fmt::Result {
+        if self.len == 0 {
+            return Ok(());
+        }
+
+        let count = s.len().min(self.len - 1 - self.pos);
+        unsafe {
+            self.str.add(self.pos).copy_from_nonoverlapping(s.as_ptr() as *const c_char, count);
+            self.pos += count;
+            *self.str.add(self.pos) = 0;
+        }
+        Ok(())
+    }
+}
+
+/// Disassembles the given instruction in `str`, or writes an empty string if there is no instruction.
+/// Returns the address of the instruction, or 0 if there is no instruction.
+unsafe fn write_instruction(instruction: Option<&Instruction>, str: *mut c_char, len: usize) -> u32 {
+    let mut writer = unsafe { CStrWriter::new(str, len) };
+    match instruction {
+        Some(inst) => {
+            inst.disassemble_to(&mut writer).unwrap();
+            inst.pc
+        },
+        None => 0,
+    }
+}
+
+/// Disassembles the given instruction.
+///
+/// `str` is a pointer to a C string buffer where the disassembled instruction will be written.
+/// `len` is the maximum size of the buffer, null-charactere included.
+#[no_mangle]
+pub extern "C" fn m68000_instruction_disassemble(instruction: *const Instruction, str: *mut c_char, len: usize) {
+    unsafe {
+        write_instruction(Some(&*instruction), str, len);
+    }
+}
+
 /// Return type of the memory callback functions.
 #[allow(non_camel_case_types)]
 #[repr(C)]
@@ -153,6 +448,9 @@ pub struct m68000_memory_result_t {
     ///
     /// If used as the return value of `m68000_*_peek_next_word`, this field contains the exception vector that occured when trying to read the next word.
     pub exception: Vector,
+    /// Set to the number of extra cycles (wait states) taken by the access, they are added to the execution time of the instruction.
+    /// Unused with `m68000_*_peek_next_word` and `m68000_*_get_next_*`.
+    pub wait_cycles: u32,
 }
 
 /// No exception is 0 (same as Reset).
@@ -161,6 +459,7 @@ const NO_EXCEPTION: Vector = unsafe { Vector::from_raw(0) };
 /// Memory callbacks sent to the interpreter methods.
 ///
 /// Every member must be a valid function pointer, no pointer checks are done when calling the callbacks.
+/// The exception is `get_block` and `set_block` which can be NULL, in which case the long (`get_block`) and word (`set_block`) callbacks are used instead.
 ///
 /// The void* argument passed on each callback is the [user_data](Self::user_data) member,
 /// and its usage is let to the user of this library. For example, this can be used to allow the usage of C++ objects,
@@ -179,66 +478,151 @@ pub struct m68000_callbacks_t {
     pub reset_instruction: extern "C" fn(user_data: *mut c_void),
 
     pub user_data: *mut c_void,
+
+    /// Reads `len` bytes starting at `addr` in `data`, for the instructions that transfer several values at once (MOVEM).
+    /// `addr` and `len` are even and `len` is not 0. Can be NULL.
+    ///
+    /// The block callbacks are the last members so the initializers written before they existed stay valid.
+    pub get_block: Option<extern "C" fn(addr: u32, data: *mut u8, len: usize, user_data: *mut c_void) -> m68000_memory_result_t>,
+    /// Writes the `len` bytes of `data` starting at `addr`, for the instructions that transfer several values at once (MOVEM).
+    /// `addr` and `len` are even and `len` is not 0. Can be NULL.
+    pub set_block: Option<extern "C" fn(addr: u32, data: *const u8, len: usize, user_data: *mut c_void) -> m68000_memory_result_t>,
+}
+
+/// Returns the data of the given callback result, or None if an exception occured.
+#[inline(always)]
+fn callback_result(res: m68000_memory_result_t) -> Option<u32> {
+    if res.exception == NO_EXCEPTION {
+        Some(res.data)
+    } else {
+        None
+    }
 }
 
 impl MemoryAccess for m68000_callbacks_t {
     fn get_byte(&mut self, addr: u32) -> Option<u8> {
-        let res = (self.get_byte)(addr, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(res.data as u8)
-        } else {
-            None
-        }
+        callback_result((self.get_byte)(addr, self.user_data)).map(|data| data as u8)
     }
 
     fn get_word(&mut self, addr: u32) -> Option<u16> {
-        let res = (self.get_word)(addr, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(res.data as u16)
-        } else {
-            None
-        }
+        callback_result((self.get_word)(addr, self.user_data)).map(|data| data as u16)
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        callback_result((self.get_long)(addr, self.user_data))
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        callback_result((self.set_byte)(addr, value, self.user_data)).map(|_| ())
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        callback_result((self.set_word)(addr, value, self.user_data)).map(|_| ())
+    }
 
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        callback_result((self.set_long)(addr, value, self.user_data)).map(|_| ())
+    }
+
+    fn reset_instruction(&mut self) {
+        (self.reset_instruction)(self.user_data)
+    }
+}
+
+/// The memory callbacks used by the interpreter functions, which count the wait cycles returned by the callbacks.
+struct Callbacks<'a> {
+    callbacks: &'a mut m68000_callbacks_t,
+    wait_cycles: usize,
+}
+
+impl Callbacks<'_> {
+    /// # Safety
+    ///
+    /// `memory` must be a valid pointer to the callbacks.
+    unsafe fn new<'a>(memory: *mut m68000_callbacks_t) -> Callbacks<'a> {
+        Callbacks { callbacks: unsafe { &mut *memory }, wait_cycles: 0 }
+    }
+
+    #[inline(always)]
+    fn result(&mut self, res: m68000_memory_result_t) -> Option<u32> {
+        self.wait_cycles += res.wait_cycles as usize;
+        callback_result(res)
+    }
+}
+
+/// The caller of `m68000_*_run_pool` guarantees the callbacks can be used from another thread.
+unsafe impl Send for Callbacks<'_> {}
+
+impl MemoryAccess for Callbacks<'_> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        let res = (self.callbacks.get_byte)(addr, self.callbacks.user_data);
+        self.result(res).map(|data| data as u8)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let res = (self.callbacks.get_word)(addr, self.callbacks.user_data);
+        self.result(res).map(|data| data as u16)
     }
 
     fn get_long(&mut self, addr: u32) -> Option<u32> {
-        let res = (self.get_long)(addr, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(res.data)
-        } else {
-            None
-        }
+        let res = (self.callbacks.get_long)(addr, self.callbacks.user_data);
+        self.result(res)
     }
 
     fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
-        let res = (self.set_byte)(addr, value, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(())
-        } else {
-            None
-        }
+        let res = (self.callbacks.set_byte)(addr, value, self.callbacks.user_data);
+        self.result(res).map(|_| ())
     }
 
     fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
-        let res = (self.set_word)(addr, value, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(())
-        } else {
-            None
-        }
+        let res = (self.callbacks.set_word)(addr, value, self.callbacks.user_data);
+        self.result(res).map(|_| ())
     }
 
     fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
-        let res = (self.set_long)(addr, value, self.user_data);
-        if res.exception == NO_EXCEPTION {
-            Some(())
-        } else {
-            None
+        let res = (self.callbacks.set_long)(addr, value, self.callbacks.user_data);
+        self.result(res).map(|_| ())
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        if let Some(get_block) = self.callbacks.get_block {
+            let res = get_block(addr, data.as_mut_ptr(), data.len(), self.callbacks.user_data);
+            return self.result(res).map(|_| ());
+        }
+
+        // Read longs to halve the number of calls.
+        let mut longs = data.chunks_exact_mut(4);
+        let mut addr = addr;
+        for long in &mut longs {
+            long.copy_from_slice(&self.get_long(addr)?.to_be_bytes());
+            addr = addr.wrapping_add(4);
+        }
+        if !longs.into_remainder().is_empty() {
+            let len = data.len();
+            data[len - 2..].copy_from_slice(&self.get_word(addr)?.to_be_bytes());
         }
+        Some(())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        if let Some(set_block) = self.callbacks.set_block {
+            let res = set_block(addr, data.as_ptr(), data.len(), self.callbacks.user_data);
+            return self.result(res).map(|_| ());
+        }
+
+        for (i, word) in data.chunks_exact(2).enumerate() {
+            self.set_word(addr.wrapping_add(i as u32 * 2), u16::from_be_bytes([word[0], word[1]]))?;
+        }
+        Some(())
     }
 
     fn reset_instruction(&mut self) {
-        (self.reset_instruction)(self.user_data)
+        (self.callbacks.reset_instruction)(self.callbacks.user_data)
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        std::mem::take(&mut self.wait_cycles)
     }
 }
 
@@ -280,7 +664,7 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _cycle>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, cycles: usize) -> usize {
                 unsafe {
-                    (*m68000).cycle(&mut *memory, cycles)
+                    (*m68000).cycle(&mut Callbacks::new(memory), cycles)
                 }
             }
 
@@ -294,7 +678,7 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _cycle_until_exception>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, cycles: usize) -> m68000_exception_result_t {
                 unsafe {
-                    let (cycles, vector) = (*m68000).cycle_until_exception(&mut *memory, cycles);
+                    let (cycles, vector) = (*m68000).cycle_until_exception(&mut Callbacks::new(memory), cycles);
                     m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
                 }
             }
@@ -306,16 +690,154 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _loop_until_exception_stop>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t) -> m68000_exception_result_t {
                 unsafe {
-                    let (cycles, vector) = (*m68000).loop_until_exception_stop(&mut *memory);
+                    let (cycles, vector) = (*m68000).loop_until_exception_stop(&mut Callbacks::new(memory));
                     m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
                 }
             }
 
+            /// `m68000_*_cycle` with the memory handlers defined by the application (`m68000_static_*`),
+            /// called with `user_data`.
+            #[cfg(feature = "static-memory")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _static_cycle>](m68000: *mut M68000<$cpu_details>, user_data: *mut c_void, cycles: usize) -> usize {
+                unsafe {
+                    (*m68000).cycle(&mut StaticMemory::new(user_data), cycles)
+                }
+            }
+
+            /// `m68000_*_cycle_until_exception` with the memory handlers defined by the application (`m68000_static_*`),
+            /// called with `user_data`.
+            #[cfg(feature = "static-memory")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _static_cycle_until_exception>](m68000: *mut M68000<$cpu_details>, user_data: *mut c_void, cycles: usize) -> m68000_exception_result_t {
+                unsafe {
+                    let (cycles, vector) = (*m68000).cycle_until_exception(&mut StaticMemory::new(user_data), cycles);
+                    m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
+                }
+            }
+
+            /// `m68000_*_loop_until_exception_stop` with the memory handlers defined by the application (`m68000_static_*`),
+            /// called with `user_data`.
+            #[cfg(feature = "static-memory")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _static_loop_until_exception_stop>](m68000: *mut M68000<$cpu_details>, user_data: *mut c_void) -> m68000_exception_result_t {
+                unsafe {
+                    let (cycles, vector) = (*m68000).loop_until_exception_stop(&mut StaticMemory::new(user_data));
+                    m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
+                }
+            }
+
+            /// `m68000_*_interpreter` with the memory handlers defined by the application (`m68000_static_*`),
+            /// called with `user_data`.
+            #[cfg(feature = "static-memory")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _static_interpreter>](m68000: *mut M68000<$cpu_details>, user_data: *mut c_void) -> usize {
+                unsafe {
+                    (*m68000).interpreter(&mut StaticMemory::new(user_data))
+                }
+            }
+
+            /// `m68000_*_interpreter_exception` with the memory handlers defined by the application (`m68000_static_*`),
+            /// called with `user_data`.
+            #[cfg(feature = "static-memory")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _static_interpreter_exception>](m68000: *mut M68000<$cpu_details>, user_data: *mut c_void) -> m68000_exception_result_t {
+                unsafe {
+                    let (cycles, vector) = (*m68000).interpreter_exception(&mut StaticMemory::new(user_data));
+                    m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
+                }
+            }
+
+            /// Runs the `count` slices of `events` and stores their result in `results`, which must be `count` long.
+            ///
+            /// Before each slice, the interrupt of the event is requested if it is not 0.
+            /// Then the slice is executed like `m68000_*_cycle_until_exception`, except that a stopped CPU consumes
+            /// the whole cycle budget of the slice like `m68000_*_cycle`.
+            ///
+            /// Stops after the first slice ending with an exception or a hook break, so the application can handle it
+            /// and resume the schedule by calling this function with the remaining events. A slice ending with a hook
+            /// break is not padded to its cycle budget.
+            /// Returns the number of slices executed.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _run_schedule>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, events: *const m68000_schedule_event_t, results: *mut m68000_schedule_result_t, count: usize) -> usize {
+                if count == 0 {
+                    return 0;
+                }
+
+                unsafe {
+                    let core = &mut *m68000;
+                    let memory = &mut Callbacks::new(memory);
+                    let events = std::slice::from_raw_parts(events, count);
+                    let results = std::slice::from_raw_parts_mut(results, count);
+
+                    for (i, (event, result)) in events.iter().zip(results.iter_mut()).enumerate() {
+                        if event.interrupt != NO_EXCEPTION {
+                            core.exception(Exception::from(event.interrupt));
+                        }
+
+                        let (mut cycles, vector) = core.cycle_until_exception(memory, event.cycles);
+                        let hook = core.hook_event().is_some();
+                        if core.stop && !hook && vector.is_none() && cycles < event.cycles {
+                            // Let m68000_*_cycle pass and count the rest of the slice as stopped.
+                            cycles += core.cycle(memory, event.cycles - cycles);
+                        }
+
+                        *result = m68000_schedule_result_t {
+                            cycles,
+                            exception: vector.unwrap_or(NO_EXCEPTION),
+                            stop: core.stopped_by_instruction(),
+                            hook,
+                        };
+
+                        if vector.is_some() || hook {
+                            return i + 1;
+                        }
+                    }
+                }
+
+                count
+            }
+
+            /// Runs the `count` independent jobs made of `cores[i]` and `memories[i]` on `threads` worker threads
+            /// (0 for the available parallelism of the host), and returns when they are all finished.
+            ///
+            /// Each job runs like `m68000_*_loop_until_exception_stop`. When it stops, `handler` is called from the worker
+            /// thread with the index of the job and the vector of the exception (0 on a STOP instruction). It can handle the
+            /// exception (for example a TRAP used as a syscall) through `cores[job]`, and returns true to continue running
+            /// the job or false when it is finished. If `handler` is NULL, each job finishes at its first exception or STOP.
+            ///
+            /// `results[i]` receives the total number of cycles executed by job `i` and its last exception.
+            ///
+            /// The memory callbacks and the handler are called concurrently from several threads and must be thread-safe.
+            /// Read-only data like a ROM image can be shared by the memories of all the jobs.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _run_pool>](cores: *const *mut M68000<$cpu_details>, memories: *mut m68000_callbacks_t, results: *mut m68000_exception_result_t, count: usize, threads: usize, handler: Option<m68000_pool_handler_t>, user_data: *mut c_void) {
+                if count == 0 {
+                    return;
+                }
+
+                unsafe {
+                    let cores = std::slice::from_raw_parts(cores, count);
+                    let mut memories: Vec<Callbacks> = (0..count).map(|i| Callbacks::new(memories.add(i))).collect();
+                    let mut jobs: Vec<Job<$cpu_details, Callbacks>> = cores.iter().zip(memories.iter_mut())
+                        .map(|(&core, memory)| Job::new(&mut *core, memory))
+                        .collect();
+
+                    let handler = &PoolHandler { handler, user_data };
+                    M68000Pool::new(threads).run(&mut jobs, |i, _, vector| handler.call(i, vector));
+
+                    let results = std::slice::from_raw_parts_mut(results, count);
+                    for (job, result) in jobs.iter().zip(results.iter_mut()) {
+                        *result = m68000_exception_result_t { cycles: job.cycles, exception: job.exception.unwrap_or(NO_EXCEPTION) };
+                    }
+                }
+            }
+
             /// Executes the next instruction, returning the cycle count necessary to execute it.
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _interpreter>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t) -> usize {
                 unsafe {
-                    (*m68000).interpreter(&mut *memory)
+                    (*m68000).interpreter(&mut Callbacks::new(memory))
                 }
             }
 
@@ -326,7 +848,7 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _interpreter_exception>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t) -> m68000_exception_result_t {
                 unsafe {
-                    let (cycles, vector) = (*m68000).interpreter_exception(&mut *memory);
+                    let (cycles, vector) = (*m68000).interpreter_exception(&mut Callbacks::new(memory));
                     m68000_exception_result_t { cycles, exception: vector.unwrap_or(NO_EXCEPTION) }
                 }
             }
@@ -338,17 +860,10 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _disassembler_interpreter>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, str: *mut c_char, len: usize) -> m68000_disassembler_result_t {
                 unsafe {
-                    let (pc, dis, cycles) = (*m68000).disassembler_interpreter(&mut *memory);
-
-                    let cstring = CString::new(dis).expect("New CString for disassembler failed")
-                        .into_bytes_with_nul();
-                    let raw_cstring = std::mem::transmute::<*const u8, *const c_char>(cstring.as_ptr());
-
-                    if cstring.len() <= len {
-                        str.copy_from_nonoverlapping(raw_cstring, cstring.len());
-                    } else {
-                        str.copy_from_nonoverlapping(raw_cstring, len - 1);
-                        *str.add(len - 1) = 0;
+                    let (instruction, cycles, vector) = (*m68000).trace_interpreter_exception(&mut Callbacks::new(memory));
+                    let pc = write_instruction(instruction.as_ref(), str, len);
+                    if let Some(e) = vector {
+                        (*m68000).exception(Exception::from(e));
                     }
 
                     m68000_disassembler_result_t {
@@ -368,23 +883,36 @@ macro_rules! cinterface {
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _disassembler_interpreter_exception>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, str: *mut c_char, len: usize) -> m68000_disassembler_exception_result_t {
                 unsafe {
-                    let (pc, dis, cycles, vector) = (*m68000).disassembler_interpreter_exception(&mut *memory);
+                    let (instruction, cycles, vector) = (*m68000).trace_interpreter_exception(&mut Callbacks::new(memory));
+                    let pc = write_instruction(instruction.as_ref(), str, len);
 
-                    let cstring = CString::new(dis).expect("New CString for disassembler failed")
-                        .into_bytes_with_nul();
-                    let raw_cstring = std::mem::transmute::<*const u8, *const c_char>(cstring.as_ptr());
+                    m68000_disassembler_exception_result_t {
+                        cycles,
+                        pc,
+                        exception: vector.unwrap_or(NO_EXCEPTION),
+                    }
+                }
+            }
 
-                    if cstring.len() <= len {
-                        str.copy_from_nonoverlapping(raw_cstring, cstring.len());
-                    } else {
-                        str.copy_from_nonoverlapping(raw_cstring, len - 1);
-                        *str.add(len - 1) = 0;
+            /// Executes the next instruction and copies it in `instruction` without disassembling it, returning the cycle count
+            /// necessary to execute it, and the vector of the exception that occured during the execution if any.
+            ///
+            /// `instruction` is written only if an instruction has been executed, which is indicated by the `executed` member.
+            /// It can be disassembled later with `m68000_instruction_disassemble`.
+            ///
+            /// To process the returned exception, call `m68000_*_exception`.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _trace_interpreter_exception>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t, instruction: *mut Instruction) -> m68000_trace_result_t {
+                unsafe {
+                    let (inst, cycles, vector) = (*m68000).trace_interpreter_exception(&mut Callbacks::new(memory));
+                    if let Some(inst) = inst {
+                        *instruction = inst;
                     }
 
-                    m68000_disassembler_exception_result_t {
+                    m68000_trace_result_t {
                         cycles,
-                        pc,
-                        exception: vector.unwrap_or(NO_EXCEPTION) ,
+                        exception: vector.unwrap_or(NO_EXCEPTION),
+                        executed: inst.is_some(),
                     }
                 }
             }
@@ -397,6 +925,241 @@ macro_rules! cinterface {
                 }
             }
 
+            /// Enables or disables the pre-decoded instruction cache.
+            ///
+            /// Only enable it if instruction fetches have no side effects on your memory system.
+            /// See the `m68000::instruction_cache` module documentation for more details.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_instruction_cache>](m68000: *mut M68000<$cpu_details>, enabled: bool) {
+                unsafe {
+                    (*m68000).set_instruction_cache(enabled)
+                }
+            }
+
+            /// Discards the cached instructions in the given address range.
+            ///
+            /// Call this function after the memory has been modified by something else than the core.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _invalidate_instruction_cache>](m68000: *mut M68000<$cpu_details>, addr: u32, len: u32) {
+                unsafe {
+                    (*m68000).invalidate_instruction_cache(addr, len)
+                }
+            }
+
+            /// Discards every cached instruction.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _clear_instruction_cache>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).clear_instruction_cache()
+                }
+            }
+
+            /// Enables or disables the prefetch window.
+            ///
+            /// Only enable it if instruction fetches have no side effects on your memory system.
+            /// See the `m68000::prefetch` module documentation for more details.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_prefetch>](m68000: *mut M68000<$cpu_details>, enabled: bool) {
+                unsafe {
+                    (*m68000).set_prefetch(enabled)
+                }
+            }
+
+            /// Discards the prefetched words.
+            ///
+            /// Call this function after the memory has been modified by something else than the core.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _invalidate_prefetch>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).invalidate_prefetch()
+                }
+            }
+
+            /// Enables or disables the detection of idle loops (branches to self, DBcc and polling loops), which are
+            /// skipped up to the cycle budget by `m68000_*_cycle`, `m68000_*_cycle_until_exception` and `m68000_*_run_schedule`.
+            ///
+            /// Must only be enabled if memory reads have no side effects and the memory is not modified during the calls.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_idle_loop_detection>](m68000: *mut M68000<$cpu_details>, enabled: bool) {
+                unsafe {
+                    (*m68000).set_idle_loop_detection(enabled)
+                }
+            }
+
+            /// Maps `len` bytes of host memory starting at `data` to the addresses starting at `addr`.
+            ///
+            /// `data` is stored in big-endian format. If `writable` is false, writes are sent to the memory callbacks.
+            /// `data` must stay valid until it is unmapped or the core is deleted.
+            ///
+            /// Returns false and maps nothing if `addr` is not a multiple of 64 KiB or if the range overflows the address space.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _map_memory>](m68000: *mut M68000<$cpu_details>, addr: u32, data: *mut u8, len: usize, writable: bool) -> bool {
+                if addr % m68000::memory_map::PAGE_SIZE != 0 || addr as u64 + len as u64 > 1 << 32 {
+                    return false;
+                }
+
+                unsafe {
+                    (*m68000).map_memory(addr, data, len, writable);
+                }
+                true
+            }
+
+            /// Unmaps the pages containing the given address range, so they are accessed through the memory callbacks again.
+            /// The range is clamped to the end of the address space, so `len` can be `SIZE_MAX` to unmap everything after `addr`.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _unmap_memory>](m68000: *mut M68000<$cpu_details>, addr: u32, len: usize) {
+                unsafe {
+                    (*m68000).unmap_memory(addr, len)
+                }
+            }
+
+            /// Adds a breakpoint at the given address.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _add_breakpoint>](m68000: *mut M68000<$cpu_details>, addr: u32) {
+                unsafe {
+                    (*m68000).add_breakpoint(addr)
+                }
+            }
+
+            /// Removes the breakpoint at the given address if any.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _remove_breakpoint>](m68000: *mut M68000<$cpu_details>, addr: u32) {
+                unsafe {
+                    (*m68000).remove_breakpoint(addr)
+                }
+            }
+
+            /// Removes all the breakpoints.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _clear_breakpoints>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).clear_breakpoints()
+                }
+            }
+
+            /// Adds a watchpoint on the `len` bytes starting at `addr`, breaking on reads (including instruction fetches)
+            /// if `read` is true and on writes if `write` is true.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _add_watchpoint>](m68000: *mut M68000<$cpu_details>, addr: u32, len: u32, read: bool, write: bool) {
+                unsafe {
+                    (*m68000).add_watchpoint(Watchpoint { range: addr..addr.saturating_add(len), read, write })
+                }
+            }
+
+            /// Removes all the watchpoints.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _clear_watchpoints>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).clear_watchpoints()
+                }
+            }
+
+            /// Sets the instruction hook called before each instruction with `user_data`, or removes it if `hook` is NULL.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_instruction_hook>](m68000: *mut M68000<$cpu_details>, hook: Option<m68000_instruction_hook_t>, user_data: *mut c_void) {
+                let hook = hook.map(|hook| {
+                    let hook = InstructionHook { hook, user_data };
+                    Arc::new(move |regs: &Registers| hook.call(regs)) as m68000::hooks::InstructionHook
+                });
+
+                unsafe {
+                    (*m68000).set_instruction_hook(hook)
+                }
+            }
+
+            /// Enables or disables the coverage collection. Disabling it discards the addresses recorded.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_coverage>](m68000: *mut M68000<$cpu_details>, enabled: bool) {
+                unsafe {
+                    (*m68000).set_coverage(enabled)
+                }
+            }
+
+            /// Returns true if the instruction at the given address has been executed since coverage collection is enabled.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _is_covered>](m68000: *const M68000<$cpu_details>, addr: u32) -> bool {
+                unsafe {
+                    (*m68000).is_covered(addr)
+                }
+            }
+
+            /// Returns the event that stopped the core, with the kind `M68000_HOOK_NONE` if it has not been stopped by a hook.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _hook_event>](m68000: *const M68000<$cpu_details>) -> m68000_hook_event_t {
+                unsafe {
+                    (*m68000).hook_event().into()
+                }
+            }
+
+            /// Resumes the execution after a hook stopped the core, and returns the event that stopped it.
+            ///
+            /// The breakpoint and the instruction hook are not checked on the next instruction.
+            /// Does nothing and returns the kind `M68000_HOOK_NONE` if the core has not been stopped by a hook.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _resume_from_hook>](m68000: *mut M68000<$cpu_details>) -> m68000_hook_event_t {
+                unsafe {
+                    (*m68000).resume_from_hook().into()
+                }
+            }
+
+            /// Enables or disables the profiler. Disabling it discards the counters.
+            #[cfg(feature = "profiler")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _set_profiler>](m68000: *mut M68000<$cpu_details>, enabled: bool) {
+                unsafe {
+                    (*m68000).set_profiler(enabled)
+                }
+            }
+
+            /// Sets all the counters of the profiler to 0.
+            #[cfg(feature = "profiler")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _reset_profile>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).reset_profile()
+                }
+            }
+
+            /// Copies the counters of the profiler in the given arrays.
+            ///
+            /// Each array receives at most its given length of counters, and can be NULL to be ignored.
+            /// `isa` is indexed in the order of the `m68000::isa::Isa` enum ([M68000_PROFILE_ISA_COUNT] counters),
+            /// `pc` by instruction address divided by 256 ([M68000_PROFILE_PC_BUCKETS] counters)
+            /// and `vectors` by exception vector number ([M68000_PROFILE_VECTORS] counters).
+            ///
+            /// Returns false and copies nothing if the profiler is disabled.
+            #[cfg(feature = "profiler")]
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _profile_snapshot>](m68000: *const M68000<$cpu_details>, isa: *mut ProfileCounter, isa_len: usize, pc: *mut ProfileCounter, pc_len: usize, vectors: *mut u64, vectors_len: usize) -> bool {
+                unsafe {
+                    match (*m68000).profile() {
+                        Some(profile) => {
+                            copy_counters(&profile.isa, isa, isa_len);
+                            copy_counters(&profile.pc, pc, pc_len);
+                            copy_counters(&profile.vectors, vectors, vectors_len);
+                            true
+                        },
+                        None => false,
+                    }
+                }
+            }
+
+            /// Returns a copy of the performance counters.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _counters>](m68000: *const M68000<$cpu_details>) -> Counters {
+                unsafe {
+                    *(*m68000).counters()
+                }
+            }
+
+            /// Sets all the performance counters to 0.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _reset_counters>](m68000: *mut M68000<$cpu_details>) {
+                unsafe {
+                    (*m68000).reset_counters()
+                }
+            }
+
             /// Returns the 16-bits word at the current PC value of the given core and advances PC by 2.
             #[no_mangle]
             pub extern "C" fn [<m68000_ $cpu _get_next_word>](m68000: *mut M68000<$cpu_details>, memory: *mut m68000_callbacks_t) -> m68000_memory_result_t {
@@ -405,10 +1168,12 @@ macro_rules! cinterface {
                         Ok(data) => m68000_memory_result_t {
                             data: data as u32,
                             exception: NO_EXCEPTION,
+                            wait_cycles: 0,
                         },
                         Err(vec) => m68000_memory_result_t {
                             data: 0,
                             exception: vec,
+                            wait_cycles: 0,
                         },
                     }
                 }
@@ -422,10 +1187,12 @@ macro_rules! cinterface {
                         Ok(data) => m68000_memory_result_t {
                             data: data,
                             exception: NO_EXCEPTION,
+                            wait_cycles: 0,
                         },
                         Err(vec) => m68000_memory_result_t {
                             data: 0,
                             exception: vec,
+                            wait_cycles: 0,
                         },
                     }
                 }
@@ -439,10 +1206,12 @@ macro_rules! cinterface {
                         Ok(data) => m68000_memory_result_t {
                             data: data as u32,
                             exception: NO_EXCEPTION,
+                            wait_cycles: 0,
                         },
                         Err(vec) => m68000_memory_result_t {
                             data: 0,
                             exception: vec,
+                            wait_cycles: 0,
                         },
                     }
                 }
@@ -479,6 +1248,26 @@ macro_rules! cinterface {
                     (*m68000).regs = regs;
                 }
             }
+
+            /// Writes the state of the core in `state`, which must be a buffer of `M68000_STATE_SIZE` bytes.
+            ///
+            /// The state contains the registers, the STOP state and the pending exceptions, but not the memory.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _save_state>](m68000: *const M68000<$cpu_details>, state: *mut u8) {
+                unsafe {
+                    *(state as *mut CpuState) = (*m68000).save_state();
+                }
+            }
+
+            /// Restores the state of the core from `state`, a buffer of `M68000_STATE_SIZE` bytes written by `m68000_*_save_state`.
+            ///
+            /// Returns false and does not modify the core if the version of the state is not supported.
+            #[no_mangle]
+            pub extern "C" fn [<m68000_ $cpu _load_state>](m68000: *mut M68000<$cpu_details>, state: *const u8) -> bool {
+                unsafe {
+                    (*m68000).load_state(&*(state as *const CpuState)).is_ok()
+                }
+            }
         }
     };
 }
@@ -0,0 +1,106 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Memory accesses resolved at link time.
+//!
+//! With the `static-memory` feature, the memory handlers are not function pointers but functions named
+//! `m68000_static_*` that the application defines, and that the `m68000_*_static_*` functions call directly.
+//! When the application and the library are built with cross-language link-time optimization, these calls can be
+//! inlined in the interpreter.
+
+use crate::m68000_memory_result_t;
+
+use m68000::MemoryAccess;
+
+use std::ffi::c_void;
+
+extern "C" {
+    fn m68000_static_get_byte(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t;
+    fn m68000_static_get_word(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t;
+    fn m68000_static_get_long(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t;
+
+    fn m68000_static_set_byte(addr: u32, data: u8, user_data: *mut c_void) -> m68000_memory_result_t;
+    fn m68000_static_set_word(addr: u32, data: u16, user_data: *mut c_void) -> m68000_memory_result_t;
+    fn m68000_static_set_long(addr: u32, data: u32, user_data: *mut c_void) -> m68000_memory_result_t;
+
+    fn m68000_static_get_block(addr: u32, data: *mut u8, len: usize, user_data: *mut c_void) -> m68000_memory_result_t;
+    fn m68000_static_set_block(addr: u32, data: *const u8, len: usize, user_data: *mut c_void) -> m68000_memory_result_t;
+
+    fn m68000_static_reset_instruction(user_data: *mut c_void);
+}
+
+/// The memory handlers defined by the application, which count the wait cycles returned by the handlers.
+pub(crate) struct StaticMemory {
+    user_data: *mut c_void,
+    wait_cycles: usize,
+}
+
+impl StaticMemory {
+    pub fn new(user_data: *mut c_void) -> Self {
+        Self { user_data, wait_cycles: 0 }
+    }
+
+    #[inline(always)]
+    fn result(&mut self, res: m68000_memory_result_t) -> Option<u32> {
+        self.wait_cycles += res.wait_cycles as usize;
+        crate::callback_result(res)
+    }
+}
+
+impl MemoryAccess for StaticMemory {
+    #[inline(always)]
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        let res = unsafe { m68000_static_get_byte(addr, self.user_data) };
+        self.result(res).map(|data| data as u8)
+    }
+
+    #[inline(always)]
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let res = unsafe { m68000_static_get_word(addr, self.user_data) };
+        self.result(res).map(|data| data as u16)
+    }
+
+    #[inline(always)]
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        let res = unsafe { m68000_static_get_long(addr, self.user_data) };
+        self.result(res)
+    }
+
+    #[inline(always)]
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        let res = unsafe { m68000_static_set_byte(addr, value, self.user_data) };
+        self.result(res).map(|_| ())
+    }
+
+    #[inline(always)]
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        let res = unsafe { m68000_static_set_word(addr, value, self.user_data) };
+        self.result(res).map(|_| ())
+    }
+
+    #[inline(always)]
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        let res = unsafe { m68000_static_set_long(addr, value, self.user_data) };
+        self.result(res).map(|_| ())
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let res = unsafe { m68000_static_get_block(addr, data.as_mut_ptr(), data.len(), self.user_data) };
+        self.result(res).map(|_| ())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        let res = unsafe { m68000_static_set_block(addr, data.as_ptr(), data.len(), self.user_data) };
+        self.result(res).map(|_| ())
+    }
+
+    fn reset_instruction(&mut self) {
+        unsafe { m68000_static_reset_instruction(self.user_data) }
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        std::mem::take(&mut self.wait_cycles)
+    }
+}
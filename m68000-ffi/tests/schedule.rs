@@ -0,0 +1,123 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the slices executed by `m68000_*_run_schedule`.
+
+use m68000::assembler as asm;
+use m68000::exception::Vector;
+use m68000_ffi::{M68000_HOOK_BREAKPOINT, m68000_callbacks_t, m68000_memory_result_t, m68000_schedule_event_t, m68000_schedule_result_t};
+use m68000_ffi::mc68000::*;
+
+use std::ffi::c_void;
+
+const START: u32 = 0x1000;
+
+fn memory<'a>(user_data: *mut c_void) -> &'a mut Vec<u8> {
+    unsafe { &mut *(user_data as *mut Vec<u8>) }
+}
+
+fn result(data: Option<u32>) -> m68000_memory_result_t {
+    match data {
+        Some(data) => m68000_memory_result_t { data, exception: unsafe { Vector::from_raw(0) }, wait_cycles: 0 },
+        None => m68000_memory_result_t { data: 0, exception: Vector::AccessError, wait_cycles: 0 },
+    }
+}
+
+extern "C" fn get_byte(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    result(memory(user_data).get(addr as usize).map(|&b| b as u32))
+}
+
+extern "C" fn get_word(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get(addr as usize..addr as usize + 2).map(|w| u16::from_be_bytes([w[0], w[1]]) as u32))
+}
+
+extern "C" fn get_long(addr: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get(addr as usize..addr as usize + 4).map(|l| u32::from_be_bytes([l[0], l[1], l[2], l[3]])))
+}
+
+extern "C" fn set_byte(addr: u32, data: u8, user_data: *mut c_void) -> m68000_memory_result_t {
+    result(memory(user_data).get_mut(addr as usize).map(|b| { *b = data; 0 }))
+}
+
+extern "C" fn set_word(addr: u32, data: u16, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get_mut(addr as usize..addr as usize + 2).map(|w| { w.copy_from_slice(&data.to_be_bytes()); 0 }))
+}
+
+extern "C" fn set_long(addr: u32, data: u32, user_data: *mut c_void) -> m68000_memory_result_t {
+    let memory = memory(user_data);
+    result(memory.get_mut(addr as usize..addr as usize + 4).map(|l| { l.copy_from_slice(&data.to_be_bytes()); 0 }))
+}
+
+extern "C" fn reset_instruction(_: *mut c_void) {}
+
+fn callbacks(memory: &mut Vec<u8>) -> m68000_callbacks_t {
+    m68000_callbacks_t {
+        get_byte,
+        get_word,
+        get_long,
+        set_byte,
+        set_word,
+        set_long,
+        reset_instruction,
+        user_data: memory as *mut Vec<u8> as *mut c_void,
+        get_block: None,
+        set_block: None,
+    }
+}
+
+fn events(count: usize) -> Vec<m68000_schedule_event_t> {
+    (0..count).map(|_| m68000_schedule_event_t { cycles: 100, interrupt: unsafe { Vector::from_raw(0) } }).collect()
+}
+
+fn results(count: usize) -> Vec<m68000_schedule_result_t> {
+    (0..count).map(|_| m68000_schedule_result_t { cycles: 0, exception: Vector::AccessError, stop: false, hook: false }).collect()
+}
+
+#[test]
+fn breakpoint() {
+    // 0x1000: MOVEQ #1, D0
+    // 0x1002: MOVEQ #2, D0
+    // 0x1004: STOP #0x2700
+    let mut program = vec![asm::moveq(0, 1), asm::moveq(0, 2)];
+    program.extend(asm::stop(0x2700));
+    let mut memory = vec![0u8; 0x2000];
+    for (i, word) in program.iter().enumerate() {
+        let addr = START as usize + i * 2;
+        memory[addr..addr + 2].copy_from_slice(&word.to_be_bytes());
+    }
+    let mut callbacks = callbacks(&mut memory);
+
+    let core = m68000_mc68000_new_no_reset();
+    unsafe { (*m68000_mc68000_registers_mut(core)).pc.0 = START; }
+    m68000_mc68000_add_breakpoint(core, 0x1002);
+
+    // The schedule returns at the breakpoint, without padding the slice.
+    let events = events(3);
+    let mut results = results(3);
+    let done = m68000_mc68000_run_schedule(core, &mut callbacks, events.as_ptr(), results.as_mut_ptr(), 3);
+    assert_eq!(done, 1);
+    assert_eq!((results[0].cycles, results[0].exception as u8, results[0].stop, results[0].hook), (4, 0, false, true));
+
+    let event = m68000_mc68000_hook_event(core);
+    assert_eq!((event.kind, event.pc), (M68000_HOOK_BREAKPOINT, 0x1002));
+    unsafe { assert_eq!((*m68000_mc68000_registers_mut(core)).d[0].0, 1); }
+
+    // The remaining slices execute up to the STOP instruction, and then are padded.
+    m68000_mc68000_resume_from_hook(core);
+    let done = m68000_mc68000_run_schedule(core, &mut callbacks, events[1..].as_ptr(), results[1..].as_mut_ptr(), 2);
+    assert_eq!(done, 2);
+    assert_eq!((results[1].cycles, results[1].exception as u8, results[1].stop, results[1].hook), (100, 0, true, false));
+    assert_eq!((results[2].cycles, results[2].exception as u8, results[2].stop, results[2].hook), (100, 0, true, false));
+    unsafe { assert_eq!((*m68000_mc68000_registers_mut(core)).d[0].0, 2); }
+
+    // The padding is counted as stopped, the slice ending at the breakpoint is not padded.
+    let counters = m68000_mc68000_counters(core);
+    assert_eq!(counters.cycles, 4 + 4 + 4);
+    assert_eq!(counters.stopped_cycles, 200 - 8);
+
+    m68000_mc68000_delete(core);
+}
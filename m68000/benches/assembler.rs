@@ -0,0 +1,121 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Throughput benchmarks of the assembler and of the decoding of its output.
+//!
+//! Each benchmark assembles the same program of mixed instructions, with the free functions returning vectors, with
+//! the [Assembler] builder in a reused vector and in a fixed slice, and decodes it back with [Instruction::from_memory].
+//! It reports the number of instructions processed per second.
+//!
+//! Run with `cargo bench --bench assembler`. Arguments are used as filters on the benchmark names.
+
+use m68000::MemoryAccess;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler::{self as asm, Assembler, CodeBuffer, Condition as CC, SliceBuffer};
+use m68000::instruction::{Direction, Instruction, Size};
+
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+/// Number of times the instruction mix is repeated in the program.
+const REPEATS: usize = 20_000;
+/// Number of instructions in the mix.
+const MIX: usize = 8;
+/// Number of samples. The fastest one is reported.
+const SAMPLES: usize = 5;
+
+/// Appends the instruction mix with the free functions.
+fn functions(code: &mut Vec<u16>, i: usize) {
+    let reg = (i & 7) as u8;
+    code.extend(asm::r#move(Size::Long, AM::AbsLong(0x10_0000), AM::Immediate(i as u32)));
+    code.extend(asm::add(reg, Direction::DstReg, Size::Word, AM::Ariwd(reg, 8)));
+    code.push(asm::moveq(reg, i as i8));
+    code.extend(asm::movem(Direction::RegisterToMemory, Size::Long, AM::Ariwpr(7), 0x7FFE));
+    code.extend(asm::lea(reg, AM::Pciwd(0, 0x100)));
+    code.extend(asm::cmpi(Size::Byte, AM::Drd(reg), 0x42));
+    code.extend(asm::bcc(CC::NE, -20));
+    code.extend(asm::dbcc(CC::F, reg, -40));
+}
+
+/// Appends the instruction mix with the builder.
+fn builder<B: CodeBuffer>(code: &mut Assembler<B>, i: usize) {
+    let reg = (i & 7) as u8;
+    code.r#move(Size::Long, AM::AbsLong(0x10_0000), AM::Immediate(i as u32))
+        .add(reg, Direction::DstReg, Size::Word, AM::Ariwd(reg, 8))
+        .moveq(reg, i as i8)
+        .movem(Direction::RegisterToMemory, Size::Long, AM::Ariwpr(7), 0x7FFE)
+        .lea(reg, AM::Pciwd(0, 0x100))
+        .cmpi(Size::Byte, AM::Drd(reg), 0x42)
+        .bcc(CC::NE, -20)
+        .dbcc(CC::F, reg, -40);
+}
+
+/// Returns the fastest duration of the given function.
+fn measure(mut f: impl FnMut()) -> Duration {
+    let mut best = Duration::MAX;
+    for _ in 0..SAMPLES {
+        let start = Instant::now();
+        f();
+        best = best.min(start.elapsed());
+    }
+    best
+}
+
+fn main() {
+    let filters: Vec<String> = std::env::args().skip(1).filter(|arg| !arg.starts_with("--")).collect();
+    let enabled = |name: &str| filters.is_empty() || filters.iter().any(|f| name.contains(f.as_str()));
+
+    let mut program = Vec::new();
+    for i in 0..REPEATS {
+        functions(&mut program, i);
+    }
+
+    if enabled("functions") {
+        report("functions", measure(|| {
+            let mut code = Vec::new();
+            for i in 0..REPEATS {
+                functions(&mut code, black_box(i));
+            }
+            assert_eq!(black_box(code).len(), program.len());
+        }));
+    }
+
+    if enabled("assembler_vec") {
+        let mut code = Assembler::with_buffer(Vec::with_capacity(program.len()));
+        report("assembler_vec", measure(|| {
+            code.clear();
+            for i in 0..REPEATS {
+                builder(&mut code, black_box(i));
+            }
+            assert_eq!(black_box(code.words()), program);
+        }));
+    }
+
+    if enabled("assembler_slice") {
+        let mut array = vec![0; program.len()];
+        report("assembler_slice", measure(|| {
+            let mut code = Assembler::with_buffer(SliceBuffer::new(&mut array));
+            for i in 0..REPEATS {
+                builder(&mut code, black_box(i));
+            }
+            assert_eq!(black_box(code.words()), program);
+        }));
+    }
+
+    if enabled("decode") {
+        report("decode", measure(|| {
+            let mut memory = &program[..];
+            let mut iter = memory.iter_u16(0);
+            for _ in 0..REPEATS * MIX {
+                black_box(Instruction::from_memory(&mut iter).unwrap());
+            }
+            assert_eq!(iter.next_addr as usize, program.len() * 2);
+        }));
+    }
+}
+
+fn report(name: &str, duration: Duration) {
+    let minstr = (REPEATS * MIX) as f64 / duration.as_secs_f64() / 1_000_000.0;
+    println!("{name:<16} {minstr:>9.2} Minstr/s");
+}
@@ -0,0 +1,47 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Throughput benchmark of the fuzzer.
+//!
+//! Runs the same fuzzing session on one thread and on all the threads of the host, and reports the number of cases
+//! executed per second, each case being executed on both the MC68000 and the SCC68070.
+//!
+//! Run with `cargo bench --bench fuzz`. Arguments are used as filters on the benchmark names.
+
+use m68000::fuzz::Fuzzer;
+
+use std::time::{Duration, Instant};
+
+/// Number of rounds of the session.
+const ROUNDS: usize = 10;
+/// Number of cases of each round.
+const CASES_PER_ROUND: usize = 200_000;
+
+fn main() {
+    let filters: Vec<String> = std::env::args().skip(1).filter(|arg| !arg.starts_with("--")).collect();
+    let enabled = |name: &str| filters.is_empty() || filters.iter().any(|f| name.contains(f.as_str()));
+
+    let mut reference = None;
+    for (name, threads) in [("single_thread", 1), ("all_threads", 0)] {
+        if !enabled(name) {
+            continue;
+        }
+
+        let mut fuzzer = Fuzzer::new(threads);
+        let start = Instant::now();
+        let report = fuzzer.run(0, ROUNDS, CASES_PER_ROUND);
+        report_speed(name, fuzzer.threads(), start.elapsed());
+        assert!(report.divergences.is_empty(), "{} divergences", report.divergences.len());
+
+        let trace = reference.get_or_insert(report.trace);
+        let start = Instant::now();
+        assert!(fuzzer.check(trace).mismatches.is_empty());
+        report_speed(&format!("{name}_check"), fuzzer.threads(), start.elapsed());
+    }
+}
+
+fn report_speed(name: &str, threads: usize, duration: Duration) {
+    let mcases = (ROUNDS * CASES_PER_ROUND) as f64 / duration.as_secs_f64() / 1_000_000.0;
+    println!("{name:<20} {threads:>3} threads {mcases:>9.2} Mcases/s");
+}
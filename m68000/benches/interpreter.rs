@@ -0,0 +1,296 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Throughput benchmarks of the interpreter hot paths.
+//!
+//! Each benchmark runs an endless loop of a given instruction class on both the MC68000 and the SCC68070, and reports
+//! the number of instructions executed per second and the emulated frequency (cycles executed per second).
+//!
+//! Run with `cargo bench --bench interpreter`. Arguments are used as filters on the benchmark names.
+//!
+//! The benchmarks use a small std-only harness that reports the best of [SAMPLES] samples, so the crates keep no
+//! dependencies.
+
+use m68000::{CpuDetails, M68000};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::{Mc68000, Scc68070};
+use m68000::exception::Vector;
+use m68000::instruction::{Direction, Size};
+
+use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+/// Number of instructions executed in each sample.
+const INSTRUCTIONS: usize = 2_000_000;
+/// Number of samples. The fastest one is reported.
+const SAMPLES: usize = 5;
+
+const START: u32 = 0x1000;
+const TRAP_HANDLER: u32 = 0x3000;
+const SUBROUTINE: u32 = 0x3100;
+const SOURCE: u16 = 0x4000;
+const DESTINATION: u16 = 0x6000;
+const MEMORY_SIZE: usize = 0x1_0000;
+
+/// How the memory is given to the core.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Setup {
+    /// A plain `[u8]` slice.
+    Slice,
+    /// A plain `[u8]` slice with the instruction cache enabled.
+    Cached,
+    /// The memory mapped in the core's memory map.
+    Mapped,
+    /// A plain `[u8]` slice with the instruction cache enabled, executed with [M68000::cycle] by the block tier.
+    #[cfg(feature = "block-exec")]
+    BlockExec,
+}
+
+/// A benchmark program, made of an endless loop.
+struct Program {
+    name: &'static str,
+    code: Vec<u16>,
+    setup: Setup,
+}
+
+/// Appends to `code` a BRA to the given word index.
+fn close_loop(code: &mut Vec<u16>, start: usize) {
+    let disp = -(((code.len() - start) * 2 + 2) as i16);
+    code.extend(asm::bra(disp));
+}
+
+fn move_heavy() -> Vec<u16> {
+    let mut code = asm::lea(0, AM::AbsShort(SOURCE));
+    code.extend(asm::lea(1, AM::AbsShort(DESTINATION)));
+    for _ in 0..8 {
+        code.extend(asm::r#move(Size::Long, AM::Ariwpo(1), AM::Ariwpo(0)));
+    }
+    code.extend(asm::r#move(Size::Word, AM::Ariwd(1, 4), AM::Drd(0)));
+    code.extend(asm::r#move(Size::Byte, AM::Drd(1), AM::Ari(0)));
+    code.push(asm::moveq(2, 42));
+    close_loop(&mut code, 0);
+    code
+}
+
+fn alu() -> Vec<u16> {
+    let mut code = asm::add(1, Direction::DstReg, Size::Long, AM::Drd(0));
+    code.extend(asm::sub(2, Direction::DstReg, Size::Long, AM::Drd(1)));
+    code.extend(asm::and(3, Direction::DstReg, Size::Word, AM::Drd(2)));
+    code.extend(asm::or(4, Direction::DstReg, Size::Long, AM::Drd(3)));
+    code.extend(asm::eor(4, Size::Long, AM::Drd(5)));
+    code.extend(asm::cmp(6, Size::Long, AM::Drd(5)));
+    code.extend(asm::addq(1, Size::Long, AM::Drd(0)));
+    code.extend(asm::add(7, Direction::DstReg, Size::Word, AM::Immediate(0x1234)));
+    code.push(asm::swap(7));
+    code.push(asm::ror(3, Direction::Left, Size::Long, false, 6));
+    close_loop(&mut code, 0);
+    code
+}
+
+/// Register operations of many sizes and registers, so the opcodes are spread over the decoder table.
+fn mixed_opcodes() -> Vec<u16> {
+    let mut code = Vec::new();
+    for reg in 0..8 {
+        let src = AM::Drd((reg + 3) % 8);
+        for size in [Size::Byte, Size::Word, Size::Long] {
+            code.extend(asm::add(reg, Direction::DstReg, size, src));
+            code.extend(asm::sub(reg, Direction::DstReg, size, AM::Drd((reg + 5) % 8)));
+            code.extend(asm::and(reg, Direction::DstReg, size, src));
+            code.extend(asm::or(reg, Direction::DstReg, size, src));
+            code.extend(asm::eor(reg, size, AM::Drd((reg + 1) % 8)));
+            code.extend(asm::cmp(reg, size, src));
+            code.extend(asm::r#move(size, AM::Drd(reg), src));
+        }
+    }
+    close_loop(&mut code, 0);
+    code
+}
+
+fn movem() -> Vec<u16> {
+    // MOVEM.L D0-D7/A0-A6, -(A7)
+    // MOVEM.L (A7)+, D0-D7/A0-A6
+    let mut code = asm::movem(Direction::RegisterToMemory, Size::Long, AM::Ariwpr(7), 0xFFFE);
+    code.extend(asm::movem(Direction::MemoryToRegister, Size::Long, AM::Ariwpo(7), 0x7FFF));
+    code.extend(asm::movem(Direction::RegisterToMemory, Size::Word, AM::AbsShort(DESTINATION), 0x00FF));
+    close_loop(&mut code, 0);
+    code
+}
+
+fn division() -> Vec<u16> {
+    let mut code = vec![asm::moveq(1, 7)];
+    let start = code.len();
+    code.extend(asm::r#move(Size::Long, AM::Drd(0), AM::Immediate(100_000)));
+    code.extend(asm::divu(0, AM::Drd(1)));
+    code.extend(asm::r#move(Size::Long, AM::Drd(2), AM::Immediate(-100_000i32 as u32)));
+    code.extend(asm::divs(2, AM::Drd(1)));
+    close_loop(&mut code, start);
+    code
+}
+
+fn branches() -> Vec<u16> {
+    // loop:  MOVEQ #15, D0
+    // inner: ADDQ.L #1, D1
+    //        BVS.S skip ; Never taken.
+    //        NOP
+    // skip:  DBF D0, inner
+    //        BRA loop
+    let mut code = vec![asm::moveq(0, 15)];
+    let inner = code.len();
+    code.extend(asm::addq(1, Size::Long, AM::Drd(1)));
+    code.extend(asm::bcc(CC::VS, 2));
+    code.push(asm::nop());
+    let disp = -(((code.len() - inner) * 2 + 2) as i16);
+    code.extend(asm::dbcc(CC::F, 0, disp));
+    close_loop(&mut code, 0);
+    code
+}
+
+fn exception() -> Vec<u16> {
+    let mut code = vec![asm::trap(0)];
+    code.extend(asm::addq(1, Size::Long, AM::Drd(0)));
+    close_loop(&mut code, 0);
+    code
+}
+
+/// End-to-end loop that looks like ROM code: checksums a buffer, copies it and calls a subroutine.
+fn rom_loop() -> Vec<u16> {
+    let mut code = asm::lea(0, AM::AbsShort(SOURCE));
+    code.extend(asm::lea(1, AM::AbsShort(DESTINATION)));
+    code.extend(asm::r#move(Size::Word, AM::Drd(1), AM::Immediate(63)));
+    code.push(asm::moveq(0, 0));
+    let inner = code.len();
+    code.extend(asm::r#move(Size::Byte, AM::Drd(2), AM::Ari(0)));
+    code.extend(asm::add(0, Direction::DstReg, Size::Long, AM::Drd(2)));
+    code.push(asm::ror(1, Direction::Left, Size::Long, false, 0));
+    code.extend(asm::r#move(Size::Byte, AM::Ariwpo(1), AM::Ariwpo(0)));
+    code.extend(asm::tst(Size::Byte, AM::Drd(2)));
+    code.extend(asm::bcc(CC::MI, 2));
+    code.push(asm::nop());
+    let disp = -(((code.len() - inner) * 2 + 2) as i16);
+    code.extend(asm::dbcc(CC::F, 1, disp));
+    code.extend(asm::jsr(AM::AbsShort(SUBROUTINE as u16)));
+    close_loop(&mut code, 0);
+    code
+}
+
+fn programs() -> Vec<Program> {
+    vec![
+        Program { name: "move", code: move_heavy(), setup: Setup::Slice },
+        Program { name: "alu", code: alu(), setup: Setup::Slice },
+        Program { name: "mixed_opcodes", code: mixed_opcodes(), setup: Setup::Slice },
+        Program { name: "movem", code: movem(), setup: Setup::Slice },
+        Program { name: "divs_divu", code: division(), setup: Setup::Slice },
+        Program { name: "bcc_dbcc", code: branches(), setup: Setup::Slice },
+        Program { name: "exception_rte", code: exception(), setup: Setup::Slice },
+        Program { name: "rom_loop", code: rom_loop(), setup: Setup::Slice },
+        Program { name: "rom_loop_cached", code: rom_loop(), setup: Setup::Cached },
+        Program { name: "rom_loop_mapped", code: rom_loop(), setup: Setup::Mapped },
+        #[cfg(feature = "block-exec")]
+        Program { name: "rom_loop_block_exec", code: rom_loop(), setup: Setup::BlockExec },
+    ]
+}
+
+/// Returns the memory with the given program, the exception vectors and the handlers.
+fn load(code: &[u16]) -> Vec<u8> {
+    let mut memory = vec![0; MEMORY_SIZE];
+    let mut write = |addr: u32, words: &[u16]| {
+        for (i, word) in words.iter().enumerate() {
+            let addr = addr as usize + i * 2;
+            memory[addr..addr + 2].copy_from_slice(&word.to_be_bytes());
+        }
+    };
+
+    write(Vector::Trap0Instruction as u32 * 4, &[(TRAP_HANDLER >> 16) as u16, TRAP_HANDLER as u16]);
+    write(TRAP_HANDLER, &[asm::rte()]);
+
+    let mut subroutine = asm::r#move(Size::Long, AM::AbsShort(DESTINATION + 0x100), AM::Drd(0));
+    subroutine.push(asm::rts());
+    write(SUBROUTINE, &subroutine);
+
+    let pattern: Vec<u16> = (0..0x100).map(|i: u16| i.wrapping_mul(0x9E37)).collect();
+    write(SOURCE as u32, &pattern);
+
+    write(START, code);
+    memory
+}
+
+/// Runs the given program and returns the best duration and the number of cycles executed.
+fn run<CPU: CpuDetails>(program: &Program) -> (Duration, usize) {
+    let mut memory = load(&program.code);
+    let mut cpu = M68000::<CPU>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = MEMORY_SIZE as u32;
+
+    match program.setup {
+        Setup::Slice => (),
+        Setup::Cached => cpu.set_instruction_cache(true),
+        #[cfg(feature = "block-exec")]
+        Setup::BlockExec => cpu.set_instruction_cache(true),
+        // SAFETY: the memory outlives the core.
+        Setup::Mapped => unsafe { cpu.map_memory(0, memory.as_mut_ptr(), memory.len(), true) },
+    }
+
+    // The block tier runs for a number of cycles, so measure how many cycles the instructions take.
+    #[cfg(feature = "block-exec")]
+    let budget = if program.setup == Setup::BlockExec {
+        let mut probe = M68000::<CPU>::new_no_reset();
+        probe.regs = cpu.regs;
+        let mut memory = memory.clone();
+        (0..INSTRUCTIONS).map(|_| probe.interpreter(&mut memory[..])).sum()
+    } else {
+        0
+    };
+
+    let mut best = Duration::MAX;
+    let mut cycles = 0;
+    for _ in 0..SAMPLES {
+        let mut sample_cycles = 0;
+        let start = Instant::now();
+        #[cfg(feature = "block-exec")]
+        if program.setup == Setup::BlockExec {
+            sample_cycles = cpu.cycle(black_box(&mut memory[..]), budget);
+        }
+
+        if program.setup == Setup::Mapped {
+            let mut empty: [u8; 0] = [];
+            for _ in 0..INSTRUCTIONS {
+                sample_cycles += cpu.interpreter(black_box(&mut empty[..]));
+            }
+        } else if sample_cycles == 0 {
+            for _ in 0..INSTRUCTIONS {
+                sample_cycles += cpu.interpreter(black_box(&mut memory[..]));
+            }
+        }
+        let elapsed = start.elapsed();
+
+        if elapsed < best {
+            best = elapsed;
+            cycles = sample_cycles;
+        }
+    }
+
+    (best, cycles)
+}
+
+fn report(program: &str, cpu: &str, (duration, cycles): (Duration, usize)) {
+    let seconds = duration.as_secs_f64();
+    let mips = INSTRUCTIONS as f64 / seconds / 1_000_000.0;
+    let mhz = cycles as f64 / seconds / 1_000_000.0;
+    println!("{program:<16} {cpu:<9} {mips:>9.2} Minstr/s {mhz:>9.2} MHz");
+}
+
+fn main() {
+    let filters: Vec<String> = std::env::args().skip(1).filter(|arg| !arg.starts_with("--")).collect();
+
+    for program in programs() {
+        if !filters.is_empty() && !filters.iter().any(|f| program.name.contains(f.as_str())) {
+            continue;
+        }
+
+        report(program.name, "MC68000", run::<Mc68000>(&program));
+        report(program.name, "SCC68070", run::<Scc68070>(&program));
+    }
+}
@@ -137,23 +137,31 @@ impl AddressingMode {
     /// Left tuple contains the mode and register encoded as in the low 6 bits of the opcode.
     /// Right tuple contains the extension words.
     pub fn assemble(self, long: bool) -> (u16, Box<[u16]>) {
+        let (eafield, ext, len) = self.assemble_array(long);
+        (eafield, ext[..len].into())
+    }
+
+    /// Same as [Self::assemble] without allocating, usable in const contexts.
+    ///
+    /// The extension words are the first `len` words of the array, returned in the last tuple field.
+    pub const fn assemble_array(self, long: bool) -> (u16, [u16; 2], usize) {
         match self {
-            AddressingMode::Drd(reg) => (reg as u16, Box::new([])),
-            AddressingMode::Ard(reg) => (1 << 3 | reg as u16, Box::new([])),
-            AddressingMode::Ari(reg) => (2 << 3 | reg as u16, Box::new([])),
-            AddressingMode::Ariwpo(reg) => (3 << 3 | reg as u16, Box::new([])),
-            AddressingMode::Ariwpr(reg) => (4 << 3 | reg as u16, Box::new([])),
-            AddressingMode::Ariwd(reg, disp) => (5 << 3 | reg as u16, Box::new([disp as u16])),
-            AddressingMode::Ariwi8(reg, bew) => (6 << 3 | reg as u16, Box::new([bew.0])),
-            AddressingMode::AbsShort(addr) => (7 << 3, Box::new([addr])),
-            AddressingMode::AbsLong(addr) => (7 << 3 | 1, Box::new([(addr >> 16) as u16, addr as u16])),
-            AddressingMode::Pciwd(_, disp) => (7 << 3 | 2, Box::new([disp as u16])),
-            AddressingMode::Pciwi8(_, bew) => (7 << 3 | 3, Box::new([bew.0])),
+            AddressingMode::Drd(reg) => (reg as u16, [0; 2], 0),
+            AddressingMode::Ard(reg) => (1 << 3 | reg as u16, [0; 2], 0),
+            AddressingMode::Ari(reg) => (2 << 3 | reg as u16, [0; 2], 0),
+            AddressingMode::Ariwpo(reg) => (3 << 3 | reg as u16, [0; 2], 0),
+            AddressingMode::Ariwpr(reg) => (4 << 3 | reg as u16, [0; 2], 0),
+            AddressingMode::Ariwd(reg, disp) => (5 << 3 | reg as u16, [disp as u16, 0], 1),
+            AddressingMode::Ariwi8(reg, bew) => (6 << 3 | reg as u16, [bew.0, 0], 1),
+            AddressingMode::AbsShort(addr) => (7 << 3, [addr, 0], 1),
+            AddressingMode::AbsLong(addr) => (7 << 3 | 1, [(addr >> 16) as u16, addr as u16], 2),
+            AddressingMode::Pciwd(_, disp) => (7 << 3 | 2, [disp as u16, 0], 1),
+            AddressingMode::Pciwi8(_, bew) => (7 << 3 | 3, [bew.0, 0], 1),
             AddressingMode::Immediate(imm) => {
                 if long {
-                    (7 << 3 | 4, Box::new([(imm >> 16) as u16, imm as u16]))
+                    (7 << 3 | 4, [(imm >> 16) as u16, imm as u16], 2)
                 } else {
-                    (7 << 3 | 4, Box::new([imm as u16]))
+                    (7 << 3 | 4, [imm as u16, 0], 1)
                 }
             },
         }
@@ -166,17 +174,27 @@ impl AddressingMode {
     /// Left tuple contains the mode and register encoded as in the destination (bits 6 to 11).
     /// Right tuple contains the extension words.
     pub fn assemble_move_dst(self) -> (u16, Box<[u16]>) {
+        assert!(!matches!(self, AddressingMode::Pciwd(..) | AddressingMode::Pciwi8(..) | AddressingMode::Immediate(_)),
+            "{self:?} mode cannot be used as a destination mode.");
+        let (eafield, ext, len) = self.assemble_move_dst_array();
+        (eafield, ext[..len].into())
+    }
+
+    /// Same as [Self::assemble_move_dst] without allocating, usable in const contexts.
+    ///
+    /// The extension words are the first `len` words of the array, returned in the last tuple field.
+    pub const fn assemble_move_dst_array(self) -> (u16, [u16; 2], usize) {
         match self {
-            AddressingMode::Drd(reg) => ((reg as u16) << 9, Box::new([])),
-            AddressingMode::Ard(reg) => ((reg as u16) << 9 | 1 << 6, Box::new([])),
-            AddressingMode::Ari(reg) => ((reg as u16) << 9 | 2 << 6, Box::new([])),
-            AddressingMode::Ariwpo(reg) => ((reg as u16) << 9 | 3 << 6, Box::new([])),
-            AddressingMode::Ariwpr(reg) => ((reg as u16) << 9 | 4 << 6, Box::new([])),
-            AddressingMode::Ariwd(reg, disp) => ((reg as u16) << 9 | 5 << 6, Box::new([disp as u16])),
-            AddressingMode::Ariwi8(reg, bew) => ((reg as u16) << 9 | 6 << 6, Box::new([bew.0])),
-            AddressingMode::AbsShort(addr) => (7 << 6, Box::new([addr])),
-            AddressingMode::AbsLong(addr) => (1 << 9 | 7 << 6, Box::new([(addr >> 16) as u16, addr as u16])),
-            _ => panic!("{self:?} mode cannot be used as a destination mode."),
+            AddressingMode::Drd(reg) => ((reg as u16) << 9, [0; 2], 0),
+            AddressingMode::Ard(reg) => ((reg as u16) << 9 | 1 << 6, [0; 2], 0),
+            AddressingMode::Ari(reg) => ((reg as u16) << 9 | 2 << 6, [0; 2], 0),
+            AddressingMode::Ariwpo(reg) => ((reg as u16) << 9 | 3 << 6, [0; 2], 0),
+            AddressingMode::Ariwpr(reg) => ((reg as u16) << 9 | 4 << 6, [0; 2], 0),
+            AddressingMode::Ariwd(reg, disp) => ((reg as u16) << 9 | 5 << 6, [disp as u16, 0], 1),
+            AddressingMode::Ariwi8(reg, bew) => ((reg as u16) << 9 | 6 << 6, [bew.0, 0], 1),
+            AddressingMode::AbsShort(addr) => (7 << 6, [addr, 0], 1),
+            AddressingMode::AbsLong(addr) => (1 << 9 | 7 << 6, [(addr >> 16) as u16, addr as u16], 2),
+            _ => panic!("This mode cannot be used as a destination mode."),
         }
     }
 
@@ -184,22 +202,34 @@ impl AddressingMode {
     ///
     /// `modes` contains the list of valid addressing modes.
     /// `regs` contains the valid register values for Mode 7, if is in `modes`.
-    pub fn verify(self, modes: &[u8], regs: &[u8]) -> bool {
+    pub const fn verify(self, modes: &[u8], regs: &[u8]) -> bool {
         match self {
-            AddressingMode::Drd(reg) => reg <= 7 && modes.contains(&0),
-            AddressingMode::Ard(reg) => reg <= 7 && modes.contains(&1),
-            AddressingMode::Ari(reg) => reg <= 7 && modes.contains(&2),
-            AddressingMode::Ariwpo(reg) => reg <= 7 && modes.contains(&3),
-            AddressingMode::Ariwpr(reg) => reg <= 7 && modes.contains(&4),
-            AddressingMode::Ariwd(reg, _) => reg <= 7 && modes.contains(&5),
-            AddressingMode::Ariwi8(reg,_) => reg <= 7 && modes.contains(&6),
-            AddressingMode::AbsShort(_) => modes.contains(&7) && regs.contains(&0),
-            AddressingMode::AbsLong(_) => modes.contains(&7) && regs.contains(&1),
-            AddressingMode::Pciwd(_, _) => modes.contains(&7) && regs.contains(&2),
-            AddressingMode::Pciwi8(_, _) => modes.contains(&7) && regs.contains(&3),
-            AddressingMode::Immediate(_) => modes.contains(&7) && regs.contains(&4),
+            AddressingMode::Drd(reg) => reg <= 7 && contains(modes, 0),
+            AddressingMode::Ard(reg) => reg <= 7 && contains(modes, 1),
+            AddressingMode::Ari(reg) => reg <= 7 && contains(modes, 2),
+            AddressingMode::Ariwpo(reg) => reg <= 7 && contains(modes, 3),
+            AddressingMode::Ariwpr(reg) => reg <= 7 && contains(modes, 4),
+            AddressingMode::Ariwd(reg, _) => reg <= 7 && contains(modes, 5),
+            AddressingMode::Ariwi8(reg,_) => reg <= 7 && contains(modes, 6),
+            AddressingMode::AbsShort(_) => contains(modes, 7) && contains(regs, 0),
+            AddressingMode::AbsLong(_) => contains(modes, 7) && contains(regs, 1),
+            AddressingMode::Pciwd(_, _) => contains(modes, 7) && contains(regs, 2),
+            AddressingMode::Pciwi8(_, _) => contains(modes, 7) && contains(regs, 3),
+            AddressingMode::Immediate(_) => contains(modes, 7) && contains(regs, 4),
+        }
+    }
+}
+
+/// `slice.contains(&value)` usable in const contexts.
+const fn contains(slice: &[u8], value: u8) -> bool {
+    let mut i = 0;
+    while i < slice.len() {
+        if slice[i] == value {
+            return true;
         }
+        i += 1;
     }
+    false
 }
 
 impl std::fmt::Display for AddressingMode {
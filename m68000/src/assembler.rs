@@ -11,6 +11,18 @@
 //! The shift/rotate instructions are regrouped by their destination location and not by their shift/rotate direction.
 //! So [asm] is the arithmetic shift with the data in memory, and [asr] is the arithmetic shift with data in register.
 //! The direction is specified as a parameter in these functions.
+//!
+//! The free functions return the words of a single instruction. To assemble whole programs without allocating an
+//! intermediate vector per instruction, use the [Assembler] builder, which appends the instructions to a [CodeBuffer]
+//! (a `Vec<u16>` or a fixed [SliceBuffer]) and resolves the branch displacements of its [Label]s.
+//! [ConstAssembler] has the same methods as const functions, to build programs at compile time:
+//!
+//! ```
+//! use m68000::assembler::ConstAssembler;
+//!
+//! const ROM: [u16; 3] = ConstAssembler::new().moveq(0, 42).stop(0x2700).finish();
+//! assert_eq!(ROM, [0x702A, 0x4E72, 0x2700]);
+//! ```
 
 #![allow(clippy::unusual_byte_groupings)]
 
@@ -63,183 +75,226 @@ const MODES_0234567: [u8; 7] = [0, 2, 3, 4, 5, 6, 7];
 /// Modes 0, 1, 2, 3, 4, 5, 6 and 7.
 const MODES_01234567: [u8; 8] = [0, 1, 2, 3, 4, 5, 6, 7];
 
-/// ADDI, ANDI, CMPI, EORI, ORI, SUBI
-fn size_effective_address_immediate(bits8_15: u8, size: Size, am: AddressingMode, mut imm: u32) -> Vec<u16> {
-    let mut vec = Vec::new();
+/// The maximum length of an instruction, MOVE.L #imm, (xxx).L.
+const MAX_WORDS: usize = 5;
+
+/// The words of an assembled instruction, stored inline.
+#[derive(Clone, Copy)]
+struct Words {
+    words: [u16; MAX_WORDS],
+    len: usize,
+}
+
+impl Words {
+    const fn one(opcode: u16) -> Self {
+        let mut words = [0; MAX_WORDS];
+        words[0] = opcode;
+        Self { words, len: 1 }
+    }
+
+    const fn from_array<const N: usize>(array: [u16; N]) -> Self {
+        let mut words = Self { words: [0; MAX_WORDS], len: 0 };
+        let mut i = 0;
+        while i < N {
+            words = words.push(array[i]);
+            i += 1;
+        }
+        words
+    }
+
+    const fn push(mut self, word: u16) -> Self {
+        self.words[self.len] = word;
+        self.len += 1;
+        self
+    }
+
+    /// Appends the first `len` extension words returned by [AddressingMode::assemble_array].
+    const fn extend(mut self, ext: [u16; 2], len: usize) -> Self {
+        let mut i = 0;
+        while i < len {
+            self = self.push(ext[i]);
+            i += 1;
+        }
+        self
+    }
+
+    fn as_slice(&self) -> &[u16] {
+        &self.words[..self.len]
+    }
+}
+
+/// Converts the words to the return type of the free functions.
+trait FromWords {
+    fn from_words(words: Words) -> Self;
+}
+
+impl FromWords for u16 {
+    fn from_words(words: Words) -> Self {
+        words.words[0]
+    }
+}
+
+impl FromWords for [u16; 2] {
+    fn from_words(words: Words) -> Self {
+        [words.words[0], words.words[1]]
+    }
+}
 
-    let (eafield, eaext) = am.assemble(size.is_long());
+impl FromWords for Vec<u16> {
+    fn from_words(words: Words) -> Self {
+        words.as_slice().to_vec()
+    }
+}
+
+/// Returns the primary size bits of the given size, usable in const contexts.
+const fn size_bits(size: Size) -> u16 {
+    match size {
+        Size::Byte => 0,
+        Size::Word => 1,
+        Size::Long => 2,
+    }
+}
+
+/// Returns the single size bit of the given size (like MOVEM), usable in const contexts.
+const fn size_bit(size: Size) -> u16 {
+    match size {
+        Size::Word => 0,
+        Size::Long => 1,
+        Size::Byte => panic!("Byte size cannot be used."),
+    }
+}
+
+/// Returns the displacement of a branch whose opcode is at word index `from` to the word index `target`.
+const fn branch_displacement(from: usize, target: usize) -> i16 {
+    let disp = (target as isize - from as isize - 1) * 2;
+    assert!(disp >= i16::MIN as isize && disp <= i16::MAX as isize, "Branch displacement out of range.");
+    disp as i16
+}
+
+/// ADDI, ANDI, CMPI, EORI, ORI, SUBI
+const fn size_effective_address_immediate(bits8_15: u8, size: Size, am: AddressingMode, mut imm: u32) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(size.is_long());
     let opcode = (bits8_15 as u16) << 8
-               | Into::<u16>::into(size) << 6
+               | size_bits(size) << 6
                | eafield;
-    vec.push(opcode);
+    let mut words = Words::one(opcode);
 
     if size.is_long() {
-        vec.push((imm >> 16) as u16);
+        words = words.push((imm >> 16) as u16);
     } else if size.is_byte() {
         imm &= 0x0000_00FF;
     }
-    vec.push(imm as u16);
-    vec.extend(eaext.iter());
-
-    vec
+    words.push(imm as u16).extend(eaext, len)
 }
 
 /// static BCHG, BCLR, BSET, BTST
-fn effective_address_count(bits6_15: u16, am: AddressingMode, count: u8) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(false);
+const fn effective_address_count(bits6_15: u16, am: AddressingMode, count: u8) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(false);
     let opcode = (bits6_15 & 0x3FF) << 6
                | eafield;
-    vec.push(opcode);
-    vec.push(count as u16);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).push(count as u16).extend(eaext, len)
 }
 
 /// JMP, JSR, MOVE (f) SR CCR, NBCD, PEA, TAS
-fn effective_address(bits6_15: u16, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(false);
+const fn effective_address(bits6_15: u16, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(false);
     let opcode = (bits6_15 & 0x3FF) << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// CLR, NEG, NEGX, NOT, TST
-fn size_effective_address(bits8_15: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(size.is_long());
+const fn size_effective_address(bits8_15: u8, size: Size, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(size.is_long());
     let opcode = (bits8_15 as u16) << 8
-               | Into::<u16>::into(size) << 6
+               | size_bits(size) << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// dynamic BCHG, BCLR, BSET, BTST, CHK, DIVS, DIVU, LEA, MULS, MULU
-fn register_effective_address(bits12_15: u16, reg: u16, bits6_8: u16, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(false);
+const fn register_effective_address(bits12_15: u16, reg: u16, bits6_8: u16, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(false);
     let opcode = (bits12_15 & 0xF) << 12
                | (reg & 7) << 9
                | (bits6_8 & 7) << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// MOVE, MOVEA
-fn size_effective_address_effective_address(size: Size, dst: AddressingMode, src: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let src = src.assemble(size.is_long());
-    let dst = dst.assemble_move_dst();
-    let opcode = size.into_move() << 12 | dst.0 | src.0;
-
-    vec.push(opcode);
-    vec.extend(src.1.iter());
-    vec.extend(dst.1.iter());
+const fn size_effective_address_effective_address(size: Size, dst: AddressingMode, src: AddressingMode) -> Words {
+    let (srcfield, srcext, srclen) = src.assemble_array(size.is_long());
+    let (dstfield, dstext, dstlen) = dst.assemble_move_dst_array();
+    let opcode = size.into_move() << 12 | dstfield | srcfield;
 
-    vec
+    Words::one(opcode).extend(srcext, srclen).extend(dstext, dstlen)
 }
 
 /// SWAP, UNLK
-fn register(bits3_15: u16, reg: u8) -> u16 {
+const fn register(bits3_15: u16, reg: u8) -> u16 {
     bits3_15 << 3 | reg as u16 & 7
 }
 
 /// ADDQ, SUBQ
-fn data_size_effective_address(data: u8, bit8: u16, size: Size, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(size.is_long());
+const fn data_size_effective_address(data: u8, bit8: u16, size: Size, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(size.is_long());
     let opcode = 0b0101 << 12
                | (data as u16 & 7) << 9
                | (bit8 & 1) << 8
-               | Into::<u16>::into(size) << 6
+               | size_bits(size) << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// Bcc, BRA, BSR
 ///
 /// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
-fn condition_displacement(cond: Condition, disp: i16) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let mut opcode = 0b0110 << 12 | (cond as u16) << 8;
+const fn condition_displacement(cond: Condition, disp: i16) -> Words {
+    let opcode = 0b0110 << 12 | (cond as u16) << 8;
 
     if disp < i8::MIN as i16 || disp > i8::MAX as i16 || disp == 0 {
-        vec.push(opcode);
-        vec.push(disp as u16);
+        Words::from_array([opcode, disp as u16])
     } else {
-        opcode |= disp as u8 as u16;
-        vec.push(opcode);
+        Words::one(opcode | disp as u8 as u16)
     }
-
-    vec
 }
 
 /// ADD, AND, CMP, EOR, OR, SUB
 ///
 /// [Direction::DstReg] or [Direction::DstEa].
-fn register_direction_size_effective_address(bits12_15: u16, reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(size.is_long());
+const fn register_direction_size_effective_address(bits12_15: u16, reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(size.is_long());
     let opcode = bits12_15 << 12
                | (reg as u16) << 9
-               | if dir == Direction::DstEa { 1 } else { 0 } << 8
-               | Into::<u16>::into(size) << 6
+               | if matches!(dir, Direction::DstEa) { 1 } else { 0 } << 8
+               | size_bits(size) << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// ADDA, CMPA, SUBA
-fn register_size_effective_address(bits12_15: u16, reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(size.is_long());
+const fn register_size_effective_address(bits12_15: u16, reg: u8, size: Size, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(size.is_long());
     let opcode = bits12_15 << 12
                | (reg as u16 & 7) << 9
-               | size.into_bit() << 8
+               | size_bit(size) << 8
                | 0b11 << 6
                | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// ABCD, ADDX, SBCD, SUBX
 ///
 /// [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
-fn register_size_mode_register(bits12_15: u16, dst: u8, size: Size, bits4_5: u16, mode: Direction, src: u8) -> u16 {
+const fn register_size_mode_register(bits12_15: u16, dst: u8, size: Size, bits4_5: u16, mode: Direction, src: u8) -> u16 {
     let mut opcode = (bits12_15 & 0xF) << 12
                    | (dst as u16 & 7) << 9
                    | 1 << 8
-                   | Into::<u16>::into(size) << 6
+                   | size_bits(size) << 6
                    | (bits4_5 & 3) << 4
                    | src as u16 & 7;
-    if mode == Direction::MemoryToMemory {
+    if matches!(mode, Direction::MemoryToMemory) {
         opcode |= 0x0008;
     }
 
@@ -247,610 +302,965 @@ fn register_size_mode_register(bits12_15: u16, dst: u8, size: Size, bits4_5: u16
 }
 
 /// ASm, LSm, ROm, ROXm
-fn direction_effective_address(bits9_15: u16, dir: Direction, bits6_7: u16, am: AddressingMode) -> Vec<u16> {
-    let mut vec = Vec::new();
-
-    let (eafield, eaext) = am.assemble(false);
+const fn direction_effective_address(bits9_15: u16, dir: Direction, bits6_7: u16, am: AddressingMode) -> Words {
+    let (eafield, eaext, len) = am.assemble_array(false);
     let mut opcode = (bits9_15 & 0x7F) << 9
                    | (bits6_7 & 3) << 6
                    | eafield;
-    if dir == Direction::Left {
+    if matches!(dir, Direction::Left) {
         opcode |= 0x0100;
     }
-    vec.push(opcode);
-    vec.extend(eaext.iter());
-
-    vec
+    Words::one(opcode).extend(eaext, len)
 }
 
 /// ASr, LSr, ROr, ROXr
-fn rotation_direction_size_mode_register(bits12_15: u16, count_reg: u16, dir: Direction, size: Size, ir: u16, bits3_4: u16, reg: u16) -> u16 {
+const fn rotation_direction_size_mode_register(bits12_15: u16, count_reg: u16, dir: Direction, size: Size, ir: u16, bits3_4: u16, reg: u16) -> u16 {
     let mut opcode = (bits12_15 & 0xF) << 12
                    | (count_reg & 7) << 9
-                   | Into::<u16>::into(size) << 6
+                   | size_bits(size) << 6
                    | (ir & 1) << 5
                    | (bits3_4 & 3) << 3
                    | reg & 7;
-    if dir == Direction::Left {
+    if matches!(dir, Direction::Left) {
         opcode |= 0x0100;
     }
 
     opcode
 }
 
-/// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
-pub fn abcd(dst: u8, mode: Direction, src: u8) -> u16 {
-    assert!(dst <= 7, "Invalid destination register number {}.", dst);
-    assert!(mode == Direction::RegisterToRegister || mode == Direction::MemoryToMemory, "Invalid mode.");
-    assert!(src <= 7, "Invalid source register number {}.", dst);
-    register_size_mode_register(0b1100, dst, Size::Byte, 0, mode, src)
+/// A buffer the [Assembler] appends the instructions to.
+pub trait CodeBuffer {
+    /// Returns the words in the buffer.
+    fn words(&self) -> &[u16];
+
+    /// Returns the words in the buffer mutably, to resolve the branch displacements.
+    fn words_mut(&mut self) -> &mut [u16];
+
+    /// Appends the given words at the end of the buffer. Panics if the buffer is full.
+    fn append(&mut self, words: &[u16]);
+
+    /// Removes all the words of the buffer.
+    fn clear(&mut self);
 }
 
-/// `dir` must be [Direction::DstReg] or [Direction::DstEa].
-pub fn add(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(dir == Direction::DstEa || dir == Direction::DstReg, "Invalid direction.");
-    if dir == Direction::DstEa {
-        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
-    } else {
-        assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
-        assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+impl CodeBuffer for Vec<u16> {
+    fn words(&self) -> &[u16] {
+        self
     }
-    register_direction_size_effective_address(0b1101, reg, dir, size, am)
-}
 
-pub fn adda(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(!size.is_byte(), "ADDA cannot be byte sized.");
-    register_size_effective_address(0b1101, reg, size, am)
-}
+    fn words_mut(&mut self) -> &mut [u16] {
+        self
+    }
 
-pub fn addi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ADDI assembler");
-    size_effective_address_immediate(0b0000_0110, size, am, imm)
-}
+    fn append(&mut self, words: &[u16]) {
+        self.extend_from_slice(words);
+    }
 
-/// `data` must be 1 to 8.
-pub fn addq(data: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_01234567, &[0, 1]), "Invalid addressing mode.");
-    assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct destination operand.");
-    assert!(data >= 1 && data <= 8, "Invalid data.");
-    let data = if data == 8 { 0 } else { data };
-    data_size_effective_address(data, 0, size, am)
+    fn clear(&mut self) {
+        Vec::clear(self);
+    }
 }
 
-/// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
-pub fn addx(dst: u8, size: Size, mode: Direction, src: u8) -> u16 {
-    assert!(dst <= 7, "Invalid destination register number {}.", dst);
-    assert!(mode == Direction::RegisterToRegister || mode == Direction::MemoryToMemory, "Invalid mode.");
-    assert!(src <= 7, "Invalid source register number {}.", dst);
-    register_size_mode_register(0b1101, dst, size, 0, mode, src)
-}
+impl<B: CodeBuffer + ?Sized> CodeBuffer for &mut B {
+    fn words(&self) -> &[u16] {
+        (**self).words()
+    }
 
-/// `dir` must be [Direction::DstReg] or [Direction::DstEa].
-pub fn and(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(dir == Direction::DstEa || dir == Direction::DstReg, "Invalid direction.");
-    if dir == Direction::DstEa {
-        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
-    } else {
-        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+    fn words_mut(&mut self) -> &mut [u16] {
+        (**self).words_mut()
     }
-    register_direction_size_effective_address(0b1100, reg, dir, size, am)
-}
 
-pub fn andi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ANDI assembler");
-    size_effective_address_immediate(0b0000_0010, size, am, imm)
-}
+    fn append(&mut self, words: &[u16]) {
+        (**self).append(words);
+    }
 
-pub fn andiccr(imm: u16) -> [u16; 2] {
-    [0x023C, imm & 0x00FF]
+    fn clear(&mut self) {
+        (**self).clear();
+    }
 }
 
-pub fn andisr(imm: u16) -> [u16; 2] {
-    [0x027C, imm]
+/// A [CodeBuffer] filling a fixed slice from its beginning.
+#[derive(Debug)]
+pub struct SliceBuffer<'a> {
+    slice: &'a mut [u16],
+    len: usize,
 }
 
-/// Arithmetic Shift in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
-pub fn asm(dir: Direction, am: AddressingMode) -> Vec<u16> {
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ASm assembler: expected left or right, got {:?}", dir);
-    assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ASm assembler");
-    direction_effective_address(0b1110_000, dir, 0b11, am)
-}
+impl<'a> SliceBuffer<'a> {
+    /// Creates an empty buffer writing to the given slice.
+    pub fn new(slice: &'a mut [u16]) -> Self {
+        Self { slice, len: 0 }
+    }
 
-/// Arithmetic Shift in register. `dir` must be [Direction::Left] or [Direction::Right].
-pub fn asr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
-    assert!(count_reg <= 7, "Invalid count/register field in ASr assembler: expected 0 to 7, got {}", count_reg);
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ASr assembler: expected left or right, got {:?}", dir);
-    assert!(reg <= 7, "Invalid register field in ASr assembler: expected 0 to 7, got {}", reg);
-    rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b00, reg)
-}
+    /// Returns the number of words written to the slice.
+    pub fn len(&self) -> usize {
+        self.len
+    }
 
-/// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
-pub fn bcc(cond: Condition, disp: i16) -> Vec<u16> {
-    assert!(cond != Condition::T && cond != Condition::F, "Invalid condition.");
-    condition_displacement(cond, disp)
+    /// Returns true if no word has been written to the slice.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
 }
 
-pub fn bchg_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in BCHG dynamic assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCHG dynamic assembler");
-    register_effective_address(0b0000, reg as u16, 0b101, am)
-}
+impl CodeBuffer for SliceBuffer<'_> {
+    fn words(&self) -> &[u16] {
+        &self.slice[..self.len]
+    }
 
-pub fn bchg_static(am: AddressingMode, count: u8) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCHG static assembler");
-    effective_address_count(0b0000_1000_01, am, count)
-}
+    fn words_mut(&mut self) -> &mut [u16] {
+        &mut self.slice[..self.len]
+    }
 
-pub fn bclr_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in BCLR dynamic assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCLR dynamic assembler");
-    register_effective_address(0b0000, reg as u16, 0b110, am)
-}
+    fn append(&mut self, words: &[u16]) {
+        let end = self.len + words.len();
+        assert!(end <= self.slice.len(), "The slice buffer is full.");
+        self.slice[self.len..end].copy_from_slice(words);
+        self.len = end;
+    }
 
-pub fn bclr_static(am: AddressingMode, count: u8) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCLR static assembler");
-    effective_address_count(0b0000_1000_10, am, count)
+    fn clear(&mut self) {
+        self.len = 0;
+    }
 }
 
-/// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
-pub fn bra(disp: i16) -> Vec<u16> {
-    condition_displacement(Condition::T, disp)
-}
+/// A branch target of an [Assembler], created by [Assembler::label] and placed with [Assembler::bind].
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Label(usize);
 
-pub fn bset_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in BSET dynamic assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BSET dynamic assembler");
-    register_effective_address(0b0000, reg as u16, 0b111, am)
+/// Assembles instructions at the end of a [CodeBuffer], without intermediate allocations.
+///
+/// There is a method for each assembler function of this module, with the same parameters.
+/// The `*_label` methods branch to a [Label], which can be bound before or after the branch.
+/// The forward branches always use a 16-bits displacement, which is written when their label is bound.
+///
+/// ```
+/// use m68000::assembler::{Assembler, Condition};
+///
+/// let mut asm = Assembler::new();
+/// let end = asm.label();
+/// let count = asm.label();
+/// asm.moveq(0, 3).bind(count).bra_label(end).dbcc_label(Condition::F, 0, count).bind(end).nop();
+/// assert_eq!(asm.finish(), [0x7003, 0x6000, 0x0006, 0x51C8, 0xFFFA, 0x4E71]);
+/// ```
+#[derive(Debug, Default)]
+pub struct Assembler<B: CodeBuffer = Vec<u16>> {
+    buffer: B,
+    /// The word index of each label, None if it is not bound yet.
+    labels: Vec<Option<usize>>,
+    /// The index of the displacement word of the branches to labels not bound yet.
+    fixups: Vec<(usize, Label)>,
+}
+
+impl Assembler {
+    /// Creates an assembler appending to a new vector.
+    pub fn new() -> Self {
+        Self::with_buffer(Vec::new())
+    }
 }
 
-pub fn bset_static(am: AddressingMode, count: u8) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BSET static assembler");
-    effective_address_count(0b0000_1000_11, am, count)
-}
+impl<B: CodeBuffer> Assembler<B> {
+    /// Creates an assembler appending to the given buffer.
+    ///
+    /// The labels are word indices in the buffer, so its existing words are at the start of the program.
+    pub fn with_buffer(buffer: B) -> Self {
+        Self {
+            buffer,
+            labels: Vec::new(),
+            fixups: Vec::new(),
+        }
+    }
 
-/// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
-pub fn bsr(disp: i16) -> Vec<u16> {
-    condition_displacement(Condition::F, disp)
-}
+    /// Returns the words in the buffer.
+    pub fn words(&self) -> &[u16] {
+        self.buffer.words()
+    }
 
-pub fn btst_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in BTST dynamic assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in BTST dynamic assembler");
-    register_effective_address(0b0000, reg as u16, 0b100, am)
-}
+    /// Returns the number of words in the buffer, which is the word index of the next instruction.
+    pub fn len(&self) -> usize {
+        self.buffer.words().len()
+    }
 
-pub fn btst_static(am: AddressingMode, count: u8) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in BTST static assembler");
-    effective_address_count(0b0000_1000_00, am, count)
-}
+    /// Returns true if the buffer is empty.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
 
-pub fn chk(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in CHK assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in CHK assembler");
-    register_effective_address(0b0100, reg as u16, 0b110, am)
-}
+    /// Creates a new label, not bound yet.
+    pub fn label(&mut self) -> Label {
+        self.labels.push(None);
+        Label(self.labels.len() - 1)
+    }
 
-pub fn clr(size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in CLR assembler");
-    size_effective_address(0b0100_0010, size, am)
-}
+    /// Binds the label to the current position, and resolves the branches already emitted to it.
+    ///
+    /// Panics if the label is already bound or if a displacement is out of range.
+    pub fn bind(&mut self, label: Label) -> &mut Self {
+        assert!(self.labels[label.0].is_none(), "Label already bound.");
+        let target = self.len();
+        self.labels[label.0] = Some(target);
+
+        let words = self.buffer.words_mut();
+        self.fixups.retain(|&(index, l)| {
+            if l == label {
+                words[index] = branch_displacement(index - 1, target) as u16;
+                false
+            } else {
+                true
+            }
+        });
+
+        self
+    }
 
-pub fn cmp(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
-    assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
-    register_direction_size_effective_address(0b1011, reg, Direction::DstReg, size, am)
-}
+    /// BRA to the given label.
+    pub fn bra_label(&mut self, label: Label) -> &mut Self {
+        self.emit_branch(label, |disp| encode::bra(disp))
+    }
 
-pub fn cmpa(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(!size.is_byte(), "CMPA cannot be byte sized.");
-    register_size_effective_address(0b1011, reg, size, am)
-}
+    /// BSR to the given label.
+    pub fn bsr_label(&mut self, label: Label) -> &mut Self {
+        self.emit_branch(label, |disp| encode::bsr(disp))
+    }
 
-pub fn cmpi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in CMPI assembler");
-    size_effective_address_immediate(0b0000_1100, size, am, imm)
-}
+    /// Bcc to the given label.
+    pub fn bcc_label(&mut self, cond: Condition, label: Label) -> &mut Self {
+        self.emit_branch(label, |disp| encode::bcc(cond, disp))
+    }
 
-pub fn cmpm(ax: u8, size: Size, ay: u8) -> u16 {
-    assert!(ax <= 7, "Invalid destination register.");
-    assert!(ay <= 7, "Invalid source register.");
-    0b1011_0001 << 8 | (ax as u16 & 7) << 9 | Into::<u16>::into(size) << 6 | 0b001 << 3 | ay as u16 & 7
-}
+    /// DBcc to the given label.
+    pub fn dbcc_label(&mut self, cond: Condition, reg: u8, label: Label) -> &mut Self {
+        self.emit_branch(label, |disp| encode::dbcc(cond, reg, disp))
+    }
 
-pub fn dbcc(cond: Condition, reg: u8, disp: i16) -> [u16; 2] {
-    assert!(reg <= 7, "Invalid register.");
-    [0b0101 << 12 | (cond as u16) << 8 | 0b1100_1 << 3 | reg as u16 & 7, disp as u16]
-}
+    /// Removes all the words of the buffer and all the labels, keeping the allocations to assemble another program.
+    pub fn clear(&mut self) {
+        self.buffer.clear();
+        self.labels.clear();
+        self.fixups.clear();
+    }
 
-pub fn divs(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in DIVS assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in DIVS assembler");
-    register_effective_address(0b1000, reg as u16, 0b111, am)
-}
+    /// Returns the buffer. Panics if a branch targets a label that is not bound.
+    pub fn finish(self) -> B {
+        assert!(self.fixups.is_empty(), "Branch to a label that is not bound.");
+        self.buffer
+    }
 
-pub fn divu(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in DIVU assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in DIVU assembler");
-    register_effective_address(0b1000, reg as u16, 0b011, am)
-}
+    fn emit(&mut self, words: Words) -> &mut Self {
+        self.buffer.append(words.as_slice());
+        self
+    }
 
-pub fn eor(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode.");
-    register_direction_size_effective_address(0b1011, reg, Direction::DstEa, size, am)
+    /// Emits the backward branch, or the forward branch with a 16-bits displacement resolved by [Self::bind].
+    fn emit_branch(&mut self, label: Label, branch: impl FnOnce(i16) -> Words) -> &mut Self {
+        let from = self.len();
+        match self.labels[label.0] {
+            Some(target) => self.emit(branch(branch_displacement(from, target))),
+            None => {
+                self.fixups.push((from + 1, label));
+                self.emit(branch(0))
+            },
+        }
+    }
 }
 
-pub fn eori(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in EORI assembler");
-    size_effective_address_immediate(0b0000_1010, size, am, imm)
-}
+/// Assembles instructions in an array in const contexts, to build programs at compile time.
+///
+/// There is a method for each assembler function of this module, with the same parameters.
+/// As labels cannot be resolved by const functions, the `*_to` methods branch to a word index of the program instead.
+///
+/// ```
+/// use m68000::assembler::{Condition, ConstAssembler};
+///
+/// const fn rom() -> [u16; 4] {
+///     let asm = ConstAssembler::new().moveq(0, 3);
+///     let start = asm.len();
+///     asm.nop().dbcc_to(Condition::F, 0, start).finish()
+/// }
+///
+/// const ROM: [u16; 4] = rom();
+/// assert_eq!(ROM, [0x7003, 0x4E71, 0x51C8, 0xFFFC]);
+/// ```
+#[derive(Clone, Copy, Debug)]
+pub struct ConstAssembler<const N: usize> {
+    words: [u16; N],
+    len: usize,
+}
+
+impl<const N: usize> ConstAssembler<N> {
+    /// Creates an empty program.
+    pub const fn new() -> Self {
+        Self { words: [0; N], len: 0 }
+    }
+
+    /// Returns the number of words in the program, which is the word index of the next instruction.
+    pub const fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns true if the program is empty.
+    pub const fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns the words of the program.
+    pub const fn as_slice(&self) -> &[u16] {
+        self.words.split_at(self.len).0
+    }
+
+    /// Returns the array, padded with zeros after the program.
+    pub const fn finish(self) -> [u16; N] {
+        self.words
+    }
+
+    /// BRA to the given word index.
+    pub const fn bra_to(self, target: usize) -> Self {
+        let disp = branch_displacement(self.len, target);
+        self.emit(encode::bra(disp))
+    }
+
+    /// BSR to the given word index.
+    pub const fn bsr_to(self, target: usize) -> Self {
+        let disp = branch_displacement(self.len, target);
+        self.emit(encode::bsr(disp))
+    }
+
+    /// Bcc to the given word index.
+    pub const fn bcc_to(self, cond: Condition, target: usize) -> Self {
+        let disp = branch_displacement(self.len, target);
+        self.emit(encode::bcc(cond, disp))
+    }
 
-pub fn eoriccr(imm: u16) -> [u16; 2] {
-    [0x0A3C, imm & 0x00FF]
+    /// DBcc to the given word index.
+    pub const fn dbcc_to(self, cond: Condition, reg: u8, target: usize) -> Self {
+        let disp = branch_displacement(self.len, target);
+        self.emit(encode::dbcc(cond, reg, disp))
+    }
+
+    const fn emit(mut self, words: Words) -> Self {
+        assert!(self.len + words.len <= N, "The const assembler array is full.");
+        let mut i = 0;
+        while i < words.len {
+            self.words[self.len] = words.words[i];
+            self.len += 1;
+            i += 1;
+        }
+        self
+    }
 }
 
-pub fn eorisr(imm: u16) -> [u16; 2] {
-    [0x0A7C, imm]
+impl<const N: usize> Default for ConstAssembler<N> {
+    fn default() -> Self {
+        Self::new()
+    }
 }
 
-/// `dir` must be [Direction::ExchangeData], [Direction::ExchangeAddress] or [Direction::ExchangeDataAddress].
-pub fn exg(rx: u8, dir: Direction, ry: u8) -> u16 {
-    assert!(dir == Direction::ExchangeData || dir == Direction::ExchangeAddress || dir == Direction::ExchangeDataAddress, "Invalid operation");
-    assert!(rx <= 7, "Invalid Rx register.");
-    assert!(ry <= 7, "Invalid Ry register.");
-    let opmode = if dir == Direction::ExchangeData {
-        0b01000
-    } else if dir == Direction::ExchangeAddress {
-        0b01001
-    } else {
-        0b10001
+/// Generates from the instruction encoders the free functions, the [Assembler] methods and the [ConstAssembler] methods.
+macro_rules! instructions {
+    ($(
+        $(#[$attr:meta])*
+        pub fn $name:ident($($arg:ident: $ty:ty),*) -> $ret:ty $body:block
+    )*) => {
+        /// The const encoders, returning the words inline.
+        mod encode {
+            use super::*;
+
+            $(
+                pub(super) const fn $name($($arg: $ty),*) -> Words $body
+            )*
+        }
+
+        $(
+            $(#[$attr])*
+            pub fn $name($($arg: $ty),*) -> $ret {
+                FromWords::from_words(encode::$name($($arg),*))
+            }
+        )*
+
+        impl<B: CodeBuffer> Assembler<B> {
+            $(
+                #[doc = concat!("Appends [`", stringify!($name), "`](fn@", stringify!($name), ").")]
+                pub fn $name(&mut self, $($arg: $ty),*) -> &mut Self {
+                    self.emit(encode::$name($($arg),*))
+                }
+            )*
+        }
+
+        impl<const N: usize> ConstAssembler<N> {
+            $(
+                #[doc = concat!("Appends [`", stringify!($name), "`](fn@", stringify!($name), ").")]
+                pub const fn $name(self, $($arg: $ty),*) -> Self {
+                    self.emit(encode::$name($($arg),*))
+                }
+            )*
+        }
     };
-    0b1100_0001 << 8 | (rx as u16) << 9 | opmode << 3 | ry as u16 & 7
 }
 
-/// `word_to_long` is true for word to long sign extension, false for byte to word sign extension.
-pub fn ext(word_to_long: bool, reg: u8) -> u16 {
-    assert!(reg <= 7, "Invalid register.");
-    0b0100_1000_1 << 7 | (word_to_long as u16) << 6 | reg as u16 & 7
-}
+instructions! {
+    /// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
+    pub fn abcd(dst: u8, mode: Direction, src: u8) -> u16 {
+        assert!(dst <= 7, "Invalid destination register number.");
+        assert!(matches!(mode, Direction::RegisterToRegister | Direction::MemoryToMemory), "Invalid mode.");
+        assert!(src <= 7, "Invalid source register number.");
+        Words::one(register_size_mode_register(0b1100, dst, Size::Byte, 0, mode, src))
+    }
 
-pub fn illegal() -> u16 {
-    0x4AFC
-}
+    /// `dir` must be [Direction::DstReg] or [Direction::DstEa].
+    pub fn add(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(matches!(dir, Direction::DstEa | Direction::DstReg), "Invalid direction.");
+        if matches!(dir, Direction::DstEa) {
+            assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
+        } else {
+            assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
+            assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+        }
+        register_direction_size_effective_address(0b1101, reg, dir, size, am)
+    }
 
-pub fn jmp(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in JMP assembler");
-    effective_address(0b0100_1110_11, am)
-}
+    pub fn adda(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(!size.is_byte(), "ADDA cannot be byte sized.");
+        register_size_effective_address(0b1101, reg, size, am)
+    }
 
-pub fn jsr(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in JSR assembler");
-    effective_address(0b0100_1110_10, am)
-}
+    pub fn addi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ADDI assembler");
+        size_effective_address_immediate(0b0000_0110, size, am, imm)
+    }
 
-pub fn lea(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in LEA assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in LEA assembler");
-    register_effective_address(0b0100, reg as u16, 0b111, am)
-}
+    /// `data` must be 1 to 8.
+    pub fn addq(data: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_01234567, &[0, 1]), "Invalid addressing mode.");
+        assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct destination operand.");
+        assert!(data >= 1 && data <= 8, "Invalid data.");
+        let data = if data == 8 { 0 } else { data };
+        data_size_effective_address(data, 0, size, am)
+    }
 
-pub fn link(reg: u8, disp: i16) -> [u16; 2] {
-    assert!(reg <= 7, "Invalid register.");
-    [0b0100_1110_0101_0 << 3 | reg as u16 & 7, disp as u16]
-}
+    /// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
+    pub fn addx(dst: u8, size: Size, mode: Direction, src: u8) -> u16 {
+        assert!(dst <= 7, "Invalid destination register number.");
+        assert!(matches!(mode, Direction::RegisterToRegister | Direction::MemoryToMemory), "Invalid mode.");
+        assert!(src <= 7, "Invalid source register number.");
+        Words::one(register_size_mode_register(0b1101, dst, size, 0, mode, src))
+    }
 
-/// Logical Shift in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
-pub fn lsm(dir: Direction, am: AddressingMode) -> Vec<u16> {
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in LSm assembler: expected left or right, got {:?}", dir);
-    assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in LSm assembler");
-    direction_effective_address(0b1110_001, dir, 0b11, am)
-}
+    /// `dir` must be [Direction::DstReg] or [Direction::DstEa].
+    pub fn and(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(matches!(dir, Direction::DstEa | Direction::DstReg), "Invalid direction.");
+        if matches!(dir, Direction::DstEa) {
+            assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
+        } else {
+            assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+        }
+        register_direction_size_effective_address(0b1100, reg, dir, size, am)
+    }
 
-/// Logical Shift in register. `dir` must be [Direction::Left] or [Direction::Right].
-pub fn lsr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
-    assert!(count_reg <= 7, "Invalid count/register field in LSr assembler: expected 0 to 7, got {}", count_reg);
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in LSr assembler: expected left or right, got {:?}", dir);
-    assert!(reg <= 7, "Invalid register field in LSr assembler: expected 0 to 7, got {}", reg);
-    rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b01, reg)
-}
+    pub fn andi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ANDI assembler");
+        size_effective_address_immediate(0b0000_0010, size, am, imm)
+    }
 
-pub fn r#move(size: Size, dst: AddressingMode, src: AddressingMode) -> Vec<u16> {
-    assert!(dst.verify(&MODES_0234567, &[0, 1]), "Invalid destination addressing mode.");
-    assert!(!(src.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
-    size_effective_address_effective_address(size, dst, src)
-}
+    pub fn andiccr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x023C, imm & 0x00FF])
+    }
 
-pub fn movea(size: Size, dst_reg: u8, src: AddressingMode) -> Vec<u16> {
-    assert!(dst_reg <= 7, "Invalid address register.");
-    assert!(size != Size::Byte, "MOVEA cannot be byte sized.");
-    size_effective_address_effective_address(size, AddressingMode::Ard(dst_reg), src)
-}
+    pub fn andisr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x027C, imm])
+    }
 
-pub fn moveccr(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MOVE to CCR assembler");
-    effective_address(0b0100_0100_11, am)
-}
+    /// Arithmetic Shift in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn asm(dir: Direction, am: AddressingMode) -> Vec<u16> {
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ASm assembler: expected left or right");
+        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ASm assembler");
+        direction_effective_address(0b1110_000, dir, 0b11, am)
+    }
 
-pub fn movefsr(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in MOVE from SR assembler");
-    effective_address(0b0100_0000_11, am)
-}
+    /// Arithmetic Shift in register. `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn asr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
+        assert!(count_reg <= 7, "Invalid count/register field in ASr assembler: expected 0 to 7");
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ASr assembler: expected left or right");
+        assert!(reg <= 7, "Invalid register field in ASr assembler: expected 0 to 7");
+        Words::one(rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b00, reg))
+    }
 
-pub fn movesr(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MOVE to SR assembler");
-    effective_address(0b0100_0110_11, am)
-}
+    /// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
+    pub fn bcc(cond: Condition, disp: i16) -> Vec<u16> {
+        assert!(!matches!(cond, Condition::T | Condition::F), "Invalid condition.");
+        condition_displacement(cond, disp)
+    }
 
-/// `dir` must be [Direction::UspToRegister] or [Direction::RegisterToUsp].
-pub fn moveusp(dir: Direction, reg: u8) -> u16 {
-    assert!(dir == Direction::UspToRegister || dir == Direction::RegisterToUsp, "Invalid direction.");
-    assert!(reg <= 7, "Invalid register");
-    let d = if dir == Direction::UspToRegister { 1 } else { 0 };
-    0b0100_1110_0110 << 4 | d << 3 | reg as u16 & 7
-}
+    pub fn bchg_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in BCHG dynamic assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCHG dynamic assembler");
+        register_effective_address(0b0000, reg as u16, 0b101, am)
+    }
 
-/// `dir` must be [Direction::RegisterToMemory] or [Direction::MemoryToRegister]. `mask` is the raw mask list.
-pub fn movem(dir: Direction, size: Size, am: AddressingMode, mask: u16) -> Vec<u16> {
-    assert!(dir == Direction::RegisterToMemory || dir == Direction::MemoryToRegister, "Invalid direction.");
-    assert!(!size.is_byte(), "Invalid byte size for MOVEM.");
-    let d = if dir == Direction::MemoryToRegister {
-        assert!(am.verify(&[2, 3, 5, 6, 7], &[0, 1, 2, 3]), "Invalid addressing mode.");
-        1
-    } else {
-        assert!(am.verify(&[2, 4, 5, 6, 7], &[0, 1]), "Invalid addressing mode.");
-        0
-    };
+    pub fn bchg_static(am: AddressingMode, count: u8) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCHG static assembler");
+        effective_address_count(0b0000_1000_01, am, count)
+    }
 
-    let mut vec = Vec::new();
+    pub fn bclr_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in BCLR dynamic assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCLR dynamic assembler");
+        register_effective_address(0b0000, reg as u16, 0b110, am)
+    }
 
-    let (eafield, eaext) = am.assemble(size.is_long());
-    let opcode = 0b0100_1 << 11
-               | d << 10
-               | 0b001 << 7
-               | size.into_bit() << 6
-               | eafield;
+    pub fn bclr_static(am: AddressingMode, count: u8) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BCLR static assembler");
+        effective_address_count(0b0000_1000_10, am, count)
+    }
 
-    vec.push(opcode);
-    vec.push(mask);
-    vec.extend(eaext.iter());
+    /// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
+    pub fn bra(disp: i16) -> Vec<u16> {
+        condition_displacement(Condition::T, disp)
+    }
 
-    vec
-}
+    pub fn bset_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in BSET dynamic assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BSET dynamic assembler");
+        register_effective_address(0b0000, reg as u16, 0b111, am)
+    }
 
-/// `dir` must be [Direction::MemoryToRegister] or [Direction::RegisterToMemory].
-pub fn movep(data_reg: u8, dir: Direction, size: Size, addr_reg: u8, disp: i16) -> [u16; 2] {
-    assert!(data_reg <= 7, "Invalid data register.");
-    assert!(dir == Direction::RegisterToMemory || dir == Direction::MemoryToRegister, "Invalid direction.");
-    assert!(!size.is_byte(), "Invalid byte size for MOVEP.");
-    assert!(addr_reg <= 7, "Invalid address register.");
+    pub fn bset_static(am: AddressingMode, count: u8) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in BSET static assembler");
+        effective_address_count(0b0000_1000_11, am, count)
+    }
 
-    let mut opcode = (data_reg as u16 & 7) << 9
-                   | 0b1_0000_1 << 3
-                   | addr_reg as u16 & 7;
-    if dir == Direction::RegisterToMemory {
-        opcode |= 0x0080;
+    /// If the displacement fits in an i8 and is not 0, 1 opcode is used, otherwise 2.
+    pub fn bsr(disp: i16) -> Vec<u16> {
+        condition_displacement(Condition::F, disp)
     }
-    if size.is_long() {
-        opcode |= 0x0040;
+
+    pub fn btst_dynamic(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in BTST dynamic assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in BTST dynamic assembler");
+        register_effective_address(0b0000, reg as u16, 0b100, am)
     }
-    [opcode, disp as u16]
-}
 
-pub fn moveq(reg: u8, data: i8) -> u16 {
-    assert!(reg <= 7, "Invalid register.");
-    0b0111 << 12 | (reg as u16) << 9 | data as u8 as u16
-}
+    pub fn btst_static(am: AddressingMode, count: u8) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in BTST static assembler");
+        effective_address_count(0b0000_1000_00, am, count)
+    }
 
-pub fn muls(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in MULS assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MULS assembler");
-    register_effective_address(0b1100, reg as u16, 0b111, am)
-}
+    pub fn chk(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in CHK assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in CHK assembler");
+        register_effective_address(0b0100, reg as u16, 0b110, am)
+    }
 
-pub fn mulu(reg: u8, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register field in MULU assembler: expected 0 to 7, got {}", reg);
-    assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MULU assembler");
-    register_effective_address(0b1100, reg as u16, 0b011, am)
-}
+    pub fn clr(size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in CLR assembler");
+        size_effective_address(0b0100_0010, size, am)
+    }
 
-pub fn nbcd(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NBCD assembler");
-    effective_address(0b0100_1000_00, am)
-}
+    pub fn cmp(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
+        assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+        register_direction_size_effective_address(0b1011, reg, Direction::DstReg, size, am)
+    }
 
-pub fn neg(size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NEG assembler");
-    size_effective_address(0b0100_0100, size, am)
-}
+    pub fn cmpa(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(!size.is_byte(), "CMPA cannot be byte sized.");
+        register_size_effective_address(0b1011, reg, size, am)
+    }
 
-pub fn negx(size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NEGX assembler");
-    size_effective_address(0b0100_0000, size, am)
-}
+    pub fn cmpi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in CMPI assembler");
+        size_effective_address_immediate(0b0000_1100, size, am, imm)
+    }
 
-pub fn nop() -> u16 {
-    0x4E71
-}
+    pub fn cmpm(ax: u8, size: Size, ay: u8) -> u16 {
+        assert!(ax <= 7, "Invalid destination register.");
+        assert!(ay <= 7, "Invalid source register.");
+        Words::one(0b1011_0001 << 8 | (ax as u16 & 7) << 9 | size_bits(size) << 6 | 0b001 << 3 | ay as u16 & 7)
+    }
 
-pub fn not(size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NOT assembler");
-    size_effective_address(0b0100_0110, size, am)
-}
+    pub fn dbcc(cond: Condition, reg: u8, disp: i16) -> [u16; 2] {
+        assert!(reg <= 7, "Invalid register.");
+        Words::from_array([0b0101 << 12 | (cond as u16) << 8 | 0b1100_1 << 3 | reg as u16 & 7, disp as u16])
+    }
 
-/// `dir` must be [Direction::DstReg] or [Direction::DstEa].
-pub fn or(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(dir == Direction::DstEa || dir == Direction::DstReg, "Invalid direction.");
-    if dir == Direction::DstEa {
-        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
-    } else {
-        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+    pub fn divs(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in DIVS assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in DIVS assembler");
+        register_effective_address(0b1000, reg as u16, 0b111, am)
     }
-    register_direction_size_effective_address(0b1000, reg, dir, size, am)
-}
 
-pub fn ori(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ORI assembler");
-    size_effective_address_immediate(0b0000_0000, size, am, imm)
-}
+    pub fn divu(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in DIVU assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in DIVU assembler");
+        register_effective_address(0b1000, reg as u16, 0b011, am)
+    }
 
-pub fn oriccr(imm: u16) -> [u16; 2] {
-    [0x003C, imm & 0x00FF]
-}
+    pub fn eor(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode.");
+        register_direction_size_effective_address(0b1011, reg, Direction::DstEa, size, am)
+    }
 
-pub fn orisr(imm: u16) -> [u16; 2] {
-    [0x007C, imm]
-}
+    pub fn eori(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in EORI assembler");
+        size_effective_address_immediate(0b0000_1010, size, am, imm)
+    }
 
-pub fn pea(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in PEA assembler");
-    effective_address(0b0100_1000_01, am)
-}
+    pub fn eoriccr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x0A3C, imm & 0x00FF])
+    }
 
-pub fn reset() -> u16 {
-    0x4E70
-}
+    pub fn eorisr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x0A7C, imm])
+    }
 
-/// Rotate in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
-pub fn rom(dir: Direction, am: AddressingMode) -> Vec<u16> {
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ROm assembler: expected left or right, got {:?}", dir);
-    assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ROm assembler");
-    direction_effective_address(0b1110_011, dir, 0b11, am)
-}
+    /// `dir` must be [Direction::ExchangeData], [Direction::ExchangeAddress] or [Direction::ExchangeDataAddress].
+    pub fn exg(rx: u8, dir: Direction, ry: u8) -> u16 {
+        assert!(matches!(dir, Direction::ExchangeData | Direction::ExchangeAddress | Direction::ExchangeDataAddress), "Invalid operation");
+        assert!(rx <= 7, "Invalid Rx register.");
+        assert!(ry <= 7, "Invalid Ry register.");
+        let opmode = if matches!(dir, Direction::ExchangeData) {
+            0b01000
+        } else if matches!(dir, Direction::ExchangeAddress) {
+            0b01001
+        } else {
+            0b10001
+        };
+        Words::one(0b1100_0001 << 8 | (rx as u16) << 9 | opmode << 3 | ry as u16 & 7)
+    }
 
-/// Rotate in register. `dir` must be [Direction::Left] or [Direction::Right].
-pub fn ror(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
-    assert!(count_reg <= 7, "Invalid count/register field in ROr assembler: expected 0 to 7, got {}", count_reg);
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ROr assembler: expected left or right, got {:?}", dir);
-    assert!(reg <= 7, "Invalid register field in ROr assembler: expected 0 to 7, got {}", reg);
-    rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b11, reg)
-}
+    /// `word_to_long` is true for word to long sign extension, false for byte to word sign extension.
+    pub fn ext(word_to_long: bool, reg: u8) -> u16 {
+        assert!(reg <= 7, "Invalid register.");
+        Words::one(0b0100_1000_1 << 7 | (word_to_long as u16) << 6 | reg as u16 & 7)
+    }
 
-/// Rotate with Extend in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
-pub fn roxm(dir: Direction, am: AddressingMode) -> Vec<u16> {
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ROXm assembler: expected left or right, got {:?}", dir);
-    assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ROXm assembler");
-    direction_effective_address(0b1110_010, dir, 0b11, am)
-}
+    pub fn illegal() -> u16 {
+        Words::one(0x4AFC)
+    }
 
-/// Rotate with Extend in register. `dir` must be [Direction::Left] or [Direction::Right].
-pub fn roxr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
-    assert!(count_reg <= 7, "Invalid count/register field in ROXr assembler: expected 0 to 7, got {}", count_reg);
-    assert!(dir == Direction::Left || dir == Direction::Right, "Invalid direction field in ROXr assembler: expected left or right, got {:?}", dir);
-    assert!(reg <= 7, "Invalid register field in ROXr assembler: expected 0 to 7, got {}", reg);
-    rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b10, reg)
-}
+    pub fn jmp(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in JMP assembler");
+        effective_address(0b0100_1110_11, am)
+    }
 
-pub fn rte() -> u16 {
-    0x4E73
-}
+    pub fn jsr(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in JSR assembler");
+        effective_address(0b0100_1110_10, am)
+    }
 
-pub fn rtr() -> u16 {
-    0x4E77
-}
+    pub fn lea(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in LEA assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in LEA assembler");
+        register_effective_address(0b0100, reg as u16, 0b111, am)
+    }
 
-pub fn rts() -> u16 {
-    0x4E75
-}
+    pub fn link(reg: u8, disp: i16) -> [u16; 2] {
+        assert!(reg <= 7, "Invalid register.");
+        Words::from_array([0b0100_1110_0101_0 << 3 | reg as u16 & 7, disp as u16])
+    }
 
-/// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
-pub fn sbcd(dst: u8, mode: Direction, src: u8) -> u16 {
-    assert!(dst <= 7, "Invalid destination register number {}.", dst);
-    assert!(mode == Direction::RegisterToRegister || mode == Direction::MemoryToMemory, "Invalid mode.");
-    assert!(src <= 7, "Invalid source register number {}.", dst);
-    register_size_mode_register(0b1000, dst, Size::Byte, 0, mode, src)
-}
+    /// Logical Shift in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn lsm(dir: Direction, am: AddressingMode) -> Vec<u16> {
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in LSm assembler: expected left or right");
+        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in LSm assembler");
+        direction_effective_address(0b1110_001, dir, 0b11, am)
+    }
 
-pub fn scc(cond: Condition, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode");
-    let mut vec = Vec::new();
+    /// Logical Shift in register. `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn lsr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
+        assert!(count_reg <= 7, "Invalid count/register field in LSr assembler: expected 0 to 7");
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in LSr assembler: expected left or right");
+        assert!(reg <= 7, "Invalid register field in LSr assembler: expected 0 to 7");
+        Words::one(rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b01, reg))
+    }
 
-    let (eafield, eaext) = am.assemble(false);
-    let opcode = 0b0101 << 12
-               | (cond as u16) << 8
-               | 0b11 << 6
-               | eafield;
-    vec.push(opcode);
-    vec.extend(eaext.iter());
+    pub fn r#move(size: Size, dst: AddressingMode, src: AddressingMode) -> Vec<u16> {
+        assert!(dst.verify(&MODES_0234567, &[0, 1]), "Invalid destination addressing mode.");
+        assert!(!(src.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
+        size_effective_address_effective_address(size, dst, src)
+    }
 
-    vec
-}
+    pub fn movea(size: Size, dst_reg: u8, src: AddressingMode) -> Vec<u16> {
+        assert!(dst_reg <= 7, "Invalid address register.");
+        assert!(!size.is_byte(), "MOVEA cannot be byte sized.");
+        size_effective_address_effective_address(size, AddressingMode::Ard(dst_reg), src)
+    }
 
-pub fn stop(sr: u16) -> [u16; 2] {
-    [0x4E72, sr]
-}
+    pub fn moveccr(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MOVE to CCR assembler");
+        effective_address(0b0100_0100_11, am)
+    }
 
-/// `dir` must be [Direction::DstReg] or [Direction::DstEa].
-pub fn sub(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(dir == Direction::DstEa || dir == Direction::DstReg, "Invalid direction.");
-    if dir == Direction::DstEa {
-        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
-    } else {
-        assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
-        assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+    pub fn movefsr(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in MOVE from SR assembler");
+        effective_address(0b0100_0000_11, am)
     }
-    register_direction_size_effective_address(0b1001, reg, dir, size, am)
-}
 
-pub fn suba(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(reg <= 7, "Invalid register.");
-    assert!(!size.is_byte(), "SUBA cannot be byte sized.");
-    register_size_effective_address(0b1001, reg, size, am)
-}
+    pub fn movesr(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MOVE to SR assembler");
+        effective_address(0b0100_0110_11, am)
+    }
 
-pub fn subi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in SUBI assembler");
-    size_effective_address_immediate(0b0000_0100, size, am, imm)
-}
+    /// `dir` must be [Direction::UspToRegister] or [Direction::RegisterToUsp].
+    pub fn moveusp(dir: Direction, reg: u8) -> u16 {
+        assert!(matches!(dir, Direction::UspToRegister | Direction::RegisterToUsp), "Invalid direction.");
+        assert!(reg <= 7, "Invalid register");
+        let d = if matches!(dir, Direction::UspToRegister) { 1 } else { 0 };
+        Words::one(0b0100_1110_0110 << 4 | d << 3 | reg as u16 & 7)
+    }
 
-/// `data` must be 1 to 8.
-pub fn subq(data: u8, size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_01234567, &[0, 1]), "Invalid addressing mode.");
-    assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct destination operand.");
-    assert!(data >= 1 && data <= 8, "Invalid data.");
-    let data = if data == 8 { 0 } else { data };
-    data_size_effective_address(data, 1, size, am)
-}
+    /// `dir` must be [Direction::RegisterToMemory] or [Direction::MemoryToRegister]. `mask` is the raw mask list.
+    pub fn movem(dir: Direction, size: Size, am: AddressingMode, mask: u16) -> Vec<u16> {
+        assert!(matches!(dir, Direction::RegisterToMemory | Direction::MemoryToRegister), "Invalid direction.");
+        assert!(!size.is_byte(), "Invalid byte size for MOVEM.");
+        let d = if matches!(dir, Direction::MemoryToRegister) {
+            assert!(am.verify(&[2, 3, 5, 6, 7], &[0, 1, 2, 3]), "Invalid addressing mode.");
+            1
+        } else {
+            assert!(am.verify(&[2, 4, 5, 6, 7], &[0, 1]), "Invalid addressing mode.");
+            0
+        };
+
+        let (eafield, eaext, len) = am.assemble_array(size.is_long());
+        let opcode = 0b0100_1 << 11
+                   | d << 10
+                   | 0b001 << 7
+                   | size_bit(size) << 6
+                   | eafield;
 
-/// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
-pub fn subx(dst: u8, size: Size, mode: Direction, src: u8) -> u16 {
-    assert!(dst <= 7, "Invalid destination register number {}.", dst);
-    assert!(mode == Direction::RegisterToRegister || mode == Direction::MemoryToMemory, "Invalid mode.");
-    assert!(src <= 7, "Invalid source register number {}.", dst);
-    register_size_mode_register(0b1001, dst, size, 0, mode, src)
-}
+        Words::one(opcode).push(mask).extend(eaext, len)
+    }
 
-pub fn swap(reg: u8) -> u16 {
-    assert!(reg <= 7, "Invalid register.");
-    register(0b0100_1000_0100_0, reg)
-}
+    /// `dir` must be [Direction::MemoryToRegister] or [Direction::RegisterToMemory].
+    pub fn movep(data_reg: u8, dir: Direction, size: Size, addr_reg: u8, disp: i16) -> [u16; 2] {
+        assert!(data_reg <= 7, "Invalid data register.");
+        assert!(matches!(dir, Direction::RegisterToMemory | Direction::MemoryToRegister), "Invalid direction.");
+        assert!(!size.is_byte(), "Invalid byte size for MOVEP.");
+        assert!(addr_reg <= 7, "Invalid address register.");
+
+        let mut opcode = (data_reg as u16 & 7) << 9
+                       | 0b1_0000_1 << 3
+                       | addr_reg as u16 & 7;
+        if matches!(dir, Direction::RegisterToMemory) {
+            opcode |= 0x0080;
+        }
+        if size.is_long() {
+            opcode |= 0x0040;
+        }
+        Words::from_array([opcode, disp as u16])
+    }
 
-pub fn tas(am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in TAS assembler");
-    effective_address(0b0100_1010_11, am)
-}
+    pub fn moveq(reg: u8, data: i8) -> u16 {
+        assert!(reg <= 7, "Invalid register.");
+        Words::one(0b0111 << 12 | (reg as u16) << 9 | data as u8 as u16)
+    }
 
-pub fn trap(vector: u8) -> u16 {
-    assert!(vector <= 15, "Invalid TRAP vector.");
-    0b0100_1110_0100 << 4 | vector as u16
-}
+    pub fn muls(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in MULS assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MULS assembler");
+        register_effective_address(0b1100, reg as u16, 0b111, am)
+    }
 
-pub fn trapv() -> u16 {
-    0x4E76
-}
+    pub fn mulu(reg: u8, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register field in MULU assembler: expected 0 to 7");
+        assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode in MULU assembler");
+        register_effective_address(0b1100, reg as u16, 0b011, am)
+    }
 
-pub fn tst(size: Size, am: AddressingMode) -> Vec<u16> {
-    assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in TST assembler");
-    size_effective_address(0b0100_1010, size, am)
-}
+    pub fn nbcd(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NBCD assembler");
+        effective_address(0b0100_1000_00, am)
+    }
+
+    pub fn neg(size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NEG assembler");
+        size_effective_address(0b0100_0100, size, am)
+    }
+
+    pub fn negx(size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NEGX assembler");
+        size_effective_address(0b0100_0000, size, am)
+    }
+
+    pub fn nop() -> u16 {
+        Words::one(0x4E71)
+    }
+
+    pub fn not(size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in NOT assembler");
+        size_effective_address(0b0100_0110, size, am)
+    }
+
+    /// `dir` must be [Direction::DstReg] or [Direction::DstEa].
+    pub fn or(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(matches!(dir, Direction::DstEa | Direction::DstReg), "Invalid direction.");
+        if matches!(dir, Direction::DstEa) {
+            assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
+        } else {
+            assert!(am.verify(&MODES_0234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+        }
+        register_direction_size_effective_address(0b1000, reg, dir, size, am)
+    }
+
+    pub fn ori(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in ORI assembler");
+        size_effective_address_immediate(0b0000_0000, size, am, imm)
+    }
+
+    pub fn oriccr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x003C, imm & 0x00FF])
+    }
+
+    pub fn orisr(imm: u16) -> [u16; 2] {
+        Words::from_array([0x007C, imm])
+    }
+
+    pub fn pea(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_2567, &[0, 1, 2, 3]), "Invalid addressing mode in PEA assembler");
+        effective_address(0b0100_1000_01, am)
+    }
+
+    pub fn reset() -> u16 {
+        Words::one(0x4E70)
+    }
+
+    /// Rotate in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn rom(dir: Direction, am: AddressingMode) -> Vec<u16> {
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ROm assembler: expected left or right");
+        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ROm assembler");
+        direction_effective_address(0b1110_011, dir, 0b11, am)
+    }
+
+    /// Rotate in register. `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn ror(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
+        assert!(count_reg <= 7, "Invalid count/register field in ROr assembler: expected 0 to 7");
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ROr assembler: expected left or right");
+        assert!(reg <= 7, "Invalid register field in ROr assembler: expected 0 to 7");
+        Words::one(rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b11, reg))
+    }
+
+    /// Rotate with Extend in memory (BYTE size only). `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn roxm(dir: Direction, am: AddressingMode) -> Vec<u16> {
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ROXm assembler: expected left or right");
+        assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode field in ROXm assembler");
+        direction_effective_address(0b1110_010, dir, 0b11, am)
+    }
+
+    /// Rotate with Extend in register. `dir` must be [Direction::Left] or [Direction::Right].
+    pub fn roxr(count_reg: u16, dir: Direction, size: Size, reg_shift: bool, reg: u16) -> u16 {
+        assert!(count_reg <= 7, "Invalid count/register field in ROXr assembler: expected 0 to 7");
+        assert!(matches!(dir, Direction::Left | Direction::Right), "Invalid direction field in ROXr assembler: expected left or right");
+        assert!(reg <= 7, "Invalid register field in ROXr assembler: expected 0 to 7");
+        Words::one(rotation_direction_size_mode_register(0b1110, count_reg, dir, size, reg_shift as u16, 0b10, reg))
+    }
+
+    pub fn rte() -> u16 {
+        Words::one(0x4E73)
+    }
+
+    pub fn rtr() -> u16 {
+        Words::one(0x4E77)
+    }
 
-pub fn unlk(reg: u8) -> u16 {
-    assert!(reg <= 7, "Invalid register.");
-    register(0b0100_1110_0101_1, reg)
+    pub fn rts() -> u16 {
+        Words::one(0x4E75)
+    }
+
+    /// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
+    pub fn sbcd(dst: u8, mode: Direction, src: u8) -> u16 {
+        assert!(dst <= 7, "Invalid destination register number.");
+        assert!(matches!(mode, Direction::RegisterToRegister | Direction::MemoryToMemory), "Invalid mode.");
+        assert!(src <= 7, "Invalid source register number.");
+        Words::one(register_size_mode_register(0b1000, dst, Size::Byte, 0, mode, src))
+    }
+
+    pub fn scc(cond: Condition, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode");
+        let (eafield, eaext, len) = am.assemble_array(false);
+        let opcode = 0b0101 << 12
+                   | (cond as u16) << 8
+                   | 0b11 << 6
+                   | eafield;
+        Words::one(opcode).extend(eaext, len)
+    }
+
+    pub fn stop(sr: u16) -> [u16; 2] {
+        Words::from_array([0x4E72, sr])
+    }
+
+    /// `dir` must be [Direction::DstReg] or [Direction::DstEa].
+    pub fn sub(reg: u8, dir: Direction, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(matches!(dir, Direction::DstEa | Direction::DstReg), "Invalid direction.");
+        if matches!(dir, Direction::DstEa) {
+            assert!(am.verify(&MODES_234567, &[0, 1]), "Invalid addressing mode.");
+        } else {
+            assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct source operand.");
+            assert!(am.verify(&MODES_01234567, &[0, 1, 2, 3, 4]), "Invalid addressing mode.");
+        }
+        register_direction_size_effective_address(0b1001, reg, dir, size, am)
+    }
+
+    pub fn suba(reg: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(reg <= 7, "Invalid register.");
+        assert!(!size.is_byte(), "SUBA cannot be byte sized.");
+        register_size_effective_address(0b1001, reg, size, am)
+    }
+
+    pub fn subi(size: Size, am: AddressingMode, imm: u32) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in SUBI assembler");
+        size_effective_address_immediate(0b0000_0100, size, am, imm)
+    }
+
+    /// `data` must be 1 to 8.
+    pub fn subq(data: u8, size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_01234567, &[0, 1]), "Invalid addressing mode.");
+        assert!(!(am.is_ard() && size.is_byte()), "Byte size cannot be used with Address Register Direct destination operand.");
+        assert!(data >= 1 && data <= 8, "Invalid data.");
+        let data = if data == 8 { 0 } else { data };
+        data_size_effective_address(data, 1, size, am)
+    }
+
+    /// `mode` must be [Direction::RegisterToRegister] or [Direction::MemoryToMemory].
+    pub fn subx(dst: u8, size: Size, mode: Direction, src: u8) -> u16 {
+        assert!(dst <= 7, "Invalid destination register number.");
+        assert!(matches!(mode, Direction::RegisterToRegister | Direction::MemoryToMemory), "Invalid mode.");
+        assert!(src <= 7, "Invalid source register number.");
+        Words::one(register_size_mode_register(0b1001, dst, size, 0, mode, src))
+    }
+
+    pub fn swap(reg: u8) -> u16 {
+        assert!(reg <= 7, "Invalid register.");
+        Words::one(register(0b0100_1000_0100_0, reg))
+    }
+
+    pub fn tas(am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in TAS assembler");
+        effective_address(0b0100_1010_11, am)
+    }
+
+    pub fn trap(vector: u8) -> u16 {
+        assert!(vector <= 15, "Invalid TRAP vector.");
+        Words::one(0b0100_1110_0100 << 4 | vector as u16)
+    }
+
+    pub fn trapv() -> u16 {
+        Words::one(0x4E76)
+    }
+
+    pub fn tst(size: Size, am: AddressingMode) -> Vec<u16> {
+        assert!(am.verify(&MODES_0234567, &[0, 1]), "Invalid addressing mode in TST assembler");
+        size_effective_address(0b0100_1010, size, am)
+    }
+
+    pub fn unlk(reg: u8) -> u16 {
+        assert!(reg <= 7, "Invalid register.");
+        Words::one(register(0b0100_1110_0101_1, reg))
+    }
 }
@@ -8,6 +8,9 @@
 //!
 //! I don't know if macros and const generics and such could do the job for me,
 //! so I do it with a dedicated program instead.
+//!
+//! The argument selects the layout used by the generated `decode` function: `compact` (the default) or `flat`.
+//! Both tables are always generated.
 
 #![allow(non_upper_case_globals)]
 
@@ -22,6 +25,10 @@ const FILE_BEGIN: &[u8] = b"// This Source Code Form is subject to the terms of
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 //! Instruction decoding module.
+//!
+//! Two layouts of the decoding table are available: the flat [DECODER] table with one entry per opcode (64 KiB), and
+//! the compact two-level table [DECODER_BLOCK_INDEX] and [DECODER_BLOCKS] (about 6 KiB), which shares the identical
+//! blocks of 64 opcodes. [decode] uses the layout selected when generating this file.
 
 use crate::isa::{Isa, Isa::*};
 
@@ -41,7 +48,26 @@ const FILE_END: &[u8] = b"
 ];
 ";
 
+/// Number of opcodes in each block of the compact table.
+/// The lower 6 bits are the effective address field of most instructions, so most blocks are identical.
+const BLOCK_SIZE: usize = 64;
+
+/// Layout of the decoding table used by the generated `decode` function.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Layout {
+    /// One entry per opcode.
+    Flat,
+    /// Index of the block of each group of [BLOCK_SIZE] opcodes, then the ISA in the block.
+    Compact,
+}
+
 fn main() {
+    let layout = match std::env::args().nth(1).as_deref() {
+        None | Some("compact") => Layout::Compact,
+        Some("flat") => Layout::Flat,
+        Some(arg) => panic!("Unknown layout {arg}, expected flat or compact"),
+    };
+
     let mut file = File::create("decoder.rs").expect("Unable to create file decoder.rs");
     let mut opcodes = [Isa::Unknown; 65536];
 
@@ -66,6 +92,75 @@ fn main() {
     if let Err(e) = file.write(FILE_END) {
         panic!("Failed to write: {e}")
     }
+
+    if let Err(e) = file.write(compact_tables(&opcodes, layout).as_bytes()) {
+        panic!("Failed to write the compact tables: {e}")
+    }
+}
+
+/// Returns the source code of the compact tables and of the `decode` function.
+fn compact_tables(opcodes: &[Isa; 65536], layout: Layout) -> String {
+    let mut blocks: Vec<&[Isa]> = Vec::new();
+    let mut index = Vec::new();
+    for block in opcodes.chunks(BLOCK_SIZE) {
+        let i = blocks.iter().position(|b| *b == block).unwrap_or_else(|| {
+            blocks.push(block);
+            blocks.len() - 1
+        });
+        index.push(u8::try_from(i).expect("Too many distinct blocks for an u8 index"));
+    }
+
+    let mut str = format!("
+/// Number of opcodes in each block of [DECODER_BLOCKS].
+pub const DECODER_BLOCK_SIZE: usize = {BLOCK_SIZE};
+
+/// Index in [DECODER_BLOCKS] of the block of each group of [DECODER_BLOCK_SIZE] opcodes.
+///
+/// Use `opcode / DECODER_BLOCK_SIZE` as the index in the array.
+pub const DECODER_BLOCK_INDEX: [u8; {}] = [", index.len());
+
+    for (i, block) in index.iter().enumerate() {
+        if i % 16 == 0 {
+            str += "\n   ";
+        }
+        str += &format!(" {block:2},");
+    }
+
+    str += &format!("
+];
+
+/// The distinct blocks of [DECODER_BLOCK_SIZE] opcodes of the decoding table.
+///
+/// Use `opcode % DECODER_BLOCK_SIZE` as the index in the block.
+pub const DECODER_BLOCKS: [[Isa; DECODER_BLOCK_SIZE]; {}] = [", blocks.len());
+
+    for block in blocks {
+        str += "\n    [";
+        for (i, isa) in block.iter().enumerate() {
+            if i % 16 == 0 {
+                str += "\n        ";
+            }
+            str += &format!("{isa:7?}, ");
+        }
+        str += "\n    ],";
+    }
+
+    let body = match layout {
+        Layout::Flat => "DECODER[opcode as usize]",
+        Layout::Compact => "DECODER_BLOCKS[DECODER_BLOCK_INDEX[opcode as usize / DECODER_BLOCK_SIZE] as usize][opcode as usize % DECODER_BLOCK_SIZE]",
+    };
+
+    str += &format!("
+];
+
+/// Returns the Isa of the given opcode.
+#[inline(always)]
+pub const fn decode(opcode: u16) -> Isa {{
+    {body}
+}}
+");
+
+    str
 }
 
 fn generate_isa(opcodes: &mut [Isa; 65536]) {
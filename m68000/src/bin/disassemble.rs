@@ -4,8 +4,13 @@
 
 //! Little program to disassemble the given binary file for the specified range.
 //!
-//! Usage: `./disassembler.exe <input file> [-o <output file>] [-b <beginning pos>] [-e <ending position>]`
+//! Usage: `./disassembler.exe <input file> [-o <output file>] [-b <beginning pos>] [-e <ending position>] [-f] [-x <entry point>]...`
+//!
+//! With `-f` or `-x`, only the instructions reached by following the control flow from the entry points are
+//! disassembled, and the other ranges are written as data. The entry points are the ones given with `-x`, and with
+//! `-f` the initial PC and exception handlers of the vector table at the beginning of the file.
 
+use m68000::code_map::{ImageDisassembler, vector_table_entries};
 use m68000::decoder::DECODER;
 use m68000::disassembler::DLUT;
 use m68000::instruction::Instruction;
@@ -18,10 +23,11 @@ use std::io::{Read, Write};
 fn main() {
     let mut args = std::env::args();
     let exec = args.next().unwrap();
-    if args.len() < 1 || args.len() > 7 {
+    if args.len() < 1 {
         println!("Disassembles the instructions in the given input binary file, starting and ending at the given locations.");
         println!("Outputs the instructions in the given output file, or on the standard output if the output file is not supplied or cannot be opened.");
-        println!("Usage: {} <input file> [-o <output file>] [-b <beginning pos>] [-e <ending position>]", exec);
+        println!("With -f or -x, follows the control flow from the vector table (-f) and the given entry points (-x), and outputs the other ranges as data.");
+        println!("Usage: {} <input file> [-o <output file>] [-b <beginning pos>] [-e <ending position>] [-f] [-x <entry point>]...", exec);
         std::process::exit(1);
     }
 
@@ -31,12 +37,16 @@ fn main() {
     let mut outname = String::new();
     let mut beg = 0;
     let mut end = usize::MAX;
+    let mut follow = false;
+    let mut entry_points = Vec::new();
 
     while let Some(arg) = args.next() {
         match &arg[..] {
             "-o" => outname = args.next().expect("Expected output filename with parameter -o"),
             "-b" => beg = args.next().expect("Expected beginning position with parameter -b").parse().expect("Expected number for beginning position"),
             "-e" => end = args.next().expect("Expected ending position with parameter -e").parse().expect("Expected number for ending position"),
+            "-f" => follow = true,
+            "-x" => entry_points.push(args.next().expect("Expected entry point with parameter -x").parse().expect("Expected number for entry point")),
             _ => panic!("Unknown parameter \"{}\"", arg),
         }
     }
@@ -55,6 +65,30 @@ fn main() {
     let mut data = Vec::new();
     infile.read_to_end(&mut data).unwrap();
 
+    if follow || !entry_points.is_empty() {
+        if follow {
+            entry_points.extend(vector_table_entries(&data, 0));
+        }
+
+        let code = ImageDisassembler::new(0).disassemble(&data, 0, &entry_points);
+        let mut data_ranges = code.data_ranges(beg as u32..end as u32).into_iter().peekable();
+        let first = code.entries().partition_point(|entry| (entry.addr as usize) < beg);
+        let mut iter = data.iter_u16(0);
+        for entry in code.entries()[first..].iter().take_while(|entry| (entry.addr as usize) < end) {
+            while let Some(range) = data_ranges.next_if(|range| range.start < entry.addr) {
+                write_line(&mut outfile, format_args!("{:#X} DATA {} bytes", range.start, range.end - range.start));
+            }
+
+            iter.next_addr = entry.addr;
+            let inst = Instruction::from_memory(&mut iter).unwrap();
+            write_line(&mut outfile, format_args!("{:#X} {}", entry.addr, DLUT[DECODER[inst.opcode as usize] as usize](&inst)));
+        }
+        for range in data_ranges {
+            write_line(&mut outfile, format_args!("{:#X} DATA {} bytes", range.start, range.end - range.start));
+        }
+        return;
+    }
+
     let mut i = beg;
     let mut iter = data.iter_u16(i as u32);
     while i < end {
@@ -69,3 +103,11 @@ fn main() {
         i = iter.next_addr as usize;
     }
 }
+
+fn write_line(outfile: &mut Option<File>, line: std::fmt::Arguments) {
+    if let Some(outfile) = outfile {
+        writeln!(outfile, "{}", line).unwrap();
+    } else {
+        println!("{}", line);
+    }
+}
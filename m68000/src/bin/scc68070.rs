@@ -7,9 +7,7 @@
 
 use m68000::M68000;
 use m68000::memory_access::MemoryAccess;
-
-use std::fs::File;
-use std::io::Read;
+use m68000::rom::Rom;
 
 /// The microcontroller structure, with its CPU core and its internal peripherals memory.
 struct Scc68070 {
@@ -21,8 +19,15 @@ struct Scc68070 {
 struct Memory68070 {
     pub memory_swap: usize,
     pub ram: Box<[u8]>,
+    /// The program, shared by all the instances.
+    pub rom: Rom,
 }
 
+/// The address of the ROM.
+const ROM_START: u32 = 0x40_0000;
+/// The end address of the ROM area.
+const ROM_END: u32 = 0x50_0000;
+
 impl MemoryAccess for Memory68070 {
     fn get_byte(&mut self, addr: u32) -> Option<u8> {
         if addr >= 0x8000_2011 && addr <= 0x8000_201B {
@@ -33,6 +38,8 @@ impl MemoryAccess for Memory68070 {
             }
         } else if (addr as usize) < self.ram.len() {
             Some(self.ram[addr as usize])
+        } else if addr >= ROM_START && addr < ROM_END {
+            Some(self.rom.as_bytes().get((addr - ROM_START) as usize).copied().unwrap_or(0))
         } else {
             None
         }
@@ -41,7 +48,7 @@ impl MemoryAccess for Memory68070 {
     fn get_word(&mut self, addr: u32) -> Option<u16> {
         if self.memory_swap < 4 {
             self.memory_swap += 1;
-            Some((self.get_byte(addr + 0x40_0000)? as u16) << 8 | self.get_byte(addr + 0x40_0001)? as u16)
+            Some((self.get_byte(addr + ROM_START)? as u16) << 8 | self.get_byte(addr + ROM_START + 1)? as u16)
         } else {
             Some((self.get_byte(addr)? as u16) << 8 | self.get_byte(addr + 1)? as u16)
         }
@@ -71,17 +78,17 @@ impl MemoryAccess for Memory68070 {
 
 fn main()
 {
-    let mut ram = Memory68070 {
-        memory_swap: 0,
-        ram: vec![0; 0x50_0000].into_boxed_slice(),
+    // Load the program, which can be shared by several instances without copying it.
+    let rom = match Rom::from_file("cpudiag40.rom") {
+        Ok(rom) => rom,
+        Err(e) => panic!("Failed to read from cpudiag40.rom: {}", e),
     };
 
-    // Load the program in memory.
-    let mut bios_file = File::open("cpudiag40.rom").expect("no cpudiag40.rom");
-    match bios_file.read(&mut ram.ram[0x40_0000..]) {
-        Ok(_) => (),
-        Err(e) => panic!("Failed to read from cpudiag40.rom: {}", e),
-    }
+    let ram = Memory68070 {
+        memory_swap: 0,
+        ram: vec![0; ROM_START as usize].into_boxed_slice(),
+        rom,
+    };
 
     let mut scc68070 = Scc68070 {
         cpu: M68000::new(),
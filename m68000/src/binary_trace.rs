@@ -0,0 +1,968 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Streaming binary execution trace, for recording long executions to a file or a socket.
+//!
+//! [M68000::record_interpreter_exception] executes an instruction like
+//! [M68000::trace_interpreter_exception](crate::M68000::trace_interpreter_exception) and appends it to a
+//! [TraceWriter]: the PC as a delta from the expected one, the instruction words, the registers that changed and the
+//! memory accesses done by the instruction. The records are grouped in blocks that start with a full copy of the
+//! registers (a keyframe), and a background thread compresses the blocks and writes them to the output, so recording
+//! an instruction only costs the encoding of a few bytes.
+//!
+//! [TraceReader] indexes the blocks of a trace and returns any instruction by its index, decompressing only the block
+//! that contains it. The instructions are stored as their words and are only decoded when requested with
+//! [TraceEntry::instruction], so they can be disassembled lazily with [Instruction::disassemble_to].
+//!
+//! # Format
+//!
+//! All the integers are little-endian. The trace starts with the 8 bytes of [MAGIC], followed by the blocks.
+//! Each block starts with a 20-bytes header: the index of its first instruction (u64), its instruction count,
+//! its decompressed size and its stored size (u32). The block data follows, compressed with an LZ77 scheme, or stored
+//! as-is when the stored size is equal to the decompressed size.
+//!
+//! The decompressed data starts with the keyframe, the registers before the first instruction of the block
+//! (D0-D7, A0-A6, USP, SSP and PC as u32, then SR as u16). Then comes one record per instruction:
+//! - a flags byte: the number of instruction words in bits 0-2, then in bits 3 to 7 if the PC before, the exception,
+//!   the register mask, the memory accesses and the PC after are present.
+//! - the PC before, as a zigzag LEB128 delta from the PC after the previous record, if not equal to it.
+//! - the instruction words as u16.
+//! - the cycle count as LEB128.
+//! - the exception vector as u8.
+//! - the register mask as LEB128 (bits 0-7 for D0-D7, 8-14 for A0-A6, 15 for USP, 16 for SSP and 17 for SR),
+//!   followed by each changed register XORed with its previous value as LEB128.
+//! - the memory access count as LEB128, followed by the accesses: a kind byte (the size in bits 0-1, bit 2 set for
+//!   writes, bit 3 set for access errors), the address as a zigzag LEB128 delta from the previous access of the block,
+//!   and the value as LEB128 if there was no access error.
+//! - the PC after, as a zigzag LEB128 delta from the address following the instruction, if not equal to it.
+
+use crate::{CpuDetails, M68000, MemoryAccess, Registers};
+use crate::exception::Vector;
+use crate::instruction::{Instruction, Size};
+
+use std::io::{self, Read, Seek, SeekFrom, Write};
+use std::num::Wrapping;
+use std::sync::mpsc::{self, Receiver, SyncSender};
+use std::thread::{self, JoinHandle};
+
+/// The first bytes of a trace.
+pub const MAGIC: [u8; 8] = *b"M68KTRC1";
+/// The default number of instructions per block, between two keyframes.
+pub const DEFAULT_KEYFRAME_INTERVAL: u32 = 4096;
+
+/// Number of words of the longest instruction.
+const MAX_WORDS: usize = 5;
+const BLOCK_HEADER_SIZE: usize = 20;
+/// The size of the keyframe at the start of the block data: 18 u32 registers and SR.
+const KEYFRAME_SIZE: u64 = 18 * 4 + 2;
+/// The smallest instruction record: the flags byte and a one-byte cycle count.
+const MIN_RECORD_SIZE: u64 = 2;
+/// The largest decompressed size of one byte of compressed data, reached by the length extension bytes of the matches.
+const MAX_EXPANSION: u64 = 255;
+/// Number of blocks waiting for the background thread before the recording waits for it.
+const QUEUE_LEN: usize = 4;
+
+const FLAG_WORDS: u8 = 0b111;
+const FLAG_PC_BEFORE: u8 = 1 << 3;
+const FLAG_EXCEPTION: u8 = 1 << 4;
+const FLAG_REGISTERS: u8 = 1 << 5;
+const FLAG_ACCESSES: u8 = 1 << 6;
+const FLAG_PC_AFTER: u8 = 1 << 7;
+
+const ACCESS_SIZE: u8 = 0b11;
+pub(crate) const ACCESS_WRITE: u8 = 1 << 2;
+pub(crate) const ACCESS_ERROR: u8 = 1 << 3;
+
+/// Index of SR in the register mask.
+const SR_BIT: u32 = 17;
+
+/// A memory access done by a recorded instruction.
+///
+/// The blocks transferred by MOVEM are recorded as one word access per word.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct MemoryRecord {
+    pub addr: u32,
+    pub size: Size,
+    pub write: bool,
+    /// The value read or written, or None if the access triggered an access error.
+    pub value: Option<u32>,
+}
+
+/// An instruction read from a trace.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct TraceEntry {
+    /// The index of the instruction in the trace.
+    pub index: u64,
+    /// The address of the instruction, or the value of the PC after the step if no instruction has been executed.
+    pub pc: u32,
+    words: [u16; MAX_WORDS],
+    len: usize,
+    /// The cycle count necessary to execute the instruction (and the pending exceptions processed before it).
+    pub cycles: usize,
+    /// The vector of the exception that occured during the execution if any.
+    pub exception: Option<Vector>,
+    /// The registers after the execution of the instruction.
+    pub regs: Registers,
+    /// The memory accesses done by the exception processing and the instruction, in order, excluding the reading of
+    /// the instruction itself.
+    pub accesses: Vec<MemoryRecord>,
+}
+
+impl TraceEntry {
+    /// Returns the words of the instruction, empty if no instruction has been executed.
+    pub fn words(&self) -> &[u16] {
+        &self.words[..self.len]
+    }
+
+    /// Decodes the instruction, or returns None if no instruction has been executed.
+    pub fn instruction(&self) -> Option<Instruction> {
+        if self.len == 0 {
+            return None;
+        }
+
+        let mut words = InstructionWords { pc: self.pc, words: self.words() };
+        Instruction::from_memory(&mut words.iter_u16(self.pc)).ok()
+    }
+}
+
+/// The words of a recorded instruction, seen as the memory at its address.
+struct InstructionWords<'a> {
+    pc: u32,
+    words: &'a [u16],
+}
+
+impl MemoryAccess for InstructionWords<'_> {
+    fn get_byte(&mut self, _: u32) -> Option<u8> {
+        None
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.words.get(addr.wrapping_sub(self.pc) as usize / 2).copied()
+    }
+
+    fn set_byte(&mut self, _: u32, _: u8) -> Option<()> {
+        None
+    }
+
+    fn set_word(&mut self, _: u32, _: u16) -> Option<()> {
+        None
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+/// Memory wrapper that logs the accesses of the instruction being recorded.
+struct Recorder<'a, M: MemoryAccess + ?Sized> {
+    memory: &'a mut M,
+    accesses: &'a mut Vec<MemoryRecord>,
+    words: [u16; MAX_WORDS],
+    len: usize,
+}
+
+impl<M: MemoryAccess + ?Sized> Recorder<'_, M> {
+    #[inline(always)]
+    fn log(&mut self, addr: u32, size: Size, write: bool, value: Option<u32>) {
+        self.accesses.push(MemoryRecord { addr, size, write, value });
+    }
+
+    /// Moves the last `len` reads, which are the words of the instruction that has just been decoded, out of the log.
+    fn take_fetches(&mut self, len: usize) {
+        let len = len.min(MAX_WORDS).min(self.accesses.len());
+        let start = self.accesses.len() - len;
+        for (word, access) in self.words.iter_mut().zip(self.accesses.drain(start..)) {
+            *word = access.value.unwrap_or(0) as u16;
+        }
+        self.len = len;
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> MemoryAccess for Recorder<'_, M> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        let data = self.memory.get_byte(addr);
+        self.log(addr, Size::Byte, false, data.map(u32::from));
+        data
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let data = self.memory.get_word(addr);
+        self.log(addr, Size::Word, false, data.map(u32::from));
+        data
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        let data = self.memory.get_long(addr);
+        self.log(addr, Size::Long, false, data);
+        data
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        let res = self.memory.set_byte(addr, value);
+        self.log(addr, Size::Byte, true, res.map(|_| value as u32));
+        res
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        let res = self.memory.set_word(addr, value);
+        self.log(addr, Size::Word, true, res.map(|_| value as u32));
+        res
+    }
+
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        let res = self.memory.set_long(addr, value);
+        self.log(addr, Size::Long, true, res.map(|_| value));
+        res
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let res = self.memory.get_block(addr, data);
+        self.log_block(addr, data, false, res.is_some());
+        res
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        let res = self.memory.set_block(addr, data);
+        self.log_block(addr, data, true, res.is_some());
+        res
+    }
+
+    fn prefetched_word(&self, addr: u32) -> Option<u16> {
+        self.memory.prefetched_word(addr)
+    }
+
+    fn reset_instruction(&mut self) {
+        self.memory.reset_instruction();
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        self.memory.take_wait_cycles()
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> Recorder<'_, M> {
+    fn log_block(&mut self, addr: u32, data: &[u8], write: bool, ok: bool) {
+        if !ok {
+            self.log(addr, Size::Word, write, None);
+            return;
+        }
+
+        for (i, word) in data.chunks_exact(2).enumerate() {
+            let value = u16::from_be_bytes([word[0], word[1]]) as u32;
+            self.log(addr.wrapping_add(i as u32 * 2), Size::Word, write, Some(value));
+        }
+    }
+}
+
+/// A block of records sent to the background thread: its first instruction index, its instruction count and its data.
+type Block = (u64, u32, Vec<u8>);
+
+/// Records instructions in a binary trace, written to the output by a background thread.
+///
+/// The trace is written when the writer is finished with [Self::finish] or dropped. If writing to the output fails,
+/// the following blocks are discarded and the error is returned by [Self::finish].
+pub struct TraceWriter<W: Write + Send + 'static> {
+    /// The data of the current block.
+    data: Vec<u8>,
+    /// The number of instructions in the current block.
+    count: u32,
+    /// The index of the first instruction of the current block.
+    first_index: u64,
+    interval: u32,
+    /// The registers after the last recorded instruction.
+    regs: Registers,
+    /// The address of the last recorded memory access of the block.
+    addr: u32,
+    /// The accesses of the instruction being recorded.
+    accesses: Vec<MemoryRecord>,
+    sender: Option<SyncSender<Block>>,
+    thread: Option<JoinHandle<io::Result<W>>>,
+}
+
+impl<W: Write + Send + 'static> TraceWriter<W> {
+    /// Creates a new writer with a keyframe every [DEFAULT_KEYFRAME_INTERVAL] instructions.
+    pub fn new(output: W) -> Self {
+        Self::with_keyframe_interval(output, DEFAULT_KEYFRAME_INTERVAL)
+    }
+
+    /// Creates a new writer with a keyframe every `interval` instructions.
+    ///
+    /// Shorter intervals make seeking faster and longer ones make the trace smaller.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `interval` is 0.
+    pub fn with_keyframe_interval(output: W, interval: u32) -> Self {
+        assert!(interval > 0, "Keyframe interval must not be 0");
+        let (sender, receiver) = mpsc::sync_channel(QUEUE_LEN);
+        let thread = thread::spawn(move || write_blocks(output, receiver));
+
+        Self {
+            data: Vec::new(),
+            count: 0,
+            first_index: 0,
+            interval,
+            regs: Registers::default(),
+            addr: 0,
+            accesses: Vec::new(),
+            sender: Some(sender),
+            thread: Some(thread),
+        }
+    }
+
+    /// Returns the number of instructions recorded.
+    pub fn len(&self) -> u64 {
+        self.first_index + self.count as u64
+    }
+
+    /// Returns true if no instruction has been recorded.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Sends the current block to the background thread, so the next instruction starts a new block with a keyframe.
+    ///
+    /// Call it to make the recorded instructions available to a reader of the output, or after modifying the
+    /// registers of the core outside of the recorded instructions, although such modifications are recorded anyway.
+    pub fn flush(&mut self) {
+        if self.count == 0 {
+            return;
+        }
+
+        let capacity = self.data.capacity();
+        let data = std::mem::replace(&mut self.data, Vec::with_capacity(capacity));
+        if let Some(sender) = &self.sender {
+            // The thread only stops on an error, which is returned by finish.
+            let _ = sender.send((self.first_index, self.count, data));
+        }
+
+        self.first_index += self.count as u64;
+        self.count = 0;
+    }
+
+    /// Writes the remaining instructions and returns the output, or the error that occured when writing to it.
+    pub fn finish(mut self) -> io::Result<W> {
+        self.stop().unwrap()
+    }
+
+    fn stop(&mut self) -> Option<io::Result<W>> {
+        self.flush();
+        self.sender = None;
+        let thread = self.thread.take()?;
+        Some(thread.join().unwrap_or_else(|e| std::panic::resume_unwind(e)))
+    }
+
+    /// Appends an instruction to the current block.
+    fn push(&mut self, before: &Registers, pc: u32, words: &[u16], cycles: usize, exception: Option<Vector>, after: &Registers) {
+        if self.count == 0 {
+            self.regs = *before;
+            self.addr = 0;
+            write_keyframe(&mut self.data, before);
+        }
+
+        let flags_pos = self.data.len();
+        self.data.push(0);
+        let mut flags = words.len() as u8;
+
+        if !words.is_empty() && pc != self.regs.pc.0 {
+            flags |= FLAG_PC_BEFORE;
+            write_signed(&mut self.data, pc.wrapping_sub(self.regs.pc.0));
+        }
+
+        for word in words {
+            self.data.extend_from_slice(&word.to_le_bytes());
+        }
+
+        write_varint(&mut self.data, cycles as u64);
+
+        if let Some(vector) = exception {
+            flags |= FLAG_EXCEPTION;
+            self.data.push(vector as u8);
+        }
+
+        let old = general_registers(&self.regs);
+        let new = general_registers(after);
+        let old_sr = u16::from(self.regs.sr);
+        let new_sr = u16::from(after.sr);
+        let mut mask = old.iter().zip(new.iter()).enumerate()
+            .fold(0, |mask, (i, (old, new))| if old != new { mask | 1 << i } else { mask });
+        if old_sr != new_sr {
+            mask |= 1 << SR_BIT;
+        }
+        if mask != 0 {
+            flags |= FLAG_REGISTERS;
+            write_varint(&mut self.data, mask as u64);
+            for i in (0..old.len()).filter(|i| mask & 1 << i != 0) {
+                write_varint(&mut self.data, (old[i] ^ new[i]) as u64);
+            }
+            if mask & 1 << SR_BIT != 0 {
+                write_varint(&mut self.data, (old_sr ^ new_sr) as u64);
+            }
+        }
+
+        if !self.accesses.is_empty() {
+            flags |= FLAG_ACCESSES;
+            write_varint(&mut self.data, self.accesses.len() as u64);
+            for access in &self.accesses {
+                let mut kind = size_code(access.size);
+                if access.write {
+                    kind |= ACCESS_WRITE;
+                }
+                if access.value.is_none() {
+                    kind |= ACCESS_ERROR;
+                }
+
+                self.data.push(kind);
+                write_signed(&mut self.data, access.addr.wrapping_sub(self.addr));
+                if let Some(value) = access.value {
+                    write_varint(&mut self.data, value as u64);
+                }
+                self.addr = access.addr;
+            }
+        }
+
+        let next = next_pc(self.regs.pc.0, pc, words.len());
+        if after.pc.0 != next {
+            flags |= FLAG_PC_AFTER;
+            write_signed(&mut self.data, after.pc.0.wrapping_sub(next));
+        }
+
+        self.data[flags_pos] = flags;
+        self.regs = *after;
+        self.count += 1;
+        if self.count == self.interval {
+            self.flush();
+        }
+    }
+}
+
+impl<W: Write + Send + 'static> Drop for TraceWriter<W> {
+    fn drop(&mut self) {
+        let _ = self.stop();
+    }
+}
+
+/// The loop of the background thread, which compresses and writes the blocks.
+fn write_blocks<W: Write>(mut output: W, receiver: Receiver<Block>) -> io::Result<W> {
+    output.write_all(&MAGIC)?;
+
+    let mut compressed = Vec::new();
+    for (first_index, count, data) in receiver {
+        compressed.clear();
+        compress(&data, &mut compressed);
+        let stored = if compressed.len() < data.len() { &compressed } else { &data };
+
+        let mut header = [0; BLOCK_HEADER_SIZE];
+        header[0..8].copy_from_slice(&first_index.to_le_bytes());
+        header[8..12].copy_from_slice(&count.to_le_bytes());
+        header[12..16].copy_from_slice(&(data.len() as u32).to_le_bytes());
+        header[16..20].copy_from_slice(&(stored.len() as u32).to_le_bytes());
+        output.write_all(&header)?;
+        output.write_all(stored)?;
+    }
+
+    output.flush()?;
+    Ok(output)
+}
+
+/// The location of a block in the trace.
+#[derive(Clone, Copy, Debug)]
+struct BlockInfo {
+    first_index: u64,
+    count: u32,
+    /// The offset of the block data in the input.
+    offset: u64,
+    raw_len: u32,
+    stored_len: u32,
+}
+
+/// Reads a binary trace, decompressing the block of the requested instruction.
+pub struct TraceReader<R: Read + Seek> {
+    input: R,
+    blocks: Vec<BlockInfo>,
+    len: u64,
+    /// The index of the decoded block and its instructions.
+    cache: Option<(usize, Vec<TraceEntry>)>,
+}
+
+impl<R: Read + Seek> TraceReader<R> {
+    /// Indexes the blocks of the trace that starts at the beginning of the given input.
+    ///
+    /// Only the block headers are read. Returns an error if the input is not a trace.
+    pub fn new(mut input: R) -> io::Result<Self> {
+        input.seek(SeekFrom::Start(0))?;
+
+        let mut magic = [0; MAGIC.len()];
+        input.read_exact(&mut magic)?;
+        if magic != MAGIC {
+            return Err(invalid_data("not a m68000 binary trace"));
+        }
+
+        let end = input.seek(SeekFrom::End(0))?;
+        input.seek(SeekFrom::Start(MAGIC.len() as u64))?;
+
+        // The headers are checked before anything is allocated from them, so a corrupted trace is an error.
+        let mut blocks = Vec::new();
+        let mut len = 0;
+        while let Some(header) = read_header(&mut input)? {
+            let block = BlockInfo {
+                first_index: u64::from_le_bytes(header[0..8].try_into().unwrap()),
+                count: u32::from_le_bytes(header[8..12].try_into().unwrap()),
+                offset: input.stream_position()?,
+                raw_len: u32::from_le_bytes(header[12..16].try_into().unwrap()),
+                stored_len: u32::from_le_bytes(header[16..20].try_into().unwrap()),
+            };
+            if block.first_index != len || block.stored_len > block.raw_len ||
+                block.raw_len as u64 > block.stored_len as u64 * MAX_EXPANSION ||
+                KEYFRAME_SIZE + block.count as u64 * MIN_RECORD_SIZE > block.raw_len as u64 {
+                return Err(invalid_data("invalid block header"));
+            }
+            if block.offset + block.stored_len as u64 > end {
+                return Err(invalid_data("truncated block"));
+            }
+
+            input.seek(SeekFrom::Current(block.stored_len as i64))?;
+            len += block.count as u64;
+            blocks.push(block);
+        }
+
+        Ok(Self { input, blocks, len, cache: None })
+    }
+
+    /// Returns the number of instructions in the trace.
+    pub fn len(&self) -> u64 {
+        self.len
+    }
+
+    /// Returns true if the trace contains no instruction.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns the number of blocks, which is the number of keyframes.
+    pub fn block_count(&self) -> usize {
+        self.blocks.len()
+    }
+
+    /// Returns the instruction at the given index, or None if the index is past the end of the trace.
+    ///
+    /// The block of the instruction is decompressed and kept until an instruction of another block is requested,
+    /// so reading the instructions in order decompresses each block once.
+    pub fn get(&mut self, index: u64) -> io::Result<Option<&TraceEntry>> {
+        if index >= self.len {
+            return Ok(None);
+        }
+
+        let block = self.blocks.partition_point(|block| block.first_index + block.count as u64 <= index);
+        if self.cache.as_ref().map_or(true, |(cached, _)| *cached != block) {
+            let entries = self.read_block(&self.blocks[block].clone())?;
+            self.cache = Some((block, entries));
+        }
+
+        let (_, entries) = self.cache.as_ref().unwrap();
+        Ok(entries.get((index - self.blocks[block].first_index) as usize))
+    }
+
+    fn read_block(&mut self, block: &BlockInfo) -> io::Result<Vec<TraceEntry>> {
+        self.input.seek(SeekFrom::Start(block.offset))?;
+        let mut stored = vec![0; block.stored_len as usize];
+        self.input.read_exact(&mut stored)?;
+
+        let data = if block.stored_len < block.raw_len {
+            decompress(&stored, block.raw_len as usize)?
+        } else {
+            stored
+        };
+
+        decode_block(&data, block.first_index, block.count)
+    }
+}
+
+/// Reads a block header, or returns None at the end of the input.
+fn read_header<R: Read>(input: &mut R) -> io::Result<Option<[u8; BLOCK_HEADER_SIZE]>> {
+    let mut header = [0; BLOCK_HEADER_SIZE];
+    let mut len = 0;
+    while len < header.len() {
+        match input.read(&mut header[len..]) {
+            Ok(0) => break,
+            Ok(n) => len += n,
+            Err(e) if e.kind() == io::ErrorKind::Interrupted => (),
+            Err(e) => return Err(e),
+        }
+    }
+
+    match len {
+        0 => Ok(None),
+        BLOCK_HEADER_SIZE => Ok(Some(header)),
+        _ => Err(io::ErrorKind::UnexpectedEof.into()),
+    }
+}
+
+fn decode_block(data: &[u8], first_index: u64, count: u32) -> io::Result<Vec<TraceEntry>> {
+    let mut data = Bytes::new(data);
+    let mut regs = read_keyframe(&mut data)?;
+    let mut addr = 0u32;
+    let mut entries = Vec::with_capacity(count as usize);
+
+    for index in first_index..first_index + count as u64 {
+        let flags = data.u8()?;
+        let len = (flags & FLAG_WORDS) as usize;
+        if len > MAX_WORDS {
+            return Err(invalid_data("invalid instruction length"));
+        }
+
+        let mut pc = regs.pc.0;
+        if flags & FLAG_PC_BEFORE != 0 {
+            pc = pc.wrapping_add(data.signed()?);
+        }
+
+        let mut words = [0; MAX_WORDS];
+        for word in &mut words[..len] {
+            *word = data.u16()?;
+        }
+
+        let cycles = data.varint()? as usize;
+
+        let exception = if flags & FLAG_EXCEPTION != 0 {
+            Some(vector_from_u8(data.u8()?)?)
+        } else {
+            None
+        };
+
+        let next = next_pc(regs.pc.0, pc, len);
+        if flags & FLAG_REGISTERS != 0 {
+            let mask = data.varint()?;
+            let mut values = general_registers(&regs);
+            for (_, value) in values.iter_mut().enumerate().filter(|(i, _)| mask & 1 << i != 0) {
+                *value ^= data.varint()? as u32;
+            }
+            set_general_registers(&mut regs, &values);
+            if mask & 1 << SR_BIT != 0 {
+                regs.sr = (u16::from(regs.sr) ^ data.varint()? as u16).into();
+            }
+        }
+
+        let mut accesses = Vec::new();
+        if flags & FLAG_ACCESSES != 0 {
+            let access_count = data.varint()? as usize;
+            accesses.reserve(access_count.min(data.data.len()));
+            for _ in 0..access_count {
+                let kind = data.u8()?;
+                addr = addr.wrapping_add(data.signed()?);
+                let size = size_from_code(kind)?;
+                let value = if kind & ACCESS_ERROR == 0 { Some(data.varint()? as u32) } else { None };
+                accesses.push(MemoryRecord { addr, size, write: kind & ACCESS_WRITE != 0, value });
+            }
+        }
+
+        regs.pc.0 = next;
+        if flags & FLAG_PC_AFTER != 0 {
+            regs.pc.0 = next.wrapping_add(data.signed()?);
+        }
+
+        if len == 0 {
+            pc = regs.pc.0;
+        }
+
+        entries.push(TraceEntry { index, pc, words, len, cycles, exception, regs, accesses });
+    }
+
+    if !data.is_empty() {
+        return Err(invalid_data("trailing data in block"));
+    }
+
+    Ok(entries)
+}
+
+/// The address following the instruction of `len` words at `pc`, or `previous` if there is no instruction.
+fn next_pc(previous: u32, pc: u32, len: usize) -> u32 {
+    if len == 0 {
+        previous
+    } else {
+        pc.wrapping_add(len as u32 * 2)
+    }
+}
+
+/// D0-D7, A0-A6, USP and SSP.
+fn general_registers(regs: &Registers) -> [u32; 17] {
+    let mut values = [0; 17];
+    for (value, reg) in values.iter_mut().zip(regs.d.iter().chain(regs.a.iter())) {
+        *value = reg.0;
+    }
+    values[15] = regs.usp.0;
+    values[16] = regs.ssp.0;
+    values
+}
+
+fn set_general_registers(regs: &mut Registers, values: &[u32; 17]) {
+    for (reg, value) in regs.d.iter_mut().chain(regs.a.iter_mut()).zip(values) {
+        *reg = Wrapping(*value);
+    }
+    regs.usp.0 = values[15];
+    regs.ssp.0 = values[16];
+}
+
+fn write_keyframe(data: &mut Vec<u8>, regs: &Registers) {
+    for value in general_registers(regs) {
+        data.extend_from_slice(&value.to_le_bytes());
+    }
+    data.extend_from_slice(&regs.pc.0.to_le_bytes());
+    data.extend_from_slice(&u16::from(regs.sr).to_le_bytes());
+}
+
+fn read_keyframe(data: &mut Bytes) -> io::Result<Registers> {
+    let mut values = [0; 17];
+    for value in &mut values {
+        *value = data.u32()?;
+    }
+
+    let mut regs = Registers::default();
+    set_general_registers(&mut regs, &values);
+    regs.pc.0 = data.u32()?;
+    regs.sr = data.u16()?.into();
+    Ok(regs)
+}
+
+pub(crate) fn write_varint(data: &mut Vec<u8>, mut value: u64) {
+    while value >= 0x80 {
+        data.push(value as u8 | 0x80);
+        value >>= 7;
+    }
+    data.push(value as u8);
+}
+
+/// Writes the given difference of two addresses as a zigzag-encoded varint.
+pub(crate) fn write_signed(data: &mut Vec<u8>, delta: u32) {
+    let delta = delta as i32;
+    write_varint(data, ((delta << 1) ^ (delta >> 31)) as u32 as u64);
+}
+
+/// Cursor over the decompressed data of a block.
+pub(crate) struct Bytes<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Bytes<'a> {
+    pub(crate) fn new(data: &'a [u8]) -> Self {
+        Self { data, pos: 0 }
+    }
+
+    /// Returns true if all the data has been read.
+    pub(crate) fn is_empty(&self) -> bool {
+        self.pos == self.data.len()
+    }
+
+    fn take<const N: usize>(&mut self) -> io::Result<[u8; N]> {
+        let bytes = self.data.get(self.pos..self.pos + N).ok_or_else(|| invalid_data("truncated block"))?;
+        self.pos += N;
+        Ok(bytes.try_into().unwrap())
+    }
+
+    pub(crate) fn u8(&mut self) -> io::Result<u8> {
+        Ok(self.take::<1>()?[0])
+    }
+
+    pub(crate) fn u16(&mut self) -> io::Result<u16> {
+        Ok(u16::from_le_bytes(self.take()?))
+    }
+
+    pub(crate) fn u32(&mut self) -> io::Result<u32> {
+        Ok(u32::from_le_bytes(self.take()?))
+    }
+
+    pub(crate) fn varint(&mut self) -> io::Result<u64> {
+        let mut value = 0;
+        for shift in (0..64).step_by(7) {
+            let byte = self.u8()?;
+            value |= ((byte & 0x7F) as u64) << shift;
+            if byte & 0x80 == 0 {
+                return Ok(value);
+            }
+        }
+        Err(invalid_data("invalid varint"))
+    }
+
+    /// Reads a zigzag-encoded difference of two addresses.
+    pub(crate) fn signed(&mut self) -> io::Result<u32> {
+        let value = self.varint()? as u32;
+        Ok((value >> 1) ^ (value & 1).wrapping_neg())
+    }
+}
+
+pub(crate) fn vector_from_u8(raw: u8) -> io::Result<Vector> {
+    match raw {
+        0 | 2..=11 | 14 | 15 | 24..=47 | 57..=64 => Ok(unsafe { Vector::from_raw(raw) }),
+        _ => Err(invalid_data("invalid exception vector")),
+    }
+}
+
+/// The size of an access in the 2 low bits of a kind byte.
+pub(crate) fn size_code(size: Size) -> u8 {
+    match size {
+        Size::Byte => 0,
+        Size::Word => 1,
+        Size::Long => 2,
+    }
+}
+
+pub(crate) fn size_from_code(kind: u8) -> io::Result<Size> {
+    match kind & ACCESS_SIZE {
+        0 => Ok(Size::Byte),
+        1 => Ok(Size::Word),
+        2 => Ok(Size::Long),
+        _ => Err(invalid_data("invalid access size")),
+    }
+}
+
+pub(crate) fn invalid_data(msg: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, msg)
+}
+
+/// Minimum length of a match.
+const MIN_MATCH: usize = 4;
+const HASH_BITS: u32 = 12;
+const MAX_OFFSET: usize = u16::MAX as usize;
+
+/// Compresses the data with an LZ77 scheme.
+///
+/// The output is a sequence of tokens. The high nibble of the token byte is the number of literals and the low nibble
+/// is the length of the match minus [MIN_MATCH], both extended by bytes of 255 ended by a smaller byte when equal
+/// to 15. The literals follow, then the offset of the match as u16. The last token only has literals.
+fn compress(input: &[u8], output: &mut Vec<u8>) {
+    let mut table = [0u32; 1 << HASH_BITS];
+    let mut anchor = 0;
+    let mut i = 0;
+
+    while i + MIN_MATCH <= input.len() {
+        let sequence = u32::from_le_bytes(input[i..i + MIN_MATCH].try_into().unwrap());
+        let hash = (sequence.wrapping_mul(2654435761) >> (32 - HASH_BITS)) as usize;
+        let candidate = table[hash] as usize;
+        table[hash] = i as u32 + 1;
+
+        if candidate != 0 {
+            let candidate = candidate - 1;
+            if i - candidate <= MAX_OFFSET && input[candidate..candidate + MIN_MATCH] == input[i..i + MIN_MATCH] {
+                let mut len = MIN_MATCH;
+                while i + len < input.len() && input[candidate + len] == input[i + len] {
+                    len += 1;
+                }
+
+                write_token(output, &input[anchor..i], Some((i - candidate, len)));
+                i += len;
+                anchor = i;
+                continue;
+            }
+        }
+
+        i += 1;
+    }
+
+    write_token(output, &input[anchor..], None);
+}
+
+fn write_token(output: &mut Vec<u8>, literals: &[u8], matched: Option<(usize, usize)>) {
+    let match_len = matched.map_or(0, |(_, len)| len - MIN_MATCH);
+    output.push((literals.len().min(15) as u8) << 4 | match_len.min(15) as u8);
+
+    write_length(output, literals.len());
+    output.extend_from_slice(literals);
+
+    if let Some((offset, _)) = matched {
+        output.extend_from_slice(&(offset as u16).to_le_bytes());
+        write_length(output, match_len);
+    }
+}
+
+/// Writes the extension bytes of a token length.
+fn write_length(output: &mut Vec<u8>, len: usize) {
+    if len >= 15 {
+        let mut len = len - 15;
+        while len >= 255 {
+            output.push(255);
+            len -= 255;
+        }
+        output.push(len as u8);
+    }
+}
+
+fn decompress(input: &[u8], len: usize) -> io::Result<Vec<u8>> {
+    let mut input = Bytes::new(input);
+    let mut output = Vec::with_capacity(len);
+
+    loop {
+        let token = input.u8()?;
+
+        let literals = read_length(&mut input, (token >> 4) as usize)?;
+        let literals = input.data.get(input.pos..input.pos + literals).ok_or_else(|| invalid_data("truncated block"))?;
+        output.extend_from_slice(literals);
+        input.pos += literals.len();
+
+        if input.is_empty() {
+            break;
+        }
+
+        let offset = input.u16()? as usize;
+        let match_len = read_length(&mut input, (token & 0xF) as usize)? + MIN_MATCH;
+        if offset == 0 || offset > output.len() || output.len() + match_len > len {
+            return Err(invalid_data("invalid match"));
+        }
+
+        let start = output.len() - offset;
+        for i in start..start + match_len {
+            output.push(output[i]);
+        }
+    }
+
+    if output.len() != len {
+        return Err(invalid_data("invalid decompressed size"));
+    }
+
+    Ok(output)
+}
+
+fn read_length(input: &mut Bytes, len: usize) -> io::Result<usize> {
+    let mut len = len;
+    if len == 15 {
+        loop {
+            let byte = input.u8()?;
+            len += byte as usize;
+            if byte != 255 {
+                break;
+            }
+        }
+    }
+    Ok(len)
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Runs the interpreter loop once and records the instruction in the given trace.
+    ///
+    /// Returns the cycle count necessary to execute the instruction, and the vector of the exception that occured during
+    /// the execution if any.
+    ///
+    /// To process the returned exception, call [M68000::exception].
+    ///
+    /// See [Self::interpreter_exception] for the potential caveat.
+    pub fn record_interpreter_exception<M: MemoryAccess + ?Sized, W: Write + Send + 'static>(&mut self, memory: &mut M, trace: &mut TraceWriter<W>) -> (usize, Option<Vector>) {
+        if self.stop {
+            return (0, None);
+        }
+
+        let before = self.regs;
+        trace.accesses.clear();
+
+        // The accesses are recorded outside of the memory map and the caches to see all of them.
+        let (instruction, words, len, cycles, vector) = self.with_core_memory(memory, |cpu, memory| {
+            let mut recorder = Recorder { memory, accesses: &mut trace.accesses, words: [0; MAX_WORDS], len: 0 };
+            let (instruction, cycles, vector) = cpu.trace_interpreter_exception_inner(&mut recorder, |recorder, len| recorder.take_fetches(len));
+            (instruction, recorder.words, recorder.len, cycles, vector)
+        });
+
+        let cycles = cycles + self.take_wait_cycles(memory);
+        let pc = instruction.map_or(self.regs.pc.0, |instruction| instruction.pc);
+        trace.push(&before, pc, &words[..len], cycles, vector, &self.regs);
+
+        (cycles, vector)
+    }
+}
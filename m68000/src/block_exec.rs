@@ -0,0 +1,53 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Block execution tier of the instruction cache, enabled with the `block-exec` feature.
+//!
+//! When the instruction cache is enabled, [M68000::cycle], [M68000::cycle_until_exception] and
+//! [M68000::loop_until_exception_stop] run the cached basic blocks in a single loop instead of going through
+//! [M68000::interpreter_exception] for each instruction. The memory system is wrapped only once for the whole run,
+//! and the hot blocks are chained to their successors so jumping from one to another does not look up the cache.
+//!
+//! This is a threaded-code tier: the pre-decoded instructions are dispatched directly to the same handlers as the
+//! interpreter, no host machine code is generated. The execution times, the exceptions and the instruction-level
+//! granularity of the cycle budget are the same as the interpreter.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Runs the cached instructions until either an exception occurs, the CPU stops
+    /// or **at least** the given number of cycles have been executed.
+    ///
+    /// Must only be called when the instruction cache is enabled.
+    pub(super) fn run_cached_blocks<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, cycles: usize) -> (usize, Option<Vector>) {
+        self.with_core_memory(memory, |cpu, memory| {
+            let mut total = 0;
+
+            // There is no budget to skip idle loops to when running until an exception.
+            let idle_detection = cpu.idle_detection.is_some() && cycles != usize::MAX;
+
+            while total < cycles && !cpu.stop {
+                let pc = cpu.regs.pc.0;
+                let (c, vector) = cpu.cached_interpreter_exception(memory);
+                total += c + cpu.take_wait_cycles(memory);
+
+                if vector.is_some() {
+                    return (total, vector);
+                }
+
+                if idle_detection && total < cycles {
+                    let (c, vector) = cpu.skip_idle_loop(memory, pc, cycles - total);
+                    total += c;
+
+                    if vector.is_some() {
+                        return (total, vector);
+                    }
+                }
+            }
+
+            (total, None)
+        })
+    }
+}
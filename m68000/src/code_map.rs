@@ -0,0 +1,457 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Whole-image disassembly with control-flow recovery.
+//!
+//! [ImageDisassembler::disassemble] finds the instructions of a binary image by following the control flow from a set
+//! of entry points, so the data mixed with the code is not disassembled as instructions. It works in two passes:
+//! - the image is split in chunks decoded in parallel on several threads, an instruction being decoded at every word;
+//! - the control flow is followed from the entry points over the decoded words, through the fall-through paths and the
+//!   static targets of Bcc, BRA, BSR, DBcc, JMP and JSR. Targets computed at run time (like `JMP (A0)`) are not
+//!   followed, so their destinations have to be given as entry points.
+//!
+//! The resulting [CodeMap] is the sorted index of the instructions found. It can be saved with [CodeMap::write_to] in
+//! a format made of fixed-size records, which [CodeMapView] searches in place, for example in a memory-mapped file,
+//! without loading it. [M68000::warm_instruction_cache](crate::M68000::warm_instruction_cache) pre-decodes the
+//! instructions of a code map in the instruction cache.
+//!
+//! ```
+//! use m68000::assembler as asm;
+//! use m68000::code_map::ImageDisassembler;
+//!
+//! let mut program = vec![asm::nop()];
+//! program.extend(asm::bsr(4));
+//! program.push(asm::rts());
+//! program.push(0xFFFF); // Data after the RTS.
+//! program.push(asm::rts()); // The subroutine.
+//! let image: Vec<u8> = program.iter().flat_map(|word| word.to_be_bytes()).collect();
+//!
+//! let code = ImageDisassembler::new(0).disassemble(&image, 0x1000, &[0x1000]);
+//! let addresses: Vec<u32> = code.iter().map(|entry| entry.addr).collect();
+//! assert_eq!(addresses, [0x1000, 0x1002, 0x1004, 0x1008]);
+//! ```
+
+use crate::MemoryAccess;
+use crate::addressing_modes::AddressingMode;
+use crate::binary_trace::invalid_data;
+use crate::instruction::{Instruction, Operands};
+use crate::isa::Isa;
+
+use std::io::{self, Read, Write};
+use std::num::NonZeroUsize;
+use std::ops::Range;
+
+/// First bytes of a serialized code map.
+const MAGIC: [u8; 8] = *b"M68KCOD1";
+/// Length of the header: magic and number of records.
+const HEADER_LEN: usize = MAGIC.len() + 8;
+/// Length of a serialized [CodeEntry].
+const RECORD_LEN: usize = 8;
+/// Length of the exception vector table.
+const VECTOR_TABLE_LEN: u32 = 1024;
+
+/// An instruction found in the image.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct CodeEntry {
+    /// The address of the instruction.
+    pub addr: u32,
+    /// The length of the instruction in bytes.
+    pub len: u16,
+    /// The [CodeEntry::ENTRY_POINT], [CodeEntry::BRANCH_TARGET] and [CodeEntry::CALL_TARGET] flags.
+    pub flags: u16,
+}
+
+impl CodeEntry {
+    /// The instruction is one of the given entry points.
+    pub const ENTRY_POINT: u16 = 0x1;
+    /// The instruction is the target of a Bcc, BRA, DBcc or JMP.
+    pub const BRANCH_TARGET: u16 = 0x2;
+    /// The instruction is the target of a BSR or JSR.
+    pub const CALL_TARGET: u16 = 0x4;
+
+    /// Returns true if the control flow can reach this instruction from elsewhere than the previous instruction,
+    /// so it starts a basic block.
+    pub const fn is_leader(&self) -> bool {
+        self.flags & (Self::ENTRY_POINT | Self::BRANCH_TARGET | Self::CALL_TARGET) != 0
+    }
+
+    /// Returns the address of the byte after the instruction.
+    pub const fn end(&self) -> u32 {
+        self.addr.wrapping_add(self.len as u32)
+    }
+
+    fn from_record(record: &[u8]) -> Self {
+        Self {
+            addr: u32::from_le_bytes(record[0..4].try_into().unwrap()),
+            len: u16::from_le_bytes(record[4..6].try_into().unwrap()),
+            flags: u16::from_le_bytes(record[6..8].try_into().unwrap()),
+        }
+    }
+
+    fn to_record(self) -> [u8; RECORD_LEN] {
+        let mut record = [0; RECORD_LEN];
+        record[0..4].copy_from_slice(&self.addr.to_le_bytes());
+        record[4..6].copy_from_slice(&self.len.to_le_bytes());
+        record[6..8].copy_from_slice(&self.flags.to_le_bytes());
+        record
+    }
+}
+
+/// The instructions found in an image, sorted by address.
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct CodeMap {
+    entries: Vec<CodeEntry>,
+}
+
+impl CodeMap {
+    /// Returns the instructions, sorted by address.
+    pub fn entries(&self) -> &[CodeEntry] {
+        &self.entries
+    }
+
+    /// Returns an iterator over the instructions, sorted by address.
+    pub fn iter(&self) -> impl Iterator<Item = CodeEntry> + '_ {
+        self.entries.iter().copied()
+    }
+
+    /// Returns the number of instructions.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Returns true if no instruction has been found.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Returns the instruction starting at the given address.
+    pub fn get(&self, addr: u32) -> Option<&CodeEntry> {
+        self.entries.binary_search_by_key(&addr, |entry| entry.addr).ok().map(|i| &self.entries[i])
+    }
+
+    /// Returns the instruction that contains the byte at the given address.
+    pub fn find(&self, addr: u32) -> Option<&CodeEntry> {
+        let i = self.entries.partition_point(|entry| entry.addr <= addr);
+        self.entries[..i].last().filter(|entry| addr < entry.end())
+    }
+
+    /// Returns the address ranges of `range` that do not contain instructions, which are considered data.
+    pub fn data_ranges(&self, range: Range<u32>) -> Vec<Range<u32>> {
+        let mut ranges = Vec::new();
+        let mut addr = range.start;
+        let first = self.entries.partition_point(|entry| entry.end() <= range.start);
+        for entry in &self.entries[first..] {
+            if entry.addr >= range.end {
+                break;
+            }
+            if entry.addr > addr {
+                ranges.push(addr..entry.addr);
+            }
+            addr = addr.max(entry.end());
+        }
+        if addr < range.end {
+            ranges.push(addr..range.end);
+        }
+        ranges
+    }
+
+    /// Serializes the code map, in the format read by [CodeMapView] and [Self::read_from].
+    pub fn write_to<W: Write + ?Sized>(&self, output: &mut W) -> io::Result<()> {
+        let mut data = Vec::with_capacity(HEADER_LEN + self.entries.len() * RECORD_LEN);
+        data.extend_from_slice(&MAGIC);
+        data.extend_from_slice(&(self.entries.len() as u64).to_le_bytes());
+        for entry in &self.entries {
+            data.extend_from_slice(&entry.to_record());
+        }
+        output.write_all(&data)
+    }
+
+    /// Deserializes a code map written by [Self::write_to].
+    pub fn read_from<R: Read + ?Sized>(input: &mut R) -> io::Result<Self> {
+        let mut data = Vec::new();
+        input.read_to_end(&mut data)?;
+        let view = CodeMapView::new(&data)?;
+        Ok(Self { entries: view.iter().collect() })
+    }
+}
+
+/// A serialized [CodeMap], searched in place.
+#[derive(Clone, Copy, Debug)]
+pub struct CodeMapView<'a> {
+    records: &'a [u8],
+}
+
+impl<'a> CodeMapView<'a> {
+    /// Checks the header of the serialized code map. The records are not copied.
+    pub fn new(data: &'a [u8]) -> io::Result<Self> {
+        if data.len() < HEADER_LEN || !data.starts_with(&MAGIC) {
+            return Err(invalid_data("not a m68000 code map"));
+        }
+
+        let count = u64::from_le_bytes(data[MAGIC.len()..HEADER_LEN].try_into().unwrap());
+        let records = &data[HEADER_LEN..];
+        if count.checked_mul(RECORD_LEN as u64) != Some(records.len() as u64) {
+            return Err(invalid_data("truncated code map"));
+        }
+
+        Ok(Self { records })
+    }
+
+    /// Returns the number of instructions.
+    pub fn len(&self) -> usize {
+        self.records.len() / RECORD_LEN
+    }
+
+    /// Returns true if the code map is empty.
+    pub fn is_empty(&self) -> bool {
+        self.records.is_empty()
+    }
+
+    /// Returns the instruction at the given index, in address order.
+    pub fn entry(&self, index: usize) -> Option<CodeEntry> {
+        self.records.get(index * RECORD_LEN..(index + 1) * RECORD_LEN).map(CodeEntry::from_record)
+    }
+
+    /// Returns an iterator over the instructions, sorted by address.
+    pub fn iter(&self) -> impl Iterator<Item = CodeEntry> + 'a {
+        self.records.chunks_exact(RECORD_LEN).map(CodeEntry::from_record)
+    }
+
+    /// Returns the instruction starting at the given address.
+    pub fn get(&self, addr: u32) -> Option<CodeEntry> {
+        let (mut low, mut high) = (0, self.len());
+        while low < high {
+            let mid = low + (high - low) / 2;
+            let entry = self.entry(mid).unwrap();
+            match entry.addr.cmp(&addr) {
+                std::cmp::Ordering::Less => low = mid + 1,
+                std::cmp::Ordering::Greater => high = mid,
+                std::cmp::Ordering::Equal => return Some(entry),
+            }
+        }
+        None
+    }
+}
+
+/// How the control flow continues after an instruction.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+enum Flow {
+    /// The word does not start a valid instruction.
+    #[default]
+    Invalid,
+    /// Continues to the next instruction.
+    Next,
+    /// Continues to the next instruction or the target (Bcc, DBcc).
+    Branch,
+    /// Calls the target then continues to the next instruction (BSR, JSR).
+    Call,
+    /// Continues to the target (BRA, JMP).
+    Jump,
+    /// Does not continue to a known address (RTS, RTE, RTR, ILLEGAL, indirect JMP).
+    End,
+}
+
+/// The instruction decoded at a word of the image.
+#[derive(Clone, Copy, Debug, Default)]
+struct Slot {
+    flow: Flow,
+    /// Length of the instruction in bytes.
+    len: u8,
+    /// The static target of the instruction, if it is even and inside the image.
+    target: Option<u32>,
+}
+
+/// The image as memory, read-only. Reads outside of it return 0 so the decoder does not fail.
+#[derive(Clone, Copy)]
+struct Image<'a> {
+    data: &'a [u8],
+    base: u32,
+}
+
+impl Image<'_> {
+    /// Returns true if `addr` is a word inside the image.
+    fn contains_word(&self, addr: u32) -> bool {
+        addr & 1 == 0 && addr.wrapping_sub(self.base) < self.data.len() as u32 & !1
+    }
+
+    /// Decodes the instruction at the given address.
+    fn decode(mut self, addr: u32) -> Slot {
+        let mut iter = self.iter_u16(addr);
+        let Ok(instruction) = Instruction::from_memory(&mut iter) else {
+            return Slot::default();
+        };
+        let next = iter.next_addr;
+        let isa = Isa::from(instruction.opcode);
+        if isa == Isa::Unknown || next.wrapping_sub(self.base) > self.data.len() as u32 {
+            return Slot::default();
+        }
+
+        let pc = addr.wrapping_add(2);
+        let (flow, target) = match (isa, instruction.operands) {
+            (Isa::Bcc, Operands::ConditionDisplacement(_, disp)) => (Flow::Branch, Some(pc.wrapping_add(disp as u32))),
+            (Isa::Dbcc, Operands::ConditionRegisterDisplacement(_, _, disp)) => (Flow::Branch, Some(pc.wrapping_add(disp as u32))),
+            (Isa::Bra, Operands::Displacement(disp)) => (Flow::Jump, Some(pc.wrapping_add(disp as u32))),
+            (Isa::Bsr, Operands::Displacement(disp)) => (Flow::Call, Some(pc.wrapping_add(disp as u32))),
+            (Isa::Jmp, Operands::EffectiveAddress(am)) => match static_target(am) {
+                Some(target) => (Flow::Jump, Some(target)),
+                None => (Flow::End, None),
+            },
+            (Isa::Jsr, Operands::EffectiveAddress(am)) => (Flow::Call, static_target(am)),
+            (Isa::Rts | Isa::Rte | Isa::Rtr | Isa::Illegal, _) => (Flow::End, None),
+            _ => (Flow::Next, None),
+        };
+
+        Slot {
+            flow,
+            len: next.wrapping_sub(addr) as u8,
+            target: target.filter(|&target| self.contains_word(target)),
+        }
+    }
+}
+
+impl MemoryAccess for Image<'_> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        let offset = addr.wrapping_sub(self.base) as usize;
+        Some(self.data.get(offset).copied().unwrap_or(0))
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        Some((self.get_byte(addr)? as u16) << 8 | self.get_byte(addr.wrapping_add(1))? as u16)
+    }
+
+    fn set_byte(&mut self, _: u32, _: u8) -> Option<()> {
+        None
+    }
+
+    fn set_word(&mut self, _: u32, _: u16) -> Option<()> {
+        None
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+/// Returns the address of a JMP or JSR effective address known without executing the code.
+fn static_target(am: AddressingMode) -> Option<u32> {
+    match am {
+        AddressingMode::AbsShort(addr) => Some(addr as i16 as u32),
+        AddressingMode::AbsLong(addr) => Some(addr),
+        AddressingMode::Pciwd(pc, disp) => Some(pc.wrapping_add(disp as u32)),
+        _ => None,
+    }
+}
+
+/// Returns the initial PC and the exception handlers of the vector table at the beginning of the image,
+/// keeping the addresses that are even, inside the image and after the vector table.
+///
+/// Use it for images that start at address 0 with the vector table, like most 68000 ROMs.
+pub fn vector_table_entries(image: &[u8], base: u32) -> Vec<u32> {
+    let image = Image { data: image, base };
+    let mut entries: Vec<u32> = image.data.chunks_exact(4)
+        .take(256)
+        .skip(1) // The initial SSP.
+        .map(|vector| u32::from_be_bytes(vector.try_into().unwrap()))
+        .filter(|&addr| image.contains_word(addr) && addr.wrapping_sub(base) >= VECTOR_TABLE_LEN)
+        .collect();
+    entries.sort_unstable();
+    entries.dedup();
+    entries
+}
+
+/// Disassembles whole images on several threads.
+#[derive(Clone, Copy, Debug)]
+pub struct ImageDisassembler {
+    threads: usize,
+}
+
+impl ImageDisassembler {
+    /// Creates a new disassembler that decodes the images on the given number of threads.
+    ///
+    /// If `threads` is 0, the number of threads is the available parallelism of the host.
+    pub fn new(threads: usize) -> Self {
+        let threads = if threads == 0 {
+            std::thread::available_parallelism().map_or(1, NonZeroUsize::get)
+        } else {
+            threads
+        };
+
+        Self { threads }
+    }
+
+    /// Returns the number of threads used to decode the images.
+    pub fn threads(&self) -> usize {
+        self.threads
+    }
+
+    /// Returns the instructions reachable from the given entry points in the image located at address `base`.
+    ///
+    /// Entry points that are odd or outside of the image are ignored.
+    pub fn disassemble(&self, image: &[u8], base: u32, entry_points: &[u32]) -> CodeMap {
+        let image = Image { data: image, base };
+        let slots = self.decode(image);
+
+        // Flags of each word, non-zero when an instruction starts at it.
+        const CODE: u16 = 0x8000;
+        let mut flags = vec![0u16; slots.len()];
+        let mut worklist = Vec::new();
+        let index = |addr: u32| (addr.wrapping_sub(base) / 2) as usize;
+
+        for &addr in entry_points {
+            if image.contains_word(addr) {
+                flags[index(addr)] |= CodeEntry::ENTRY_POINT;
+                worklist.push(index(addr));
+            }
+        }
+
+        while let Some(mut i) = worklist.pop() {
+            while i < slots.len() && flags[i] & CODE == 0 && slots[i].flow != Flow::Invalid {
+                flags[i] |= CODE;
+                let slot = slots[i];
+
+                if let Some(target) = slot.target {
+                    let t = index(target);
+                    flags[t] |= if slot.flow == Flow::Call { CodeEntry::CALL_TARGET } else { CodeEntry::BRANCH_TARGET };
+                    if flags[t] & CODE == 0 {
+                        worklist.push(t);
+                    }
+                }
+
+                if matches!(slot.flow, Flow::Jump | Flow::End) {
+                    break;
+                }
+                i += slot.len as usize / 2;
+            }
+        }
+
+        let entries = flags.iter().enumerate()
+            .filter(|(_, &f)| f & CODE != 0)
+            .map(|(i, &f)| CodeEntry {
+                addr: base.wrapping_add(i as u32 * 2),
+                len: slots[i].len as u16,
+                flags: f & !CODE,
+            })
+            .collect();
+        CodeMap { entries }
+    }
+
+    /// Decodes an instruction at each word of the image, splitting it in one chunk per thread.
+    fn decode(&self, image: Image) -> Vec<Slot> {
+        let mut slots = vec![Slot::default(); image.data.len() / 2];
+        if slots.is_empty() {
+            return slots;
+        }
+
+        let chunk_len = slots.len().div_ceil(self.threads);
+        std::thread::scope(|scope| {
+            for (c, chunk) in slots.chunks_mut(chunk_len).enumerate() {
+                scope.spawn(move || {
+                    let first = image.base.wrapping_add((c * chunk_len * 2) as u32);
+                    for (i, slot) in chunk.iter_mut().enumerate() {
+                        *slot = image.decode(first.wrapping_add(i as u32 * 2));
+                    }
+                });
+            }
+        });
+        slots
+    }
+}
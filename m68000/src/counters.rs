@@ -0,0 +1,248 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Always-on performance counters.
+//!
+//! Each core counts the cycles and the instructions it executes, the exceptions it processes, the cycles it spends
+//! stopped and the calls it makes to the memory. Unlike the profiler of the `profiler` feature, the counters cannot be
+//! disabled: they are a few additions per instruction, cheap enough to be scraped from a running emulator with
+//! [M68000::counters] without slowing it down.
+//!
+//! - [Counters::cycles] are the cycles of the instructions, of the exceptions processing and the wait states, and
+//!   those of the idle loop iterations skipped by the [idle loop detection](crate::idle).
+//! - [Counters::stopped_cycles] are the cycles that passed while the core was stopped by a STOP instruction, in
+//!   [M68000::cycle], [M68000::run_scheduler] and the [multi-core runner](crate::multi_cpu).
+//! - [Counters::memory] are the calls made to the [MemoryAccess] methods of the memory given to the interpreters while
+//!   executing instructions and processing exceptions. The accesses served by the [memory map](crate::memory_map) or
+//!   the [prefetch window](crate::prefetch) do not call the memory and are not counted, while filling the prefetch
+//!   window is counted as one block read. The calls made by the public memory methods of the core, like
+//!   [M68000::get_next_word], are not counted.
+//!
+//! ```
+//! use m68000::M68000;
+//! use m68000::cpu_details::Mc68000;
+//!
+//! let mut memory = [0x4E71u16; 0x100]; // NOPs.
+//! let mut cpu = M68000::<Mc68000>::new_no_reset();
+//! cpu.cycle(&mut memory[..], 40);
+//!
+//! let counters = cpu.counters();
+//! assert_eq!((counters.instructions, counters.cycles), (10, 40));
+//! assert_eq!(counters.memory.word_reads, 10);
+//!
+//! cpu.reset_counters();
+//! assert_eq!(cpu.counters().instructions, 0);
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+use crate::interpreter::InterpreterResult;
+
+/// The number of exception counters, indexed by vector number. [Vector::UserInterrupt] is the last vector number used.
+pub const EXCEPTION_COUNTERS: usize = 65;
+
+const _: () = assert!(EXCEPTION_COUNTERS == Vector::UserInterrupt as usize + 1);
+
+/// The number of calls to each [MemoryAccess] method.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+#[cfg_attr(feature = "ffi", repr(C))]
+pub struct MemoryCounters {
+    /// Calls to [MemoryAccess::get_byte].
+    pub byte_reads: u64,
+    /// Calls to [MemoryAccess::get_word].
+    pub word_reads: u64,
+    /// Calls to [MemoryAccess::get_long].
+    pub long_reads: u64,
+    /// Calls to [MemoryAccess::get_block].
+    pub block_reads: u64,
+    /// Calls to [MemoryAccess::set_byte].
+    pub byte_writes: u64,
+    /// Calls to [MemoryAccess::set_word].
+    pub word_writes: u64,
+    /// Calls to [MemoryAccess::set_long].
+    pub long_writes: u64,
+    /// Calls to [MemoryAccess::set_block].
+    pub block_writes: u64,
+}
+
+/// The performance counters of a core.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+#[cfg_attr(feature = "ffi", repr(C))]
+pub struct Counters {
+    /// The number of cycles executed.
+    pub cycles: u64,
+    /// The number of instructions executed, including the ones that raised an exception.
+    pub instructions: u64,
+    /// The number of cycles spent stopped by a STOP instruction.
+    pub stopped_cycles: u64,
+    /// The number of times each exception has been processed, indexed by vector number.
+    ///
+    /// Only the vector numbers of [Vector] are counted, so the counters stay small in each core.
+    pub exceptions: [u64; EXCEPTION_COUNTERS],
+    /// The memory calls.
+    pub memory: MemoryCounters,
+}
+
+impl Counters {
+    /// Creates new counters set to 0.
+    pub const fn new() -> Self {
+        Self {
+            cycles: 0,
+            instructions: 0,
+            stopped_cycles: 0,
+            exceptions: [0; EXCEPTION_COUNTERS],
+            memory: MemoryCounters {
+                byte_reads: 0,
+                word_reads: 0,
+                long_reads: 0,
+                block_reads: 0,
+                byte_writes: 0,
+                word_writes: 0,
+                long_writes: 0,
+                block_writes: 0,
+            },
+        }
+    }
+
+    /// Returns the number of exceptions processed.
+    pub fn total_exceptions(&self) -> u64 {
+        self.exceptions.iter().sum()
+    }
+}
+
+impl Default for Counters {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Returns the performance counters.
+    pub const fn counters(&self) -> &Counters {
+        &self.counters
+    }
+
+    /// Sets all the performance counters to 0.
+    pub fn reset_counters(&mut self) {
+        self.counters = Counters::new();
+    }
+
+    /// Counts the given executed instruction.
+    #[inline(always)]
+    pub(super) fn count_instruction(&mut self, result: &InterpreterResult) {
+        self.counters.instructions += 1;
+        self.counters.cycles += *result.as_ref().unwrap_or(&0) as u64;
+    }
+
+    /// Counts the given processed exception.
+    #[inline(always)]
+    pub(super) fn count_exception(&mut self, vector: Vector) {
+        self.counters.exceptions[vector as usize] += 1;
+    }
+
+    /// Counts the cycles remaining until `cycles` as stopped and returns `cycles`, when [M68000::cycle] stops at `total`.
+    #[inline(always)]
+    pub(super) fn count_stopped(&mut self, total: usize, cycles: usize) -> usize {
+        self.counters.stopped_cycles += cycles.saturating_sub(total) as u64;
+        cycles
+    }
+
+    /// Returns and counts the wait cycles of the memory.
+    #[inline(always)]
+    pub(super) fn take_wait_cycles<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> usize {
+        let cycles = memory.take_wait_cycles();
+        self.counters.cycles += cycles as u64;
+        cycles
+    }
+
+    /// Runs the given function with the memory wrapped in a [CountedMemory], counting the calls made to it.
+    ///
+    /// The memory counters are copied into the wrapper and back instead of being added, so a wrapper nested in a
+    /// [CoreMemory](crate::memory_access::CoreMemory) or in another [CountedMemory] does not count the same calls twice: the outer wrapper overwrites
+    /// what the inner one counted when it is done.
+    #[inline(always)]
+    pub(super) fn with_counted_memory<M: MemoryAccess + ?Sized, R>(&mut self, memory: &mut M, f: impl FnOnce(&mut Self, &mut CountedMemory<M>) -> R) -> R {
+        let mut counted = CountedMemory::new(memory, self.counters.memory);
+        let res = f(self, &mut counted);
+        self.counters.memory = counted.counters;
+        res
+    }
+}
+
+/// Memory wrapper counting the calls forwarded to the application's memory.
+///
+/// Used directly by the interpreters when the core memory is not needed, and by [CoreMemory](crate::memory_access::CoreMemory) for the accesses that are
+/// not served by the memory map or the prefetch window.
+pub(crate) struct CountedMemory<'a, M: MemoryAccess + ?Sized> {
+    pub memory: &'a mut M,
+    pub counters: MemoryCounters,
+}
+
+impl<'a, M: MemoryAccess + ?Sized> CountedMemory<'a, M> {
+    #[inline(always)]
+    pub(crate) fn new(memory: &'a mut M, counters: MemoryCounters) -> Self {
+        Self { memory, counters }
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> MemoryAccess for CountedMemory<'_, M> {
+    #[inline(always)]
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.counters.byte_reads += 1;
+        self.memory.get_byte(addr)
+    }
+
+    #[inline(always)]
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.counters.word_reads += 1;
+        self.memory.get_word(addr)
+    }
+
+    #[inline(always)]
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        self.counters.long_reads += 1;
+        self.memory.get_long(addr)
+    }
+
+    #[inline(always)]
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.counters.byte_writes += 1;
+        self.memory.set_byte(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.counters.word_writes += 1;
+        self.memory.set_word(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        self.counters.long_writes += 1;
+        self.memory.set_long(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        self.counters.block_reads += 1;
+        self.memory.get_block(addr, data)
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        self.counters.block_writes += 1;
+        self.memory.set_block(addr, data)
+    }
+
+    fn prefetched_word(&self, addr: u32) -> Option<u16> {
+        self.memory.prefetched_word(addr)
+    }
+
+    fn reset_instruction(&mut self) {
+        self.memory.reset_instruction()
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        self.memory.take_wait_cycles()
+    }
+}
@@ -30,6 +30,8 @@ pub enum StackFormat {
 /// - `STACK_FORMAT` is the stack format to use.
 /// - `VECTOR_RESET` is the time the CPU takes to reset itself (RESET vector 0).
 /// - [`vector_execution_time`](CpuDetails::vector_execution_time) returns the time it takes to process the given exception vector.
+/// - [`divs_execution_time`](CpuDetails::divs_execution_time) and [`divu_execution_time`](CpuDetails::divu_execution_time)
+///   return the data-dependent execution time of DIVS and DIVU. By default they return `DIVS` and `DIVU`.
 /// - `EA_*` is the calculation time of each addressing mode for the byte and word sizes.
 ///   For long size m68000 automatically adds 4 to these values.
 ///
@@ -212,6 +214,20 @@ pub trait CpuDetails : Default {
 
     const DIVU: usize;
 
+    /// Returns the execution time of DIVS for the given operands, without the effective address calculation time.
+    ///
+    /// The default implementation returns `DIVS`, which is then the maximum execution time.
+    fn divs_execution_time(_dividend: u32, _divisor: u16) -> usize {
+        Self::DIVS
+    }
+
+    /// Returns the execution time of DIVU for the given operands, without the effective address calculation time.
+    ///
+    /// The default implementation returns `DIVU`, which is then the maximum execution time.
+    fn divu_execution_time(_dividend: u32, _divisor: u16) -> usize {
+        Self::DIVU
+    }
+
     const EOR_REG_BW: usize;
     const EOR_REG_L: usize;
     const EOR_MEM_BW: usize;
@@ -146,6 +146,58 @@ impl CpuDetails for Mc68000 {
     const DIVS: usize = 158;
     const DIVU: usize = 140;
 
+    /// From Jorge Cwik's measurements. The algorithm adds one microcycle (2 clock cycles) for each 0 in the 15 most
+    /// significant bits of the absolute quotient.
+    fn divs_execution_time(dividend: u32, divisor: u16) -> usize {
+        let (dividend, divisor) = (dividend as i32, divisor as i16);
+        let mut mcycles = if dividend < 0 { 7 } else { 6 };
+
+        let (abs_dividend, abs_divisor) = (dividend.unsigned_abs(), divisor.unsigned_abs() as u32);
+        if abs_dividend >> 16 >= abs_divisor {
+            return (mcycles + 2) * 2; // Absolute overflow.
+        }
+
+        mcycles += 55;
+        if divisor >= 0 {
+            if dividend >= 0 {
+                mcycles -= 1;
+            } else {
+                mcycles += 1;
+            }
+        }
+
+        let quot = abs_dividend / abs_divisor;
+        mcycles += 15 - (quot & 0xFFFE).count_ones() as usize;
+        mcycles * 2
+    }
+
+    /// From Jorge Cwik's measurements. Each of the 15 most significant quotient bits takes 2 microcycles when 0, 1 when
+    /// 1, and 0 when the partial remainder overflows 16 bits, which can only happen when the divisor is greater than
+    /// 0x8000. The partial remainders are computed from the quotient instead of stepping through the division.
+    fn divu_execution_time(dividend: u32, divisor: u16) -> usize {
+        let divisor = divisor as u32;
+        if dividend >> 16 >= divisor {
+            return 10; // Overflow.
+        }
+
+        let quot = dividend / divisor;
+        let mut ones = quot & 0xFFFE;
+        let zeros = 15 - ones.count_ones() as usize;
+        let mut carries = 0;
+        if divisor > 0x8000 {
+            while ones != 0 {
+                let shift = ones.trailing_zeros() + 1;
+                let rem = (dividend >> shift) - divisor * (quot >> shift);
+                if rem >= 0x8000 {
+                    carries += 1;
+                }
+                ones &= ones - 1;
+            }
+        }
+
+        (53 + zeros - carries) * 2
+    }
+
     const EOR_REG_BW: usize = 4;
     const EOR_REG_L: usize = 8;
     const EOR_MEM_BW: usize = 8;
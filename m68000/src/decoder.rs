@@ -3,6 +3,10 @@
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 //! Instruction decoding module.
+//!
+//! Two layouts of the decoding table are available: the flat [DECODER] table with one entry per opcode (64 KiB), and
+//! the compact two-level table [DECODER_BLOCK_INDEX] and [DECODER_BLOCKS] (about 6 KiB), which shares the identical
+//! blocks of 64 opcodes. [decode] uses the layout selected when generating this file.
 
 use crate::isa::{Isa, Isa::*};
 
@@ -4114,3 +4118,562 @@ pub const DECODER: [Isa; 65536] = [
     Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
     Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
 ];
+
+/// Number of opcodes in each block of [DECODER_BLOCKS].
+pub const DECODER_BLOCK_SIZE: usize = 64;
+
+/// Index in [DECODER_BLOCKS] of the block of each group of [DECODER_BLOCK_SIZE] opcodes.
+///
+/// Use `opcode / DECODER_BLOCK_SIZE` as the index in the array.
+pub const DECODER_BLOCK_INDEX: [u8; 1024] = [
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10,  3,  4,  5,  6,  7,
+    11, 11, 11,  3,  4,  5,  6,  7, 12, 12, 12,  3,  4,  5,  6,  7,
+    13, 14, 15, 16,  4,  5,  6,  7, 17, 18, 19,  3,  4,  5,  6,  7,
+    20, 20, 20,  3,  4,  5,  6,  7,  3,  3,  3,  3,  4,  5,  6,  7,
+    21,  3, 21, 21, 21, 21, 21, 21, 21,  3, 21, 21, 21, 21, 21, 21,
+    21,  3, 21, 21, 21, 21, 21,  3, 21,  3, 21, 21, 21, 21, 21,  3,
+    21,  3, 21, 21, 21, 21, 21,  3, 21,  3, 21, 21, 21, 21, 21,  3,
+    21,  3, 21, 21, 21, 21, 21,  3, 21,  3, 21, 21, 21, 21, 21,  3,
+    22, 23, 22, 22, 22, 22, 22, 22, 22, 23, 22, 22, 22, 22, 22, 22,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    22, 23, 22, 22, 22, 22, 22, 22, 22, 23, 22, 22, 22, 22, 22, 22,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    22, 23, 22, 22, 22, 22, 22,  3, 22, 23, 22, 22, 22, 22, 22,  3,
+    24, 24, 24, 25,  3,  3, 26, 27, 28, 28, 28,  3,  3,  3, 26, 27,
+    29, 29, 29, 30,  3,  3, 26, 27, 31, 31, 31, 32,  3,  3, 26, 27,
+    33, 34, 35, 35,  3,  3, 26, 27, 36, 36, 36, 37,  3,  3, 26, 27,
+     3,  3, 38, 38,  3,  3, 26, 27,  3, 39, 40, 41,  3,  3, 26, 27,
+    42, 43, 43, 44, 45, 46, 46, 44, 42, 43, 43, 44, 45, 46, 46, 44,
+    42, 43, 43, 44, 45, 46, 46, 44, 42, 43, 43, 44, 45, 46, 46, 44,
+    42, 43, 43, 44, 45, 46, 46, 44, 42, 43, 43, 44, 45, 46, 46, 44,
+    42, 43, 43, 44, 45, 46, 46, 44, 42, 43, 43, 44, 45, 46, 46, 44,
+    47, 47, 47, 47, 48, 48, 48, 48, 49, 49, 49, 49, 49, 49, 49, 49,
+    49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49,
+    49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49,
+    49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49, 49,
+    50, 50, 50, 50,  3,  3,  3,  3, 50, 50, 50, 50,  3,  3,  3,  3,
+    50, 50, 50, 50,  3,  3,  3,  3, 50, 50, 50, 50,  3,  3,  3,  3,
+    50, 50, 50, 50,  3,  3,  3,  3, 50, 50, 50, 50,  3,  3,  3,  3,
+    50, 50, 50, 50,  3,  3,  3,  3, 50, 50, 50, 50,  3,  3,  3,  3,
+    51, 51, 51, 52, 53, 54, 54, 55, 51, 51, 51, 52, 53, 54, 54, 55,
+    51, 51, 51, 52, 53, 54, 54, 55, 51, 51, 51, 52, 53, 54, 54, 55,
+    51, 51, 51, 52, 53, 54, 54, 55, 51, 51, 51, 52, 53, 54, 54, 55,
+    51, 51, 51, 52, 53, 54, 54, 55, 51, 51, 51, 52, 53, 54, 54, 55,
+    56, 57, 57, 58, 59, 59, 59, 58, 56, 57, 57, 58, 59, 59, 59, 58,
+    56, 57, 57, 58, 59, 59, 59, 58, 56, 57, 57, 58, 59, 59, 59, 58,
+    56, 57, 57, 58, 59, 59, 59, 58, 56, 57, 57, 58, 59, 59, 59, 58,
+    56, 57, 57, 58, 59, 59, 59, 58, 56, 57, 57, 58, 59, 59, 59, 58,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    60, 61, 61, 62, 63, 63, 63, 62, 60, 61, 61, 62, 63, 63, 63, 62,
+    60, 61, 61, 62, 63, 63, 63, 62, 60, 61, 61, 62, 63, 63, 63, 62,
+    60, 61, 61, 62, 63, 63, 63, 62, 60, 61, 61, 62, 63, 63, 63, 62,
+    60, 61, 61, 62, 63, 63, 63, 62, 60, 61, 61, 62, 63, 63, 63, 62,
+    64, 64, 64, 65, 66, 67, 68, 69, 64, 64, 64, 65, 66, 67, 68, 69,
+    64, 64, 64, 65, 66, 67, 68, 69, 64, 64, 64, 65, 66, 67, 68, 69,
+    64, 64, 64, 65, 66, 67, 68, 69, 64, 64, 64, 65, 66, 67, 68, 69,
+    64, 64, 64, 65, 66, 67, 68, 69, 64, 64, 64, 65, 66, 67, 68, 69,
+    70, 71, 71, 72, 73, 73, 73, 72, 70, 71, 71, 72, 73, 73, 73, 72,
+    70, 71, 71, 72, 73, 73, 73, 72, 70, 71, 71, 72, 73, 73, 73, 72,
+    70, 71, 71, 72, 73, 73, 73, 72, 70, 71, 71, 72, 73, 73, 73, 72,
+    70, 71, 71, 72, 73, 73, 73, 72, 70, 71, 71, 72, 73, 73, 73, 72,
+    74, 74, 74, 75, 74, 74, 74, 75, 74, 74, 74, 76, 74, 74, 74, 76,
+    74, 74, 74, 77, 74, 74, 74, 77, 74, 74, 74, 78, 74, 74, 74, 78,
+    74, 74, 74,  3, 74, 74, 74,  3, 74, 74, 74,  3, 74, 74, 74,  3,
+    74, 74, 74,  3, 74, 74, 74,  3, 74, 74, 74,  3, 74, 74, 74,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+];
+
+/// The distinct blocks of [DECODER_BLOCK_SIZE] opcodes of the decoding table.
+///
+/// Use `opcode % DECODER_BLOCK_SIZE` as the index in the block.
+pub const DECODER_BLOCKS: [[Isa; DECODER_BLOCK_SIZE]; 79] = [
+    [
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Oriccr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Orisr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori,
+        Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Ori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Movep, Movep, Movep, Movep, Movep, Movep, Movep, Movep,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Movep, Movep, Movep, Movep, Movep, Movep, Movep, Movep,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Movep, Movep, Movep, Movep, Movep, Movep, Movep, Movep,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Movep, Movep, Movep, Movep, Movep, Movep, Movep, Movep,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Andiccr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Andisr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi,
+        Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Andi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi,
+        Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi,
+        Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Subi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi,
+        Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi,
+        Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Addi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst,
+        Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Btst, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg,
+        Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Bchg, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr,
+        Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Bclr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset,
+        Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Bset, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Eoriccr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Eorisr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori,
+        Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Eori, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi,
+        Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi,
+        Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Cmpi, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Move, Move, Move, Move, Move, Move, Move, Move, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Unknown, Unknown, Unknown,
+    ],
+    [
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move,
+        Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Move, Unknown, Unknown, Unknown,
+    ],
+    [
+        Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea,
+        Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea,
+        Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea,
+        Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Movea, Unknown, Unknown, Unknown,
+    ],
+    [
+        Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx,
+        Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx,
+        Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Negx, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr,
+        Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr,
+        Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Movefsr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk,
+        Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk,
+        Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Chk, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea,
+        Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Lea, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr,
+        Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr,
+        Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Clr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg,
+        Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg,
+        Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Neg, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr,
+        Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr,
+        Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Moveccr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Not, Not, Not, Not, Not, Not, Not, Not, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not,
+        Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Not,
+        Not, Not, Not, Not, Not, Not, Not, Not, Not, Not, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr,
+        Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr,
+        Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Movesr, Unknown, Unknown, Unknown,
+    ],
+    [
+        Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd,
+        Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd,
+        Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Nbcd, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Swap, Swap, Swap, Swap, Swap, Swap, Swap, Swap, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea,
+        Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Pea, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Ext, Ext, Ext, Ext, Ext, Ext, Ext, Ext, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst,
+        Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst,
+        Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Tst, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas,
+        Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas,
+        Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Tas, Unknown, Unknown, Illegal, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem,
+        Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Movem, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap, Trap,
+        Link, Link, Link, Link, Link, Link, Link, Link, Unlk, Unlk, Unlk, Unlk, Unlk, Unlk, Unlk, Unlk,
+        Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp, Moveusp,
+        Reset, Nop, Stop, Rte, Unknown, Rts, Trapv, Rtr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr,
+        Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Jsr, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp,
+        Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Jmp, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq,
+        Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Addq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Dbcc, Dbcc, Dbcc, Dbcc, Dbcc, Dbcc, Dbcc, Dbcc,
+        Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc,
+        Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc,
+        Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Scc, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq,
+        Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Subq, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra,
+        Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra,
+        Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra,
+        Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra, Bra,
+    ],
+    [
+        Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr,
+        Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr,
+        Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr,
+        Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr, Bsr,
+    ],
+    [
+        Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc,
+        Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc,
+        Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc,
+        Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc, Bcc,
+    ],
+    [
+        Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq,
+        Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq,
+        Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq,
+        Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq, Moveq,
+    ],
+    [
+        Or, Or, Or, Or, Or, Or, Or, Or, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Unknown, Unknown, Unknown,
+    ],
+    [
+        Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu,
+        Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu,
+        Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Divu, Unknown, Unknown, Unknown,
+    ],
+    [
+        Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd, Sbcd,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Or,
+        Or, Or, Or, Or, Or, Or, Or, Or, Or, Or, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs,
+        Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs,
+        Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Divs, Unknown, Unknown, Unknown,
+    ],
+    [
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Unknown, Unknown, Unknown,
+    ],
+    [
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Unknown, Unknown, Unknown,
+    ],
+    [
+        Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba,
+        Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba,
+        Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba,
+        Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Suba, Unknown, Unknown, Unknown,
+    ],
+    [
+        Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx, Subx,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub,
+        Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Sub, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Unknown, Unknown, Unknown,
+    ],
+    [
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp,
+        Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Cmp, Unknown, Unknown, Unknown,
+    ],
+    [
+        Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa,
+        Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa,
+        Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa,
+        Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Cmpa, Unknown, Unknown, Unknown,
+    ],
+    [
+        Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Cmpm, Cmpm, Cmpm, Cmpm, Cmpm, Cmpm, Cmpm, Cmpm,
+        Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor,
+        Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor,
+        Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Eor, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        And, And, And, And, And, And, And, And, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, Unknown, Unknown, Unknown,
+    ],
+    [
+        Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu,
+        Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu,
+        Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Mulu, Unknown, Unknown, Unknown,
+    ],
+    [
+        Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd, Abcd,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Exg, Exg, Exg, Exg, Exg, Exg, Exg, Exg,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, And, And, And, And, And, And,
+        And, And, And, And, And, And, And, And, And, And, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls,
+        Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls,
+        Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Muls, Unknown, Unknown, Unknown,
+    ],
+    [
+        Add, Add, Add, Add, Add, Add, Add, Add, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Unknown, Unknown, Unknown,
+    ],
+    [
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Unknown, Unknown, Unknown,
+    ],
+    [
+        Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda,
+        Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda,
+        Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda,
+        Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Adda, Unknown, Unknown, Unknown,
+    ],
+    [
+        Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx, Addx,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Add,
+        Add, Add, Add, Add, Add, Add, Add, Add, Add, Add, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Asr, Asr, Asr, Asr, Asr, Asr, Asr, Asr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr,
+        Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Ror, Ror, Ror, Ror, Ror, Ror, Ror, Ror,
+        Asr, Asr, Asr, Asr, Asr, Asr, Asr, Asr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr, Lsr,
+        Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Roxr, Ror, Ror, Ror, Ror, Ror, Ror, Ror, Ror,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm,
+        Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm,
+        Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Asm, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm,
+        Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm,
+        Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Lsm, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm,
+        Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm,
+        Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Roxm, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+    [
+        Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+        Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom,
+        Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom,
+        Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Rom, Unknown, Unknown, Unknown, Unknown, Unknown, Unknown,
+    ],
+];
+
+/// Returns the Isa of the given opcode.
+#[inline(always)]
+pub const fn decode(opcode: u16) -> Isa {
+    DECODER_BLOCKS[DECODER_BLOCK_INDEX[opcode as usize / DECODER_BLOCK_SIZE] as usize][opcode as usize % DECODER_BLOCK_SIZE]
+}
@@ -9,514 +9,618 @@ use crate::isa::Isa;
 use crate::status_register::disassemble_conditional_test;
 use crate::utils::bits;
 
-pub fn disassemble_unknown_instruction(inst: &Instruction) -> String {
-    format!("Unknown instruction {:04X} at {:#X}", inst.opcode, inst.pc)
+use std::fmt::{self, Write};
+
+pub fn write_unknown_instruction(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
+    write!(f, "Unknown instruction {:04X} at {:#X}", inst.opcode, inst.pc)
 }
 
-pub fn disassemble_abcd(inst: &Instruction) -> String {
+pub fn write_abcd(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rx, _, mode, ry) = inst.operands.register_size_mode_register();
     if mode == Direction::MemoryToMemory {
-        format!("ABCD -(A{}), -(A{})", ry, rx)
+        write!(f, "ABCD -(A{}), -(A{})", ry, rx)
     } else {
-        format!("ABCD D{}, D{}", ry, rx)
+        write!(f, "ABCD D{}, D{}", ry, rx)
     }
 }
 
-pub fn disassemble_add(inst: &Instruction) -> String {
+pub fn write_add(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, d, s, am) = inst.operands.register_direction_size_effective_address();
     if d == Direction::DstEa {
-        format!("ADD.{} D{}, {}", s, r, am)
+        write!(f, "ADD.{} D{}, {}", s, r, am)
     } else {
-        format!("ADD.{} {}, D{}", s, am, r)
+        write!(f, "ADD.{} {}, D{}", s, am, r)
     }
 }
 
-pub fn disassemble_adda(inst: &Instruction) -> String {
+pub fn write_adda(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, s, am) = inst.operands.register_size_effective_address();
-    format!("ADDA.{} {}, A{}", s, am, r)
+    write!(f, "ADDA.{} {}, A{}", s, am, r)
 }
 
-pub fn disassemble_addi(inst: &Instruction) -> String {
+pub fn write_addi(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("ADDI.{} #{}, {}", s, imm, am)
+    write!(f, "ADDI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_addq(inst: &Instruction) -> String {
+pub fn write_addq(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, s, am) = inst.operands.data_size_effective_address();
     let d = if d == 0 { 8 } else { d };
-    format!("ADDQ.{} #{}, {}", s, d, am)
+    write!(f, "ADDQ.{} #{}, {}", s, d, am)
 }
 
-pub fn disassemble_addx(inst: &Instruction) -> String {
+pub fn write_addx(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rx, s, mode, ry) = inst.operands.register_size_mode_register();
     if mode == Direction::MemoryToMemory {
-        format!("ADDX.{} -(A{}), -(A{})", s, ry, rx)
+        write!(f, "ADDX.{} -(A{}), -(A{})", s, ry, rx)
     } else {
-        format!("ADDX.{} D{}, D{}", s, ry, rx)
+        write!(f, "ADDX.{} D{}, D{}", s, ry, rx)
     }
 }
 
-pub fn disassemble_and(inst: &Instruction) -> String {
+pub fn write_and(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, d, s, am) = inst.operands.register_direction_size_effective_address();
     if d == Direction::DstEa {
-        format!("AND.{} D{}, {}", s, r, am)
+        write!(f, "AND.{} D{}, {}", s, r, am)
     } else {
-        format!("AND.{} {}, D{}", s, am, r)
+        write!(f, "AND.{} {}, D{}", s, am, r)
     }
 }
 
-pub fn disassemble_andi(inst: &Instruction) -> String {
+pub fn write_andi(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("ANDI.{} #{}, {}", s, imm, am)
+    write!(f, "ANDI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_andiccr(inst: &Instruction) -> String {
+pub fn write_andiccr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("ANDI {:#X}, CCR", imm)
+    write!(f, "ANDI {:#X}, CCR", imm)
 }
 
-pub fn disassemble_andisr(inst: &Instruction) -> String {
+pub fn write_andisr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("ANDI {:#X}, SR", imm)
+    write!(f, "ANDI {:#X}, SR", imm)
 }
 
-pub fn disassemble_asm(inst: &Instruction) -> String {
+pub fn write_asm(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, am) = inst.operands.direction_effective_address();
-    format!("AS{} {}", d, am)
+    write!(f, "AS{} {}", d, am)
 }
 
-pub fn disassemble_asr(inst: &Instruction) -> String {
+pub fn write_asr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rot, d, s, ir, reg) = inst.operands.rotation_direction_size_mode_register();
     if ir {
-        format!("AS{}.{} D{}, D{}", d, s, rot, reg)
+        write!(f, "AS{}.{} D{}, D{}", d, s, rot, reg)
     } else {
         let rot = if rot == 0 { 8 } else { rot };
-        format!("AS{}.{} #{}, D{}", d, s, rot, reg)
+        write!(f, "AS{}.{} #{}, D{}", d, s, rot, reg)
     }
 }
 
-pub fn disassemble_bcc(inst: &Instruction) -> String {
+pub fn write_bcc(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (cc, disp) = inst.operands.condition_displacement();
-    format!("B{} {} <{:#X}>", disassemble_conditional_test(cc), disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
+    write!(f, "B{} {} <{:#X}>", disassemble_conditional_test(cc), disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
 }
 
-pub fn disassemble_bchg(inst: &Instruction) -> String {
+pub fn write_bchg(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (am, count) = inst.operands.effective_address_count();
     if bits(inst.opcode, 8, 8) != 0 {
-        format!("BCHG D{}, {}", count, am)
+        write!(f, "BCHG D{}, {}", count, am)
     } else {
-        format!("BCHG #{}, {}", count, am)
+        write!(f, "BCHG #{}, {}", count, am)
     }
 }
 
-pub fn disassemble_bclr(inst: &Instruction) -> String {
+pub fn write_bclr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (am, count) = inst.operands.effective_address_count();
     if bits(inst.opcode, 8, 8) != 0 {
-        format!("BCLR D{}, {}", count, am)
+        write!(f, "BCLR D{}, {}", count, am)
     } else {
-        format!("BCLR #{}, {}", count, am)
+        write!(f, "BCLR #{}, {}", count, am)
     }
 }
 
-pub fn disassemble_bra(inst: &Instruction) -> String {
+pub fn write_bra(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let disp = inst.operands.displacement();
-    format!("BRA {} <{:#X}>", disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
+    write!(f, "BRA {} <{:#X}>", disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
 }
 
-pub fn disassemble_bset(inst: &Instruction) -> String {
+pub fn write_bset(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (am, count) = inst.operands.effective_address_count();
     if bits(inst.opcode, 8, 8) != 0 {
-        format!("BSET D{}, {}", count, am)
+        write!(f, "BSET D{}, {}", count, am)
     } else {
-        format!("BSET #{}, {}", count, am)
+        write!(f, "BSET #{}, {}", count, am)
     }
 }
 
-pub fn disassemble_bsr(inst: &Instruction) -> String {
+pub fn write_bsr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let disp = inst.operands.displacement();
-    format!("BSR {} <{:#X}>", disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
+    write!(f, "BSR {} <{:#X}>", disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
 }
 
-pub fn disassemble_btst(inst: &Instruction) -> String {
+pub fn write_btst(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (am, count) = inst.operands.effective_address_count();
     if bits(inst.opcode, 8, 8) != 0 {
-        format!("BTST D{}, {}", count, am)
+        write!(f, "BTST D{}, {}", count, am)
     } else {
-        format!("BTST #{}, {}", count, am)
+        write!(f, "BTST #{}, {}", count, am)
     }
 }
 
-pub fn disassemble_chk(inst: &Instruction) -> String {
+pub fn write_chk(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("CHK.W {}, D{}", am, r)
+    write!(f, "CHK.W {}, D{}", am, r)
 }
 
-pub fn disassemble_clr(inst: &Instruction) -> String {
+pub fn write_clr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am) = inst.operands.size_effective_address();
-    format!("CLR.{} {}", s, am)
+    write!(f, "CLR.{} {}", s, am)
 }
 
-pub fn disassemble_cmp(inst: &Instruction) -> String {
+pub fn write_cmp(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, _, s, am) = inst.operands.register_direction_size_effective_address();
-    format!("CMP.{} {}, D{}", s, am, r)
+    write!(f, "CMP.{} {}, D{}", s, am, r)
 }
 
-pub fn disassemble_cmpa(inst: &Instruction) -> String {
+pub fn write_cmpa(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, s, am) = inst.operands.register_size_effective_address();
-    format!("CMPA.{} {}, A{}", s, am, r)
+    write!(f, "CMPA.{} {}, A{}", s, am, r)
 }
 
-pub fn disassemble_cmpi(inst: &Instruction) -> String {
+pub fn write_cmpi(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("CMPI.{} #{}, {}", s, imm, am)
+    write!(f, "CMPI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_cmpm(inst: &Instruction) -> String {
+pub fn write_cmpm(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rx, s, ry) = inst.operands.register_size_register();
-    format!("CMPM.{} (A{})+, (A{})+", s, ry, rx)
+    write!(f, "CMPM.{} (A{})+, (A{})+", s, ry, rx)
 }
 
-pub fn disassemble_dbcc(inst: &Instruction) -> String {
+pub fn write_dbcc(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (cc, r, disp) = inst.operands.condition_register_displacement();
-    format!("DB{} D{}, {} <{:#X}>", disassemble_conditional_test(cc), r, disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
+    write!(f, "DB{} D{}, {} <{:#X}>", disassemble_conditional_test(cc), r, disp, inst.pc.wrapping_add(2).wrapping_add(disp as u32))
 }
 
-pub fn disassemble_divs(inst: &Instruction) -> String {
+pub fn write_divs(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("DIVS.W {}, D{}", am, r)
+    write!(f, "DIVS.W {}, D{}", am, r)
 }
 
-pub fn disassemble_divu(inst: &Instruction) -> String {
+pub fn write_divu(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("DIVU.W {}, D{}", am, r)
+    write!(f, "DIVU.W {}, D{}", am, r)
 }
 
-pub fn disassemble_eor(inst: &Instruction) -> String {
+pub fn write_eor(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, _, s, am) = inst.operands.register_direction_size_effective_address();
-    format!("EOR.{} D{}, {}", s, r, am)
+    write!(f, "EOR.{} D{}, {}", s, r, am)
 }
 
-pub fn disassemble_eori(inst: &Instruction) -> String {
+pub fn write_eori(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("EORI.{} #{}, {}", s, imm, am)
+    write!(f, "EORI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_eoriccr(inst: &Instruction) -> String {
+pub fn write_eoriccr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("EORI {:#X}, CCR", imm)
+    write!(f, "EORI {:#X}, CCR", imm)
 }
 
-pub fn disassemble_eorisr(inst: &Instruction) -> String {
+pub fn write_eorisr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("EORI {:#X}, SR", imm)
+    write!(f, "EORI {:#X}, SR", imm)
 }
 
-pub fn disassemble_exg(inst: &Instruction) -> String {
+pub fn write_exg(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rx, mode, ry) = inst.operands.register_opmode_register();
     if mode == Direction::ExchangeData {
-        format!("EXG D{}, D{}", rx, ry)
+        write!(f, "EXG D{}, D{}", rx, ry)
     } else if mode == Direction::ExchangeAddress {
-        format!("EXG A{}, A{}", rx, ry)
+        write!(f, "EXG A{}, A{}", rx, ry)
     } else {
-        format!("EXG D{}, A{}", rx, ry)
+        write!(f, "EXG D{}, A{}", rx, ry)
     }
 }
 
-pub fn disassemble_ext(inst: &Instruction) -> String {
+pub fn write_ext(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (mode, r) = inst.operands.opmode_register();
     if mode == 0b010 {
-        format!("EXT.W D{}", r)
+        write!(f, "EXT.W D{}", r)
     } else {
-        format!("EXT.L D{}", r)
+        write!(f, "EXT.L D{}", r)
     }
 }
 
-pub fn disassemble_illegal(_: &Instruction) -> String {
-    "ILLEGAL".to_string()
+pub fn write_illegal(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("ILLEGAL")
 }
 
-pub fn disassemble_jmp(inst: &Instruction) -> String {
+pub fn write_jmp(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("JMP {}", am)
+    write!(f, "JMP {}", am)
 }
 
-pub fn disassemble_jsr(inst: &Instruction) -> String {
+pub fn write_jsr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("JSR {}", am)
+    write!(f, "JSR {}", am)
 }
 
-pub fn disassemble_lea(inst: &Instruction) -> String {
+pub fn write_lea(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("LEA {}, A{}", am, r)
+    write!(f, "LEA {}, A{}", am, r)
 }
 
-pub fn disassemble_link(inst: &Instruction) -> String {
+pub fn write_link(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, disp) = inst.operands.register_displacement();
-    format!("LINK.W A{}, #{}", r, disp)
+    write!(f, "LINK.W A{}, #{}", r, disp)
 }
 
-pub fn disassemble_lsm(inst: &Instruction) -> String {
+pub fn write_lsm(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, am) = inst.operands.direction_effective_address();
-    format!("LS{} {}", d, am)
+    write!(f, "LS{} {}", d, am)
 }
 
-pub fn disassemble_lsr(inst: &Instruction) -> String {
+pub fn write_lsr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rot, d, s, ir, reg) = inst.operands.rotation_direction_size_mode_register();
     if ir {
-        format!("LS{}.{} D{}, D{}", d, s, rot, reg)
+        write!(f, "LS{}.{} D{}, D{}", d, s, rot, reg)
     } else {
         let rot = if rot == 0 { 8 } else { rot };
-        format!("LS{}.{} #{}, D{}", d, s, rot, reg)
+        write!(f, "LS{}.{} #{}, D{}", d, s, rot, reg)
     }
 }
 
-pub fn disassemble_move(inst: &Instruction) -> String {
+pub fn write_move(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, dst, src) = inst.operands.size_effective_address_effective_address();
-    format!("MOVE.{} {}, {}", s, src, dst)
+    write!(f, "MOVE.{} {}, {}", s, src, dst)
 }
 
-pub fn disassemble_movea(inst: &Instruction) -> String {
+pub fn write_movea(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, r, am) = inst.operands.size_register_effective_address();
-    format!("MOVEA.{} {:#X}, A{}", s, am, r)
+    write!(f, "MOVEA.{} {:#X}, A{}", s, am, r)
 }
 
-pub fn disassemble_moveccr(inst: &Instruction) -> String {
+pub fn write_moveccr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("MOVE {:#X}, CCR", am)
+    write!(f, "MOVE {:#X}, CCR", am)
 }
 
-pub fn disassemble_movefsr(inst: &Instruction) -> String {
+pub fn write_movefsr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("MOVE SR, {:#X}", am)
+    write!(f, "MOVE SR, {:#X}", am)
 }
 
-pub fn disassemble_movesr(inst: &Instruction) -> String {
+pub fn write_movesr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("MOVE {:#X}, SR", am)
+    write!(f, "MOVE {:#X}, SR", am)
 }
 
-pub fn disassemble_moveusp(inst: &Instruction) -> String {
+pub fn write_moveusp(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (dir, reg) = inst.operands.direction_register();
     if dir == Direction::UspToRegister {
-        format!("MOVE USP, A{}", reg)
+        write!(f, "MOVE USP, A{}", reg)
     } else {
-        format!("MOVE A{}, USP", reg)
+        write!(f, "MOVE A{}, USP", reg)
     }
 }
 
-pub fn disassemble_movem(inst: &Instruction) -> String {
+pub fn write_movem(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     // TODO: disassemble register list.
     let (d, s, am, list) = inst.operands.direction_size_effective_address_list();
     if d == Direction::MemoryToRegister {
-        format!("MOVEM.{} {}, {:#X}", s, am, list)
+        write!(f, "MOVEM.{} {}, {:#X}", s, am, list)
     } else {
-        format!("MOVEM.{} {:#X}, {}", s, list, am)
+        write!(f, "MOVEM.{} {:#X}, {}", s, list, am)
     }
 }
 
-pub fn disassemble_movep(inst: &Instruction) -> String {
+pub fn write_movep(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (dreg, d, s, areg, disp) = inst.operands.register_direction_size_register_displacement();
     if d == Direction::RegisterToMemory {
-        format!("MOVEP.{} D{}, ({}, A{})", s, dreg, disp, areg)
+        write!(f, "MOVEP.{} D{}, ({}, A{})", s, dreg, disp, areg)
     } else {
-        format!("MOVEP.{} ({}, A{}), D{}", s, disp, areg, dreg)
+        write!(f, "MOVEP.{} ({}, A{}), D{}", s, disp, areg, dreg)
     }
 }
 
-pub fn disassemble_moveq(inst: &Instruction) -> String {
+pub fn write_moveq(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, d) = inst.operands.register_data();
-    format!("MOVEQ.L #{}, D{}", d, r)
+    write!(f, "MOVEQ.L #{}, D{}", d, r)
 }
 
-pub fn disassemble_muls(inst: &Instruction) -> String {
+pub fn write_muls(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("MULS.W {}, D{}", am, r)
+    write!(f, "MULS.W {}, D{}", am, r)
 }
 
-pub fn disassemble_mulu(inst: &Instruction) -> String {
+pub fn write_mulu(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, am) = inst.operands.register_effective_address();
-    format!("MULU.W {}, D{}", am, r)
+    write!(f, "MULU.W {}, D{}", am, r)
 }
 
-pub fn disassemble_nbcd(inst: &Instruction) -> String {
+pub fn write_nbcd(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("NBCD {}", am)
+    write!(f, "NBCD {}", am)
 }
 
-pub fn disassemble_neg(inst: &Instruction) -> String {
+pub fn write_neg(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am) = inst.operands.size_effective_address();
-    format!("NEG.{} {}", s, am)
+    write!(f, "NEG.{} {}", s, am)
 }
 
-pub fn disassemble_negx(inst: &Instruction) -> String {
+pub fn write_negx(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am) = inst.operands.size_effective_address();
-    format!("NEGX.{} {}", s, am)
+    write!(f, "NEGX.{} {}", s, am)
 }
 
-pub fn disassemble_nop(_: &Instruction) -> String {
-    "NOP".to_string()
+pub fn write_nop(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("NOP")
 }
 
-pub fn disassemble_not(inst: &Instruction) -> String {
+pub fn write_not(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am) = inst.operands.size_effective_address();
-    format!("NOT.{} {}", s, am)
+    write!(f, "NOT.{} {}", s, am)
 }
 
-pub fn disassemble_or(inst: &Instruction) -> String {
+pub fn write_or(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, d, s, am) = inst.operands.register_direction_size_effective_address();
     if d == Direction::DstEa {
-        format!("OR.{} D{}, {}", s, r, am)
+        write!(f, "OR.{} D{}, {}", s, r, am)
     } else {
-        format!("OR.{} {}, D{}", s, am, r)
+        write!(f, "OR.{} {}, D{}", s, am, r)
     }
 }
 
-pub fn disassemble_ori(inst: &Instruction) -> String {
+pub fn write_ori(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("ORI.{} #{}, {}", s, imm, am)
+    write!(f, "ORI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_oriccr(inst: &Instruction) -> String {
+pub fn write_oriccr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("ORI {:#X}, CCR", imm)
+    write!(f, "ORI {:#X}, CCR", imm)
 }
 
-pub fn disassemble_orisr(inst: &Instruction) -> String {
+pub fn write_orisr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("ORI {:#X}, SR", imm)
+    write!(f, "ORI {:#X}, SR", imm)
 }
 
-pub fn disassemble_pea(inst: &Instruction) -> String {
+pub fn write_pea(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("PEA {}", am)
+    write!(f, "PEA {}", am)
 }
 
-pub fn disassemble_reset(_: &Instruction) -> String {
-    "RESET".to_owned()
+pub fn write_reset(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("RESET")
 }
 
-pub fn disassemble_rom(inst: &Instruction) -> String {
+pub fn write_rom(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, am) = inst.operands.direction_effective_address();
-    format!("RO{} {}", d, am)
+    write!(f, "RO{} {}", d, am)
 }
 
-pub fn disassemble_ror(inst: &Instruction) -> String {
+pub fn write_ror(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rot, d, s, ir, reg) = inst.operands.rotation_direction_size_mode_register();
     if ir {
-        format!("RO{}.{} D{}, D{}", d, s, rot, reg)
+        write!(f, "RO{}.{} D{}, D{}", d, s, rot, reg)
     } else {
         let rot = if rot == 0 { 8 } else { rot };
-        format!("RO{}.{} #{}, D{}", d, s, rot, reg)
+        write!(f, "RO{}.{} #{}, D{}", d, s, rot, reg)
     }
 }
 
-pub fn disassemble_roxm(inst: &Instruction) -> String {
+pub fn write_roxm(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, am) = inst.operands.direction_effective_address();
-    format!("ROX{} {}", d, am)
+    write!(f, "ROX{} {}", d, am)
 }
 
-pub fn disassemble_roxr(inst: &Instruction) -> String {
+pub fn write_roxr(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (rot, d, s, ir, reg) = inst.operands.rotation_direction_size_mode_register();
     if ir {
-        format!("ROX{}.{} D{}, D{}", d, s, rot, reg)
+        write!(f, "ROX{}.{} D{}, D{}", d, s, rot, reg)
     } else {
         let rot = if rot == 0 { 8 } else { rot };
-        format!("ROX{}.{} #{}, D{}", d, s, rot, reg)
+        write!(f, "ROX{}.{} #{}, D{}", d, s, rot, reg)
     }
 }
 
-pub fn disassemble_rte(_: &Instruction) -> String {
-    "RTE".to_string()
+pub fn write_rte(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("RTE")
 }
 
-pub fn disassemble_rtr(_: &Instruction) -> String {
-    "RTR".to_string()
+pub fn write_rtr(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("RTR")
 }
 
-pub fn disassemble_rts(_: &Instruction) -> String {
-    "RTS".to_string()
+pub fn write_rts(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("RTS")
 }
 
-pub fn disassemble_sbcd(inst: &Instruction) -> String {
+pub fn write_sbcd(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (ry, _, mode, rx) = inst.operands.register_size_mode_register();
     if mode == Direction::MemoryToMemory {
-        format!("SBCD -(A{}), -(A{})", rx, ry)
+        write!(f, "SBCD -(A{}), -(A{})", rx, ry)
     } else {
-        format!("SBCD D{}, D{}", rx, ry)
+        write!(f, "SBCD D{}, D{}", rx, ry)
     }
 }
 
-pub fn disassemble_scc(inst: &Instruction) -> String {
+pub fn write_scc(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (cc, am) = inst.operands.condition_effective_address();
-    format!("S{} {}", disassemble_conditional_test(cc), am)
+    write!(f, "S{} {}", disassemble_conditional_test(cc), am)
 }
 
-pub fn disassemble_stop(inst: &Instruction) -> String {
+pub fn write_stop(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let imm = inst.operands.immediate();
-    format!("STOP #{:#X}", imm)
+    write!(f, "STOP #{:#X}", imm)
 }
 
-pub fn disassemble_sub(inst: &Instruction) -> String {
+pub fn write_sub(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, d, s, am) = inst.operands.register_direction_size_effective_address();
     if d == Direction::DstEa {
-        format!("SUB.{} D{}, {}", s, r, am)
+        write!(f, "SUB.{} D{}, {}", s, r, am)
     } else {
-        format!("SUB.{} {}, D{}", s, am, r)
+        write!(f, "SUB.{} {}, D{}", s, am, r)
     }
 }
 
-pub fn disassemble_suba(inst: &Instruction) -> String {
+pub fn write_suba(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (r, s, am) = inst.operands.register_size_effective_address();
-    format!("SUBA.{} {}, A{}", s, am, r)
+    write!(f, "SUBA.{} {}, A{}", s, am, r)
 }
 
-pub fn disassemble_subi(inst: &Instruction) -> String {
+pub fn write_subi(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am, imm) = inst.operands.size_effective_address_immediate();
-    format!("SUBI.{} #{}, {}", s, imm, am)
+    write!(f, "SUBI.{} #{}, {}", s, imm, am)
 }
 
-pub fn disassemble_subq(inst: &Instruction) -> String {
+pub fn write_subq(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (d, s, am) = inst.operands.data_size_effective_address();
     let d = if d == 0 { 8 } else { d };
-    format!("SUBQ.{} #{}, {}", s, d, am)
+    write!(f, "SUBQ.{} #{}, {}", s, d, am)
 }
 
-pub fn disassemble_subx(inst: &Instruction) -> String {
+pub fn write_subx(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (ry, s, mode, rx) = inst.operands.register_size_mode_register();
     if mode == Direction::MemoryToMemory {
-        format!("SUBX.{} -(A{}), -(A{})", s, rx, ry)
+        write!(f, "SUBX.{} -(A{}), -(A{})", s, rx, ry)
     } else {
-        format!("SUBX.{} D{}, D{}", s, rx, ry)
+        write!(f, "SUBX.{} D{}, D{}", s, rx, ry)
     }
 }
 
-pub fn disassemble_swap(inst: &Instruction) -> String {
+pub fn write_swap(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let r = inst.operands.register();
-    format!("SWAP D{}", r)
+    write!(f, "SWAP D{}", r)
 }
 
-pub fn disassemble_tas(inst: &Instruction) -> String {
+pub fn write_tas(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let am = inst.operands.effective_address();
-    format!("TAS {}", am)
+    write!(f, "TAS {}", am)
 }
 
-pub fn disassemble_trap(inst: &Instruction) -> String {
+pub fn write_trap(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let v = inst.operands.vector();
-    format!("TRAP #{}", v)
+    write!(f, "TRAP #{}", v)
 }
 
-pub fn disassemble_trapv(_: &Instruction) -> String {
-    "TRAPV".to_string()
+pub fn write_trapv(f: &mut dyn Write, _: &Instruction) -> fmt::Result {
+    f.write_str("TRAPV")
 }
 
-pub fn disassemble_tst(inst: &Instruction) -> String {
+pub fn write_tst(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let (s, am) = inst.operands.size_effective_address();
-    format!("TST.{} {}", s, am)
+    write!(f, "TST.{} {}", s, am)
 }
 
-pub fn disassemble_unlk(inst: &Instruction) -> String {
+pub fn write_unlk(f: &mut dyn Write, inst: &Instruction) -> fmt::Result {
     let r = inst.operands.register();
-    format!("UNLK A{}", r)
+    write!(f, "UNLK A{}", r)
+}
+
+/// Generates the `disassemble_*` functions, which return the disassembled instruction in a new [String],
+/// from the `write_*` functions.
+macro_rules! string_disassemblers {
+    ($($name:ident => $write:ident,)*) => {
+        $(
+            pub fn $name(inst: &Instruction) -> String {
+                let mut s = String::new();
+                $write(&mut s, inst).unwrap();
+                s
+            }
+        )*
+    };
+}
+
+string_disassemblers! {
+    disassemble_unknown_instruction => write_unknown_instruction,
+    disassemble_abcd => write_abcd,
+    disassemble_add => write_add,
+    disassemble_adda => write_adda,
+    disassemble_addi => write_addi,
+    disassemble_addq => write_addq,
+    disassemble_addx => write_addx,
+    disassemble_and => write_and,
+    disassemble_andi => write_andi,
+    disassemble_andiccr => write_andiccr,
+    disassemble_andisr => write_andisr,
+    disassemble_asm => write_asm,
+    disassemble_asr => write_asr,
+    disassemble_bcc => write_bcc,
+    disassemble_bchg => write_bchg,
+    disassemble_bclr => write_bclr,
+    disassemble_bra => write_bra,
+    disassemble_bset => write_bset,
+    disassemble_bsr => write_bsr,
+    disassemble_btst => write_btst,
+    disassemble_chk => write_chk,
+    disassemble_clr => write_clr,
+    disassemble_cmp => write_cmp,
+    disassemble_cmpa => write_cmpa,
+    disassemble_cmpi => write_cmpi,
+    disassemble_cmpm => write_cmpm,
+    disassemble_dbcc => write_dbcc,
+    disassemble_divs => write_divs,
+    disassemble_divu => write_divu,
+    disassemble_eor => write_eor,
+    disassemble_eori => write_eori,
+    disassemble_eoriccr => write_eoriccr,
+    disassemble_eorisr => write_eorisr,
+    disassemble_exg => write_exg,
+    disassemble_ext => write_ext,
+    disassemble_illegal => write_illegal,
+    disassemble_jmp => write_jmp,
+    disassemble_jsr => write_jsr,
+    disassemble_lea => write_lea,
+    disassemble_link => write_link,
+    disassemble_lsm => write_lsm,
+    disassemble_lsr => write_lsr,
+    disassemble_move => write_move,
+    disassemble_movea => write_movea,
+    disassemble_moveccr => write_moveccr,
+    disassemble_movefsr => write_movefsr,
+    disassemble_movesr => write_movesr,
+    disassemble_moveusp => write_moveusp,
+    disassemble_movem => write_movem,
+    disassemble_movep => write_movep,
+    disassemble_moveq => write_moveq,
+    disassemble_muls => write_muls,
+    disassemble_mulu => write_mulu,
+    disassemble_nbcd => write_nbcd,
+    disassemble_neg => write_neg,
+    disassemble_negx => write_negx,
+    disassemble_nop => write_nop,
+    disassemble_not => write_not,
+    disassemble_or => write_or,
+    disassemble_ori => write_ori,
+    disassemble_oriccr => write_oriccr,
+    disassemble_orisr => write_orisr,
+    disassemble_pea => write_pea,
+    disassemble_reset => write_reset,
+    disassemble_rom => write_rom,
+    disassemble_ror => write_ror,
+    disassemble_roxm => write_roxm,
+    disassemble_roxr => write_roxr,
+    disassemble_rte => write_rte,
+    disassemble_rtr => write_rtr,
+    disassemble_rts => write_rts,
+    disassemble_sbcd => write_sbcd,
+    disassemble_scc => write_scc,
+    disassemble_stop => write_stop,
+    disassemble_sub => write_sub,
+    disassemble_suba => write_suba,
+    disassemble_subi => write_subi,
+    disassemble_subq => write_subq,
+    disassemble_subx => write_subx,
+    disassemble_swap => write_swap,
+    disassemble_tas => write_tas,
+    disassemble_trap => write_trap,
+    disassemble_trapv => write_trapv,
+    disassemble_tst => write_tst,
+    disassemble_unlk => write_unlk,
 }
 
 /// Disassembler function Look-Up Table.
@@ -623,3 +727,109 @@ pub const DLUT: [fn(&Instruction) -> String; Isa::_Size as usize] = [
     disassemble_tst,
     disassemble_unlk,
 ];
+
+/// Disassembler function Look-Up Table that writes the instruction in a [Write] instead of allocating a new [String].
+///
+/// # Usage
+///
+/// ```
+/// use m68000::decoder::DECODER;
+/// use m68000::disassembler::WLUT;
+/// use m68000::instruction::Instruction;
+/// use m68000::memory_access::MemoryAccess;
+///
+/// let mut data: Vec<u8> = Vec::new();
+/// data.resize(4, 0); // Load the binary in data.
+/// let mut iter = data.iter_u16(0);
+/// let inst = Instruction::from_memory(&mut iter).unwrap();
+/// let mut buffer = String::with_capacity(64); // Reuse the buffer for each instruction.
+/// WLUT[DECODER[inst.opcode as usize] as usize](&mut buffer, &inst).unwrap();
+/// println!("{:#X} {}", inst.pc, buffer);
+/// ```
+pub const WLUT: [fn(&mut dyn Write, &Instruction) -> fmt::Result; Isa::_Size as usize] = [
+    write_unknown_instruction,
+    write_abcd,
+    write_add,
+    write_adda,
+    write_addi,
+    write_addq,
+    write_addx,
+    write_and,
+    write_andi,
+    write_andiccr,
+    write_andisr,
+    write_asm,
+    write_asr,
+    write_bcc,
+    write_bchg,
+    write_bclr,
+    write_bra,
+    write_bset,
+    write_bsr,
+    write_btst,
+    write_chk,
+    write_clr,
+    write_cmp,
+    write_cmpa,
+    write_cmpi,
+    write_cmpm,
+    write_dbcc,
+    write_divs,
+    write_divu,
+    write_eor,
+    write_eori,
+    write_eoriccr,
+    write_eorisr,
+    write_exg,
+    write_ext,
+    write_illegal,
+    write_jmp,
+    write_jsr,
+    write_lea,
+    write_link,
+    write_lsm,
+    write_lsr,
+    write_move,
+    write_movea,
+    write_moveccr,
+    write_movefsr,
+    write_movesr,
+    write_moveusp,
+    write_movem,
+    write_movep,
+    write_moveq,
+    write_muls,
+    write_mulu,
+    write_nbcd,
+    write_neg,
+    write_negx,
+    write_nop,
+    write_not,
+    write_or,
+    write_ori,
+    write_oriccr,
+    write_orisr,
+    write_pea,
+    write_reset,
+    write_rom,
+    write_ror,
+    write_roxm,
+    write_roxr,
+    write_rte,
+    write_rtr,
+    write_rts,
+    write_sbcd,
+    write_scc,
+    write_stop,
+    write_sub,
+    write_suba,
+    write_subi,
+    write_subq,
+    write_subx,
+    write_swap,
+    write_tas,
+    write_trap,
+    write_trapv,
+    write_tst,
+    write_unlk,
+];
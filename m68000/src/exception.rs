@@ -8,7 +8,6 @@ use crate::{CpuDetails, M68000, MemoryAccess, StackFormat};
 use crate::interpreter::InterpreterResult;
 
 use std::cmp::Ordering;
-use std::collections::BTreeSet;
 
 /// Constant equal to the AccessError vector.
 pub const ACCESS_ERROR: u8 = Vector::AccessError as u8;
@@ -91,19 +90,7 @@ impl Vector {
     }
 
     const fn priority(self) -> u8 {
-        match self as u8 {
-            3 => 0, // Address error.
-            2 => 1, // Access Error.
-            9 => 2, // Trace.
-            24..=31 => 3, // Interrupt.
-            64..=255 => 3, // User Interrupt.
-            4 => 4, // Illegal.
-            8 => 5, // Privilege.
-            // Even though Reset has the highest priority, it is given a high number.
-            // The point is to make the reset vector be processed first,
-            // and the reset processing clears all the pending exceptions.
-            _ => u8::MAX, // Reset and the other vectors.
-        }
+        priority(self as u8)
     }
 
     /// If the vector is an interrupt, returns the interrupt priority level.
@@ -114,6 +101,24 @@ impl Vector {
     }
 }
 
+/// Returns the priority of the given vector number. Lower means higher priority.
+const fn priority(vector: u8) -> u8 {
+    match vector {
+        3 => 0, // Address error.
+        2 => 1, // Access Error.
+        9 => 2, // Trace.
+        24..=31 => 3, // Interrupt.
+        57..=63 => 3, // On-chip interrupt.
+        64..=255 => 3, // User Interrupt.
+        4 => 4, // Illegal.
+        8 => 5, // Privilege.
+        // Even though Reset has the highest priority, it is given a high number.
+        // The point is to make the reset vector be processed first,
+        // and the reset processing clears all the pending exceptions.
+        _ => u8::MAX, // Reset and the other vectors.
+    }
+}
+
 /// M68000 exception, with a vector number and a priority.
 ///
 /// This struct implements `From<u8>` and `From<Vector>`, to create an
@@ -146,7 +151,7 @@ impl PartialOrd for Exception {
 }
 
 impl Ord for Exception {
-    /// For BTreeSet, compare by actual priority and not by the value itself, so higher number means less priority.
+    /// Compare by actual priority and not by the value itself, so higher number means less priority.
     fn cmp(&self, other: &Self) -> Ordering {
         match self.priority.cmp(&other.priority) {
             Ordering::Greater => Ordering::Less,
@@ -156,16 +161,145 @@ impl Ord for Exception {
     }
 }
 
+/// Bits of the level 1 to 7 interrupts (auto-vector and on-chip) in the first word of [PendingExceptions].
+/// `levels` has one bit per level, bit 0 being unused.
+const fn level_interrupts(levels: u64) -> u64 {
+    levels << 24 | levels << 56
+}
+
+/// Returns the bitmask of the vectors that are in the given priority class.
+const fn priority_class(priority: u8) -> [u64; 4] {
+    let mut mask = [0; 4];
+    let mut i = 0;
+    while i < 256 {
+        if self::priority(i as u8) == priority {
+            mask[i >> 6] |= 1 << (i & 63);
+        }
+        i += 1;
+    }
+    mask
+}
+
+/// The vectors grouped by priority, from the lowest to the highest priority.
+const PRIORITY_CLASSES: [[u64; 4]; 7] = [
+    priority_class(u8::MAX),
+    priority_class(5),
+    priority_class(4),
+    priority_class(3),
+    priority_class(2),
+    priority_class(1),
+    priority_class(0),
+];
+
+/// The pending exceptions, stored as one bit per vector number.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub(crate) struct PendingExceptions([u64; 4]);
+
+impl PendingExceptions {
+    pub const fn new() -> Self {
+        Self([0; 4])
+    }
+
+    #[inline(always)]
+    pub const fn is_empty(&self) -> bool {
+        self.0[0] | self.0[1] | self.0[2] | self.0[3] == 0
+    }
+
+    #[inline(always)]
+    pub fn insert(&mut self, vector: Vector) {
+        self.0[vector as usize >> 6] |= 1 << (vector as u8 & 63);
+    }
+
+    #[inline(always)]
+    pub const fn contains(&self, vector: Vector) -> bool {
+        self.0[vector as usize >> 6] & 1 << (vector as u8 & 63) != 0
+    }
+
+    #[inline(always)]
+    pub fn clear(&mut self) {
+        self.0 = [0; 4];
+    }
+
+    /// Returns the raw bitmap, bit `n % 64` of word `n / 64` being set when vector `n` is pending.
+    pub const fn bits(&self) -> [u64; 4] {
+        self.0
+    }
+
+    /// Creates the pending exceptions from the raw bitmap returned by [Self::bits].
+    pub const fn from_bits(bits: [u64; 4]) -> Self {
+        Self(bits)
+    }
+
+    /// Removes and returns the exceptions that can be processed with the given interrupt priority mask.
+    ///
+    /// The interrupts lower or equal to the interrupt mask stay pending. Only the highest unmasked interrupt level
+    /// is taken, the lower ones stay pending and are masked once the taken one is processed.
+    fn take_processable(&mut self, interrupt_mask: u8) -> Self {
+        // MC68000UM 6.3.2 Level 7 interrupts cannot be inhibited by the interrupt priority mask.
+        let allowed_levels = 0xFEu64 << interrupt_mask & 0xFE | 0x80;
+        let mut set = self.0;
+        set[0] &= !level_interrupts(0xFE & !allowed_levels);
+
+        let levels = (set[0] >> 24 | set[0] >> 56) & 0xFE;
+        if levels != 0 {
+            let highest = 1 << (63 - levels.leading_zeros());
+            let taken = if set[0] & highest << 24 != 0 { highest << 24 } else { highest << 56 };
+            set[0] &= !level_interrupts(0xFE) | taken;
+        }
+
+        for (pending, taken) in self.0.iter_mut().zip(set) {
+            *pending &= !taken;
+        }
+        Self(set)
+    }
+
+    /// Returns an iterator over the vectors, from the lowest to the highest priority.
+    fn iter_by_priority(self) -> PriorityIter {
+        PriorityIter { set: self.0, class: 0 }
+    }
+}
+
+/// Iterator over the vectors of [PendingExceptions], from the lowest to the highest priority.
+struct PriorityIter {
+    set: [u64; 4],
+    class: usize,
+}
+
+impl Iterator for PriorityIter {
+    type Item = Vector;
+
+    fn next(&mut self) -> Option<Vector> {
+        while self.class < PRIORITY_CLASSES.len() {
+            let class = &PRIORITY_CLASSES[self.class];
+            for word in (0..4).rev() {
+                let bits = self.set[word] & class[word];
+                if bits != 0 {
+                    let bit = 63 - bits.leading_zeros();
+                    self.set[word] &= !(1 << bit);
+                    // SAFETY: only valid vectors are inserted in the set.
+                    return Some(unsafe { Vector::from_raw((word as u32 * 64 + bit) as u8) });
+                }
+            }
+            self.class += 1;
+        }
+
+        None
+    }
+}
+
 impl<CPU: CpuDetails> M68000<CPU> {
     /// Requests the CPU to process the given exception.
+    ///
+    /// Interrupts, Reset and Trace wake up the CPU after a STOP instruction, but not when it has been stopped by a
+    /// [hook](crate::hooks).
     pub fn exception(&mut self, ex: Exception) {
-        if ex.vector == Vector::ResetSspPc ||
-           ex.vector == Vector::Trace ||
-           ex.is_interrupt() {
+        if (ex.vector == Vector::ResetSspPc ||
+            ex.vector == Vector::Trace ||
+            ex.is_interrupt()) && self.hook_event().is_none() {
             self.stop = false;
         }
 
-        self.exceptions.insert(ex);
+        self.exceptions.insert(ex.vector);
     }
 
     /// Resets the CPU by fetching the reset vectors.
@@ -182,39 +316,37 @@ impl<CPU: CpuDetails> M68000<CPU> {
 
     /// Attempts to process all the pending exceptions
     pub(super) fn process_pending_exceptions<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> usize {
-        // Extract the exceptions to process and keep the masked interrupts.
-        let exceptions: BTreeSet<_> = self.exceptions.extract_if(|ex| {
-            if ex.is_interrupt() {
-                // If the interrupt is lower or equal to the interrupt mask, then it is not processed.
-                // MC68000UM 6.3.2 Level 7 interrupts cannot be inhibited by the interrupt priority mask.
-                let level = ex.vector.interrupt_level();
-                if level != 7 && level <= self.regs.sr.interrupt_mask {
-                    return false;
-                }
-            }
+        if self.exceptions.contains(Vector::ResetSspPc) {
+            self.exceptions.clear(); // The reset vector clears all the pending interrupts.
+            self.count_exception(Vector::ResetSspPc);
+            #[cfg(feature = "profiler")]
+            self.profile_exception(Vector::ResetSspPc);
+            let cycles = self.reset(memory);
+            self.counters.cycles += cycles as u64;
+            return cycles;
+        }
 
-            true
-        }).collect();
+        // Extract the exceptions to process and keep the masked interrupts.
+        let exceptions = self.exceptions.take_processable(self.regs.sr.interrupt_mask);
 
         let mut total = 0;
 
         // Iterates from the lowest priority to highest, so that when all exceptions have been processed,
         // the one with the highest priority will be the one treated first.
-        for exception in exceptions.iter() {
-            if exception.vector == Vector::ResetSspPc {
-                self.exceptions.clear(); // The reset vector clears all the pending interrupts.
-                return self.reset(memory);
-            }
+        for vector in exceptions.iter_by_priority() {
+            self.count_exception(vector);
+            #[cfg(feature = "profiler")]
+            self.profile_exception(vector);
 
-            total += match self.process_exception(memory, exception.vector) {
+            total += match self.process_exception(memory, vector) {
                 Ok(cycles) => cycles,
                 Err(e) => {
                     if e == Vector::AccessError {
-                        if exception.vector == Vector::AccessError {
+                        if vector == Vector::AccessError {
                             panic!("An access error occured during access error processing (at {:#X})", self.regs.pc);
                         }
 
-                        if exception.is_interrupt() {
+                        if vector.is_interrupt() {
                             self.exception(Exception::from(Vector::SpuriousInterrupt));
                         } else {
                             self.exception(Exception::from(e));
@@ -228,6 +360,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
             };
         }
 
+        self.counters.cycles += total as u64;
         total
     }
 
@@ -264,8 +397,11 @@ impl<CPU: CpuDetails> M68000<CPU> {
             },
             StackFormat::SCC68070 => {
                 if vector == Vector::AccessError || vector == Vector::AddressError { // TODO: Long format.
+                    // The next word of the instruction stream when it is in the prefetch window. It is not read from
+                    // the memory, so the current opcode is used as placeholder when the window is disabled.
+                    let irc = memory.prefetched_word(self.regs.pc.0).unwrap_or(self.current_opcode);
                     self.push_word(memory, 0)?; // Internal information
-                    self.push_word(memory, self.current_opcode)?; // IRC
+                    self.push_word(memory, irc)?; // IRC
                     self.push_word(memory, self.current_opcode)?; // IR
                     self.push_long(memory, 0)?; // DBIN
                     self.push_long(memory, 0)?; // TPF
@@ -0,0 +1,722 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Coverage-guided fuzzing and differential testing of the instruction semantics.
+//!
+//! A [Fuzzer] executes randomly generated [FuzzCase]s, which are an instruction and a register state. The instructions
+//! are built with the [assembler](crate::assembler) with random valid parameters, or are raw random words to also
+//! cover the invalid encodings. Each case executes one instruction on an `M68000<Mc68000>` and on an
+//! `M68000<Scc68070>`, then the exception it raised if any. The result of each core is summarized in a
+//! [FuzzOutcome], which digest is recorded in a [FuzzTrace].
+//!
+//! The cases are generated in rounds. Each round mutates the cases of the previous rounds that reached a new coverage
+//! bucket, which is the combination of the executed instruction, the exception it raised and the resulting condition
+//! codes. The cases only depend on the seed and on their index, so a run gives the same trace whatever the number of
+//! threads, and a trace recorded with a reference version of the core can be checked later with [Fuzzer::check].
+//!
+//! Each thread reuses its own cores and memory for all its cases. The memory writes of a case are logged and undone
+//! after it, so the memory is never copied.
+//!
+//! ```
+//! use m68000::fuzz::Fuzzer;
+//!
+//! let mut fuzzer = Fuzzer::new(0);
+//! let report = fuzzer.run(1, 4, 1000);
+//! assert!(report.divergences.is_empty());
+//!
+//! // Later, with a modified core.
+//! let report = fuzzer.check(&report.trace);
+//! assert!(report.mismatches.is_empty());
+//! ```
+
+use crate::{M68000, MemoryAccess, Registers};
+use crate::addressing_modes::{AddressingMode, BriefExtensionWord};
+use crate::assembler::{ConstAssembler, Condition};
+use crate::binary_trace::invalid_data;
+use crate::cpu_details::{CpuDetails, Mc68000, Scc68070};
+use crate::exception::{Exception, Vector};
+use crate::instruction::{Direction, Size};
+use crate::isa::Isa;
+
+use std::io::{self, Read, Write};
+use std::num::NonZeroUsize;
+
+/// Magic number at the start of a serialized fuzz trace.
+const MAGIC: [u8; 8] = *b"M68KFUZ1";
+/// Length of the header of a serialized fuzz trace: the magic number, the seed, the cases per round and the count.
+const HEADER_LEN: usize = 32;
+/// Length of the two digests of a case in a serialized fuzz trace.
+const RECORD_LEN: usize = 16;
+
+/// Number of words of a case, the longest MC68000 instruction.
+pub const CASE_WORDS: usize = 5;
+/// Length of the memory of the cases, starting at address 0. Accesses above raise an Access Error.
+pub const MEMORY_LEN: usize = 0x1_0000;
+/// Address where all the exception vectors point to, which contains a `STOP #0x2700`.
+pub const HANDLER: u32 = 0x400;
+/// Start of the area where the instructions are placed.
+pub const CODE: u32 = 0x1000;
+/// Start of the area where the address registers point to.
+pub const DATA: u32 = 0x2000;
+
+/// Number of coverage buckets: the ISA, the vector number and the CCR.
+const BUCKETS: usize = 1 << 19;
+
+/// A test case: the registers before the execution and the words at the Program Counter.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct FuzzCase {
+    pub regs: Registers,
+    /// The instruction and its extension words, followed by padding if it is shorter.
+    pub words: [u16; CASE_WORDS],
+}
+
+/// The result of the execution of a [FuzzCase] on a core.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct FuzzOutcome {
+    /// The registers after the execution.
+    pub regs: Registers,
+    /// The exception raised by the instruction, which handler has then been executed.
+    ///
+    /// An Access Error is not processed when the SSP is outside of the memory, which would halt a real CPU.
+    pub vector: Option<Vector>,
+    /// The CCR right after the instruction, before its exception is processed.
+    pub ccr: u8,
+    /// The cycles of the instruction and of its exception.
+    pub cycles: usize,
+    /// The digest of the memory writes, in the order they occured.
+    pub writes: u64,
+}
+
+impl FuzzOutcome {
+    /// Returns the digest of the whole outcome, as recorded in a [FuzzTrace].
+    pub fn digest(&self) -> u64 {
+        let mut hash = hash_regs(0, &self.regs);
+        hash = combine(hash, self.vector.map_or(0, |vector| vector as u64 + 1));
+        hash = combine(hash, self.ccr as u64);
+        hash = combine(hash, self.cycles as u64);
+        combine(hash, self.writes)
+    }
+
+    /// Returns true if both outcomes have the same architectural effects, ignoring the timing.
+    ///
+    /// The exceptions are not compared because the MC68000 and the SCC68070 use different stack frames.
+    fn same_effects(&self, other: &Self) -> bool {
+        self.regs == other.regs && self.writes == other.writes
+    }
+}
+
+/// The digests of the outcomes of all the cases of a run, `[MC68000, SCC68070]` for each case.
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct FuzzTrace {
+    pub seed: u64,
+    pub cases_per_round: usize,
+    pub digests: Vec<[u64; 2]>,
+}
+
+impl FuzzTrace {
+    /// Returns the number of rounds of the run.
+    pub fn rounds(&self) -> usize {
+        if self.cases_per_round == 0 {
+            0
+        } else {
+            self.digests.len() / self.cases_per_round
+        }
+    }
+
+    /// Serializes the trace.
+    pub fn write_to<W: Write + ?Sized>(&self, output: &mut W) -> io::Result<()> {
+        let mut data = Vec::with_capacity(HEADER_LEN + self.digests.len() * RECORD_LEN);
+        data.extend_from_slice(&MAGIC);
+        data.extend_from_slice(&self.seed.to_le_bytes());
+        data.extend_from_slice(&(self.cases_per_round as u64).to_le_bytes());
+        data.extend_from_slice(&(self.digests.len() as u64).to_le_bytes());
+        for digests in &self.digests {
+            data.extend_from_slice(&digests[0].to_le_bytes());
+            data.extend_from_slice(&digests[1].to_le_bytes());
+        }
+        output.write_all(&data)
+    }
+
+    /// Deserializes a trace written by [Self::write_to].
+    pub fn read_from<R: Read + ?Sized>(input: &mut R) -> io::Result<Self> {
+        let mut data = Vec::new();
+        input.read_to_end(&mut data)?;
+        if data.len() < HEADER_LEN || !data.starts_with(&MAGIC) {
+            return Err(invalid_data("not a m68000 fuzz trace"));
+        }
+
+        let u64_at = |offset: usize| u64::from_le_bytes(data[offset..offset + 8].try_into().unwrap());
+        let seed = u64_at(8);
+        let cases_per_round = u64_at(16) as usize;
+        let count = u64_at(24);
+        let records = &data[HEADER_LEN..];
+        if count.checked_mul(RECORD_LEN as u64) != Some(records.len() as u64) {
+            return Err(invalid_data("truncated fuzz trace"));
+        }
+
+        let digests = records.chunks_exact(RECORD_LEN).map(|record| {
+            let (mc68000, scc68070) = record.split_at(8);
+            [u64::from_le_bytes(mc68000.try_into().unwrap()), u64::from_le_bytes(scc68070.try_into().unwrap())]
+        }).collect();
+        Ok(Self { seed, cases_per_round, digests })
+    }
+}
+
+/// The result of [Fuzzer::run] or [Fuzzer::check].
+#[derive(Clone, Debug, Default)]
+pub struct FuzzReport {
+    pub trace: FuzzTrace,
+    /// The cases that reached a new coverage bucket, in the order they were found.
+    pub corpus: Vec<FuzzCase>,
+    /// The number of coverage buckets reached.
+    pub coverage: usize,
+    /// The cases which executed without exception on both cores but with different effects, with their index.
+    /// RTE is not compared.
+    pub divergences: Vec<(usize, FuzzCase)>,
+    /// The cases which digests differ from the reference trace given to [Fuzzer::check], with their index.
+    pub mismatches: Vec<(usize, FuzzCase)>,
+}
+
+/// Generates and executes test cases on several threads.
+pub struct Fuzzer {
+    workers: Vec<Worker>,
+}
+
+impl Fuzzer {
+    /// Creates a fuzzer with the given number of threads, each one with its own cores and memory.
+    ///
+    /// If `threads` is 0, the number of threads is the available parallelism of the host.
+    pub fn new(threads: usize) -> Self {
+        let threads = if threads == 0 {
+            std::thread::available_parallelism().map_or(1, NonZeroUsize::get)
+        } else {
+            threads
+        };
+
+        Self { workers: (0..threads).map(|_| Worker::new()).collect() }
+    }
+
+    /// Returns the number of threads used to execute the cases.
+    pub fn threads(&self) -> usize {
+        self.workers.len()
+    }
+
+    /// Executes `rounds` rounds of `cases_per_round` cases generated from the given seed.
+    pub fn run(&mut self, seed: u64, rounds: usize, cases_per_round: usize) -> FuzzReport {
+        self.run_inner(seed, rounds, cases_per_round, None)
+    }
+
+    /// Executes again the cases of the given trace, and reports the ones which outcomes are different.
+    pub fn check(&mut self, reference: &FuzzTrace) -> FuzzReport {
+        self.run_inner(reference.seed, reference.rounds(), reference.cases_per_round, Some(&reference.digests))
+    }
+
+    /// Executes a single case, returning its MC68000 and SCC68070 outcomes.
+    pub fn execute(&mut self, case: &FuzzCase) -> (FuzzOutcome, FuzzOutcome) {
+        let worker = &mut self.workers[0];
+        (worker.memory.execute(&mut worker.mc68000, case), worker.memory.execute(&mut worker.scc68070, case))
+    }
+
+    fn run_inner(&mut self, seed: u64, rounds: usize, cases_per_round: usize, reference: Option<&[[u64; 2]]>) -> FuzzReport {
+        let mut report = FuzzReport {
+            trace: FuzzTrace { seed, cases_per_round, digests: vec![[0; 2]; rounds * cases_per_round] },
+            ..FuzzReport::default()
+        };
+        let mut coverage = vec![0u64; BUCKETS / 64];
+        let chunk_len = cases_per_round.div_ceil(self.workers.len()).max(1);
+
+        for (round, digests) in report.trace.digests.chunks_mut(cases_per_round.max(1)).enumerate() {
+            let first = round * cases_per_round;
+            let corpus = &report.corpus;
+            let coverage_ref = &coverage;
+
+            let results: Vec<RoundResult> = std::thread::scope(|s| {
+                let handles: Vec<_> = self.workers.iter_mut().zip(digests.chunks_mut(chunk_len)).enumerate().map(|(i, (worker, digests))| {
+                    let first = first + i * chunk_len;
+                    let reference = reference.map(|reference| &reference[first..first + digests.len()]);
+                    s.spawn(move || worker.run(seed, first, digests, corpus, coverage_ref, reference))
+                }).collect();
+                handles.into_iter().map(|handle| handle.join().unwrap()).collect()
+            });
+
+            // The results are in case order, so the lowest index reaching a bucket is the one added to the corpus.
+            for result in results {
+                for (bucket, case) in result.new_buckets {
+                    let (word, bit) = (bucket / 64, 1 << (bucket % 64));
+                    if coverage[word] & bit == 0 {
+                        coverage[word] |= bit;
+                        report.corpus.push(case);
+                    }
+                }
+                report.divergences.extend(result.divergences);
+                report.mismatches.extend(result.mismatches);
+            }
+        }
+
+        report.coverage = coverage.iter().map(|word| word.count_ones() as usize).sum();
+        report
+    }
+}
+
+/// What a worker found during a round.
+struct RoundResult {
+    /// The buckets that were not covered at the start of the round, with the first case reaching them.
+    new_buckets: Vec<(usize, FuzzCase)>,
+    divergences: Vec<(usize, FuzzCase)>,
+    mismatches: Vec<(usize, FuzzCase)>,
+}
+
+/// The cores and the memory of a thread.
+struct Worker {
+    mc68000: M68000<Mc68000>,
+    scc68070: M68000<Scc68070>,
+    memory: FuzzMemory,
+    /// The buckets found during the current round, so only the first case reaching a bucket is reported.
+    seen: Box<[u64]>,
+}
+
+impl Worker {
+    fn new() -> Self {
+        Self {
+            mc68000: M68000::new_no_reset(),
+            scc68070: M68000::new_no_reset(),
+            memory: FuzzMemory::new(),
+            seen: vec![0; BUCKETS / 64].into_boxed_slice(),
+        }
+    }
+
+    /// Executes the cases starting at index `first`, one for each digest.
+    fn run(&mut self, seed: u64, first: usize, digests: &mut [[u64; 2]], corpus: &[FuzzCase], coverage: &[u64], reference: Option<&[[u64; 2]]>) -> RoundResult {
+        let mut result = RoundResult { new_buckets: Vec::new(), divergences: Vec::new(), mismatches: Vec::new() };
+        self.seen.fill(0);
+
+        for (i, digest) in digests.iter_mut().enumerate() {
+            let index = first + i;
+            let mut rng = Rng::new(seed ^ mix(index as u64));
+            let case = if !corpus.is_empty() && rng.below(2) == 0 {
+                corpus[rng.below(corpus.len() as u32) as usize].mutate(&mut rng)
+            } else {
+                FuzzCase::random(&mut rng)
+            };
+
+            let mc68000 = self.memory.execute(&mut self.mc68000, &case);
+            let scc68070 = self.memory.execute(&mut self.scc68070, &case);
+            *digest = [mc68000.digest(), scc68070.digest()];
+
+            let isa = Isa::from(case.words[0]);
+            let bucket = (isa as usize) << 12
+                       | mc68000.vector.map_or(0, |vector| vector as usize & 0x7F) << 5
+                       | mc68000.ccr as usize;
+            let (word, bit) = (bucket / 64, 1 << (bucket % 64));
+            if coverage[word] & bit == 0 && self.seen[word] & bit == 0 {
+                self.seen[word] |= bit;
+                result.new_buckets.push((bucket, case));
+            }
+
+            // RTE reads the stack frame, which format is specific to each CPU.
+            if isa != Isa::Rte && mc68000.vector.is_none() && scc68070.vector.is_none() && !mc68000.same_effects(&scc68070) {
+                result.divergences.push((index, case));
+            }
+            if reference.is_some_and(|reference| reference[i] != *digest) {
+                result.mismatches.push((index, case));
+            }
+        }
+
+        result
+    }
+}
+
+/// The memory of a worker, which logs the writes so they can be undone.
+struct FuzzMemory {
+    data: Box<[u8]>,
+    /// The address and the previous value of each byte written, in order.
+    undo: Vec<(u32, u8)>,
+    /// The digest of the writes since the last restore.
+    writes: u64,
+}
+
+impl FuzzMemory {
+    fn new() -> Self {
+        let mut rng = Rng::new(0);
+        let mut data: Box<[u8]> = (0..MEMORY_LEN).map(|_| rng.next() as u8).collect();
+        for vector in 0..256 {
+            data[vector * 4..vector * 4 + 4].copy_from_slice(&HANDLER.to_be_bytes());
+        }
+        data[HANDLER as usize..HANDLER as usize + 4].copy_from_slice(&[0x4E, 0x72, 0x27, 0x00]); // STOP #0x2700
+
+        Self { data, undo: Vec::new(), writes: 0 }
+    }
+
+    fn write(&mut self, addr: usize, value: u8) {
+        self.undo.push((addr as u32, self.data[addr]));
+        self.data[addr] = value;
+    }
+
+    /// Undoes all the writes.
+    fn restore(&mut self) {
+        while let Some((addr, value)) = self.undo.pop() {
+            self.data[addr as usize] = value;
+        }
+        self.writes = 0;
+    }
+
+    /// Executes the instruction of the case, then processes its exception and executes the handler.
+    fn execute<CPU: CpuDetails>(&mut self, cpu: &mut M68000<CPU>, case: &FuzzCase) -> FuzzOutcome {
+        let pc = case.regs.pc.0 as usize;
+        for (i, word) in case.words.iter().enumerate() {
+            self.write(pc + i * 2, (word >> 8) as u8);
+            self.write(pc + i * 2 + 1, *word as u8);
+        }
+
+        cpu.regs = case.regs;
+        cpu.stop = false;
+        cpu.exceptions.clear();
+
+        let (mut cycles, vector) = cpu.interpreter_exception(self);
+        let ccr = u16::from(cpu.regs.sr) as u8 & 0x1F;
+        // An Access Error that cannot be stacked is a double bus fault, which halts the CPU.
+        let ssp = cpu.regs.ssp.0;
+        if let Some(vector) = vector.filter(|&v| v != Vector::AccessError || ssp >= HANDLER && ssp as usize <= MEMORY_LEN) {
+            cpu.exception(Exception::from(vector));
+            cycles += cpu.interpreter_exception(self).0;
+        }
+
+        let outcome = FuzzOutcome { regs: cpu.regs, vector, ccr, cycles, writes: self.writes };
+        self.restore();
+        outcome
+    }
+}
+
+impl MemoryAccess for FuzzMemory {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.data.get(addr as usize).copied()
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let addr = addr as usize;
+        if addr + 1 < self.data.len() {
+            Some(u16::from_be_bytes([self.data[addr], self.data[addr + 1]]))
+        } else {
+            None
+        }
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        if (addr as usize) < self.data.len() {
+            self.write(addr as usize, value);
+            self.writes = combine(self.writes, (addr as u64) << 8 | value as u64);
+            Some(())
+        } else {
+            None
+        }
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        if (addr as usize) + 1 < self.data.len() {
+            let [high, low] = value.to_be_bytes();
+            self.write(addr as usize, high);
+            self.write(addr as usize + 1, low);
+            self.writes = combine(self.writes, (addr as u64) << 16 | value as u64);
+            Some(())
+        } else {
+            None
+        }
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+/// Effective addressing modes, by index in the list of [Rng::addressing_mode].
+const ALL: &[u8] = &[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11];
+const DATA_MODES: &[u8] = &[0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11];
+const ALTERABLE: &[u8] = &[0, 1, 2, 3, 4, 5, 6, 7, 8];
+const DATA_ALTERABLE: &[u8] = &[0, 2, 3, 4, 5, 6, 7, 8];
+const MEMORY_ALTERABLE: &[u8] = &[2, 3, 4, 5, 6, 7, 8];
+const CONTROL: &[u8] = &[2, 5, 6, 7, 8, 9, 10];
+const MOVEM_LOAD: &[u8] = &[2, 3, 5, 6, 7, 8, 9, 10];
+const MOVEM_STORE: &[u8] = &[2, 4, 5, 6, 7, 8];
+
+/// Values of the data registers and of the immediate operands that are on the edges of the operations.
+const EDGE_VALUES: [u32; 12] = [0, 1, 2, 0x7F, 0x80, 0xFF, 0x7FFF, 0x8000, 0xFFFF, 0x7FFF_FFFF, 0x8000_0000, 0xFFFF_FFFF];
+
+const CONDITIONS: [Condition; 16] = [
+    Condition::T, Condition::F, Condition::HI, Condition::LS, Condition::CC, Condition::CS, Condition::NE, Condition::EQ,
+    Condition::VC, Condition::VS, Condition::PL, Condition::MI, Condition::GE, Condition::LT, Condition::GT, Condition::LE,
+];
+
+impl FuzzCase {
+    /// Generates a random case.
+    fn random(rng: &mut Rng) -> Self {
+        let mut words = [0; CASE_WORDS];
+        if rng.below(4) == 0 {
+            words.fill_with(|| rng.next() as u16);
+        } else {
+            let code = rng.instruction();
+            words[..code.len()].copy_from_slice(code.as_slice());
+        }
+
+        Self { regs: rng.registers(), words }
+    }
+
+    /// Returns a copy of the case with a random change.
+    fn mutate(&self, rng: &mut Rng) -> Self {
+        let mut case = *self;
+        match rng.below(5) {
+            0 => case.words[0] ^= 1 << rng.below(16),
+            1 => case.words[1 + rng.below(CASE_WORDS as u32 - 1) as usize] = rng.next() as u16,
+            2 => case.regs.d[rng.below(8) as usize].0 = rng.data(),
+            3 => case.regs.a[rng.below(7) as usize].0 = rng.address(),
+            _ => case.regs.sr = rng.status_register().into(),
+        }
+        case
+    }
+}
+
+/// A xorshift64* generator.
+struct Rng(u64);
+
+impl Rng {
+    fn new(seed: u64) -> Self {
+        Self(mix(seed) | 1)
+    }
+
+    fn next(&mut self) -> u64 {
+        self.0 ^= self.0 >> 12;
+        self.0 ^= self.0 << 25;
+        self.0 ^= self.0 >> 27;
+        self.0.wrapping_mul(0x2545_F491_4F6C_DD1D)
+    }
+
+    /// Returns a number lower than `n`.
+    fn below(&mut self, n: u32) -> u32 {
+        ((self.next() >> 32) * n as u64 >> 32) as u32
+    }
+
+    fn bool(&mut self) -> bool {
+        self.next() >> 63 != 0
+    }
+
+    fn reg(&mut self) -> u8 {
+        self.below(8) as u8
+    }
+
+    fn size(&mut self) -> Size {
+        [Size::Byte, Size::Word, Size::Long][self.below(3) as usize]
+    }
+
+    fn word_long(&mut self) -> Size {
+        if self.bool() { Size::Long } else { Size::Word }
+    }
+
+    fn data(&mut self) -> u32 {
+        match self.below(4) {
+            0 => EDGE_VALUES[self.below(EDGE_VALUES.len() as u32) as usize],
+            1 => self.below(0x100),
+            _ => self.next() as u32,
+        }
+    }
+
+    /// Returns an even address in the data area, sometimes odd or outside of the memory.
+    fn address(&mut self) -> u32 {
+        match self.below(16) {
+            0 => self.next() as u32,
+            1 => DATA + self.below(MEMORY_LEN as u32 - 0x100 - DATA),
+            _ => DATA + self.below(MEMORY_LEN as u32 - 0x100 - DATA) & !1,
+        }
+    }
+
+    /// Returns a small even displacement, rarely odd.
+    fn displacement(&mut self) -> i16 {
+        let disp = self.below(0x100) as i16 - 0x80;
+        if self.below(16) == 0 { disp } else { disp & !1 }
+    }
+
+    fn status_register(&mut self) -> u16 {
+        let trace = if self.below(16) == 0 { 0x8000 } else { 0 };
+        trace | self.next() as u16 & 0x271F
+    }
+
+    fn registers(&mut self) -> Registers {
+        let mut regs = Registers::default();
+        for d in regs.d.iter_mut() {
+            d.0 = self.data();
+        }
+        for a in regs.a.iter_mut() {
+            a.0 = self.address();
+        }
+        regs.usp.0 = self.address();
+        // The SSP stays valid so the exceptions can be processed.
+        regs.ssp.0 = 0x8000 + self.below(0x7000) & !1;
+        regs.sr = self.status_register().into();
+        regs.pc.0 = CODE + self.below(0x80) * 2;
+        regs
+    }
+
+    fn brief_extension_word(&mut self) -> BriefExtensionWord {
+        BriefExtensionWord(self.next() as u16 & 0xF8FF)
+    }
+
+    /// Returns a random addressing mode among the given indices.
+    fn addressing_mode(&mut self, modes: &[u8]) -> AddressingMode {
+        let reg = self.reg();
+        match modes[self.below(modes.len() as u32) as usize] {
+            0 => AddressingMode::Drd(reg),
+            1 => AddressingMode::Ard(reg),
+            2 => AddressingMode::Ari(reg),
+            3 => AddressingMode::Ariwpo(reg),
+            4 => AddressingMode::Ariwpr(reg),
+            5 => AddressingMode::Ariwd(reg, self.displacement()),
+            6 => AddressingMode::Ariwi8(reg, self.brief_extension_word()),
+            7 => AddressingMode::AbsShort(self.address() as u16 & 0x7FFF),
+            8 => AddressingMode::AbsLong(self.address()),
+            9 => AddressingMode::Pciwd(0, self.displacement()),
+            10 => AddressingMode::Pciwi8(0, self.brief_extension_word()),
+            _ => AddressingMode::Immediate(self.data()),
+        }
+    }
+
+    /// Returns a source operand of the given size, which cannot be an address register for bytes.
+    fn source(&mut self, size: Size) -> AddressingMode {
+        self.addressing_mode(if size.is_byte() { DATA_MODES } else { ALL })
+    }
+
+    /// Returns a random valid instruction, assembled in place.
+    fn instruction(&mut self) -> ConstAssembler<CASE_WORDS> {
+        let asm = ConstAssembler::new();
+        let (reg, reg2) = (self.reg(), self.reg());
+        let size = self.size();
+        let word_long = self.word_long();
+        let shift = if self.bool() { Direction::Left } else { Direction::Right };
+        let rm = if self.bool() { Direction::RegisterToRegister } else { Direction::MemoryToMemory };
+        let cond = CONDITIONS[self.below(16) as usize];
+        let branch = CONDITIONS[self.below(14) as usize + 2];
+        let imm = self.data();
+        let imm16 = imm as u16;
+        let count = self.below(8) as u16;
+        let quick = count as u8 + 1;
+
+        match self.below(90) {
+            0 => asm.abcd(reg, rm, reg2),
+            1 => asm.add(reg, Direction::DstReg, size, self.source(size)),
+            2 => asm.add(reg, Direction::DstEa, size, self.addressing_mode(MEMORY_ALTERABLE)),
+            3 => asm.adda(reg, word_long, self.addressing_mode(ALL)),
+            4 => asm.addi(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            5 => asm.addq(quick, size, self.addressing_mode(if size.is_byte() { DATA_ALTERABLE } else { ALTERABLE })),
+            6 => asm.addx(reg, size, rm, reg2),
+            7 => asm.and(reg, Direction::DstReg, size, self.addressing_mode(DATA_MODES)),
+            8 => asm.and(reg, Direction::DstEa, size, self.addressing_mode(MEMORY_ALTERABLE)),
+            9 => asm.andi(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            10 => asm.andiccr(imm16),
+            11 => asm.andisr(imm16),
+            12 => asm.asm(shift, self.addressing_mode(MEMORY_ALTERABLE)),
+            13 => asm.asr(count, shift, size, self.bool(), reg as u16),
+            14 => asm.bcc(branch, self.displacement()),
+            15 => asm.bchg_dynamic(reg, self.addressing_mode(DATA_ALTERABLE)),
+            16 => asm.bchg_static(self.addressing_mode(DATA_ALTERABLE), imm as u8),
+            17 => asm.bclr_dynamic(reg, self.addressing_mode(DATA_ALTERABLE)),
+            18 => asm.bclr_static(self.addressing_mode(DATA_ALTERABLE), imm as u8),
+            19 => asm.bra(self.displacement()),
+            20 => asm.bset_dynamic(reg, self.addressing_mode(DATA_ALTERABLE)),
+            21 => asm.bset_static(self.addressing_mode(DATA_ALTERABLE), imm as u8),
+            22 => asm.bsr(self.displacement()),
+            23 => asm.btst_dynamic(reg, self.addressing_mode(DATA_MODES)),
+            24 => asm.btst_static(self.addressing_mode(DATA_ALTERABLE), imm as u8),
+            25 => asm.chk(reg, self.addressing_mode(DATA_MODES)),
+            26 => asm.clr(size, self.addressing_mode(DATA_ALTERABLE)),
+            27 => asm.cmp(reg, size, self.source(size)),
+            28 => asm.cmpa(reg, word_long, self.addressing_mode(ALL)),
+            29 => asm.cmpi(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            30 => asm.cmpm(reg, size, reg2),
+            31 => asm.dbcc(cond, reg, self.displacement()),
+            32 => asm.divs(reg, self.addressing_mode(DATA_MODES)),
+            33 => asm.divu(reg, self.addressing_mode(DATA_MODES)),
+            34 => asm.eor(reg, size, self.addressing_mode(DATA_ALTERABLE)),
+            35 => asm.eori(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            36 => asm.eoriccr(imm16),
+            37 => asm.eorisr(imm16),
+            38 => asm.exg(reg, [Direction::ExchangeData, Direction::ExchangeAddress, Direction::ExchangeDataAddress][self.below(3) as usize], reg2),
+            39 => asm.ext(self.bool(), reg),
+            40 => asm.illegal(),
+            41 => asm.jmp(self.addressing_mode(CONTROL)),
+            42 => asm.jsr(self.addressing_mode(CONTROL)),
+            43 => asm.lea(reg, self.addressing_mode(CONTROL)),
+            44 => asm.link(reg, self.displacement()),
+            45 => asm.lsm(shift, self.addressing_mode(MEMORY_ALTERABLE)),
+            46 => asm.lsr(count, shift, size, self.bool(), reg as u16),
+            47 => asm.r#move(size, self.addressing_mode(DATA_ALTERABLE), self.source(size)),
+            48 => asm.movea(word_long, reg, self.addressing_mode(ALL)),
+            49 => asm.moveccr(self.addressing_mode(DATA_MODES)),
+            50 => asm.movefsr(self.addressing_mode(DATA_ALTERABLE)),
+            51 => asm.movesr(self.addressing_mode(DATA_MODES)),
+            52 => asm.moveusp(if self.bool() { Direction::UspToRegister } else { Direction::RegisterToUsp }, reg),
+            53 => asm.movem(Direction::MemoryToRegister, word_long, self.addressing_mode(MOVEM_LOAD), imm16),
+            54 => asm.movem(Direction::RegisterToMemory, word_long, self.addressing_mode(MOVEM_STORE), imm16),
+            55 => asm.movep(reg, if self.bool() { Direction::MemoryToRegister } else { Direction::RegisterToMemory }, word_long, reg2, self.displacement()),
+            56 => asm.moveq(reg, imm as i8),
+            57 => asm.muls(reg, self.addressing_mode(DATA_MODES)),
+            58 => asm.mulu(reg, self.addressing_mode(DATA_MODES)),
+            59 => asm.nbcd(self.addressing_mode(DATA_ALTERABLE)),
+            60 => asm.neg(size, self.addressing_mode(DATA_ALTERABLE)),
+            61 => asm.negx(size, self.addressing_mode(DATA_ALTERABLE)),
+            62 => asm.nop(),
+            63 => asm.not(size, self.addressing_mode(DATA_ALTERABLE)),
+            64 => asm.or(reg, Direction::DstReg, size, self.addressing_mode(DATA_MODES)),
+            65 => asm.or(reg, Direction::DstEa, size, self.addressing_mode(MEMORY_ALTERABLE)),
+            66 => asm.ori(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            67 => asm.oriccr(imm16),
+            68 => asm.orisr(imm16),
+            69 => asm.pea(self.addressing_mode(CONTROL)),
+            70 => asm.reset(),
+            71 => asm.rom(shift, self.addressing_mode(MEMORY_ALTERABLE)),
+            72 => asm.ror(count, shift, size, self.bool(), reg as u16),
+            73 => asm.roxm(shift, self.addressing_mode(MEMORY_ALTERABLE)),
+            74 => asm.roxr(count, shift, size, self.bool(), reg as u16),
+            75 => asm.rte(),
+            76 => asm.rtr(),
+            77 => asm.rts(),
+            78 => asm.sbcd(reg, rm, reg2),
+            79 => asm.scc(cond, self.addressing_mode(DATA_ALTERABLE)),
+            80 => asm.stop(imm16),
+            81 => asm.sub(reg, Direction::DstReg, size, self.source(size)),
+            82 => asm.sub(reg, Direction::DstEa, size, self.addressing_mode(MEMORY_ALTERABLE)),
+            83 => asm.suba(reg, word_long, self.addressing_mode(ALL)),
+            84 => asm.subi(size, self.addressing_mode(DATA_ALTERABLE), imm),
+            85 => asm.subq(quick, size, self.addressing_mode(if size.is_byte() { DATA_ALTERABLE } else { ALTERABLE })),
+            86 => asm.subx(reg, size, rm, reg2),
+            87 => asm.swap(reg),
+            88 => asm.tas(self.addressing_mode(DATA_ALTERABLE)),
+            _ => match self.below(4) {
+                0 => asm.trap(count as u8 * 2 + self.below(2) as u8),
+                1 => asm.trapv(),
+                2 => asm.tst(size, self.addressing_mode(DATA_ALTERABLE)),
+                _ => asm.unlk(reg),
+            },
+        }
+    }
+}
+
+/// The finalizer of splitmix64.
+const fn mix(mut x: u64) -> u64 {
+    x = (x ^ x >> 30).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    x = (x ^ x >> 27).wrapping_mul(0x94D0_49BB_1331_11EB);
+    x ^ x >> 31
+}
+
+/// Adds a value to a digest.
+const fn combine(hash: u64, value: u64) -> u64 {
+    (hash.rotate_left(5) ^ value).wrapping_mul(0x517C_C1B7_2722_0A95)
+}
+
+fn hash_regs(mut hash: u64, regs: &Registers) -> u64 {
+    for d in regs.d {
+        hash = combine(hash, d.0 as u64);
+    }
+    for a in regs.a {
+        hash = combine(hash, a.0 as u64);
+    }
+    hash = combine(hash, regs.usp.0 as u64);
+    hash = combine(hash, regs.ssp.0 as u64);
+    hash = combine(hash, u16::from(regs.sr) as u64);
+    combine(hash, regs.pc.0 as u64)
+}
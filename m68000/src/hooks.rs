@@ -0,0 +1,381 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Execution hooks: breakpoints, watchpoints, instruction hook and coverage collection.
+//!
+//! Hooks are checked by [M68000::interpreter_exception] and all the methods based on it ([M68000::cycle],
+//! [M68000::cycle_until_exception], [M68000::loop_until_exception_stop], [M68000::run_scheduler](crate::M68000::run_scheduler),
+//! the [pool](crate::pool) and the [lockstep](crate::lockstep) runners). A core with no hook registered only tests
+//! that none is registered on each instruction.
+//!
+//! - Breakpoints ([M68000::add_breakpoint]) are checked before executing the instruction at their address.
+//! - Watchpoints ([M68000::add_watchpoint]) are checked on each memory access of the core, **including the
+//!   instruction fetches** for read watchpoints. The instruction that hits a watchpoint is fully executed.
+//! - The instruction hook ([M68000::set_instruction_hook]) is called before each instruction, and can request a break.
+//! - Coverage collection ([M68000::set_coverage]) records the address of each instruction executed.
+//!
+//! When a hook breaks the execution, the core is stopped like after a STOP instruction, so the run methods return,
+//! and the reason is returned by [M68000::hook_event]. Interrupts requested while the core is stopped by a hook stay
+//! pending. Call [M68000::resume_from_hook] to continue the execution, which does not break again on the breakpoint
+//! or instruction hook that stopped the core. A core that executed a STOP instruction before the break stays stopped by
+//! it when resumed, and [M68000::save_state](crate::M68000::save_state) saves the STOP state, not the break.
+//!
+//! While hooks are registered, the block execution tier of the `block-exec` feature and the idle loop detection are disabled,
+//! so every instruction is checked.
+//!
+//! ```
+//! use m68000::M68000;
+//! use m68000::cpu_details::Mc68000;
+//! use m68000::hooks::HookEvent;
+//!
+//! // 0x1000: MOVEQ #1, D0
+//! // 0x1002: MOVEQ #2, D0
+//! // 0x1004: STOP #0x2700
+//! let mut memory = vec![0u16; 0x1000];
+//! memory[0x800..0x804].copy_from_slice(&[0x7001, 0x7002, 0x4E72, 0x2700]);
+//!
+//! let mut cpu = M68000::<Mc68000>::new_no_reset();
+//! cpu.regs.pc.0 = 0x1000;
+//! cpu.add_breakpoint(0x1002);
+//!
+//! cpu.loop_until_exception_stop(&mut memory[..]);
+//! assert_eq!(cpu.hook_event(), Some(HookEvent::Breakpoint(0x1002)));
+//! assert_eq!(cpu.regs.d[0].0, 1);
+//!
+//! cpu.resume_from_hook();
+//! cpu.loop_until_exception_stop(&mut memory[..]);
+//! assert_eq!(cpu.hook_event(), None);
+//! assert_eq!(cpu.regs.d[0].0, 2);
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess, Registers};
+use crate::exception::Vector;
+
+use std::fmt;
+use std::ops::Range;
+use std::sync::Arc;
+
+/// Number of bits to shift an address to get its page number in an [AddressSet].
+const PAGE_SHIFT: u32 = 16;
+/// Number of pages in the 32-bits address space.
+const PAGE_COUNT: usize = 1 << (32 - PAGE_SHIFT);
+/// Number of 64-bits words in the bitmap of a page, one bit per even address.
+const PAGE_WORDS: usize = 1 << (PAGE_SHIFT - 1 - 6);
+
+/// The reason why a hook stopped the core.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum HookEvent {
+    /// The PC reached the breakpoint at this address. The instruction has not been executed.
+    Breakpoint(u32),
+    /// The instruction hook returned false before the instruction at this address. The instruction has not been
+    /// executed.
+    Instruction(u32),
+    /// The instruction at `pc` (or the exception processed before it) accessed the watched address `addr`.
+    /// The instruction has been executed.
+    Watchpoint {
+        pc: u32,
+        addr: u32,
+        write: bool,
+    },
+}
+
+/// A watched range of addresses.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct Watchpoint {
+    /// The watched addresses.
+    pub range: Range<u32>,
+    /// Break on reads (including instruction fetches).
+    pub read: bool,
+    /// Break on writes.
+    pub write: bool,
+}
+
+/// The instruction hook, called with the registers before each instruction. Return false to break.
+pub type InstructionHook = Arc<dyn Fn(&Registers) -> bool + Send + Sync>;
+
+/// Set of even addresses, as a bitmap allocated by pages of 64 KiB.
+#[derive(Clone, Debug, Default)]
+struct AddressSet {
+    pages: Vec<Option<Box<[u64; PAGE_WORDS]>>>,
+    len: usize,
+}
+
+impl AddressSet {
+    /// Returns the page, the word in the page and the bit in the word of the given address.
+    #[inline(always)]
+    const fn location(addr: u32) -> (usize, usize, u64) {
+        let bit = (addr & ((1 << PAGE_SHIFT) - 1)) >> 1;
+        ((addr >> PAGE_SHIFT) as usize, (bit >> 6) as usize, 1 << (bit & 63))
+    }
+
+    #[inline(always)]
+    fn contains(&self, addr: u32) -> bool {
+        let (page, word, bit) = Self::location(addr);
+        self.pages.get(page).and_then(Option::as_ref).is_some_and(|p| p[word] & bit != 0)
+    }
+
+    fn insert(&mut self, addr: u32) {
+        let (page, word, bit) = Self::location(addr);
+        if self.pages.is_empty() {
+            self.pages.resize(PAGE_COUNT, None);
+        }
+
+        let p = self.pages[page].get_or_insert_with(|| Box::new([0; PAGE_WORDS]));
+        if p[word] & bit == 0 {
+            p[word] |= bit;
+            self.len += 1;
+        }
+    }
+
+    fn remove(&mut self, addr: u32) {
+        let (page, word, bit) = Self::location(addr);
+        if let Some(p) = self.pages.get_mut(page).and_then(Option::as_mut) {
+            if p[word] & bit != 0 {
+                p[word] &= !bit;
+                self.len -= 1;
+            }
+        }
+    }
+
+    fn iter(&self) -> impl Iterator<Item = u32> + '_ {
+        self.pages.iter().enumerate().filter_map(|(page, p)| p.as_ref().map(|p| (page, p))).flat_map(|(page, p)| {
+            p.iter().enumerate().flat_map(move |(word, &bits)| {
+                (0..64).filter(move |bit| bits & 1 << bit != 0)
+                    .map(move |bit| (page << PAGE_SHIFT | (word << 6 | bit) << 1) as u32)
+            })
+        })
+    }
+}
+
+/// The hooks registered in a core.
+#[derive(Clone, Default)]
+pub(crate) struct Hooks {
+    breakpoints: AddressSet,
+    watchpoints: Vec<Watchpoint>,
+    instruction_hook: Option<InstructionHook>,
+    /// The addresses of the instructions executed, `None` when disabled.
+    coverage: Option<Box<AddressSet>>,
+    /// The event that stopped the core.
+    event: Option<HookEvent>,
+    /// The STOP state of the core before the event stopped it, restored when resuming.
+    stopped: bool,
+    /// The first watched access of the current instruction, with true if it is a write.
+    watch_hit: Option<(u32, bool)>,
+    /// Do not check the breakpoint and the instruction hook on the next instruction, after resuming from them.
+    skip: bool,
+}
+
+impl Hooks {
+    /// Returns true if nothing is registered, so the core does not need to check the hooks.
+    fn is_empty(&self) -> bool {
+        self.breakpoints.len == 0 && self.watchpoints.is_empty() && self.instruction_hook.is_none() &&
+        self.coverage.is_none() && self.event.is_none()
+    }
+
+    /// Called before the instruction at the PC. Returns true if the execution has to break.
+    fn before_instruction(&mut self, regs: &Registers) -> bool {
+        let pc = regs.pc.0;
+
+        if !std::mem::take(&mut self.skip) {
+            if self.breakpoints.contains(pc) {
+                self.event = Some(HookEvent::Breakpoint(pc));
+                return true;
+            }
+
+            if self.instruction_hook.as_ref().is_some_and(|hook| !hook(regs)) {
+                self.event = Some(HookEvent::Instruction(pc));
+                return true;
+            }
+        }
+
+        if let Some(coverage) = &mut self.coverage {
+            coverage.insert(pc);
+        }
+
+        false
+    }
+
+    /// Records the first access of the instruction that hits a watchpoint.
+    #[inline(always)]
+    pub fn check_access(&mut self, addr: u32, len: u32, write: bool) {
+        if self.watch_hit.is_some() {
+            return;
+        }
+
+        let end = addr.saturating_add(len);
+        for watch in &self.watchpoints {
+            if (write && watch.write || !write && watch.read) && addr < watch.range.end && watch.range.start < end {
+                self.watch_hit = Some((addr.max(watch.range.start), write));
+                return;
+            }
+        }
+    }
+}
+
+impl fmt::Debug for Hooks {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("Hooks")
+            .field("breakpoints", &self.breakpoints.len)
+            .field("watchpoints", &self.watchpoints)
+            .field("instruction_hook", &self.instruction_hook.is_some())
+            .field("coverage", &self.coverage.as_ref().map(|c| c.len))
+            .field("event", &self.event)
+            .finish()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Returns the hooks, registering them if needed.
+    fn hooks_mut(&mut self) -> &mut Hooks {
+        self.hooks.get_or_insert_with(Box::default)
+    }
+
+    /// Unregisters the hooks if they are empty, so the core does not check them anymore.
+    fn release_hooks(&mut self) {
+        if self.hooks.as_ref().is_some_and(|hooks| hooks.is_empty()) {
+            self.hooks = None;
+        }
+    }
+
+    /// Adds a breakpoint at the given address. Odd addresses are rounded down.
+    pub fn add_breakpoint(&mut self, addr: u32) {
+        self.hooks_mut().breakpoints.insert(addr);
+    }
+
+    /// Removes the breakpoint at the given address if any.
+    pub fn remove_breakpoint(&mut self, addr: u32) {
+        if let Some(hooks) = &mut self.hooks {
+            hooks.breakpoints.remove(addr);
+            self.release_hooks();
+        }
+    }
+
+    /// Removes all the breakpoints.
+    pub fn clear_breakpoints(&mut self) {
+        if let Some(hooks) = &mut self.hooks {
+            hooks.breakpoints = AddressSet::default();
+            self.release_hooks();
+        }
+    }
+
+    /// Returns true if there is a breakpoint at the given address.
+    pub fn has_breakpoint(&self, addr: u32) -> bool {
+        self.hooks.as_ref().is_some_and(|hooks| hooks.breakpoints.contains(addr))
+    }
+
+    /// Adds a watchpoint on the given range of addresses.
+    pub fn add_watchpoint(&mut self, watchpoint: Watchpoint) {
+        self.hooks_mut().watchpoints.push(watchpoint);
+    }
+
+    /// Removes all the watchpoints.
+    pub fn clear_watchpoints(&mut self) {
+        if let Some(hooks) = &mut self.hooks {
+            hooks.watchpoints.clear();
+            self.release_hooks();
+        }
+    }
+
+    /// Sets the instruction hook, or removes it if `None`.
+    pub fn set_instruction_hook(&mut self, hook: Option<InstructionHook>) {
+        if hook.is_some() {
+            self.hooks_mut().instruction_hook = hook;
+        } else if let Some(hooks) = &mut self.hooks {
+            hooks.instruction_hook = None;
+            self.release_hooks();
+        }
+    }
+
+    /// Enables or disables the coverage collection. Disabled by default.
+    ///
+    /// Enabling it when it is already enabled keeps the addresses already recorded.
+    pub fn set_coverage(&mut self, enabled: bool) {
+        if enabled {
+            self.hooks_mut().coverage.get_or_insert_with(Box::default);
+        } else if let Some(hooks) = &mut self.hooks {
+            hooks.coverage = None;
+            self.release_hooks();
+        }
+    }
+
+    /// Returns true if the instruction at the given address has been executed since coverage collection is enabled.
+    pub fn is_covered(&self, addr: u32) -> bool {
+        self.hooks.as_ref().and_then(|hooks| hooks.coverage.as_ref()).is_some_and(|coverage| coverage.contains(addr))
+    }
+
+    /// Returns the addresses of the instructions executed since coverage collection is enabled, in ascending order.
+    pub fn covered_addresses(&self) -> impl Iterator<Item = u32> + '_ {
+        self.hooks.as_ref().and_then(|hooks| hooks.coverage.as_ref()).into_iter().flat_map(|coverage| coverage.iter())
+    }
+
+    /// Returns true if the core is stopped by a STOP instruction, even when a hook also stopped it.
+    pub fn stopped_by_instruction(&self) -> bool {
+        match self.hooks.as_deref() {
+            Some(hooks) if hooks.event.is_some() => hooks.stopped,
+            _ => self.stop,
+        }
+    }
+
+    /// Sets the STOP state of the core, keeping it stopped if a hook stopped it.
+    pub(crate) fn set_stopped_by_instruction(&mut self, stop: bool) {
+        match self.hooks.as_deref_mut() {
+            Some(hooks) if hooks.event.is_some() => hooks.stopped = stop,
+            _ => self.stop = stop,
+        }
+    }
+
+    /// Returns the event that stopped the core if any.
+    pub fn hook_event(&self) -> Option<HookEvent> {
+        self.hooks.as_ref().and_then(|hooks| hooks.event)
+    }
+
+    /// Resumes the execution after a hook stopped the core, and returns the event that stopped it.
+    ///
+    /// The breakpoint and the instruction hook are not checked on the next instruction, so the execution does not
+    /// break again at the same place. If the core executed a STOP instruction before the hook stopped it, it stays
+    /// stopped by the STOP instruction.
+    /// Does nothing and returns `None` if the core has not been stopped by a hook.
+    pub fn resume_from_hook(&mut self) -> Option<HookEvent> {
+        let hooks = self.hooks.as_mut()?;
+        let event = hooks.event.take()?;
+        hooks.skip = matches!(event, HookEvent::Breakpoint(_) | HookEvent::Instruction(_));
+        self.stop = hooks.stopped;
+        self.release_hooks();
+        Some(event)
+    }
+
+    /// [Self::interpreter_exception] when hooks are registered.
+    pub(super) fn hooked_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> (usize, Option<Vector>) {
+        let (cycles, vector) = self.with_core_memory(memory, |cpu, memory| {
+            let mut cycles = 0;
+            memory.hooks.as_deref_mut().expect("hooks must be registered").watch_hit = None;
+
+            // Process the exceptions first, so the hooks see the first instruction of the handler.
+            if !cpu.exceptions.is_empty() {
+                cycles += cpu.process_pending_exceptions(memory);
+            }
+
+            let pc = cpu.regs.pc.0;
+            let hooks = memory.hooks.as_deref_mut().expect("hooks must be registered");
+            if hooks.before_instruction(&cpu.regs) {
+                hooks.stopped = cpu.stop;
+                cpu.stop = true;
+                return (cycles, None);
+            }
+
+            let (c, vector) = cpu.core_memory_interpreter_exception(memory);
+
+            let hooks = memory.hooks.as_deref_mut().expect("hooks must be registered");
+            if let Some((addr, write)) = hooks.watch_hit.take() {
+                hooks.event = Some(HookEvent::Watchpoint { pc, addr, write });
+                hooks.stopped = cpu.stop; // The instruction may be a STOP.
+                cpu.stop = true;
+            }
+
+            (cycles + c, vector)
+        });
+
+        (cycles + self.take_wait_cycles(memory), vector)
+    }
+}
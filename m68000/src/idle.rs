@@ -0,0 +1,159 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Idle loop detection.
+//!
+//! When enabled with [M68000::set_idle_loop_detection], the methods that run the CPU for a given number of cycles
+//! ([M68000::cycle], [M68000::cycle_until_exception] and [M68000::run_scheduler](crate::M68000::run_scheduler))
+//! look for small loops that cannot change the state of the core: branches to self (`BRA *`), `DBcc` loops that only
+//! decrement their counter, and polling loops that test a memory location (`TST`, `BTST` or `CMP` followed by a
+//! branch). When such a loop is found, one iteration is executed normally to measure its execution time, then the
+//! iterations that fit in the remaining cycle budget are skipped at once. The skipped cycles are returned like
+//! executed ones, and the iterations that do not fit entirely are still interpreted, so the timings are exactly the
+//! same as without detection.
+//!
+//! Polling loops are skipped only if an iteration reads the same values, so the detection must only be enabled when
+//! memory reads have no side effects and when the memory is not modified during the call (by DMA or devices emulated
+//! in the memory accesses for example). Devices updated between the calls, like in the event handler of
+//! [M68000::run_scheduler](crate::M68000::run_scheduler), are seen on the next call.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+use crate::instruction::{Instruction, Operands};
+use crate::isa::Isa;
+
+/// The maximum number of instructions in an idle loop.
+const MAX_LOOP_INSTRUCTIONS: usize = 4;
+/// The maximum size in bytes of an idle loop.
+const MAX_LOOP_SIZE: u32 = 32;
+/// Address that never matches a loop, as instructions are at even addresses.
+const NO_LOOP: u32 = 1;
+
+/// State of the idle loop detection.
+#[derive(Clone, Copy, Debug)]
+pub(crate) struct IdleDetection {
+    /// The address of the last loop that can't be skipped, so it is not decoded again on each iteration.
+    rejected: u32,
+}
+
+impl IdleDetection {
+    pub const fn new() -> Self {
+        Self { rejected: NO_LOOP }
+    }
+}
+
+/// Returns true if the instruction can only modify the CCR and the PC.
+const fn is_idle_instruction(isa: Isa) -> bool {
+    use Isa::*;
+    matches!(isa, Bcc | Bra | Btst | Cmp | Cmpa | Cmpi | Dbcc | Nop | Tst)
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Enables or disables the detection of idle loops. Disabled by default.
+    ///
+    /// See the [idle](crate::idle) module for the loops detected and the requirements on the memory.
+    pub fn set_idle_loop_detection(&mut self, enabled: bool) {
+        self.idle_detection = enabled.then(IdleDetection::new);
+    }
+
+    /// Called after the instruction at `pc` has been executed without exception, with the number of cycles remaining
+    /// in the budget. If the instruction closed an idle loop, executes one iteration to measure it and skips the
+    /// iterations that fit in the budget.
+    ///
+    /// Returns the number of cycles executed and skipped, and the exception that occured during the measured iteration.
+    pub(super) fn skip_idle_loop<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, pc: u32, budget: usize) -> (usize, Option<Vector>) {
+        let head = self.regs.pc.0;
+        let Some(detection) = self.idle_detection else {
+            return (0, None);
+        };
+
+        // Only backward branches close a loop.
+        if head > pc || pc - head >= MAX_LOOP_SIZE || head == detection.rejected ||
+           self.stop || self.regs.sr.t || !self.exceptions.is_empty() || self.hooks.is_some() {
+            return (0, None);
+        }
+
+        let Some((instructions, counter)) = decode_loop(memory, head, pc) else {
+            self.idle_detection = Some(IdleDetection { rejected: head });
+            return (0, None);
+        };
+
+        // Execute one iteration to measure it, and check that it did not change anything but the counter.
+        let start = self.regs;
+        let mut cycles = 0;
+        let mut executed = 0;
+        for _ in 0..instructions {
+            let (c, vector) = self.interpreter_exception(memory);
+            cycles += c;
+            executed += 1;
+
+            // Like the interpreter, stop in the middle of the iteration when the budget is reached.
+            if vector.is_some() || self.stop || cycles >= budget {
+                return (cycles, vector);
+            }
+            if self.regs.pc.0 == head {
+                break;
+            }
+        }
+
+        if self.regs.pc.0 != head || cycles == 0 || !self.exceptions.is_empty() {
+            return (cycles, None);
+        }
+
+        let mut expected = start;
+        if let Some(reg) = counter {
+            expected.d_word(reg, self.regs.d[reg as usize].0 as u16);
+        }
+        if self.regs != expected {
+            return (cycles, None);
+        }
+
+        let mut iterations = budget.saturating_sub(cycles) / cycles;
+        if let Some(reg) = counter {
+            // DBcc does not branch when the counter reaches -1, so the iterations that end at the head are limited.
+            let count = self.regs.d[reg as usize].0 as u16;
+            iterations = iterations.min(count as usize);
+            self.regs.d_word(reg, count - iterations as u16);
+        }
+
+        self.counters.cycles += (iterations * cycles) as u64;
+        self.counters.instructions += (iterations * executed) as u64;
+
+        (cycles + iterations * cycles, None)
+    }
+}
+
+/// Decodes the loop starting at `head` and ending with the branch at `branch`.
+///
+/// Returns the number of instructions of the loop and the counter register of the DBcc instruction if any,
+/// or None if the loop contains an instruction that may change the state of the core.
+fn decode_loop<M: MemoryAccess + ?Sized>(memory: &mut M, head: u32, branch: u32) -> Option<(usize, Option<u8>)> {
+    let mut iter = memory.iter_u16(head);
+    let mut counter = None;
+
+    for count in 1..=MAX_LOOP_INSTRUCTIONS {
+        let pc = iter.next_addr;
+        let instruction = Instruction::from_memory(&mut iter).ok()?;
+        let isa = Isa::from(instruction.opcode);
+        if !is_idle_instruction(isa) {
+            return None;
+        }
+
+        if let Operands::ConditionRegisterDisplacement(_, reg, _) = instruction.operands {
+            if counter.is_some() {
+                return None;
+            }
+            counter = Some(reg);
+        }
+
+        if pc == branch {
+            return Some((count, counter));
+        }
+        if pc > branch {
+            return None;
+        }
+    }
+
+    None
+}
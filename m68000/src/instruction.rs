@@ -8,8 +8,8 @@
 //! They take as parameters the opcode of the instruction and an iterator over the extension words.
 
 use crate::addressing_modes::AddressingMode;
-use crate::decoder::DECODER;
-use crate::disassembler::DLUT;
+use crate::decoder::decode;
+use crate::disassembler::{DLUT, WLUT};
 use crate::exception::Vector;
 use crate::isa::{Isa, IsaEntry};
 use crate::memory_access::{MemoryAccess, MemoryIter};
@@ -58,11 +58,17 @@ impl Instruction {
         let isa = Isa::from(self.opcode);
         (DLUT[isa as usize])(self)
     }
+
+    /// Disassemble the instruction in the given writer, without allocating.
+    pub fn disassemble_to(&self, f: &mut dyn std::fmt::Write) -> std::fmt::Result {
+        let isa = Isa::from(self.opcode);
+        (WLUT[isa as usize])(f, self)
+    }
 }
 
 impl std::fmt::Display for Instruction {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
-        write!(f, "{}", self.disassemble())
+        self.disassemble_to(f)
     }
 }
 
@@ -201,20 +207,20 @@ impl Size {
 
     /// Returns true if it is Size::Byte, false otherwise.
     #[inline(always)]
-    pub fn is_byte(self) -> bool {
-        self == Self::Byte
+    pub const fn is_byte(self) -> bool {
+        matches!(self, Self::Byte)
     }
 
     /// Returns true if it is Size::Word, false otherwise.
     #[inline(always)]
-    pub fn is_word(self) -> bool {
-        self == Self::Word
+    pub const fn is_word(self) -> bool {
+        matches!(self, Self::Word)
     }
 
     /// Returns true if it is Size::long, false otherwise.
     #[inline(always)]
-    pub fn is_long(self) -> bool {
-        self == Self::Long
+    pub const fn is_long(self) -> bool {
+        matches!(self, Self::Long)
     }
 }
 
@@ -759,7 +765,7 @@ pub fn effective_address_count<M: MemoryAccess + ?Sized>(opcode: u16, memory: &m
 
 /// JMP, JSR, MOVE (f) SR CCR, NBCD, PEA, TAS
 pub fn effective_address<M: MemoryAccess + ?Sized>(opcode: u16, memory: &mut MemoryIter<M>) -> AddressingMode {
-    let isa = DECODER[opcode as usize];
+    let isa = decode(opcode);
 
     let size = if isa == Isa::Nbcd || isa == Isa::Tas {
         Some(Size::Byte)
@@ -787,7 +793,7 @@ pub fn size_effective_address<M: MemoryAccess + ?Sized>(opcode: u16, memory: &mu
 
 /// CHK, DIVS, DIVU, LEA, MULS, MULU
 pub fn register_effective_address<M: MemoryAccess + ?Sized>(opcode: u16, memory: &mut MemoryIter<M>) -> (u8, AddressingMode) {
-    let isa = DECODER[opcode as usize];
+    let isa = decode(opcode);
 
     let reg = bits(opcode, 9, 11) as u8;
     let size = if isa == Isa::Lea {
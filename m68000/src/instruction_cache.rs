@@ -0,0 +1,491 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Pre-decoded instruction cache.
+//!
+//! When enabled with [M68000::set_instruction_cache], the interpreter stores the decoded instructions (opcode,
+//! operands, extension words and address of the next instruction) and reuses them the next time the same address is
+//! executed, so hot loops are fetched and decoded only once.
+//!
+//! Instructions are grouped in basic blocks keyed by the address of their first instruction.
+//! A block ends after a control-flow instruction or when it reaches [MAX_BLOCK_LENGTH] instructions.
+//! Executing sequentially inside a block does not require any look-up.
+//!
+//! Every write done by the core (including exception stack frames) is checked against the pages containing cached
+//! code, and the blocks of the written page are discarded so self-modifying code is executed correctly.
+//! Writes done outside of the core (DMA, program loading, etc.) are not seen by the cache, so the application
+//! has to call [M68000::invalidate_instruction_cache] or [M68000::clear_instruction_cache] after them.
+//!
+//! Because the opcode and extension words are no longer read from memory on each execution, the cache must only be
+//! enabled when instruction fetches have no side effects on the memory system.
+//!
+//! With the `block-exec` feature, [M68000::cycle], [M68000::cycle_until_exception] and [M68000::loop_until_exception_stop]
+//! execute the cached blocks in a single loop instead of going through [M68000::interpreter_exception] for each
+//! instruction, with the same execution times and exceptions.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::code_map::CodeEntry;
+use crate::exception::Vector;
+use crate::instruction::Instruction;
+use crate::interpreter_disassembler::Execute;
+use crate::isa::Isa;
+use crate::memory_access::CoreMemory;
+
+use std::collections::HashMap;
+
+/// The maximum number of instructions in a basic block.
+pub const MAX_BLOCK_LENGTH: usize = 64;
+
+/// Size of the invalidation pages is 2^PAGE_SHIFT bytes.
+const PAGE_SHIFT: u32 = 8;
+/// Number of bits in the page filter. Covers the 16 MiB address space of the 68000, upper addresses alias.
+const PAGE_FILTER_BITS: usize = 1 << 16;
+
+/// A decoded instruction stored in the cache.
+#[derive(Clone, Copy, Debug)]
+pub(crate) struct CachedInstruction {
+    /// The decoded instruction.
+    pub instruction: Instruction,
+    /// The ISA of the instruction, so the handler is looked up without the decoder table.
+    pub isa: Isa,
+    /// The address of the instruction following this one.
+    pub next_pc: u32,
+}
+
+/// A sequence of instructions executed one after the other.
+#[derive(Clone, Debug)]
+struct BasicBlock {
+    instructions: Vec<CachedInstruction>,
+    /// Address of the first instruction.
+    start: u32,
+    /// First page containing this block.
+    first_page: u32,
+    /// Last page containing this block.
+    last_page: u32,
+    /// True when no more instruction can be appended to this block.
+    closed: bool,
+    /// The start address and index of the last two blocks executed after this one, so jumping between hot blocks
+    /// does not look up [InstructionCache::entries].
+    links: [(u32, usize); 2],
+}
+
+/// A link that never matches, as instructions are at even addresses.
+const NO_LINK: (u32, usize) = (1, 0);
+
+impl Default for BasicBlock {
+    fn default() -> Self {
+        Self {
+            instructions: Vec::new(),
+            start: 0,
+            first_page: 0,
+            last_page: 0,
+            closed: false,
+            links: [NO_LINK; 2],
+        }
+    }
+}
+
+impl BasicBlock {
+    /// Address of the byte after the last instruction.
+    fn end(&self) -> u32 {
+        self.instructions.last().map_or(self.start, |i| i.next_pc)
+    }
+}
+
+/// Cache of pre-decoded basic blocks, keyed by address.
+#[derive(Clone)]
+pub struct InstructionCache {
+    /// Block storage. Invalidated blocks are left empty and their index is reused.
+    blocks: Vec<BasicBlock>,
+    /// Indices of the empty slots of `blocks`.
+    free: Vec<usize>,
+    /// Maps the address of the first instruction of a block to its index.
+    entries: HashMap<u32, usize>,
+    /// Maps a page number to the indices of the blocks that contain code in this page.
+    pages: HashMap<u32, Vec<usize>>,
+    /// One bit per page (aliased on 16 bits) set when code may be cached in it, to filter writes cheaply.
+    filter: Box<[u64]>,
+    /// The current block and the index of the next instruction expected to be executed in it.
+    cursor: Option<(usize, usize)>,
+}
+
+impl InstructionCache {
+    /// Creates a new empty cache.
+    pub fn new() -> Self {
+        Self {
+            blocks: Vec::new(),
+            free: Vec::new(),
+            entries: HashMap::new(),
+            pages: HashMap::new(),
+            filter: vec![0; PAGE_FILTER_BITS / 64].into_boxed_slice(),
+            cursor: None,
+        }
+    }
+
+    /// Returns the number of basic blocks currently cached.
+    pub fn block_count(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Removes every cached block.
+    pub fn clear(&mut self) {
+        self.blocks.clear();
+        self.free.clear();
+        self.entries.clear();
+        self.pages.clear();
+        self.filter.fill(0);
+        self.cursor = None;
+    }
+
+    /// Discards the blocks that contain code in the given address range.
+    pub fn invalidate(&mut self, addr: u32, len: u32) {
+        if len == 0 {
+            return;
+        }
+
+        let first = addr >> PAGE_SHIFT;
+        let last = addr.saturating_add(len - 1) >> PAGE_SHIFT;
+        for page in first..=last {
+            self.invalidate_page(page);
+        }
+    }
+
+    /// Pre-decodes the given instructions, sorted by address, so they are not decoded when first executed.
+    ///
+    /// A block starts at each [leader](CodeEntry::is_leader), after a control-flow instruction and after a gap between
+    /// two instructions. Instructions that cannot be read from memory are skipped.
+    pub fn warm<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, code: impl IntoIterator<Item = CodeEntry>) {
+        let mut current = None;
+        for entry in code {
+            if let Some(id) = current {
+                let block: &BasicBlock = &self.blocks[id];
+                if entry.addr >= block.start && entry.addr < block.end() {
+                    continue;
+                }
+                if entry.is_leader() || block.closed || block.end() != entry.addr {
+                    current = None;
+                }
+            }
+
+            if current.is_none() {
+                if let Some(&id) = self.entries.get(&entry.addr) {
+                    current = Some(id);
+                    continue;
+                }
+            }
+
+            let Ok(inst) = decode(entry.addr, memory) else {
+                current = None;
+                continue;
+            };
+            match current {
+                Some(id) => self.append(id, inst),
+                None => current = Some(self.new_block(inst)),
+            }
+        }
+    }
+
+    /// Called on each write of the core.
+    #[inline(always)]
+    pub(crate) fn notify_write(&mut self, addr: u32, size: u32) {
+        let first = addr >> PAGE_SHIFT;
+        let last = addr.wrapping_add(size - 1) >> PAGE_SHIFT;
+
+        if self.filter_contains(first) {
+            self.invalidate_page(first);
+        }
+        if last != first && self.filter_contains(last) {
+            self.invalidate_page(last);
+        }
+    }
+
+    #[inline(always)]
+    fn filter_contains(&self, page: u32) -> bool {
+        let bit = page as usize % PAGE_FILTER_BITS;
+        self.filter[bit / 64] & (1 << (bit % 64)) != 0
+    }
+
+    fn filter_insert(&mut self, page: u32) {
+        let bit = page as usize % PAGE_FILTER_BITS;
+        self.filter[bit / 64] |= 1 << (bit % 64);
+    }
+
+    fn invalidate_page(&mut self, page: u32) {
+        if let Some(ids) = self.pages.remove(&page) {
+            for id in ids {
+                self.invalidate_block(id, page);
+            }
+        }
+    }
+
+    /// Removes the given block. `page` is the page being invalidated, already removed from [Self::pages].
+    fn invalidate_block(&mut self, id: usize, page: u32) {
+        let block = std::mem::take(&mut self.blocks[id]);
+
+        if self.entries.get(&block.start) == Some(&id) {
+            self.entries.remove(&block.start);
+        }
+
+        let mut p = block.first_page;
+        loop {
+            if p != page {
+                if let Some(ids) = self.pages.get_mut(&p) {
+                    ids.retain(|&b| b != id);
+                    if ids.is_empty() {
+                        self.pages.remove(&p);
+                    }
+                }
+            }
+
+            if p == block.last_page {
+                break;
+            }
+            p = p.wrapping_add(1);
+        }
+
+        if matches!(self.cursor, Some((c, _)) if c == id) {
+            self.cursor = None;
+        }
+
+        self.free.push(id);
+    }
+
+    /// Registers the block in the pages covered by the given address range.
+    fn add_pages(&mut self, id: usize, addr: u32, next: u32) {
+        let first = addr >> PAGE_SHIFT;
+        let last = next.wrapping_sub(1).max(addr) >> PAGE_SHIFT;
+
+        let mut page = first;
+        loop {
+            let ids = self.pages.entry(page).or_default();
+            if !ids.contains(&id) {
+                ids.push(id);
+            }
+            self.filter_insert(page);
+
+            if page == last {
+                break;
+            }
+            page = page.wrapping_add(1);
+        }
+
+        let block = &mut self.blocks[id];
+        block.last_page = block.last_page.max(last);
+    }
+
+    /// Appends the instruction at the end of the given block.
+    fn append(&mut self, id: usize, inst: CachedInstruction) {
+        self.add_pages(id, inst.instruction.pc, inst.next_pc);
+
+        let block = &mut self.blocks[id];
+        block.instructions.push(inst);
+        block.closed = is_block_end(inst.isa) || block.instructions.len() >= MAX_BLOCK_LENGTH;
+    }
+
+    /// Creates a new block starting with the given instruction and returns its index.
+    fn new_block(&mut self, inst: CachedInstruction) -> usize {
+        let start = inst.instruction.pc;
+        let block = BasicBlock {
+            instructions: Vec::with_capacity(8),
+            start,
+            first_page: start >> PAGE_SHIFT,
+            last_page: start >> PAGE_SHIFT,
+            closed: false,
+            links: [NO_LINK; 2],
+        };
+
+        let id = if let Some(id) = self.free.pop() {
+            self.blocks[id] = block;
+            id
+        } else {
+            self.blocks.push(block);
+            self.blocks.len() - 1
+        };
+
+        self.entries.insert(start, id);
+        self.append(id, inst);
+        id
+    }
+
+    /// Returns the instruction at the given address, decoding it from memory if it is not cached.
+    #[inline]
+    fn fetch<M: MemoryAccess + ?Sized>(&mut self, pc: u32, memory: &mut M) -> Result<CachedInstruction, Vector> {
+        if let Some((id, index)) = self.cursor {
+            let block = &self.blocks[id];
+            if let Some(inst) = block.instructions.get(index) {
+                if inst.instruction.pc == pc {
+                    self.cursor = Some((id, index + 1));
+                    return Ok(*inst);
+                }
+            } else if !block.closed && block.end() == pc && !self.entries.contains_key(&pc) {
+                let inst = decode(pc, memory)?;
+                self.append(id, inst);
+                self.cursor = Some((id, index + 1));
+                return Ok(inst);
+            }
+        }
+
+        let previous = self.cursor.map(|(id, _)| id);
+        if let Some(prev) = previous {
+            // Invalidated blocks are empty, and a reused slot starting at the same address is the right block anyway.
+            for (start, id) in self.blocks[prev].links {
+                if start == pc {
+                    if let Some(inst) = self.blocks[id].instructions.first() {
+                        if self.blocks[id].start == pc {
+                            self.cursor = Some((id, 1));
+                            return Ok(*inst);
+                        }
+                    }
+                }
+            }
+        }
+
+        let id = if let Some(&id) = self.entries.get(&pc) {
+            id
+        } else {
+            let inst = decode(pc, memory)?;
+            self.new_block(inst)
+        };
+
+        if let Some(prev) = previous {
+            let links = &mut self.blocks[prev].links;
+            links[1] = links[0];
+            links[0] = (pc, id);
+        }
+
+        self.cursor = Some((id, 1));
+        Ok(self.blocks[id].instructions[0])
+    }
+}
+
+impl Default for InstructionCache {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl std::fmt::Debug for InstructionCache {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("InstructionCache")
+            .field("blocks", &self.entries.len())
+            .field("pages", &self.pages.len())
+            .finish()
+    }
+}
+
+/// Decodes the instruction at the given address.
+pub(crate) fn decode<M: MemoryAccess + ?Sized>(pc: u32, memory: &mut M) -> Result<CachedInstruction, Vector> {
+    let mut iter = memory.iter_u16(pc);
+    let instruction = Instruction::from_memory(&mut iter)?;
+    Ok(CachedInstruction {
+        instruction,
+        isa: Isa::from(instruction.opcode),
+        next_pc: iter.next_addr,
+    })
+}
+
+/// Returns true if the given instruction ends a basic block.
+const fn is_block_end(isa: Isa) -> bool {
+    use Isa::*;
+    matches!(isa, Unknown | Bcc | Bra | Bsr | Chk | Dbcc | Illegal | Jmp | Jsr | Reset | Rte | Rtr | Rts | Stop | Trap | Trapv)
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Enables or disables the pre-decoded instruction cache. Disabling it frees the cached instructions.
+    ///
+    /// See the [instruction_cache](crate::instruction_cache) module for the requirements of the cache.
+    pub fn set_instruction_cache(&mut self, enabled: bool) {
+        if enabled {
+            if self.instruction_cache.is_none() {
+                self.instruction_cache = Some(Box::default());
+            }
+        } else {
+            self.instruction_cache = None;
+        }
+    }
+
+    /// Returns true if the instruction cache is enabled.
+    pub fn instruction_cache_enabled(&self) -> bool {
+        self.instruction_cache.is_some()
+    }
+
+    /// Discards the cached instructions in the given address range.
+    ///
+    /// Call this function after the memory has been modified by something else than the core.
+    /// Does nothing if the cache is disabled.
+    pub fn invalidate_instruction_cache(&mut self, addr: u32, len: u32) {
+        if let Some(cache) = &mut self.instruction_cache {
+            cache.invalidate(addr, len);
+        }
+    }
+
+    /// Pre-decodes the given instructions in the instruction cache, for example from a
+    /// [CodeMap](crate::code_map::CodeMap) of the program. Does nothing if the cache is disabled.
+    ///
+    /// See [InstructionCache::warm].
+    pub fn warm_instruction_cache<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, code: impl IntoIterator<Item = CodeEntry>) {
+        if let Some(cache) = &mut self.instruction_cache {
+            cache.warm(memory, code);
+        }
+    }
+
+    /// Discards every cached instruction. Does nothing if the cache is disabled.
+    pub fn clear_instruction_cache(&mut self) {
+        if let Some(cache) = &mut self.instruction_cache {
+            cache.clear();
+        }
+    }
+
+    /// [Self::interpreter_exception] using the instruction cache.
+    pub(super) fn cached_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut CoreMemory<M>) -> (usize, Option<Vector>) {
+        let mut cycle_count = 0;
+
+        if !self.exceptions.is_empty() {
+            cycle_count += self.process_pending_exceptions(memory);
+        }
+
+        // The cache is taken out of the wrapper so the instructions are decoded through the memory map.
+        let cache = memory.cache.take().expect("cached interpreter called without cache");
+        let inst = cache.fetch(self.regs.pc.0, memory);
+        memory.cache = Some(cache);
+
+        let inst = match inst {
+            Ok(inst) => inst,
+            Err(e) => {
+                if e == Vector::AccessError {
+                    self.regs.pc += 2; // Same behaviour as get_next_word.
+                }
+                return (cycle_count, Some(e));
+            },
+        };
+        let (cycles, exception) = self.execute_cached_instruction(memory, &inst);
+        (cycle_count + cycles, exception)
+    }
+
+    /// Executes the given decoded instruction located at the current PC.
+    ///
+    /// Returns the cycle count necessary to execute it and the vector of the exception that occured if any.
+    pub(crate) fn execute_cached_instruction<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, inst: &CachedInstruction) -> (usize, Option<Vector>) {
+        self.current_opcode = inst.instruction.opcode;
+        self.regs.pc.0 = inst.next_pc;
+
+        let trace = self.regs.sr.t;
+        let result = Execute::<CPU, M>::EXECUTE[inst.isa as usize](self, memory, &inst.instruction);
+
+        self.count_instruction(&result);
+        #[cfg(feature = "profiler")]
+        self.profile_instruction(inst.isa, inst.instruction.pc, &result);
+
+        match result {
+            Ok(cycles) => {
+                if trace && !inst.isa.is_privileged() {
+                    (cycles, Some(Vector::Trace))
+                } else {
+                    (cycles, None)
+                }
+            },
+            Err(e) => (0, Some(e)),
+        }
+    }
+}
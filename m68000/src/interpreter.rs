@@ -78,7 +78,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
         }
     }
 
-    fn add<UT, ST, const ADDX: bool>(&mut self, dst: UT, src: UT) -> UT
+    pub(super) fn add<UT, ST, const ADDX: bool>(&mut self, dst: UT, src: UT) -> UT
     where
         UT: CarryingOps<ST, UT>,
         ST: Integer,
@@ -842,7 +842,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     ///
     /// https://mrjester.hapisan.com/04_MC68/Sect04Part09/Index.html
     pub(super) fn execute_divs<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, reg: u8, am: AddressingMode) -> InterpreterResult {
-        let mut exec_time = CPU::DIVS;
+        let mut exec_time = 0;
 
         let mut ea = EffectiveAddress::new(am, Some(Size::Word));
 
@@ -866,7 +866,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
             self.regs.d[reg as usize].0 = (rem as u16 as u32) << 16 | (quot as u16 as u32);
         }
 
-        Ok(exec_time)
+        Ok(exec_time + CPU::divs_execution_time(dst as u32, src as u16))
     }
 
     /// If a zero divide exception occurs, this method returns the effective address calculation time, and the
@@ -874,7 +874,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     ///
     /// https://mrjester.hapisan.com/04_MC68/Sect04Part09/Index.html
     pub(super) fn execute_divu<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, reg: u8, am: AddressingMode) -> InterpreterResult {
-        let mut exec_time = CPU::DIVU;
+        let mut exec_time = 0;
 
         let mut ea = EffectiveAddress::new(am, Some(Size::Word));
 
@@ -901,7 +901,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
             self.regs.sr.z = quot as u16 == 0;
         }
 
-        Ok(exec_time)
+        Ok(exec_time + CPU::divu_execution_time(dst, src as u16))
     }
 
     fn eor<UT>(&mut self, dst: UT, src: UT) -> UT
@@ -1277,95 +1277,49 @@ impl<CPU: CpuDetails> M68000<CPU> {
         Ok(CPU::MOVEUSP)
     }
 
-    pub(super) fn execute_movem<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, dir: Direction, size: Size, am: AddressingMode, mut list: u16) -> InterpreterResult {
+    pub(super) fn execute_movem<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, dir: Direction, size: Size, am: AddressingMode, list: u16) -> InterpreterResult {
         let count = list.count_ones() as usize;
         let mut exec_time = 0;
 
         let mut ea = EffectiveAddress::new(am, Some(size));
 
-        let gap = size as u32;
+        let len = count * size as usize;
         let eareg = ea.mode.register().unwrap_or(u8::MAX);
 
-        if ea.mode.is_ariwpr() {
-            let mut addr = self.regs.a(eareg).check_even()?; // Gap is always 2 or 4 so check for even() only once.
-
-            for reg in (0..8).rev() {
-                if list & 1 != 0 {
-                    addr = addr.wrapping_sub(gap);
-                    if size.is_word() {
-                        memory.set_word(addr, self.regs.a(reg) as u16).ok_or(AccessError)?;
-                    } else {
-                        memory.set_long(addr, self.regs.a(reg)).ok_or(AccessError)?;
-                    }
-                }
-
-                list >>= 1;
-            }
+        // The registers are transferred in a single block, D0 to D7 then A0 to A7 at increasing addresses.
+        let mut block = [0; 64];
+        let block = &mut block[..len];
 
-            for reg in (0..8).rev() {
-                if list & 1 != 0 {
-                    addr = addr.wrapping_sub(gap);
-                    if size.is_word() {
-                        memory.set_word(addr, self.regs.d[reg].0 as u16).ok_or(AccessError)?;
-                    } else {
-                        memory.set_long(addr, self.regs.d[reg].0).ok_or(AccessError)?;
-                    }
-                }
+        if ea.mode.is_ariwpr() {
+            let addr = self.regs.a(eareg).check_even()?.wrapping_sub(len as u32);
 
-                list >>= 1;
+            if count > 0 {
+                // The list is reversed in predecrement mode (bit 0 is A7).
+                self.movem_registers_to_block(list.reverse_bits(), size, block);
+                memory.set_block(addr, block).ok_or(AccessError)?;
             }
 
             self.regs.a_mut(eareg).0 = addr;
         } else {
-            let mut addr = if ea.mode.is_ariwpo() {
+            let addr = if ea.mode.is_ariwpo() {
                 self.regs.a(eareg)
             } else {
                 self.get_effective_address(&mut ea, &mut exec_time)
             }
             .check_even()?;
 
-            for reg in 0..8 {
-                if list & 1 != 0 {
-                    if dir == Direction::MemoryToRegister {
-                        self.regs.d[reg].0 = if size.is_word() {
-                            memory.get_word(addr).ok_or(AccessError)? as i16 as u32
-                        } else {
-                            memory.get_long(addr).ok_or(AccessError)?
-                        };
-                    } else if size.is_word() {
-                        memory.set_word(addr, self.regs.d[reg].0 as u16).ok_or(AccessError)?;
-                    } else {
-                        memory.set_long(addr, self.regs.d[reg].0).ok_or(AccessError)?;
-                    }
-
-                    addr = addr.wrapping_add(gap);
-                }
-
-                list >>= 1;
-            }
-
-            for reg in 0..8 {
-                if list & 1 != 0 {
-                    if dir == Direction::MemoryToRegister {
-                        self.regs.a_mut(reg).0 = if size.is_word() {
-                            memory.get_word(addr).ok_or(AccessError)? as i16 as u32
-                        } else {
-                            memory.get_long(addr).ok_or(AccessError)?
-                        };
-                    } else if size.is_word() {
-                        memory.set_word(addr, self.regs.a(reg) as u16).ok_or(AccessError)?;
-                    } else {
-                        memory.set_long(addr, self.regs.a(reg)).ok_or(AccessError)?;
-                    }
-
-                    addr = addr.wrapping_add(gap);
+            if count > 0 {
+                if dir == Direction::MemoryToRegister {
+                    memory.get_block(addr, block).ok_or(AccessError)?;
+                    self.movem_block_to_registers(list, size, block);
+                } else {
+                    self.movem_registers_to_block(list, size, block);
+                    memory.set_block(addr, block).ok_or(AccessError)?;
                 }
-
-                list >>= 1;
             }
 
             if ea.mode.is_ariwpo() {
-                self.regs.a_mut(eareg).0 = addr;
+                self.regs.a_mut(eareg).0 = addr.wrapping_add(len as u32);
             }
         }
 
@@ -1387,6 +1341,40 @@ impl<CPU: CpuDetails> M68000<CPU> {
         Ok(exec_time + count * if size.is_long() { CPU::MOVEM_LONG } else { CPU::MOVEM_WORD })
     }
 
+    /// Writes the registers of the MOVEM list (bit 0 is D0, bit 15 is A7) in `block`, in big-endian format.
+    fn movem_registers_to_block(&self, mut list: u16, size: Size, block: &mut [u8]) {
+        for chunk in block.chunks_exact_mut(size as usize) {
+            let reg = list.trailing_zeros() as u8;
+            list &= list - 1;
+
+            let value = if reg < 8 { self.regs.d[reg as usize].0 } else { self.regs.a(reg - 8) };
+            if size.is_word() {
+                chunk.copy_from_slice(&(value as u16).to_be_bytes());
+            } else {
+                chunk.copy_from_slice(&value.to_be_bytes());
+            }
+        }
+    }
+
+    /// Loads the registers of the MOVEM list (bit 0 is D0, bit 15 is A7) from `block`. Words are sign-extended.
+    fn movem_block_to_registers(&mut self, mut list: u16, size: Size, block: &[u8]) {
+        for chunk in block.chunks_exact(size as usize) {
+            let reg = list.trailing_zeros() as u8;
+            list &= list - 1;
+
+            let value = if size.is_word() {
+                i16::from_be_bytes([chunk[0], chunk[1]]) as u32
+            } else {
+                u32::from_be_bytes([chunk[0], chunk[1], chunk[2], chunk[3]])
+            };
+            if reg < 8 {
+                self.regs.d[reg as usize].0 = value;
+            } else {
+                self.regs.a_mut(reg - 8).0 = value;
+            }
+        }
+    }
+
     pub(super) fn execute_movep<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, data: u8, dir: Direction, size: Size, addr: u8, disp: i16) -> InterpreterResult {
         let mut shift = if size.is_word() { 8 } else { 24 };
         let mut addr = Wrapping(self.regs.a(addr).wrapping_add(disp as u32));
@@ -2023,7 +2011,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 
     /// Performs dst - src.
-    fn sub<UT, ST, const SUBX: bool, const CMP: bool>(&mut self, dst: UT, src: UT) -> UT
+    pub(super) fn sub<UT, ST, const SUBX: bool, const CMP: bool>(&mut self, dst: UT, src: UT) -> UT
     where
         UT: CarryingOps<ST, UT>,
         ST: Integer,
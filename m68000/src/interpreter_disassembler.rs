@@ -7,6 +7,7 @@ use crate::exception::{Exception, Vector};
 use crate::instruction::Instruction;
 use crate::interpreter::InterpreterResult;
 use crate::isa::Isa;
+use crate::trace::{TraceRecord, TraceRing};
 
 impl<CPU: CpuDetails> M68000<CPU> {
     /// Returns the instruction at the current Program Counter and advances it to the next instruction.
@@ -43,10 +44,58 @@ impl<CPU: CpuDetails> M68000<CPU> {
     ///
     /// See [Self::interpreter_exception] for the potential caveat.
     pub fn disassembler_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> (u32, String, usize, Option<Vector>) {
+        let (instruction, cycles, exception) = self.trace_interpreter_exception(memory);
+        match instruction {
+            Some(inst) => (inst.pc, inst.disassemble(), cycles, exception),
+            None => (0, String::from(""), cycles, exception),
+        }
+    }
+
+    /// Runs the interpreter loop once and records the next instruction in the given trace ring buffer if any.
+    ///
+    /// Returns the cycle count necessary to execute the instruction.
+    /// The exception that occured during the execution is processed, and also stored in the trace record.
+    ///
+    /// See [Self::interpreter] for the potential caveat.
+    pub fn trace_interpreter<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, trace: &mut TraceRing) -> usize {
+        let (instruction, cycles, exception) = self.trace_interpreter_exception(memory);
+        if let Some(instruction) = instruction {
+            trace.push(TraceRecord { instruction, cycles, exception });
+        }
+        if let Some(e) = exception {
+            self.exception(Exception::from(e));
+        }
+        cycles
+    }
+
+    /// Runs the interpreter loop once and returns the instruction that has been executed, without disassembling it.
+    ///
+    /// Returns the instruction that has been executed if any, the cycle count necessary to execute it,
+    /// and the vector of the exception that occured during the execution if any.
+    ///
+    /// This does not allocate, the instruction can be disassembled later with [Instruction::disassemble_to].
+    ///
+    /// To process the returned exception, call [M68000::exception].
+    ///
+    /// See [Self::interpreter_exception] for the potential caveat.
+    pub fn trace_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> (Option<Instruction>, usize, Option<Vector>) {
         if self.stop {
-            return (0, String::from(""), 0, None);
+            return (None, 0, None);
         }
 
+        // The instructions are not taken from the cache or the prefetch window, but the writes still have to invalidate them.
+        let (instruction, cycles, vector) = if self.instruction_cache.is_some() || self.memory_map.is_some() || self.prefetch.is_some() {
+            self.with_core_memory(memory, |cpu, memory| cpu.trace_interpreter_exception_inner(memory, |_, _| ()))
+        } else {
+            self.with_counted_memory(memory, |cpu, memory| cpu.trace_interpreter_exception_inner(memory, |_, _| ()))
+        };
+
+        (instruction, cycles + self.take_wait_cycles(memory), vector)
+    }
+
+    /// `decoded` is called after the instruction has been read, with the memory and the length of the instruction in
+    /// words, before it is executed.
+    pub(crate) fn trace_interpreter_exception_inner<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, decoded: impl FnOnce(&mut M, usize)) -> (Option<Instruction>, usize, Option<Vector>) {
         let mut cycle_count = 0;
 
         if !self.exceptions.is_empty() {
@@ -55,15 +104,21 @@ impl<CPU: CpuDetails> M68000<CPU> {
 
         let instruction = match self.get_next_instruction(memory) {
             Ok(i) => i,
-            Err(e) => return (0, String::from(""), cycle_count, Some(e)),
+            Err(e) => return (None, cycle_count, Some(e)),
         };
+        decoded(memory, (self.regs.pc.0.wrapping_sub(instruction.pc) / 2) as usize);
 
         self.current_opcode = instruction.opcode;
         let isa = Isa::from(instruction.opcode);
 
-        let dis = instruction.disassemble();
         let trace = self.regs.sr.t;
-        let exception = match Execute::<CPU, M>::EXECUTE[isa as usize](self, memory, &instruction) {
+        let result = Execute::<CPU, M>::EXECUTE[isa as usize](self, memory, &instruction);
+
+        self.count_instruction(&result);
+        #[cfg(feature = "profiler")]
+        self.profile_instruction(isa, instruction.pc, &result);
+
+        let exception = match result {
             Ok(cycles) => {
                 cycle_count += cycles;
                 if trace && !isa.is_privileged() {
@@ -75,7 +130,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
             Err(e) => Some(e),
         };
 
-        (instruction.pc, dis, cycle_count, exception)
+        (Some(instruction), cycle_count, exception)
     }
 
     fn instruction_unknown_instruction<M: MemoryAccess + ?Sized>(&mut self, _: &mut M, _: &Instruction) -> InterpreterResult {
@@ -502,14 +557,14 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 }
 
-struct Execute<E: CpuDetails, M: MemoryAccess + ?Sized> {
+pub(crate) struct Execute<E: CpuDetails, M: MemoryAccess + ?Sized> {
     _e: E,
     _m: M,
 }
 
 impl<E: CpuDetails, M: MemoryAccess + ?Sized> Execute<E, M> {
     /// Function used to execute the instruction.
-    const EXECUTE: [fn(&mut M68000<E>, &mut M, &Instruction) -> InterpreterResult; Isa::_Size as usize] = [
+    pub(crate) const EXECUTE: [fn(&mut M68000<E>, &mut M, &Instruction) -> InterpreterResult; Isa::_Size as usize] = [
         M68000::instruction_unknown_instruction,
         M68000::instruction_abcd,
         M68000::instruction_add,
@@ -7,6 +7,8 @@ use crate::exception::{Exception, Vector};
 use crate::instruction::*;
 use crate::interpreter::InterpreterResult;
 use crate::isa::Isa;
+use crate::memory_access::CoreMemory;
+use crate::utils::{CarryingOps, Integer, RegisterOperand};
 
 impl<CPU: CpuDetails> M68000<CPU> {
     /// Runs the CPU for **at least** the given number of cycles.
@@ -18,11 +20,44 @@ impl<CPU: CpuDetails> M68000<CPU> {
     pub fn cycle<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, cycles: usize) -> usize {
         let mut total = 0;
 
+        #[cfg(feature = "block-exec")]
+        if self.instruction_cache.is_some() && self.hooks.is_none() {
+            while total < cycles {
+                let (c, vector) = self.run_cached_blocks(memory, cycles - total);
+                total += c;
+
+                if let Some(e) = vector {
+                    self.exception(Exception::from(e));
+                }
+
+                if self.stop {
+                    return self.count_stopped(total, cycles);
+                }
+            }
+
+            return total;
+        }
+
         while total < cycles {
+            let pc = self.regs.pc.0;
             total += self.interpreter(memory);
 
             if self.stop {
-                return cycles;
+                // The time passes while stopped by a STOP instruction, but not while stopped by a hook.
+                return if self.hook_event().is_some() { total } else { self.count_stopped(total, cycles) };
+            }
+
+            if self.idle_detection.is_some() && total < cycles {
+                let (c, vector) = self.skip_idle_loop(memory, pc, cycles - total);
+                total += c;
+
+                if let Some(e) = vector {
+                    self.exception(Exception::from(e));
+                }
+
+                if self.stop {
+                    return self.count_stopped(total, cycles);
+                }
             }
         }
 
@@ -37,15 +72,30 @@ impl<CPU: CpuDetails> M68000<CPU> {
     /// and 6 is returned, along with the vector that occured if any.
     /// It is the caller's responsibility to handle the extra cycles.
     pub fn cycle_until_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, cycles: usize) -> (usize, Option<Vector>) {
+        #[cfg(feature = "block-exec")]
+        if self.instruction_cache.is_some() && self.hooks.is_none() {
+            return self.run_cached_blocks(memory, cycles);
+        }
+
         let mut total = 0;
 
         while total < cycles {
+            let pc = self.regs.pc.0;
             let (c, v) = self.interpreter_exception(memory);
             total += c;
 
             if v.is_some() || self.stop {
                 return (total, v);
             }
+
+            if self.idle_detection.is_some() && total < cycles {
+                let (c, v) = self.skip_idle_loop(memory, pc, cycles - total);
+                total += c;
+
+                if v.is_some() || self.stop {
+                    return (total, v);
+                }
+            }
         }
 
         (total, None)
@@ -56,6 +106,11 @@ impl<CPU: CpuDetails> M68000<CPU> {
     /// Returns the number of cycles executed and the exception that occured.
     /// If exception is None, this means the CPU has executed a STOP instruction.
     pub fn loop_until_exception_stop<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> (usize, Option<Vector>) {
+        #[cfg(feature = "block-exec")]
+        if self.instruction_cache.is_some() && self.hooks.is_none() {
+            return self.run_cached_blocks(memory, usize::MAX);
+        }
+
         let mut total_cycles = 0;
 
         loop {
@@ -96,12 +151,48 @@ impl<CPU: CpuDetails> M68000<CPU> {
             return (0, None);
         }
 
+        if self.hooks.is_some() {
+            return self.hooked_interpreter_exception(memory);
+        }
+
+        let (cycles, vector) = if self.instruction_cache.is_some() || self.memory_map.is_some() || self.prefetch.is_some() {
+            self.with_core_memory(memory, Self::core_memory_interpreter_exception)
+        } else {
+            self.with_counted_memory(memory, |cpu, memory| cpu.interpreter_exception_inner(memory))
+        };
+
+        (cycles + self.take_wait_cycles(memory), vector)
+    }
+
+    /// [Self::interpreter_exception] with the memory wrapped in a [CoreMemory], using the instruction cache or the
+    /// prefetch window if enabled.
+    pub(super) fn core_memory_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut CoreMemory<M>) -> (usize, Option<Vector>) {
+        if memory.cache.is_some() {
+            return self.cached_interpreter_exception(memory);
+        }
+
+        let mut cycle_count = 0;
+        if memory.prefetch.is_some() {
+            // Process the exceptions first, so the window is filled at the first instruction of the handler.
+            if !self.exceptions.is_empty() {
+                cycle_count += self.process_pending_exceptions(memory);
+            }
+            self.fill_prefetch(memory);
+        }
+
+        let (cycles, vector) = self.interpreter_exception_inner(memory);
+        (cycle_count + cycles, vector)
+    }
+
+    fn interpreter_exception_inner<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> (usize, Option<Vector>) {
         let mut cycle_count = 0;
 
         if !self.exceptions.is_empty() {
             cycle_count += self.process_pending_exceptions(memory);
         }
 
+        #[cfg(feature = "profiler")]
+        let pc = self.regs.pc.0;
         let opcode = match self.get_next_word(memory) {
             Ok(op) => op,
             Err(e) => return (cycle_count, Some(e)),
@@ -110,7 +201,13 @@ impl<CPU: CpuDetails> M68000<CPU> {
         let isa = Isa::from(opcode);
 
         let trace = self.regs.sr.t;
-        let exception = match Execute::<CPU, M>::EXECUTE[isa as usize](self, memory) {
+        let result = Execute::<CPU, M>::EXECUTE[isa as usize](self, memory);
+
+        self.count_instruction(&result);
+        #[cfg(feature = "profiler")]
+        self.profile_instruction(isa, pc, &result);
+
+        let exception = match result {
             Ok(cycles) => {
                 cycle_count += cycles;
                 if trace && !isa.is_privileged() {
@@ -135,6 +232,15 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 
     fn fast_add<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> InterpreterResult {
+        // ADD Dn/An, Dn.
+        if self.current_opcode & 0o460 == 0 {
+            return match self.current_opcode >> 6 & 3 {
+                0 => self.register_add::<u8, i8>(CPU::ADD_REG_BW),
+                1 => self.register_add::<u16, i16>(CPU::ADD_REG_BW),
+                _ => self.register_add::<u32, i32>(CPU::ADD_REG_L_RDIMM),
+            };
+        }
+
         let mut iter = self.iter_from_pc(memory);
         let (reg, dir, size, am) = register_direction_size_effective_address(self.current_opcode, &mut iter);
         self.regs.pc.0 = iter.next_addr;
@@ -276,6 +382,15 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 
     fn fast_cmp<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> InterpreterResult {
+        // CMP Dn/An, Dn.
+        if self.current_opcode & 0o060 == 0 {
+            return match self.current_opcode >> 6 & 3 {
+                0 => self.register_sub::<u8, i8, true>(CPU::CMP_BW),
+                1 => self.register_sub::<u16, i16, true>(CPU::CMP_BW),
+                _ => self.register_sub::<u32, i32, true>(CPU::CMP_L),
+            };
+        }
+
         let mut iter = self.iter_from_pc(memory);
         let (reg, _, size, am) = register_direction_size_effective_address(self.current_opcode, &mut iter);
         self.regs.pc.0 = iter.next_addr;
@@ -410,6 +525,15 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 
     fn fast_move<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> InterpreterResult {
+        // MOVE Dn/An, Dn.
+        if self.current_opcode & 0o760 == 0 {
+            return match self.current_opcode >> 12 {
+                1 => self.register_move::<u8>(),
+                3 => self.register_move::<u16>(),
+                _ => self.register_move::<u32>(),
+            };
+        }
+
         let mut iter = self.iter_from_pc(memory);
         let (size, amdst, amsrc) = size_effective_address_effective_address(self.current_opcode, &mut iter);
         self.regs.pc.0 = iter.next_addr;
@@ -609,6 +733,15 @@ impl<CPU: CpuDetails> M68000<CPU> {
     }
 
     fn fast_sub<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> InterpreterResult {
+        // SUB Dn/An, Dn.
+        if self.current_opcode & 0o460 == 0 {
+            return match self.current_opcode >> 6 & 3 {
+                0 => self.register_sub::<u8, i8, false>(CPU::SUB_REG_BW),
+                1 => self.register_sub::<u16, i16, false>(CPU::SUB_REG_BW),
+                _ => self.register_sub::<u32, i32, false>(CPU::SUB_REG_L_RDIMM),
+            };
+        }
+
         let mut iter = self.iter_from_pc(memory);
         let (reg, dir, size, am) = register_direction_size_effective_address(self.current_opcode, &mut iter);
         self.regs.pc.0 = iter.next_addr;
@@ -673,8 +806,73 @@ impl<CPU: CpuDetails> M68000<CPU> {
         let reg = register(self.current_opcode);
         self.execute_unlk(memory, reg)
     }
+
+    // Register to register MOVE, ADD, SUB and CMP are the most frequent instructions, so they are executed by
+    // handlers monomorphized on the operand size, which read their operands directly from the opcode.
+    // The timings are the constants of the CPU, as register direct addressing modes have no calculation time.
+    // They must behave exactly like the corresponding execute_* methods.
+
+    /// Returns the register direct source operand (Dn or An) in the lower 4 bits of the opcode.
+    #[inline(always)]
+    fn register_source<T: RegisterOperand>(&self) -> T {
+        let reg = self.current_opcode as u8 & 7;
+        if self.current_opcode & 0o10 == 0 {
+            T::from_register(self.regs.d[reg as usize].0)
+        } else {
+            T::from_register(self.regs.a(reg))
+        }
+    }
+
+    /// Returns the data register in bits 9 to 11 of the opcode.
+    #[inline(always)]
+    fn register_destination(&self) -> usize {
+        (self.current_opcode >> 9 & 7) as usize
+    }
+
+    fn register_move<T: RegisterOperand>(&mut self) -> InterpreterResult {
+        let d: T = self.register_source();
+        let reg = self.register_destination();
+        self.regs.d[reg].0 = d.into_register(self.regs.d[reg].0);
+
+        self.regs.sr.n = d & T::SIGN_BIT_MASK != T::ZERO;
+        self.regs.sr.z = d == T::ZERO;
+        self.regs.sr.v = false;
+        self.regs.sr.c = false;
+
+        Ok(CPU::MOVE_OTHER)
+    }
+
+    fn register_add<UT, ST>(&mut self, exec_time: usize) -> InterpreterResult
+    where
+        UT: RegisterOperand + CarryingOps<ST, UT>,
+        ST: Integer,
+    {
+        let src: UT = self.register_source();
+        let reg = self.register_destination();
+        let res = self.add::<UT, ST, false>(UT::from_register(self.regs.d[reg].0), src);
+        self.regs.d[reg].0 = res.into_register(self.regs.d[reg].0);
+
+        Ok(exec_time)
+    }
+
+    fn register_sub<UT, ST, const CMP: bool>(&mut self, exec_time: usize) -> InterpreterResult
+    where
+        UT: RegisterOperand + CarryingOps<ST, UT>,
+        ST: Integer,
+    {
+        let src: UT = self.register_source();
+        let reg = self.register_destination();
+        let res = self.sub::<UT, ST, false, CMP>(UT::from_register(self.regs.d[reg].0), src);
+        if !CMP {
+            self.regs.d[reg].0 = res.into_register(self.regs.d[reg].0);
+        }
+
+        Ok(exec_time)
+    }
 }
 
+type ExecuteFn<E, M> = fn(&mut M68000<E>, &mut M) -> InterpreterResult;
+
 struct Execute<E: CpuDetails, M: MemoryAccess + ?Sized> {
     _e: E,
     _m: M,
@@ -682,7 +880,7 @@ struct Execute<E: CpuDetails, M: MemoryAccess + ?Sized> {
 
 impl<E: CpuDetails, M: MemoryAccess + ?Sized> Execute<E, M> {
     /// Function used to execute the instruction.
-    const EXECUTE: [fn(&mut M68000<E>, &mut M) -> InterpreterResult; Isa::_Size as usize] = [
+    const EXECUTE: [ExecuteFn<E, M>; Isa::_Size as usize] = [
         M68000::fast_unknown_instruction,
         M68000::fast_abcd,
         M68000::fast_add,
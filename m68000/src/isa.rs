@@ -4,7 +4,7 @@
 
 //! ISA definition and helper structs to decode, disassemble and interpret (internal only) the instructions.
 
-use crate::decoder::DECODER;
+use crate::decoder::decode;
 use crate::memory_access::{MemoryAccess, MemoryIter};
 use crate::instruction::*;
 
@@ -114,7 +114,7 @@ impl Isa {
 impl From<u16> for Isa {
     /// Returns the instruction represented by the given opcode.
     fn from(opcode: u16) -> Self {
-        DECODER[opcode as usize]
+        decode(opcode)
     }
 }
 
@@ -30,7 +30,7 @@
 //!
 //! # How to use
 //!
-//! m68000 requires a nightly compiler as it uses the `btree_extract_if` and `bigint_helper_methods` features of the std.
+//! m68000 requires a nightly compiler as it uses the `bigint_helper_methods` feature of the std.
 //!
 //! First, since the memory map is application-dependant, it is the user's responsibility to define it by implementing
 //! the `MemoryAccess` trait on their memory structure, and passing it to the core on each instruction execution.
@@ -68,6 +68,11 @@
 //! }
 //! ```
 //!
+//! ## Wait states
+//!
+//! Memory accesses can take extra cycles by implementing [MemoryAccess::take_wait_cycles]. The memory system counts the
+//! wait states of the accesses it serves, and the interpreter adds them to the execution time of each instruction.
+//!
 //! ## FFI and C interface
 //!
 //! By enabling the `ffi` feature, the following structs and enums are made `repr(C)`:
@@ -88,36 +93,60 @@
 //!
 //! ## Potential issues
 //! - DIVS/DIVU may not always procuce the correct CCR flags when an overflow occured.
-//! - DIVS/DIVU always execute using their maximum execution time.
+//! - DIVS/DIVU always execute using their maximum execution time on the SCC68070.
 //! - Long exception stack frame writes the current opcode and fills the other information with 0.
-//!
-//! ## TODO
-//! - Let memory access return extra read or write cycles for accuracy.
 
 #![feature(bigint_helper_methods)]
-#![feature(btree_extract_if)]
 
 pub mod addressing_modes;
 pub mod assembler;
+pub mod binary_trace;
+pub mod code_map;
+pub mod counters;
 pub mod decoder;
 pub mod disassembler;
 pub mod exception;
+pub mod fuzz;
 pub mod cpu_details;
+pub mod hooks;
+pub mod idle;
 pub mod instruction;
+pub mod instruction_cache;
 mod interpreter;
 mod interpreter_disassembler;
 mod interpreter_fast;
 pub mod isa;
+#[cfg(feature = "block-exec")]
+mod block_exec;
+pub mod lockstep;
 pub mod memory_access;
+pub mod memory_map;
+pub mod multi_cpu;
+pub mod pool;
+pub mod prefetch;
+#[cfg(feature = "profiler")]
+pub mod profiler;
+pub mod replay;
+pub mod rom;
+pub mod scheduler;
+pub mod state;
 pub mod status_register;
+pub mod trace;
 pub mod utils;
 
-use exception::{Exception, Vector};
+use counters::Counters;
+use exception::{Exception, PendingExceptions, Vector};
 pub use cpu_details::{CpuDetails, StackFormat};
+use hooks::Hooks;
+use idle::IdleDetection;
+use instruction_cache::InstructionCache;
 pub use memory_access::MemoryAccess;
+use memory_map::MemoryMap;
+use prefetch::Prefetch;
+#[cfg(feature = "profiler")]
+use profiler::Profile;
 use status_register::StatusRegister;
 
-use std::collections::BTreeSet;
 use std::num::Wrapping;
 
 /// M68000 registers.
@@ -206,10 +235,25 @@ pub struct M68000<CPU: CpuDetails> {
 
     /// The opcode of the instruction currently executing. Stored because it is an information of the long exception stack frame.
     current_opcode: u16,
-    /// True if the CPU is stopped (after a STOP instruction), false to switch back to normal instruction execution.
+    /// True if the CPU is stopped (after a STOP instruction or by a [hook](hooks)), false to switch back to normal instruction execution.
     pub stop: bool,
-    /// The pending exceptions. Low priority are popped first (MC68000UM 6.2.3 Multiple Exceptions).
-    exceptions: BTreeSet<Exception>,
+    /// The pending exceptions. Low priority are processed first (MC68000UM 6.2.3 Multiple Exceptions).
+    exceptions: PendingExceptions,
+    /// The pre-decoded instruction cache, `None` when disabled.
+    instruction_cache: Option<Box<InstructionCache>>,
+    /// The host memory pages accessed directly by the core, `None` when nothing has been mapped.
+    memory_map: Option<Box<MemoryMap>>,
+    /// The idle loop detection state, `None` when disabled.
+    idle_detection: Option<IdleDetection>,
+    /// The execution hooks, `None` when no hook is registered.
+    hooks: Option<Box<Hooks>>,
+    /// The instruction prefetch window, `None` when disabled.
+    prefetch: Option<Box<Prefetch>>,
+    /// The profiler counters, `None` when disabled.
+    #[cfg(feature = "profiler")]
+    profile: Option<Box<Profile>>,
+    /// The always-on performance counters.
+    counters: Counters,
     /// The details of the emulated CPU.
     _cpu: CPU,
 }
@@ -238,7 +282,15 @@ impl<CPU: CpuDetails> M68000<CPU> {
 
             current_opcode: 0xFFFF,
             stop: false,
-            exceptions: BTreeSet::new(),
+            exceptions: PendingExceptions::new(),
+            instruction_cache: None,
+            memory_map: None,
+            idle_detection: None,
+            hooks: None,
+            prefetch: None,
+            #[cfg(feature = "profiler")]
+            profile: None,
+            counters: Counters::new(),
             _cpu: CPU::default(),
         }
     }
@@ -0,0 +1,116 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Lockstep execution of many cores running the same program with different data.
+//!
+//! [Lockstep::run] executes a set of [Job]s (lanes) one instruction at a time each, in rounds. The instructions are
+//! fetched and decoded once per round for all the lanes that are at the same PC, then each lane executes the decoded
+//! instruction on its own registers and memory. Lanes whose control flow diverges are simply at another PC in the next
+//! rounds, and share their decoding again with the lanes that reach the same address.
+//!
+//! This is intended for differential testing and Monte Carlo runs of the same firmware, where most lanes execute the
+//! same code. Because the code is decoded from the memory of the first lane that reaches an address, **the code must be
+//! identical in the memories of all the lanes**, typically a ROM image shared by every memory. The wait states of the
+//! instruction fetches are only counted for the lane that decoded the instruction.
+//!
+//! The execution times and exceptions of each lane are the same as [M68000::cycle_until_exception].
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+use crate::instruction_cache::{CachedInstruction, decode};
+use crate::pool::Job;
+
+/// Runs several cores in lockstep, sharing the decoding of their instructions.
+///
+/// The buffers used by a run are kept between runs, so [Self::run] does not allocate once they have grown.
+#[derive(Clone, Debug, Default)]
+pub struct Lockstep {
+    /// The lanes still running in the current run, with the cycle count at which they end.
+    active: Vec<(usize, usize)>,
+    /// The instructions decoded in the current round, with their address.
+    decoded: Vec<(u32, CachedInstruction)>,
+}
+
+impl Lockstep {
+    /// Creates a new lockstep runner.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Runs each job until either an exception occurs or **at least** the given number of cycles have been executed.
+    ///
+    /// The cycles executed are added to the `cycles` member of each job, and its `exception` member is set to the
+    /// vector that occured if any, like the return value of [M68000::cycle_until_exception].
+    /// Stopped cores do not execute anything.
+    pub fn run<CPU: CpuDetails, M: MemoryAccess + ?Sized>(&mut self, jobs: &mut [Job<CPU, M>], cycles: usize) {
+        let Self { active, decoded } = self;
+
+        active.clear();
+        for (i, job) in jobs.iter_mut().enumerate() {
+            job.exception = None;
+            if !job.cpu.stop {
+                active.push((i, job.cycles + cycles));
+            }
+        }
+
+        while !active.is_empty() {
+            decoded.clear();
+
+            active.retain(|&(i, end)| {
+                let job = &mut jobs[i];
+                let (cycles, vector) = job.cpu.lockstep_interpreter_exception(job.memory, decoded);
+                job.cycles += cycles;
+                job.exception = vector;
+
+                vector.is_none() && !job.cpu.stop && job.cycles < end
+            });
+        }
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// [Self::interpreter_exception] that looks up the instruction at the current PC in `decoded`
+    /// before decoding it, and adds it to `decoded` when it is not found.
+    fn lockstep_interpreter_exception<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, decoded: &mut Vec<(u32, CachedInstruction)>) -> (usize, Option<Vector>) {
+        if self.hooks.is_some() {
+            return self.interpreter_exception(memory);
+        }
+
+        let (cycles, vector) = if self.instruction_cache.is_some() || self.memory_map.is_some() || self.prefetch.is_some() {
+            self.with_core_memory(memory, |cpu, memory| cpu.lockstep_interpreter_exception_inner(memory, decoded))
+        } else {
+            self.with_counted_memory(memory, |cpu, memory| cpu.lockstep_interpreter_exception_inner(memory, decoded))
+        };
+
+        (cycles + self.take_wait_cycles(memory), vector)
+    }
+
+    fn lockstep_interpreter_exception_inner<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, decoded: &mut Vec<(u32, CachedInstruction)>) -> (usize, Option<Vector>) {
+        let mut cycle_count = 0;
+
+        if !self.exceptions.is_empty() {
+            cycle_count += self.process_pending_exceptions(memory);
+        }
+
+        let pc = self.regs.pc.0;
+        let inst = match decoded.iter().find(|(addr, _)| *addr == pc) {
+            Some((_, inst)) => *inst,
+            None => match decode(pc, memory) {
+                Ok(inst) => {
+                    decoded.push((pc, inst));
+                    inst
+                },
+                Err(e) => {
+                    if e == Vector::AccessError {
+                        self.regs.pc += 2; // Same behaviour as get_next_word.
+                    }
+                    return (cycle_count, Some(e));
+                },
+            },
+        };
+
+        let (cycles, exception) = self.execute_cached_instruction(memory, &inst);
+        (cycle_count + cycles, exception)
+    }
+}
@@ -6,8 +6,13 @@
 
 use crate::{CpuDetails, M68000};
 use crate::addressing_modes::{EffectiveAddress, AddressingMode};
+use crate::counters::CountedMemory;
 use crate::exception::Vector;
+use crate::hooks::Hooks;
 use crate::instruction::Size;
+use crate::instruction_cache::InstructionCache;
+use crate::memory_map::MemoryMap;
+use crate::prefetch::Prefetch;
 use crate::utils::IsEven;
 
 /// Return type of M68000's read memory methods. `Err(Vector::AddressError or AccessError as u8)` if an address or
@@ -26,7 +31,7 @@ type SetResult = Result<(), Vector>;
 /// For word and long accesses, the address is guaranted to be even (16-bits word aligned),
 /// as odd addresses are detected by the library and automatically trigger an Address Error.
 ///
-/// The trait is implemented for `[u8]`, `&[u8]`, `[u16]` and `&[u16]`, interpreted as big-endian.
+/// The trait is implemented for `[u8]`, `&[u8]`, `[u16]` and `&[u16]`, interpreted as big-endian, and for `&mut M`.
 /// A call of a `set_XXXX` method on a non-mutable slice panics.
 pub trait MemoryAccess {
     /// Returns a 8-bits integer from the given address.
@@ -62,6 +67,32 @@ pub trait MemoryAccess {
         self.set_word(addr.wrapping_add(2), value as u16)
     }
 
+    /// Reads `data.len()` consecutive bytes starting at the given address.
+    ///
+    /// Used by the instructions that transfer several values at once (MOVEM), so memory systems behind a costly
+    /// interface can serve them in a single call. The address and the length are guaranteed to be even, and the length
+    /// is not 0.
+    /// The order of the accesses inside the block is not specified.
+    ///
+    /// The default implementation is doing a call to [Self::get_word] for each word of the block.
+    #[must_use]
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        get_block_words(self, addr, data)
+    }
+
+    /// Stores `data.len()` consecutive bytes starting at the given address.
+    ///
+    /// Used by the instructions that transfer several values at once (MOVEM), so memory systems behind a costly
+    /// interface can serve them in a single call. The address and the length are guaranteed to be even, and the length
+    /// is not 0.
+    /// The order of the accesses inside the block is not specified.
+    ///
+    /// The default implementation is doing a call to [Self::set_word] for each word of the block.
+    #[must_use]
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        set_block_words(self, addr, data)
+    }
+
     /// Not meant to be overridden.
     /// Returns a [MemoryIter] starting at the given address that will be used to decode instructions.
     #[must_use]
@@ -69,8 +100,58 @@ pub trait MemoryAccess {
         MemoryIter { memory: self, next_addr: addr }
     }
 
+    /// Not meant to be overridden.
+    /// Returns the word at the given address if it is in the prefetch window of the core, without accessing the memory.
+    #[doc(hidden)]
+    #[must_use]
+    fn prefetched_word(&self, _: u32) -> Option<u16> {
+        None
+    }
+
     /// Called when the CPU executes a RESET instruction.
     fn reset_instruction(&mut self);
+
+    /// Returns the extra cycles (wait states) spent by the memory accesses since the last call, and resets the count to 0.
+    ///
+    /// The interpreter methods call it after each instruction or exception processing and add the returned cycles
+    /// to the execution time, so slow memories and peripherals get accurate timings without having to run the core
+    /// with small cycle budgets.
+    ///
+    /// The default implementation returns 0, for memory systems without wait states.
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        0
+    }
+}
+
+/// Reads the block with one [MemoryAccess::get_word] per word.
+pub(crate) fn get_block_words<M: MemoryAccess + ?Sized>(memory: &mut M, addr: u32, data: &mut [u8]) -> Option<()> {
+    let mut addr = addr;
+    for word in data.chunks_exact_mut(2) {
+        word.copy_from_slice(&memory.get_word(addr)?.to_be_bytes());
+        addr = addr.wrapping_add(2);
+    }
+    Some(())
+}
+
+/// Writes the block with one [MemoryAccess::set_word] per word.
+pub(crate) fn set_block_words<M: MemoryAccess + ?Sized>(memory: &mut M, addr: u32, data: &[u8]) -> Option<()> {
+    let mut addr = addr;
+    for word in data.chunks_exact(2) {
+        memory.set_word(addr, u16::from_be_bytes([word[0], word[1]]))?;
+        addr = addr.wrapping_add(2);
+    }
+    Some(())
+}
+
+/// Returns the range of a slice of `len` elements covered by a block starting at index `start`, if it is in bounds.
+fn block_range(start: usize, count: usize, len: usize) -> Option<std::ops::Range<usize>> {
+    let end = start.checked_add(count)?;
+    if end <= len {
+        Some(start..end)
+    } else {
+        None
+    }
 }
 
 /// Iterator over 16-bits values in memory.
@@ -176,7 +257,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     /// This function is public because it can be useful in some contexts such as OS-9 environments
     /// where the trap ID is the immediate next word after the TRAP instruction.
     pub fn get_next_word<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> GetResult<u16> {
-        let data = memory.get_word(self.regs.pc.check_even()?.0).ok_or(Vector::AccessError);
+        let data = self.mapped_get_word(memory, self.regs.pc.check_even()?.0).ok_or(Vector::AccessError);
         self.regs.pc += 2;
         data
     }
@@ -185,7 +266,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     ///
     /// Please note that this function advances the program counter so be careful when using it.
     pub fn get_next_long<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M) -> GetResult<u32> {
-        let data = memory.get_long(self.regs.pc.check_even()?.0).ok_or(Vector::AccessError);
+        let data = self.mapped_get_long(memory, self.regs.pc.check_even()?.0).ok_or(Vector::AccessError);
         self.regs.pc += 4;
         data
     }
@@ -195,7 +276,7 @@ impl<CPU: CpuDetails> M68000<CPU> {
     /// This function is public because it can be useful in some contexts such as OS-9 environments
     /// where the trap ID is the immediate next word after the TRAP instruction.
     pub fn peek_next_word<M: MemoryAccess + ?Sized>(&self, memory: &mut M) -> GetResult<u16> {
-        memory.get_word(self.regs.pc.check_even()?.0).ok_or(Vector::AccessError)
+        self.mapped_get_word(memory, self.regs.pc.check_even()?.0).ok_or(Vector::AccessError)
     }
 
     /// Pops the 16-bits value from the stack.
@@ -226,6 +307,202 @@ impl<CPU: CpuDetails> M68000<CPU> {
     pub(super) fn iter_from_pc<'a, M: MemoryAccess + ?Sized>(&self, memory: &'a mut M) -> MemoryIter<'a, M> {
         memory.iter_u16(self.regs.pc.0)
     }
+
+    /// Runs the given function with the memory wrapped in a [CoreMemory] using the memory map, the instruction cache,
+    /// the hooks and the prefetch window.
+    ///
+    /// The memory map, the instruction cache, the hooks and the prefetch window are taken out of the core during the call,
+    /// so the public memory methods called with the wrapper do not look up the memory map twice.
+    pub(super) fn with_core_memory<M: MemoryAccess + ?Sized, R>(&mut self, memory: &mut M, f: impl FnOnce(&mut Self, &mut CoreMemory<M>) -> R) -> R {
+        let mut cache = self.instruction_cache.take();
+        let map = self.memory_map.take();
+        let mut hooks = self.hooks.take();
+        let mut prefetch = self.prefetch.take();
+
+        let mut core_memory = CoreMemory {
+            memory: CountedMemory::new(memory, self.counters.memory),
+            map: map.as_deref(),
+            cache: cache.as_deref_mut(),
+            hooks: hooks.as_deref_mut(),
+            prefetch: prefetch.as_deref_mut(),
+        };
+        let res = f(self, &mut core_memory);
+
+        self.counters.memory = core_memory.memory.counters;
+        self.instruction_cache = cache;
+        self.memory_map = map;
+        self.hooks = hooks;
+        self.prefetch = prefetch;
+        res
+    }
+}
+
+/// Memory wrapper used by the interpreters when the memory map, the instruction cache, the hooks or the prefetch window
+/// are enabled.
+///
+/// Accesses are done in the memory map or in the prefetch window when possible and forwarded to the application's memory
+/// otherwise, through a [CountedMemory] that counts these calls. Writes are reported to the instruction cache and the prefetch window, and all the accesses are checked
+/// against the watchpoints.
+pub(crate) struct CoreMemory<'a, M: MemoryAccess + ?Sized> {
+    pub memory: CountedMemory<'a, M>,
+    pub map: Option<&'a MemoryMap>,
+    pub cache: Option<&'a mut InstructionCache>,
+    pub hooks: Option<&'a mut Hooks>,
+    pub prefetch: Option<&'a mut Prefetch>,
+}
+
+impl<M: MemoryAccess + ?Sized> CoreMemory<'_, M> {
+    /// Checks the access against the watchpoints.
+    #[inline(always)]
+    fn watch(&mut self, addr: u32, len: u32, write: bool) {
+        if let Some(hooks) = &mut self.hooks {
+            hooks.check_access(addr, len, write);
+        }
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> MemoryAccess for CoreMemory<'_, M> {
+    #[inline(always)]
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.watch(addr, 1, false);
+        if let Some(data) = self.map.and_then(|map| map.get_byte(addr)) {
+            return Some(data);
+        }
+        self.memory.get_byte(addr)
+    }
+
+    #[inline(always)]
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.watch(addr, 2, false);
+        if let Some(data) = self.map.and_then(|map| map.get_word(addr)) {
+            return Some(data);
+        }
+        if let Some(data) = self.prefetch.as_deref().and_then(|prefetch| prefetch.get_word(addr)) {
+            return Some(data);
+        }
+        self.memory.get_word(addr)
+    }
+
+    #[inline(always)]
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        self.watch(addr, 4, false);
+        if let Some(map) = self.map {
+            if let Some(data) = map.get_long(addr) {
+                return Some(data);
+            }
+
+            // The long crosses a page boundary or the end of a partial page.
+            if map.is_mapped(addr) || map.is_mapped(addr.wrapping_add(2)) {
+                return Some((self.get_word(addr)? as u32) << 16 | self.get_word(addr.wrapping_add(2))? as u32);
+            }
+        }
+        if let Some(data) = self.prefetch.as_deref().and_then(|prefetch| prefetch.get_long(addr)) {
+            return Some(data);
+        }
+        self.memory.get_long(addr)
+    }
+
+    #[inline(always)]
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.watch(addr, 1, true);
+        if let Some(cache) = &mut self.cache {
+            cache.notify_write(addr, 1);
+        }
+        if let Some(prefetch) = &mut self.prefetch {
+            prefetch.notify_write(addr, 1);
+        }
+        if self.map.is_some_and(|map| map.set_byte(addr, value)) {
+            return Some(());
+        }
+        self.memory.set_byte(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.watch(addr, 2, true);
+        if let Some(cache) = &mut self.cache {
+            cache.notify_write(addr, 2);
+        }
+        if let Some(prefetch) = &mut self.prefetch {
+            prefetch.notify_write(addr, 2);
+        }
+        if self.map.is_some_and(|map| map.set_word(addr, value)) {
+            return Some(());
+        }
+        self.memory.set_word(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        self.watch(addr, 4, true);
+        if let Some(cache) = &mut self.cache {
+            cache.notify_write(addr, 4);
+        }
+        if let Some(prefetch) = &mut self.prefetch {
+            prefetch.notify_write(addr, 4);
+        }
+        if let Some(map) = self.map {
+            if map.set_long(addr, value) {
+                return Some(());
+            }
+
+            // The long crosses a page boundary or the end of a partial page.
+            if map.is_mapped(addr) || map.is_mapped(addr.wrapping_add(2)) {
+                self.set_word(addr, (value >> 16) as u16)?;
+                return self.set_word(addr.wrapping_add(2), value as u16);
+            }
+        }
+        self.memory.set_long(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        self.watch(addr, data.len() as u32, false);
+        if let Some(map) = self.map {
+            if map.get_block(addr, data) {
+                return Some(());
+            }
+
+            // The block crosses a page boundary or the end of a partial page.
+            if map.is_mapped(addr) || map.is_mapped(addr.wrapping_add(data.len() as u32 - 1)) {
+                return get_block_words(self, addr, data);
+            }
+        }
+        self.memory.get_block(addr, data)
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        self.watch(addr, data.len() as u32, true);
+        if let Some(cache) = &mut self.cache {
+            cache.notify_write(addr, data.len() as u32);
+        }
+        if let Some(prefetch) = &mut self.prefetch {
+            prefetch.notify_write(addr, data.len() as u32);
+        }
+        if let Some(map) = self.map {
+            if map.set_block(addr, data) {
+                return Some(());
+            }
+
+            // The block crosses a page boundary or the end of a partial page.
+            if map.is_mapped(addr) || map.is_mapped(addr.wrapping_add(data.len() as u32 - 1)) {
+                return set_block_words(self, addr, data);
+            }
+        }
+        self.memory.set_block(addr, data)
+    }
+
+    fn prefetched_word(&self, addr: u32) -> Option<u16> {
+        self.prefetch.as_deref().and_then(|prefetch| prefetch.get_word(addr))
+    }
+
+    fn reset_instruction(&mut self) {
+        self.memory.reset_instruction()
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        self.memory.take_wait_cycles()
+    }
 }
 
 impl MemoryAccess for [u8] {
@@ -268,6 +545,18 @@ impl MemoryAccess for [u8] {
         }
     }
 
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let range = block_range(addr as usize, data.len(), self.len())?;
+        data.copy_from_slice(&self[range]);
+        Some(())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        let range = block_range(addr as usize, data.len(), self.len())?;
+        self[range].copy_from_slice(data);
+        Some(())
+    }
+
     fn reset_instruction(&mut self) {}
 }
 
@@ -298,6 +587,12 @@ impl MemoryAccess for &[u8] {
         panic!("Can't write in non-mutable buffer");
     }
 
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let range = block_range(addr as usize, data.len(), self.len())?;
+        data.copy_from_slice(&self[range]);
+        Some(())
+    }
+
     fn reset_instruction(&mut self) {}
 }
 
@@ -350,6 +645,22 @@ impl MemoryAccess for [u16] {
         }
     }
 
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let range = block_range(addr as usize >> 1, data.len() / 2, self.len())?;
+        for (bytes, word) in data.chunks_exact_mut(2).zip(&self[range]) {
+            bytes.copy_from_slice(&word.to_be_bytes());
+        }
+        Some(())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        let range = block_range(addr as usize >> 1, data.len() / 2, self.len())?;
+        for (word, bytes) in self[range].iter_mut().zip(data.chunks_exact(2)) {
+            *word = u16::from_be_bytes([bytes[0], bytes[1]]);
+        }
+        Some(())
+    }
+
     fn reset_instruction(&mut self) {}
 }
 
@@ -384,5 +695,67 @@ impl MemoryAccess for &[u16] {
         panic!("Can't write in non-mutable buffer");
     }
 
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        let range = block_range(addr as usize >> 1, data.len() / 2, self.len())?;
+        for (bytes, word) in data.chunks_exact_mut(2).zip(&self[range]) {
+            bytes.copy_from_slice(&word.to_be_bytes());
+        }
+        Some(())
+    }
+
     fn reset_instruction(&mut self) {}
 }
+
+/// Forwards the accesses to the borrowed memory, so a structure can own a `&mut [u8]` or a `&mut [u16]`.
+impl<M: MemoryAccess + ?Sized> MemoryAccess for &mut M {
+    #[inline(always)]
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        (**self).get_byte(addr)
+    }
+
+    #[inline(always)]
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        (**self).get_word(addr)
+    }
+
+    #[inline(always)]
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        (**self).get_long(addr)
+    }
+
+    #[inline(always)]
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        (**self).set_byte(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        (**self).set_word(addr, value)
+    }
+
+    #[inline(always)]
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        (**self).set_long(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        (**self).get_block(addr, data)
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        (**self).set_block(addr, data)
+    }
+
+    fn prefetched_word(&self, addr: u32) -> Option<u16> {
+        (**self).prefetched_word(addr)
+    }
+
+    fn reset_instruction(&mut self) {
+        (**self).reset_instruction()
+    }
+
+    #[inline(always)]
+    fn take_wait_cycles(&mut self) -> usize {
+        (**self).take_wait_cycles()
+    }
+}
@@ -0,0 +1,372 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Fast memory map that bypasses the [MemoryAccess] trait for plain RAM and ROM.
+//!
+//! The address space is divided in 64 KiB pages. Each page can be mapped to a host memory buffer with
+//! [M68000::map_memory], and the core then reads (and writes if the page is writable) the buffer directly with
+//! big-endian loads and stores, without calling the application's memory system. The pages are grouped in tables of
+//! 16 MiB that are allocated when one of their pages is first mapped, so a core that only maps the 24-bits bus of a
+//! 68000 uses a single 4 KiB table.
+//!
+//! Accesses to unmapped pages, writes to read-only pages, and accesses above the mapped length of a partial page
+//! are forwarded to the [MemoryAccess] implementation given to the interpreter.
+//!
+//! Writes done directly by the application in a mapped buffer are not seen by the instruction cache,
+//! see [M68000::invalidate_instruction_cache].
+//!
+//! Cloning a core does not clone the pages mapped with [M68000::map_memory]: the clone would write the same buffers as
+//! the original without any synchronization. Only the immutable buffers mapped with [M68000::map_rom] are kept.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+
+use std::sync::Arc;
+
+/// The size in bytes of a memory page.
+pub const PAGE_SIZE: u32 = 0x1_0000;
+/// Number of bits to shift an address to get its page number.
+const PAGE_SHIFT: u32 = 16;
+/// Number of bits to shift an address to get its page table number.
+const TABLE_SHIFT: u32 = 24;
+/// Number of page tables in the 32-bits address space.
+const TABLE_COUNT: usize = 1 << (32 - TABLE_SHIFT);
+/// Number of pages in each page table.
+const TABLE_PAGES: usize = 1 << (TABLE_SHIFT - PAGE_SHIFT);
+
+/// A host memory page.
+#[derive(Clone, Copy, Debug)]
+struct Page {
+    /// Pointer to the beginning of the page in host memory. Null if the page is not mapped.
+    data: *mut u8,
+    /// Number of valid bytes starting at the beginning of the page.
+    len: u32,
+    /// True if writes are done directly in host memory. Always false for unmapped pages.
+    writable: bool,
+}
+
+impl Page {
+    const UNMAPPED: Self = Self { data: std::ptr::null_mut(), len: 0, writable: false };
+}
+
+/// The pages of 16 MiB of the address space.
+type PageTable = [Page; TABLE_PAGES];
+
+/// Page table of the host memory buffers mapped in the address space of a core.
+///
+/// A clone only keeps the pages of the buffers mapped with [Self::map_shared].
+pub struct MemoryMap {
+    /// The page tables, `None` until one of their pages is mapped.
+    tables: [Option<Box<PageTable>>; TABLE_COUNT],
+    /// The shared buffers mapped with [Self::map_shared], kept alive as long as one of their pages is mapped.
+    shared: Vec<Arc<[u8]>>,
+}
+
+// SAFETY: the pointers are only dereferenced as allowed by the contract of [MemoryMap::map].
+unsafe impl Send for MemoryMap {}
+unsafe impl Sync for MemoryMap {}
+
+impl MemoryMap {
+    /// Creates a new memory map with no page mapped.
+    pub fn new() -> Self {
+        Self {
+            tables: std::array::from_fn(|_| None),
+            shared: Vec::new(),
+        }
+    }
+
+    /// Maps `len` bytes of host memory starting at `data` to the addresses starting at `addr`.
+    ///
+    /// If `writable` is false, writes to this range are forwarded to the [MemoryAccess] implementation.
+    /// If `len` is not a multiple of [PAGE_SIZE], the last page is partially mapped.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `addr` is not a multiple of [PAGE_SIZE] or if the range overflows the 32-bits address space.
+    ///
+    /// # Safety
+    ///
+    /// `data` must be valid for reads (and writes if `writable` is true) of `len` bytes for as long as it is mapped,
+    /// and must not be accessed mutably by something else while the core is executing.
+    pub unsafe fn map(&mut self, addr: u32, data: *mut u8, len: usize, writable: bool) {
+        assert!(addr % PAGE_SIZE == 0, "Mapped address must be aligned on a page");
+        assert!(addr as u64 + len as u64 <= 1 << 32, "Mapped range overflows the address space");
+
+        let mut offset = 0;
+        while offset < len {
+            let page_len = (len - offset).min(PAGE_SIZE as usize);
+            *self.page_mut((addr as usize + offset) >> PAGE_SHIFT) = Page {
+                // SAFETY: offset < len.
+                data: unsafe { data.add(offset) },
+                len: page_len as u32,
+                writable,
+            };
+            offset += page_len;
+        }
+
+        self.release_shared();
+    }
+
+    /// Maps the given shared buffer read-only to the addresses starting at `addr`.
+    ///
+    /// The map keeps a reference to the buffer until all its pages are unmapped or mapped to something else.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `addr` is not a multiple of [PAGE_SIZE] or if the range overflows the 32-bits address space.
+    pub fn map_shared(&mut self, addr: u32, data: Arc<[u8]>) {
+        // SAFETY: the buffer is immutable and is kept alive while mapped. Read-only pages are never written.
+        unsafe { self.map(addr, data.as_ptr() as *mut u8, data.len(), false); }
+        if !data.is_empty() {
+            self.shared.push(data);
+        }
+    }
+
+    /// Drops the shared buffers that are no longer mapped.
+    fn release_shared(&mut self) {
+        if self.shared.is_empty() {
+            return;
+        }
+
+        let tables = &self.tables;
+        self.shared.retain(|data| {
+            let range = data.as_ptr_range();
+            Self::pages(tables).any(|page| range.contains(&(page.data as *const u8)))
+        });
+    }
+
+    /// Returns the pages of the allocated page tables.
+    fn pages(tables: &[Option<Box<PageTable>>; TABLE_COUNT]) -> impl Iterator<Item = &Page> {
+        tables.iter().flatten().flat_map(|table| table.iter())
+    }
+
+    /// Returns true if the given page is in one of the buffers mapped with [Self::map_shared].
+    fn is_shared(&self, page: &Page) -> bool {
+        self.shared.iter().any(|data| data.as_ptr_range().contains(&(page.data as *const u8)))
+    }
+
+    /// Returns the given page to modify it, allocating its page table if necessary.
+    fn page_mut(&mut self, page: usize) -> &mut Page {
+        let table = self.tables[page / TABLE_PAGES].get_or_insert_with(|| Box::new([Page::UNMAPPED; TABLE_PAGES]));
+        &mut table[page % TABLE_PAGES]
+    }
+
+    /// Unmaps the pages containing the given address range. The range is clamped to the end of the address space.
+    pub fn unmap(&mut self, addr: u32, len: usize) {
+        if len == 0 {
+            return;
+        }
+
+        let first = addr as usize >> PAGE_SHIFT;
+        let last = ((addr as usize).saturating_add(len - 1) >> PAGE_SHIFT).min(TABLE_COUNT * TABLE_PAGES - 1);
+        for page in first..=last {
+            if let Some(table) = &mut self.tables[page / TABLE_PAGES] {
+                table[page % TABLE_PAGES] = Page::UNMAPPED;
+            }
+        }
+        self.release_shared();
+    }
+
+    /// Returns true if the given address is in a mapped page.
+    #[inline(always)]
+    pub fn is_mapped(&self, addr: u32) -> bool {
+        !self.page(addr).0.data.is_null()
+    }
+
+    /// Returns the page of the given address and the offset of the address in it.
+    #[inline(always)]
+    fn page(&self, addr: u32) -> (&Page, u32) {
+        let page = match &self.tables[(addr >> TABLE_SHIFT) as usize] {
+            Some(table) => &table[(addr >> PAGE_SHIFT) as usize % TABLE_PAGES],
+            None => &Page::UNMAPPED,
+        };
+        (page, addr & (PAGE_SIZE - 1))
+    }
+
+    /// Returns the byte at the given address if it is mapped.
+    #[inline(always)]
+    pub fn get_byte(&self, addr: u32) -> Option<u8> {
+        let (page, offset) = self.page(addr);
+        if page.data.is_null() || offset >= page.len {
+            return None;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        Some(unsafe { *page.data.add(offset as usize) })
+    }
+
+    /// Returns the big-endian word at the given address if it is mapped.
+    #[inline(always)]
+    pub fn get_word(&self, addr: u32) -> Option<u16> {
+        let (page, offset) = self.page(addr);
+        if page.data.is_null() || offset + 2 > page.len {
+            return None;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        Some(u16::from_be_bytes(unsafe { (page.data.add(offset as usize) as *const [u8; 2]).read_unaligned() }))
+    }
+
+    /// Returns the big-endian long at the given address if all of it is in the same mapped page.
+    #[inline(always)]
+    pub fn get_long(&self, addr: u32) -> Option<u32> {
+        let (page, offset) = self.page(addr);
+        if page.data.is_null() || offset + 4 > page.len {
+            return None;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        Some(u32::from_be_bytes(unsafe { (page.data.add(offset as usize) as *const [u8; 4]).read_unaligned() }))
+    }
+
+    /// Writes the byte at the given address if it is mapped and writable. Returns false otherwise.
+    #[inline(always)]
+    pub fn set_byte(&self, addr: u32, value: u8) -> bool {
+        let (page, offset) = self.page(addr);
+        if !page.writable || offset >= page.len {
+            return false;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        unsafe { *page.data.add(offset as usize) = value; }
+        true
+    }
+
+    /// Writes the big-endian word at the given address if it is mapped and writable. Returns false otherwise.
+    #[inline(always)]
+    pub fn set_word(&self, addr: u32, value: u16) -> bool {
+        let (page, offset) = self.page(addr);
+        if !page.writable || offset + 2 > page.len {
+            return false;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        unsafe { (page.data.add(offset as usize) as *mut [u8; 2]).write_unaligned(value.to_be_bytes()); }
+        true
+    }
+
+    /// Writes the big-endian long at the given address if all of it is in the same mapped and writable page.
+    /// Returns false otherwise.
+    #[inline(always)]
+    pub fn set_long(&self, addr: u32, value: u32) -> bool {
+        let (page, offset) = self.page(addr);
+        if !page.writable || offset + 4 > page.len {
+            return false;
+        }
+
+        // SAFETY: the offset is in the mapped range.
+        unsafe { (page.data.add(offset as usize) as *mut [u8; 4]).write_unaligned(value.to_be_bytes()); }
+        true
+    }
+
+    /// Reads the block at the given address if all of it is in the same mapped page. Returns false otherwise.
+    #[inline(always)]
+    pub fn get_block(&self, addr: u32, data: &mut [u8]) -> bool {
+        let (page, offset) = self.page(addr);
+        if page.data.is_null() || offset as usize + data.len() > page.len as usize {
+            return false;
+        }
+
+        // SAFETY: the range is in the mapped range.
+        unsafe { data.as_mut_ptr().copy_from_nonoverlapping(page.data.add(offset as usize), data.len()); }
+        true
+    }
+
+    /// Writes the block at the given address if all of it is in the same mapped and writable page.
+    /// Returns false otherwise.
+    #[inline(always)]
+    pub fn set_block(&self, addr: u32, data: &[u8]) -> bool {
+        let (page, offset) = self.page(addr);
+        if !page.writable || offset as usize + data.len() > page.len as usize {
+            return false;
+        }
+
+        // SAFETY: the range is in the mapped range.
+        unsafe { page.data.add(offset as usize).copy_from_nonoverlapping(data.as_ptr(), data.len()); }
+        true
+    }
+}
+
+impl Clone for MemoryMap {
+    fn clone(&self) -> Self {
+        let tables = std::array::from_fn(|i| {
+            let table = self.tables[i].as_ref()?;
+            if !table.iter().any(|page| self.is_shared(page)) {
+                return None;
+            }
+
+            let mut clone = Box::new([Page::UNMAPPED; TABLE_PAGES]);
+            for (clone, page) in clone.iter_mut().zip(table.iter()) {
+                if self.is_shared(page) {
+                    *clone = *page;
+                }
+            }
+            Some(clone)
+        });
+
+        Self { tables, shared: self.shared.clone() }
+    }
+}
+
+impl Default for MemoryMap {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl std::fmt::Debug for MemoryMap {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        let mapped = Self::pages(&self.tables).filter(|p| !p.data.is_null()).count();
+        f.debug_struct("MemoryMap")
+            .field("mapped_pages", &mapped)
+            .finish()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Maps `len` bytes of host memory starting at `data` to the addresses starting at `addr`.
+    ///
+    /// See [MemoryMap::map] for the details.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `addr` is not a multiple of [PAGE_SIZE] or if the range overflows the 32-bits address space.
+    ///
+    /// # Safety
+    ///
+    /// `data` must be valid for reads (and writes if `writable` is true) of `len` bytes for as long as it is mapped,
+    /// and must not be accessed mutably by something else while the core is executing.
+    ///
+    /// The mapping is not copied when the core is cloned, the clone accesses this range through [MemoryAccess].
+    pub unsafe fn map_memory(&mut self, addr: u32, data: *mut u8, len: usize, writable: bool) {
+        // SAFETY: same contract.
+        unsafe { self.memory_map.get_or_insert_with(Box::default).map(addr, data, len, writable); }
+    }
+
+    /// Unmaps the pages containing the given address range, so they are accessed through [MemoryAccess] again.
+    pub fn unmap_memory(&mut self, addr: u32, len: usize) {
+        if let Some(map) = &mut self.memory_map {
+            map.unmap(addr, len);
+        }
+    }
+
+    /// Reads a word from the memory map if mapped, or from the memory system otherwise.
+    pub(super) fn mapped_get_word<M: MemoryAccess + ?Sized>(&self, memory: &mut M, addr: u32) -> Option<u16> {
+        if let Some(map) = &self.memory_map {
+            if let Some(data) = map.get_word(addr) {
+                return Some(data);
+            }
+        }
+
+        memory.get_word(addr)
+    }
+
+    /// Reads a long from the memory map if mapped, or from the memory system otherwise.
+    pub(super) fn mapped_get_long<M: MemoryAccess + ?Sized>(&self, memory: &mut M, addr: u32) -> Option<u32> {
+        if self.memory_map.is_some() {
+            Some((self.mapped_get_word(memory, addr)? as u32) << 16 | self.mapped_get_word(memory, addr.wrapping_add(2))? as u32)
+        } else {
+            memory.get_long(addr)
+        }
+    }
+}
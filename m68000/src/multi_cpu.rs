@@ -0,0 +1,485 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Time-sliced execution of several CPUs sharing a bus.
+//!
+//! A [MultiCpu] owns the cores of a multiprocessor board, each with its local memory, and the memory shared by all
+//! of them. The addresses of the shared memory are given with [MultiCpu::add_shared_range]. [MultiCpu::run] advances
+//! all the cores to the same time, slice by slice:
+//! - each core first runs alone on its local memory until the end of the slice, on separate threads. When an
+//!   instruction accesses the shared ranges, it is rolled back and the core stops there;
+//! - the cores that stopped then run in turn on the shared memory, one quantum at a time, so their shared accesses
+//!   are interleaved in time order with the precision of the quantum. After each quantum the handler is called, which
+//!   emulates the shared devices and can request interrupts.
+//!
+//! A core that does not access the shared memory during a slice therefore runs the whole slice at once, and a board
+//! where no core accesses the shared memory runs in parallel with one synchronization per slice. The cores do not
+//! depend on each other during the first phase and the second phase is sequential, so the execution does not depend
+//! on the number of threads. It does not depend on the slice length either when the handler requests no interrupt,
+//! since the slice length changes when the interrupts are taken (see below).
+//!
+//! Rolling back an instruction restores the registers and the pending exceptions of the core and undoes its writes
+//! to the local memory. Hence the local memory must behave like a RAM or a ROM: reads without side effects and
+//! writes that can be restored by writing the previous value back. Devices with side effects belong to the shared
+//! ranges. The cores with a [memory map](crate::memory_map) always run at quantum granularity, since the accesses to
+//! their pages cannot be seen by the runner.
+//!
+//! Interrupts requested by the handler are taken by the cores when they run again. A core that ran a whole slice
+//! alone has already reached the end of the slice, so its interrupts are delayed to the next slice. The slice length
+//! is thus the maximum interrupt latency of the cores that do not access the shared memory.
+//!
+//! ```
+//! use m68000::{M68000, MemoryAccess};
+//! use m68000::addressing_modes::AddressingMode as AM;
+//! use m68000::assembler as asm;
+//! use m68000::cpu_details::Mc68000;
+//! use m68000::instruction::Size;
+//! use m68000::multi_cpu::MultiCpu;
+//!
+//! // Both CPUs increment the word at 0x4000 in the shared memory forever.
+//! let mut program = asm::addq(1, Size::Word, AM::AbsShort(0x4000));
+//! program.extend(asm::bra(-6));
+//! program.resize(0x1000, 0);
+//!
+//! let mut shared = vec![0u16; 0x2001];
+//! let mut local = [program.clone(), program];
+//!
+//! let mut board = MultiCpu::new(&mut shared[..], 0);
+//! board.add_shared_range(0x4000..0x4002);
+//! for memory in &mut local {
+//!     board.add_cpu(M68000::<Mc68000>::new_no_reset(), &mut memory[..]);
+//! }
+//!
+//! board.run(10_000, |_, _, _| ());
+//! assert!(board.cpus().iter().all(|cpu| cpu.time() >= 10_000));
+//! let count = board.shared_mut().get_word(0x4000).unwrap();
+//! assert!(count > 700);
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess, Registers};
+use crate::counters::MemoryCounters;
+use crate::exception::{Exception, PendingExceptions, Vector};
+use crate::memory_access::{get_block_words, set_block_words};
+
+use std::num::NonZeroUsize;
+use std::ops::Range;
+
+/// The default quantum, in cycles.
+pub const DEFAULT_QUANTUM: u64 = 100;
+/// The default slice length, in cycles.
+pub const DEFAULT_SLICE: u64 = 10_000;
+
+/// A core of a [MultiCpu] and its local memory.
+#[derive(Debug)]
+pub struct Processor<CPU: CpuDetails, L: MemoryAccess> {
+    /// The core.
+    pub cpu: M68000<CPU>,
+    /// The memory of the addresses outside of the shared ranges.
+    pub memory: L,
+    time: u64,
+    /// True when the core accessed the shared memory during the current slice.
+    synchronized: bool,
+    /// The local writes of the instruction being executed alone.
+    undo: Vec<Undo>,
+}
+
+impl<CPU: CpuDetails, L: MemoryAccess> Processor<CPU, L> {
+    /// Returns the number of cycles executed by the core since its creation.
+    pub fn time(&self) -> u64 {
+        self.time
+    }
+
+    /// Runs the core alone until `until`, and returns when an instruction accesses the shared memory.
+    fn run_alone(&mut self, ranges: &[Range<u32>], until: u64) {
+        if self.cpu.memory_map.is_some() {
+            self.synchronized = true;
+            return;
+        }
+
+        while self.time < until {
+            if self.cpu.stop {
+                self.cpu.counters.stopped_cycles += until - self.time;
+                self.time = until;
+                return;
+            }
+
+            let checkpoint = Checkpoint::new(&self.cpu);
+            let mut bus = Bus::<L, L> { local: &mut self.memory, shared: None, ranges, undo: &mut self.undo, blocked: false };
+            let (cycles, vector) = self.cpu.interpreter_exception(&mut bus);
+
+            if bus.blocked {
+                while let Some(undo) = self.undo.pop() {
+                    match undo {
+                        Undo::Byte(addr, value) => self.memory.set_byte(addr, value),
+                        Undo::Word(addr, value) => self.memory.set_word(addr, value),
+                    };
+                }
+                checkpoint.restore(&mut self.cpu);
+                self.synchronized = true;
+                return;
+            }
+
+            self.undo.clear();
+            self.time += cycles as u64;
+            if let Some(vector) = vector {
+                self.cpu.exception(Exception::from(vector));
+            }
+        }
+    }
+
+    /// Runs the core until `until` with access to the shared memory.
+    fn run_shared<M: MemoryAccess + ?Sized>(&mut self, shared: &mut M, ranges: &[Range<u32>], until: u64) {
+        if self.time < until {
+            let mut bus = Bus { local: &mut self.memory, shared: Some(shared), ranges, undo: &mut self.undo, blocked: false };
+            self.time += self.cpu.cycle(&mut bus, (until - self.time) as usize) as u64;
+        }
+    }
+}
+
+/// The interrupts requested by the handler of [MultiCpu::run].
+#[derive(Clone, Debug, Default)]
+pub struct Interrupts {
+    requests: Vec<(usize, Exception)>,
+}
+
+impl Interrupts {
+    /// Requests the given exception on the core at the given index.
+    pub fn request(&mut self, cpu: usize, exception: Exception) {
+        self.requests.push((cpu, exception));
+    }
+}
+
+/// Several cores sharing a memory, run in time slices.
+#[derive(Debug)]
+pub struct MultiCpu<CPU: CpuDetails, L: MemoryAccess, M: MemoryAccess> {
+    cpus: Vec<Processor<CPU, L>>,
+    shared: M,
+    shared_ranges: Vec<Range<u32>>,
+    quantum: u64,
+    slice: u64,
+    threads: usize,
+    time: u64,
+    interrupts: Interrupts,
+}
+
+impl<CPU: CpuDetails + Send, L: MemoryAccess + Send, M: MemoryAccess> MultiCpu<CPU, L, M> {
+    /// Creates a board without cores with the given shared memory, which runs the cores alone on the given number of
+    /// threads.
+    ///
+    /// If `threads` is 0, the number of threads is the available parallelism of the host.
+    pub fn new(shared: M, threads: usize) -> Self {
+        let threads = if threads == 0 {
+            std::thread::available_parallelism().map_or(1, NonZeroUsize::get)
+        } else {
+            threads
+        };
+
+        Self {
+            cpus: Vec::new(),
+            shared,
+            shared_ranges: Vec::new(),
+            quantum: DEFAULT_QUANTUM,
+            slice: DEFAULT_SLICE,
+            threads,
+            time: 0,
+            interrupts: Interrupts::default(),
+        }
+    }
+
+    /// Adds a core with its local memory, and returns its index. Its time starts at the current time of the board.
+    pub fn add_cpu(&mut self, cpu: M68000<CPU>, memory: L) -> usize {
+        self.cpus.push(Processor { cpu, memory, time: self.time, synchronized: false, undo: Vec::new() });
+        self.cpus.len() - 1
+    }
+
+    /// Adds a range of addresses that are accessed in the shared memory instead of the local memories.
+    pub fn add_shared_range(&mut self, range: Range<u32>) {
+        self.shared_ranges.push(range);
+    }
+
+    /// Sets the number of cycles the cores that access the shared memory run in turn. Defaults to [DEFAULT_QUANTUM].
+    ///
+    /// Panics if `cycles` is 0.
+    pub fn set_quantum(&mut self, cycles: u64) {
+        assert!(cycles != 0, "The quantum cannot be 0 cycles.");
+        self.quantum = cycles;
+    }
+
+    /// Sets the number of cycles the cores run alone before synchronizing. Defaults to [DEFAULT_SLICE].
+    ///
+    /// Panics if `cycles` is 0.
+    pub fn set_slice(&mut self, cycles: u64) {
+        assert!(cycles != 0, "The slice cannot be 0 cycles.");
+        self.slice = cycles;
+    }
+
+    /// Returns the number of threads used to run the cores alone.
+    pub fn threads(&self) -> usize {
+        self.threads
+    }
+
+    /// Returns the time reached by all the cores.
+    pub fn time(&self) -> u64 {
+        self.time
+    }
+
+    /// Returns the cores, in the order they were added.
+    pub fn cpus(&self) -> &[Processor<CPU, L>] {
+        &self.cpus
+    }
+
+    /// Returns the cores, in the order they were added.
+    pub fn cpus_mut(&mut self) -> &mut [Processor<CPU, L>] {
+        &mut self.cpus
+    }
+
+    /// Returns the shared memory.
+    pub fn shared(&self) -> &M {
+        &self.shared
+    }
+
+    /// Returns the shared memory.
+    pub fn shared_mut(&mut self) -> &mut M {
+        &mut self.shared
+    }
+
+    /// Runs all the cores until they reach `until`.
+    ///
+    /// `handler` is called with the shared memory and the current time after each quantum during which cores
+    /// accessed the shared memory, and at the end of each slice. The exceptions it requests are given to the cores
+    /// after it returns. The exceptions that occur during the execution of the instructions are processed by the
+    /// cores themselves, like [M68000::cycle].
+    ///
+    /// Since instructions are not interrupted, the cores may end a few cycles after `until`.
+    pub fn run(&mut self, until: u64, mut handler: impl FnMut(&mut M, u64, &mut Interrupts)) {
+        while self.time < until {
+            let end = until.min(self.time + self.slice);
+            self.run_alone(end);
+
+            let first = self.cpus.iter().filter(|cpu| cpu.synchronized).map(|cpu| cpu.time).min();
+            if let Some(first) = first {
+                // Start at the quantum boundary of the slice where the first core stopped.
+                let mut boundary = self.time + (first.max(self.time) - self.time) / self.quantum * self.quantum;
+                while boundary < end {
+                    boundary = end.min(boundary + self.quantum);
+                    for cpu in self.cpus.iter_mut().filter(|cpu| cpu.synchronized) {
+                        cpu.run_shared(&mut self.shared, &self.shared_ranges, boundary);
+                    }
+                    if boundary < end {
+                        self.call_handler(boundary, &mut handler);
+                    }
+                }
+            }
+
+            self.time = end;
+            for cpu in &mut self.cpus {
+                cpu.synchronized = false;
+            }
+            self.call_handler(end, &mut handler);
+        }
+    }
+
+    /// Runs the cores alone until `end` on the threads.
+    fn run_alone(&mut self, end: u64) {
+        let ranges = &self.shared_ranges[..];
+        let threads = self.threads.min(self.cpus.len());
+        if threads <= 1 {
+            for cpu in &mut self.cpus {
+                cpu.run_alone(ranges, end);
+            }
+            return;
+        }
+
+        let chunk_len = self.cpus.len().div_ceil(threads);
+        std::thread::scope(|scope| {
+            for cpus in self.cpus.chunks_mut(chunk_len) {
+                scope.spawn(move || {
+                    for cpu in cpus {
+                        cpu.run_alone(ranges, end);
+                    }
+                });
+            }
+        });
+    }
+
+    fn call_handler(&mut self, time: u64, handler: &mut impl FnMut(&mut M, u64, &mut Interrupts)) {
+        handler(&mut self.shared, time, &mut self.interrupts);
+        for (cpu, exception) in self.interrupts.requests.drain(..) {
+            self.cpus[cpu].cpu.exception(exception);
+        }
+    }
+}
+
+/// The state of a core before an instruction executed alone.
+struct Checkpoint {
+    regs: Registers,
+    current_opcode: u16,
+    stop: bool,
+    exceptions: PendingExceptions,
+    cycles: u64,
+    instructions: u64,
+    memory: MemoryCounters,
+}
+
+impl Checkpoint {
+    fn new<CPU: CpuDetails>(cpu: &M68000<CPU>) -> Self {
+        Self {
+            regs: cpu.regs,
+            current_opcode: cpu.current_opcode,
+            stop: cpu.stop,
+            exceptions: cpu.exceptions,
+            cycles: cpu.counters.cycles,
+            instructions: cpu.counters.instructions,
+            memory: cpu.counters.memory,
+        }
+    }
+
+    fn restore<CPU: CpuDetails>(self, cpu: &mut M68000<CPU>) {
+        // The instruction runs again later, so what it counted is removed, including the exceptions it processed.
+        cpu.counters.cycles = self.cycles;
+        cpu.counters.instructions = self.instructions;
+        cpu.counters.memory = self.memory;
+        if self.exceptions.contains(Vector::ResetSspPc) {
+            // The reset clears the other pending exceptions without processing them.
+            if !cpu.exceptions.contains(Vector::ResetSspPc) {
+                cpu.counters.exceptions[Vector::ResetSspPc as usize] -= 1;
+            }
+        } else {
+            for (i, (before, after)) in self.exceptions.bits().into_iter().zip(cpu.exceptions.bits()).enumerate() {
+                let mut processed = before & !after;
+                while processed != 0 {
+                    cpu.counters.exceptions[i * 64 + processed.trailing_zeros() as usize] -= 1;
+                    processed &= processed - 1;
+                }
+            }
+        }
+
+        cpu.regs = self.regs;
+        cpu.current_opcode = self.current_opcode;
+        cpu.stop = self.stop;
+        cpu.exceptions = self.exceptions;
+        cpu.invalidate_prefetch();
+    }
+}
+
+/// A local write to undo, with the previous value.
+#[derive(Clone, Copy, Debug)]
+enum Undo {
+    Byte(u32, u8),
+    Word(u32, u16),
+}
+
+/// Dispatches the accesses between the local and the shared memory.
+///
+/// Without the shared memory, the accesses to the shared ranges set `blocked` and do nothing, and the local writes
+/// are logged so the instruction can be rolled back.
+struct Bus<'a, L: MemoryAccess + ?Sized, M: MemoryAccess + ?Sized> {
+    local: &'a mut L,
+    shared: Option<&'a mut M>,
+    ranges: &'a [Range<u32>],
+    undo: &'a mut Vec<Undo>,
+    blocked: bool,
+}
+
+impl<L: MemoryAccess + ?Sized, M: MemoryAccess + ?Sized> Bus<'_, L, M> {
+    #[inline(always)]
+    fn is_shared(&self, addr: u32) -> bool {
+        self.ranges.iter().any(|range| range.contains(&addr))
+    }
+
+    /// Returns true if the block does not overlap the shared ranges.
+    fn is_local_block(&self, addr: u32, len: usize) -> bool {
+        let end = addr as u64 + len as u64;
+        self.ranges.iter().all(|range| end <= range.start as u64 || addr >= range.end)
+    }
+}
+
+impl<L: MemoryAccess + ?Sized, M: MemoryAccess + ?Sized> MemoryAccess for Bus<'_, L, M> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        if !self.is_shared(addr) {
+            return self.local.get_byte(addr);
+        }
+        match &mut self.shared {
+            Some(shared) => shared.get_byte(addr),
+            None => {
+                self.blocked = true;
+                Some(0)
+            },
+        }
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        if !self.is_shared(addr) {
+            return self.local.get_word(addr);
+        }
+        match &mut self.shared {
+            Some(shared) => shared.get_word(addr),
+            None => {
+                self.blocked = true;
+                Some(0)
+            },
+        }
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        if !self.is_shared(addr) {
+            if self.shared.is_none() {
+                self.undo.push(Undo::Byte(addr, self.local.get_byte(addr)?));
+            }
+            return self.local.set_byte(addr, value);
+        }
+        match &mut self.shared {
+            Some(shared) => shared.set_byte(addr, value),
+            None => {
+                self.blocked = true;
+                Some(())
+            },
+        }
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        if !self.is_shared(addr) {
+            if self.shared.is_none() {
+                self.undo.push(Undo::Word(addr, self.local.get_word(addr)?));
+            }
+            return self.local.set_word(addr, value);
+        }
+        match &mut self.shared {
+            Some(shared) => shared.set_word(addr, value),
+            None => {
+                self.blocked = true;
+                Some(())
+            },
+        }
+    }
+
+    /// The RESET instruction resets the devices of the shared bus.
+    fn reset_instruction(&mut self) {
+        match &mut self.shared {
+            Some(shared) => shared.reset_instruction(),
+            None => self.blocked = true,
+        }
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        if self.is_local_block(addr, data.len()) {
+            self.local.get_block(addr, data)
+        } else {
+            get_block_words(self, addr, data)
+        }
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        // The writes of an instruction executed alone are logged word by word.
+        if self.shared.is_some() && self.is_local_block(addr, data.len()) {
+            self.local.set_block(addr, data)
+        } else {
+            set_block_words(self, addr, data)
+        }
+    }
+
+    fn take_wait_cycles(&mut self) -> usize {
+        self.local.take_wait_cycles() + self.shared.as_mut().map_or(0, |shared| shared.take_wait_cycles())
+    }
+}
@@ -0,0 +1,155 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Batch runner for many independent cores on several threads.
+//!
+//! [M68000Pool::run] runs a set of [Job]s, each made of a core and its memory, with
+//! [M68000::loop_until_exception_stop] on a set of worker threads. Each time a job stops because of an exception
+//! or a STOP instruction, the handler is called on the same thread to handle it (for example to emulate a syscall
+//! on a TRAP) and decides if the job continues or is finished.
+//!
+//! Jobs are taken one at a time from a shared queue, so a thread that finishes its jobs early takes the next ones
+//! and long jobs do not delay the others.
+//!
+//! The memory of a job can borrow data shared with the other jobs, like a ROM image used through the
+//! [MemoryAccess] implementation of `&[u8]` or `&[u16]`.
+//!
+//! ```
+//! use m68000::M68000;
+//! use m68000::cpu_details::Mc68000;
+//! use m68000::exception::Vector;
+//! use m68000::pool::{Job, M68000Pool};
+//!
+//! let mut rom = vec![0u16; 0x8000]; // Load the program here, shared by all the jobs.
+//! rom[0] = m68000::assembler::trap(0);
+//! let mut cores: Vec<M68000<Mc68000>> = (0..16).map(|_| M68000::new_no_reset()).collect();
+//! let mut memories: Vec<&[u16]> = (0..16).map(|_| &rom[..]).collect();
+//!
+//! let mut jobs: Vec<_> = cores.iter_mut().zip(memories.iter_mut()).map(|(cpu, memory)| Job::new(cpu, memory)).collect();
+//! M68000Pool::new(0).run(&mut jobs, |_, job, vector| {
+//!     // Handle the exception here. Return true to continue the job.
+//!     false
+//! });
+//! assert!(jobs.iter().all(|job| job.exception == Some(Vector::Trap0Instruction)));
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+
+use std::num::NonZeroUsize;
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// A core and its memory, run by a [M68000Pool].
+#[derive(Debug)]
+pub struct Job<'a, CPU: CpuDetails, M: MemoryAccess + ?Sized> {
+    /// The core.
+    pub cpu: &'a mut M68000<CPU>,
+    /// The memory of the core.
+    pub memory: &'a mut M,
+    /// The number of cycles executed by this job.
+    pub cycles: usize,
+    /// The vector of the last exception that occured, `None` if the job has been stopped by a STOP instruction.
+    pub exception: Option<Vector>,
+}
+
+impl<'a, CPU: CpuDetails, M: MemoryAccess + ?Sized> Job<'a, CPU, M> {
+    /// Creates a new job with the given core and memory.
+    pub fn new(cpu: &'a mut M68000<CPU>, memory: &'a mut M) -> Self {
+        Self {
+            cpu,
+            memory,
+            cycles: 0,
+            exception: None,
+        }
+    }
+
+    /// Runs the job until the handler asks it to finish, or it is stopped and the handler does not wake it up.
+    fn run(&mut self, index: usize, handler: &impl Fn(usize, &mut Self, Option<Vector>) -> bool) {
+        loop {
+            let (cycles, vector) = self.cpu.loop_until_exception_stop(self.memory);
+            self.cycles += cycles;
+            self.exception = vector;
+
+            if !handler(index, self, vector) || vector.is_none() && self.cpu.stop {
+                return;
+            }
+        }
+    }
+}
+
+/// Runs independent jobs on several threads.
+#[derive(Clone, Copy, Debug)]
+pub struct M68000Pool {
+    threads: usize,
+}
+
+impl M68000Pool {
+    /// Creates a new pool that runs the jobs on the given number of threads.
+    ///
+    /// If `threads` is 0, the number of threads is the available parallelism of the host.
+    pub fn new(threads: usize) -> Self {
+        let threads = if threads == 0 {
+            std::thread::available_parallelism().map_or(1, NonZeroUsize::get)
+        } else {
+            threads
+        };
+
+        Self { threads }
+    }
+
+    /// Returns the number of threads used to run the jobs.
+    pub fn threads(&self) -> usize {
+        self.threads
+    }
+
+    /// Runs the given jobs and returns when they are all finished.
+    ///
+    /// Each job runs until an exception or a STOP instruction occurs. Then `handler` is called with the index of the
+    /// job, the job and the vector of the exception (`None` on a STOP instruction). The handler can process the
+    /// exception, or request it with [M68000::exception], and returns true to continue running the job or false when
+    /// the job is finished. Returning true on a STOP instruction without waking up the core finishes the job.
+    ///
+    /// The handler is called from the worker threads, concurrently for different jobs.
+    pub fn run<CPU, M, F>(&self, jobs: &mut [Job<CPU, M>], handler: F)
+    where
+        CPU: CpuDetails + Send,
+        M: MemoryAccess + Send + ?Sized,
+        F: Fn(usize, &mut Job<CPU, M>, Option<Vector>) -> bool + Sync,
+    {
+        let threads = self.threads.min(jobs.len());
+        if threads <= 1 {
+            for (i, job) in jobs.iter_mut().enumerate() {
+                job.run(i, &handler);
+            }
+            return;
+        }
+
+        // Each job is locked once by the thread that takes it from the queue, so the locks are never contended.
+        let jobs: Vec<Mutex<&mut Job<CPU, M>>> = jobs.iter_mut().map(Mutex::new).collect();
+        let next = AtomicUsize::new(0);
+
+        std::thread::scope(|scope| {
+            for _ in 0..threads {
+                scope.spawn(|| {
+                    loop {
+                        let i = next.fetch_add(1, Ordering::Relaxed);
+                        let Some(job) = jobs.get(i) else {
+                            break;
+                        };
+
+                        job.lock().unwrap().run(i, &handler);
+                    }
+                });
+            }
+        });
+    }
+}
+
+impl Default for M68000Pool {
+    /// Returns a pool using the available parallelism of the host.
+    fn default() -> Self {
+        Self::new(0)
+    }
+}
@@ -0,0 +1,158 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Instruction prefetch window.
+//!
+//! Like the two-words prefetch queue of the 68000 (IRD and IRC), the prefetch window holds the words of the
+//! instruction stream ahead of the PC. When enabled with [M68000::set_prefetch], the core reads
+//! [PREFETCH_WORDS] words at once with a single [MemoryAccess::get_block] call each time the PC leaves the window
+//! (on branches and exceptions) or gets too close to its end, and the opcodes and extension words are then read from
+//! the window. Memory systems behind a costly interface, like the C callbacks of m68000-ffi, get one call every
+//! few instructions instead of one call per word.
+//!
+//! Writes done by the core to the window's range discard it, so self-modifying code is executed correctly.
+//! If the memory is modified by something else than the core, call [M68000::invalidate_prefetch].
+//! Only enable it if instruction fetches have no side effects on your memory system, as the words are read before the
+//! instruction is executed and may not be executed at all.
+//!
+//! Accesses to the pages of the [memory map](crate::memory_map) and the instructions in the
+//! [instruction cache](crate::instruction_cache) do not use the window, as they do not call the memory system.
+//!
+//! The word following the instruction stream (IRC) is pushed in the long exception stack frame of the SCC68070,
+//! and is read from the window when available.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::memory_access::CoreMemory;
+
+/// Number of words read at once in the prefetch window.
+pub const PREFETCH_WORDS: usize = 16;
+
+/// Number of bytes that must be available in the window before an instruction, so the longest instruction
+/// (MOVE.L with two absolute long addresses) is entirely read from it.
+const MAX_INSTRUCTION_SIZE: u32 = 10;
+
+/// The words of the instruction stream read ahead of the PC.
+#[derive(Clone, Debug, Default)]
+pub(crate) struct Prefetch {
+    /// The address of the first word of the window.
+    addr: u32,
+    /// The number of valid bytes in the window.
+    len: u32,
+    /// True if the window is shorter than [PREFETCH_WORDS] words because an access error occured after it.
+    truncated: bool,
+    words: [u16; PREFETCH_WORDS],
+}
+
+impl Prefetch {
+    /// Returns the word at the given address if it is in the window.
+    #[inline(always)]
+    pub fn get_word(&self, addr: u32) -> Option<u16> {
+        let offset = addr.wrapping_sub(self.addr);
+        if offset < self.len && offset & 1 == 0 {
+            Some(self.words[offset as usize / 2])
+        } else {
+            None
+        }
+    }
+
+    /// Returns the long at the given address if it is in the window.
+    #[inline(always)]
+    pub fn get_long(&self, addr: u32) -> Option<u32> {
+        let offset = addr.wrapping_sub(self.addr);
+        if offset < self.len.saturating_sub(2) && offset & 1 == 0 {
+            let index = offset as usize / 2;
+            Some((self.words[index] as u32) << 16 | self.words[index + 1] as u32)
+        } else {
+            None
+        }
+    }
+
+    /// Discards the window if the given written range overlaps it.
+    #[inline(always)]
+    pub fn notify_write(&mut self, addr: u32, len: u32) {
+        if self.len != 0 && (addr.wrapping_sub(self.addr) < self.len || self.addr.wrapping_sub(addr) < len) {
+            self.len = 0;
+        }
+    }
+
+    /// Returns true if the instruction at `pc` is entirely in the window.
+    #[inline(always)]
+    fn covers(&self, pc: u32) -> bool {
+        let offset = pc.wrapping_sub(self.addr);
+        offset < self.len && (self.len - offset >= MAX_INSTRUCTION_SIZE || self.truncated)
+    }
+
+    /// Reads the window starting at `pc` in the given memory.
+    ///
+    /// If the block can't be read, the words are read one by one up to the one that can't be, so the access error
+    /// is triggered when the instruction is executed and not when it is prefetched.
+    fn fill<M: MemoryAccess + ?Sized>(&mut self, memory: &mut M, pc: u32) {
+        let mut data = [0; PREFETCH_WORDS * 2];
+        self.addr = pc;
+
+        if pc.checked_add(data.len() as u32).is_some() && memory.get_block(pc, &mut data).is_some() {
+            for (word, bytes) in self.words.iter_mut().zip(data.chunks_exact(2)) {
+                *word = u16::from_be_bytes([bytes[0], bytes[1]]);
+            }
+            self.len = data.len() as u32;
+            self.truncated = false;
+            return;
+        }
+
+        self.len = 0;
+        self.truncated = true;
+        for word in &mut self.words {
+            match memory.get_word(pc.wrapping_add(self.len)) {
+                Some(data) => *word = data,
+                None => break,
+            }
+
+            self.len += 2;
+            if pc.checked_add(self.len).is_none() {
+                break;
+            }
+        }
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Enables or disables the prefetch window. Disabled by default.
+    ///
+    /// See the [prefetch](crate::prefetch) module for the requirements on the memory.
+    pub fn set_prefetch(&mut self, enabled: bool) {
+        self.prefetch = enabled.then(Box::default);
+    }
+
+    /// Returns true if the prefetch window is enabled.
+    pub fn prefetch_enabled(&self) -> bool {
+        self.prefetch.is_some()
+    }
+
+    /// Discards the prefetched words, so they are read again from the memory system.
+    ///
+    /// Call this function after the memory has been modified by something else than the core.
+    /// Does nothing if the prefetch window is disabled.
+    pub fn invalidate_prefetch(&mut self) {
+        if let Some(prefetch) = &mut self.prefetch {
+            prefetch.len = 0;
+        }
+    }
+
+    /// Fills the prefetch window at the PC if the next instruction is not in it.
+    ///
+    /// Does nothing if the PC is odd or in a page of the memory map.
+    #[inline(always)]
+    pub(super) fn fill_prefetch<M: MemoryAccess + ?Sized>(&mut self, memory: &mut CoreMemory<M>) {
+        let pc = self.regs.pc.0;
+        let Some(prefetch) = &mut memory.prefetch else {
+            return;
+        };
+
+        if prefetch.covers(pc) || pc & 1 != 0 || memory.map.is_some_and(|map| map.is_mapped(pc)) {
+            return;
+        }
+
+        prefetch.fill(&mut memory.memory, pc);
+    }
+}
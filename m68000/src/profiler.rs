@@ -0,0 +1,146 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Execution profiler, available with the `profiler` feature.
+//!
+//! When enabled with [M68000::set_profiler], the interpreters count the instructions executed and their cycles
+//! per [Isa] and per bucket of instruction addresses, and the number of times each exception vector is processed.
+//!
+//! Only the cycles of the instructions are counted, the exception processing times are not.
+
+use crate::{CpuDetails, M68000};
+use crate::exception::Vector;
+use crate::interpreter::InterpreterResult;
+use crate::isa::Isa;
+
+/// Number of bits to shift an instruction address to get its bucket in [Profile::pc].
+pub const PC_BUCKET_SHIFT: u32 = 8;
+/// Number of buckets in [Profile::pc], covering the 24-bits address space of the 68000.
+pub const PC_BUCKETS: usize = 1 << (24 - PC_BUCKET_SHIFT);
+
+/// An execution counter.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+#[cfg_attr(feature = "ffi", repr(C))]
+pub struct ProfileCounter {
+    /// The number of instructions executed.
+    pub count: u64,
+    /// The number of cycles executed by the instructions.
+    pub cycles: u64,
+}
+
+impl ProfileCounter {
+    #[inline(always)]
+    fn add(&mut self, cycles: usize) {
+        self.count += 1;
+        self.cycles += cycles as u64;
+    }
+}
+
+/// The counters accumulated by the profiler.
+#[derive(Clone, Debug)]
+pub struct Profile {
+    /// The instructions executed, indexed by [Isa].
+    pub isa: [ProfileCounter; Isa::_Size as usize],
+    /// The instructions executed, indexed by the bits 8 to 23 of their address (see [Self::pc_bucket]).
+    pub pc: Box<[ProfileCounter]>,
+    /// The number of times each exception has been processed, indexed by vector number.
+    pub vectors: [u64; 256],
+}
+
+impl Profile {
+    /// Creates a new profile with all the counters to 0.
+    pub fn new() -> Self {
+        Self {
+            isa: [ProfileCounter::default(); Isa::_Size as usize],
+            pc: vec![ProfileCounter::default(); PC_BUCKETS].into_boxed_slice(),
+            vectors: [0; 256],
+        }
+    }
+
+    /// Sets all the counters to 0.
+    pub fn clear(&mut self) {
+        self.isa.fill(ProfileCounter::default());
+        self.pc.fill(ProfileCounter::default());
+        self.vectors.fill(0);
+    }
+
+    /// Returns the index in [Self::pc] of the given instruction address.
+    #[inline(always)]
+    pub const fn pc_bucket(addr: u32) -> usize {
+        (addr as usize & 0xFF_FFFF) >> PC_BUCKET_SHIFT
+    }
+
+    /// Returns the sum of all the instruction counters.
+    pub fn total(&self) -> ProfileCounter {
+        self.isa.iter().fold(ProfileCounter::default(), |total, c| ProfileCounter {
+            count: total.count + c.count,
+            cycles: total.cycles + c.cycles,
+        })
+    }
+
+    /// Returns the start address and the counter of the `n` buckets with the most cycles, the hottest one first.
+    pub fn hottest_pc(&self, n: usize) -> Vec<(u32, ProfileCounter)> {
+        let mut buckets: Vec<_> = self.pc.iter()
+            .enumerate()
+            .filter(|(_, c)| c.count != 0)
+            .map(|(i, c)| ((i as u32) << PC_BUCKET_SHIFT, *c))
+            .collect();
+        buckets.sort_by(|a, b| b.1.cycles.cmp(&a.1.cycles));
+        buckets.truncate(n);
+        buckets
+    }
+
+    #[inline(always)]
+    fn instruction(&mut self, isa: Isa, pc: u32, cycles: usize) {
+        self.isa[isa as usize].add(cycles);
+        self.pc[Self::pc_bucket(pc)].add(cycles);
+    }
+}
+
+impl Default for Profile {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Enables or disables the profiler. Disabling it discards the counters.
+    pub fn set_profiler(&mut self, enabled: bool) {
+        if enabled {
+            if self.profile.is_none() {
+                self.profile = Some(Box::default());
+            }
+        } else {
+            self.profile = None;
+        }
+    }
+
+    /// Returns the counters of the profiler, or `None` if it is disabled.
+    pub fn profile(&self) -> Option<&Profile> {
+        self.profile.as_deref()
+    }
+
+    /// Sets all the counters of the profiler to 0. Does nothing if the profiler is disabled.
+    pub fn reset_profile(&mut self) {
+        if let Some(profile) = &mut self.profile {
+            profile.clear();
+        }
+    }
+
+    /// Counts the given executed instruction.
+    #[inline(always)]
+    pub(super) fn profile_instruction(&mut self, isa: Isa, pc: u32, result: &InterpreterResult) {
+        if let Some(profile) = &mut self.profile {
+            profile.instruction(isa, pc, *result.as_ref().unwrap_or(&0));
+        }
+    }
+
+    /// Counts the given processed exception.
+    #[inline(always)]
+    pub(super) fn profile_exception(&mut self, vector: Vector) {
+        if let Some(profile) = &mut self.profile {
+            profile.vectors[vector as usize] += 1;
+        }
+    }
+}
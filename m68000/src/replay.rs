@@ -0,0 +1,491 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Deterministic record and replay of the external inputs of a core.
+//!
+//! The execution of a core only depends on its state, the memory and its inputs: the exceptions requested by the
+//! application (interrupts, resets...), the values read from the memory-mapped peripherals and the wait cycles of the
+//! memory. [InputRecorder] runs a core like [M68000::cycle] and logs these inputs in an [InputLog]: the exceptions with
+//! the time they were requested at in cycles, the reads from the registered MMIO ranges and the wait cycles.
+//! [InputPlayer] runs the core again from the same state, requesting the exceptions at the same time and answering
+//! the MMIO reads and the wait cycles with the logged values, so the peripherals don't have to be emulated.
+//! The writes to the MMIO ranges are discarded during the replay.
+//!
+//! The cycle budgets given to the player do not have to be the ones given to the recorder,
+//! the player splits them to reach the time of each exception exactly.
+//!
+//! To replay from a snapshot, save [InputRecorder::position] along with [M68000::save_state] and the memory, restore
+//! them and create the player with [InputPlayer::with_position].
+//! This allows bisecting a long execution by replaying it from the closest snapshot.
+//!
+//! Blocks read from or written to the MMIO ranges are transferred word by word in both modes.
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::binary_trace::{ACCESS_ERROR, Bytes, invalid_data, size_code, size_from_code, vector_from_u8, write_signed, write_varint};
+use crate::exception::{Exception, Vector};
+use crate::instruction::Size;
+
+use std::io::{self, Read, Write};
+use std::ops::Range;
+
+/// The first bytes of a serialized [InputLog].
+pub const MAGIC: [u8; 8] = *b"M68KINP1";
+
+/// A read from an MMIO range.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct MmioRead {
+    pub addr: u32,
+    pub size: Size,
+    /// The value read, or None if the access triggered an access error.
+    pub value: Option<u32>,
+}
+
+/// The external inputs of a core, recorded by an [InputRecorder].
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct InputLog {
+    /// The exceptions requested by the application, with the time they were requested at in cycles.
+    pub exceptions: Vec<(u64, Vector)>,
+    /// The reads from the MMIO ranges, in execution order.
+    pub reads: Vec<MmioRead>,
+    /// The non-zero wait cycles, with the index of the [MemoryAccess::take_wait_cycles] call that returned them.
+    pub wait_cycles: Vec<(u64, usize)>,
+}
+
+impl InputLog {
+    /// Writes the log in a compact binary format.
+    pub fn write_to<W: Write + ?Sized>(&self, output: &mut W) -> io::Result<()> {
+        let mut data = MAGIC.to_vec();
+
+        write_varint(&mut data, self.exceptions.len() as u64);
+        let mut time = 0;
+        for &(t, vector) in &self.exceptions {
+            write_varint(&mut data, t.wrapping_sub(time));
+            data.push(vector as u8);
+            time = t;
+        }
+
+        write_varint(&mut data, self.reads.len() as u64);
+        let mut addr = 0;
+        for read in &self.reads {
+            let kind = size_code(read.size) | if read.value.is_none() { ACCESS_ERROR } else { 0 };
+            data.push(kind);
+            write_signed(&mut data, read.addr.wrapping_sub(addr));
+            if let Some(value) = read.value {
+                write_varint(&mut data, value as u64);
+            }
+            addr = read.addr;
+        }
+
+        write_varint(&mut data, self.wait_cycles.len() as u64);
+        let mut call = 0;
+        for &(c, cycles) in &self.wait_cycles {
+            write_varint(&mut data, c.wrapping_sub(call));
+            write_varint(&mut data, cycles as u64);
+            call = c;
+        }
+
+        output.write_all(&data)
+    }
+
+    /// Reads a log written by [Self::write_to].
+    pub fn read_from<R: Read + ?Sized>(input: &mut R) -> io::Result<Self> {
+        let mut data = Vec::new();
+        input.read_to_end(&mut data)?;
+        if !data.starts_with(&MAGIC) {
+            return Err(invalid_data("not a m68000 input log"));
+        }
+
+        let mut data = Bytes::new(&data[MAGIC.len()..]);
+        let mut log = Self::default();
+
+        let mut time = 0u64;
+        for _ in 0..data.varint()? {
+            time = time.wrapping_add(data.varint()?);
+            log.exceptions.push((time, vector_from_u8(data.u8()?)?));
+        }
+
+        let mut addr = 0u32;
+        for _ in 0..data.varint()? {
+            let kind = data.u8()?;
+            let size = size_from_code(kind)?;
+            addr = addr.wrapping_add(data.signed()?);
+            let value = if kind & ACCESS_ERROR == 0 { Some(data.varint()? as u32) } else { None };
+            log.reads.push(MmioRead { addr, size, value });
+        }
+
+        let mut call = 0u64;
+        for _ in 0..data.varint()? {
+            call = call.wrapping_add(data.varint()?);
+            log.wait_cycles.push((call, data.varint()? as usize));
+        }
+
+        if !data.is_empty() {
+            return Err(invalid_data("trailing data in input log"));
+        }
+
+        Ok(log)
+    }
+}
+
+/// A position in an [InputLog], to start a replay from a snapshot.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct ReplayPosition {
+    time: u64,
+    exceptions: usize,
+    reads: usize,
+    wait_cycles: usize,
+    wait_calls: u64,
+}
+
+impl ReplayPosition {
+    /// Returns the time in cycles since the beginning of the recording.
+    pub fn time(&self) -> u64 {
+        self.time
+    }
+}
+
+/// Returns true if the access of `len` bytes at `addr` overlaps one of the ranges.
+fn is_mmio(ranges: &[Range<u32>], addr: u32, len: u32) -> bool {
+    let end = addr.wrapping_add(len);
+    ranges.iter().any(|range| addr < range.end && range.start < end)
+}
+
+/// Runs a core and records its external inputs.
+#[derive(Clone, Debug, Default)]
+pub struct InputRecorder {
+    log: InputLog,
+    ranges: Vec<Range<u32>>,
+    position: ReplayPosition,
+}
+
+impl InputRecorder {
+    /// Creates a new recorder with no MMIO range.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Records the reads from the given range.
+    pub fn add_mmio_range(&mut self, range: Range<u32>) {
+        self.ranges.push(range);
+    }
+
+    /// Returns the current position in the log.
+    pub fn position(&self) -> ReplayPosition {
+        self.position
+    }
+
+    /// Returns the recorded inputs.
+    pub fn log(&self) -> &InputLog {
+        &self.log
+    }
+
+    /// Returns the recorded inputs.
+    pub fn into_log(self) -> InputLog {
+        self.log
+    }
+
+    /// Requests the given exception on the core and records it at the current time.
+    pub fn exception<CPU: CpuDetails>(&mut self, cpu: &mut M68000<CPU>, exception: Exception) {
+        self.log.exceptions.push((self.position.time, exception.vector));
+        self.position.exceptions += 1;
+        cpu.exception(exception);
+    }
+
+    /// Runs the core for at least the given number of cycles with [M68000::cycle], recording the MMIO reads.
+    ///
+    /// Returns the number of cycles executed.
+    pub fn cycle<CPU: CpuDetails, M: MemoryAccess + ?Sized>(&mut self, cpu: &mut M68000<CPU>, memory: &mut M, cycles: usize) -> usize {
+        let mut memory = RecordMemory { memory, recorder: self };
+        let cycles = cpu.cycle(&mut memory, cycles);
+        self.position.time += cycles as u64;
+        cycles
+    }
+}
+
+/// Memory wrapper that records the reads from the MMIO ranges and the wait cycles.
+struct RecordMemory<'a, M: MemoryAccess + ?Sized> {
+    memory: &'a mut M,
+    recorder: &'a mut InputRecorder,
+}
+
+impl<M: MemoryAccess + ?Sized> RecordMemory<'_, M> {
+    #[inline(always)]
+    fn record(&mut self, addr: u32, size: Size, value: Option<u32>) {
+        if is_mmio(&self.recorder.ranges, addr, size as u32) {
+            self.recorder.log.reads.push(MmioRead { addr, size, value });
+            self.recorder.position.reads += 1;
+        }
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> MemoryAccess for RecordMemory<'_, M> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        let data = self.memory.get_byte(addr);
+        self.record(addr, Size::Byte, data.map(u32::from));
+        data
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let data = self.memory.get_word(addr);
+        self.record(addr, Size::Word, data.map(u32::from));
+        data
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        let data = self.memory.get_long(addr);
+        self.record(addr, Size::Long, data);
+        data
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.memory.set_word(addr, value)
+    }
+
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        self.memory.set_long(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        if !is_mmio(&self.recorder.ranges, addr, data.len() as u32) {
+            return self.memory.get_block(addr, data);
+        }
+
+        for (i, word) in data.chunks_exact_mut(2).enumerate() {
+            word.copy_from_slice(&self.get_word(addr.wrapping_add(i as u32 * 2))?.to_be_bytes());
+        }
+        Some(())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        if !is_mmio(&self.recorder.ranges, addr, data.len() as u32) {
+            return self.memory.set_block(addr, data);
+        }
+
+        for (i, word) in data.chunks_exact(2).enumerate() {
+            self.memory.set_word(addr.wrapping_add(i as u32 * 2), u16::from_be_bytes([word[0], word[1]]))?;
+        }
+        Some(())
+    }
+
+    fn reset_instruction(&mut self) {
+        self.memory.reset_instruction();
+    }
+
+    fn take_wait_cycles(&mut self) -> usize {
+        let cycles = self.memory.take_wait_cycles();
+        let position = &mut self.recorder.position;
+        if cycles != 0 {
+            self.recorder.log.wait_cycles.push((position.wait_calls, cycles));
+            position.wait_cycles += 1;
+        }
+        position.wait_calls += 1;
+        cycles
+    }
+}
+
+/// Runs a core with the external inputs of an [InputLog].
+#[derive(Clone, Debug)]
+pub struct InputPlayer {
+    log: InputLog,
+    ranges: Vec<Range<u32>>,
+    position: ReplayPosition,
+    diverged: bool,
+}
+
+impl InputPlayer {
+    /// Creates a new player that replays the log from its beginning.
+    pub fn new(log: InputLog) -> Self {
+        Self::with_position(log, ReplayPosition::default())
+    }
+
+    /// Creates a new player that replays the log from the given position, returned by [InputRecorder::position].
+    ///
+    /// The core and the memory have to be in the state they were in when the position has been returned.
+    pub fn with_position(log: InputLog, position: ReplayPosition) -> Self {
+        Self {
+            log,
+            ranges: Vec::new(),
+            position,
+            diverged: false,
+        }
+    }
+
+    /// Answers the reads from the given range with the logged values.
+    ///
+    /// The ranges must be the ones given to the recorder.
+    pub fn add_mmio_range(&mut self, range: Range<u32>) {
+        self.ranges.push(range);
+    }
+
+    /// Returns the current position in the log.
+    pub fn position(&self) -> ReplayPosition {
+        self.position
+    }
+
+    /// Returns true if all the logged exceptions and MMIO reads have been replayed.
+    pub fn is_finished(&self) -> bool {
+        self.position.exceptions == self.log.exceptions.len() && self.position.reads == self.log.reads.len()
+    }
+
+    /// Returns true if the execution did not match the log: an MMIO read that has not been recorded, or an exception
+    /// that could not be requested at its time.
+    ///
+    /// This happens when the initial state, the memory or the MMIO ranges are not the ones of the recording.
+    /// The unrecorded reads trigger an access error.
+    pub fn diverged(&self) -> bool {
+        self.diverged
+    }
+
+    /// Runs the core for at least the given number of cycles, requesting the logged exceptions at their time.
+    ///
+    /// Returns the number of cycles executed.
+    pub fn cycle<CPU: CpuDetails, M: MemoryAccess + ?Sized>(&mut self, cpu: &mut M68000<CPU>, memory: &mut M, cycles: usize) -> usize {
+        let mut total = 0;
+
+        loop {
+            self.request_exceptions(cpu);
+            if total >= cycles {
+                return total;
+            }
+
+            let mut budget = cycles - total;
+            if let Some(&(time, _)) = self.log.exceptions.get(self.position.exceptions) {
+                budget = budget.min((time - self.position.time) as usize);
+            }
+
+            let c = cpu.cycle(&mut ReplayMemory { memory: &mut *memory, player: self }, budget);
+            self.position.time += c as u64;
+            total += c;
+        }
+    }
+
+    /// Requests the exceptions whose time has been reached.
+    fn request_exceptions<CPU: CpuDetails>(&mut self, cpu: &mut M68000<CPU>) {
+        while let Some(&(time, vector)) = self.log.exceptions.get(self.position.exceptions) {
+            if time > self.position.time {
+                break;
+            }
+
+            self.diverged |= time != self.position.time;
+            cpu.exception(Exception::from(vector));
+            self.position.exceptions += 1;
+        }
+    }
+}
+
+/// Memory wrapper that answers the reads from the MMIO ranges and the wait cycles with the logged values.
+struct ReplayMemory<'a, M: MemoryAccess + ?Sized> {
+    memory: &'a mut M,
+    player: &'a mut InputPlayer,
+}
+
+impl<M: MemoryAccess + ?Sized> ReplayMemory<'_, M> {
+    #[inline(always)]
+    fn is_mmio(&self, addr: u32, len: u32) -> bool {
+        is_mmio(&self.player.ranges, addr, len)
+    }
+
+    fn replay(&mut self, addr: u32, size: Size) -> Option<u32> {
+        let position = &mut self.player.position;
+        match self.player.log.reads.get(position.reads) {
+            Some(read) if read.addr == addr && read.size == size => {
+                position.reads += 1;
+                read.value
+            },
+            _ => {
+                self.player.diverged = true;
+                None
+            },
+        }
+    }
+}
+
+impl<M: MemoryAccess + ?Sized> MemoryAccess for ReplayMemory<'_, M> {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        if self.is_mmio(addr, 1) {
+            return self.replay(addr, Size::Byte).map(|data| data as u8);
+        }
+        self.memory.get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        if self.is_mmio(addr, 2) {
+            return self.replay(addr, Size::Word).map(|data| data as u16);
+        }
+        self.memory.get_word(addr)
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        if self.is_mmio(addr, 4) {
+            return self.replay(addr, Size::Long);
+        }
+        self.memory.get_long(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        if self.is_mmio(addr, 1) {
+            return Some(());
+        }
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        if self.is_mmio(addr, 2) {
+            return Some(());
+        }
+        self.memory.set_word(addr, value)
+    }
+
+    fn set_long(&mut self, addr: u32, value: u32) -> Option<()> {
+        if self.is_mmio(addr, 4) {
+            return Some(());
+        }
+        self.memory.set_long(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        if !self.is_mmio(addr, data.len() as u32) {
+            return self.memory.get_block(addr, data);
+        }
+
+        for (i, word) in data.chunks_exact_mut(2).enumerate() {
+            word.copy_from_slice(&self.get_word(addr.wrapping_add(i as u32 * 2))?.to_be_bytes());
+        }
+        Some(())
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        if !self.is_mmio(addr, data.len() as u32) {
+            return self.memory.set_block(addr, data);
+        }
+
+        for (i, word) in data.chunks_exact(2).enumerate() {
+            self.set_word(addr.wrapping_add(i as u32 * 2), u16::from_be_bytes([word[0], word[1]]))?;
+        }
+        Some(())
+    }
+
+    fn reset_instruction(&mut self) {
+        self.memory.reset_instruction();
+    }
+
+    fn take_wait_cycles(&mut self) -> usize {
+        self.memory.take_wait_cycles();
+
+        let position = &mut self.player.position;
+        let cycles = match self.player.log.wait_cycles.get(position.wait_cycles) {
+            Some(&(call, cycles)) if call == position.wait_calls => {
+                position.wait_cycles += 1;
+                cycles
+            },
+            _ => 0,
+        };
+        position.wait_calls += 1;
+        cycles
+    }
+}
@@ -0,0 +1,139 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Read-only program images shared by many cores.
+//!
+//! A [Rom] is a reference-counted immutable buffer: cloning it does not copy the image, so all the cores of the process
+//! running the same firmware share a single copy of it, loaded once. The resident memory and the startup time do not
+//! depend on the number of instances.
+//!
+//! A [Rom] implements [MemoryAccess] like a `[u8]` starting at address 0, interpreted as big-endian, where writes fail
+//! with an Access Error. It can also be mapped directly in the address space of a core with [M68000::map_rom], which
+//! keeps a reference to the image as long as it is mapped.
+//!
+//! ```
+//! use m68000::M68000;
+//! use m68000::cpu_details::Mc68000;
+//! use m68000::rom::Rom;
+//!
+//! // MOVEQ #42, D0 and STOP #0x2700
+//! let rom = Rom::new([0x70, 0x2A, 0x4E, 0x72, 0x27, 0x00].as_slice());
+//!
+//! let mut cores: Vec<M68000<Mc68000>> = (0..4).map(|_| M68000::new_no_reset()).collect();
+//! for cpu in &mut cores {
+//!     let mut memory = rom.clone(); // Does not copy the image.
+//!     cpu.loop_until_exception_stop(&mut memory);
+//!     assert_eq!(cpu.regs.d[0].0, 42);
+//! }
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+
+use std::io;
+use std::path::Path;
+use std::sync::Arc;
+
+/// A read-only memory image, shared between its clones.
+#[derive(Clone, Debug)]
+pub struct Rom {
+    data: Arc<[u8]>,
+}
+
+impl Rom {
+    /// Creates a new ROM image with the given content.
+    pub fn new(data: impl Into<Arc<[u8]>>) -> Self {
+        Self { data: data.into() }
+    }
+
+    /// Reads the whole given file in a new ROM image.
+    pub fn from_file(path: impl AsRef<Path>) -> io::Result<Self> {
+        Ok(Self::new(std::fs::read(path)?))
+    }
+
+    /// Returns the content of the image.
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.data
+    }
+
+    /// Returns the length in bytes of the image.
+    pub fn len(&self) -> usize {
+        self.data.len()
+    }
+
+    /// Returns true if the image is empty.
+    pub fn is_empty(&self) -> bool {
+        self.data.is_empty()
+    }
+
+    /// Returns true if both images share the same buffer.
+    pub fn ptr_eq(&self, other: &Self) -> bool {
+        Arc::ptr_eq(&self.data, &other.data)
+    }
+}
+
+impl From<Vec<u8>> for Rom {
+    fn from(data: Vec<u8>) -> Self {
+        Self::new(data)
+    }
+}
+
+impl MemoryAccess for Rom {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.as_bytes().get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        let addr = addr as usize;
+        let data = self.data.get(addr..addr.checked_add(2)?)?;
+        Some(u16::from_be_bytes(data.try_into().unwrap()))
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        let addr = addr as usize;
+        let data = self.data.get(addr..addr.checked_add(4)?)?;
+        Some(u32::from_be_bytes(data.try_into().unwrap()))
+    }
+
+    /// Writes to a ROM always fail.
+    fn set_byte(&mut self, _: u32, _: u8) -> Option<()> {
+        None
+    }
+
+    /// Writes to a ROM always fail.
+    fn set_word(&mut self, _: u32, _: u16) -> Option<()> {
+        None
+    }
+
+    /// Writes to a ROM always fail.
+    fn set_long(&mut self, _: u32, _: u32) -> Option<()> {
+        None
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        self.as_bytes().get_block(addr, data)
+    }
+
+    /// Writes to a ROM always fail.
+    fn set_block(&mut self, _: u32, _: &[u8]) -> Option<()> {
+        None
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Maps the given ROM image read-only to the addresses starting at `addr`.
+    ///
+    /// The core keeps a reference to the image until all its pages are unmapped, so the image is not copied and is
+    /// shared with the other cores it is mapped in. Writes to the range are forwarded to the [MemoryAccess]
+    /// implementation like any read-only page. See [MemoryMap::map](crate::memory_map::MemoryMap::map).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `addr` is not a multiple of [PAGE_SIZE](crate::memory_map::PAGE_SIZE)
+    /// or if the range overflows the 32-bits address space.
+    pub fn map_rom(&mut self, addr: u32, rom: &Rom) {
+        self.memory_map.get_or_insert_with(Box::default).map_shared(addr, rom.data.clone());
+    }
+}
@@ -0,0 +1,240 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Event scheduler that runs the core until the next device deadline.
+//!
+//! The application schedules the events of its devices (timers, serial ports, video, etc.) at a given cycle in a
+//! [Scheduler], then calls [M68000::run_scheduler]. The core executes instructions until the nearest deadline,
+//! calls the event handler, which can request interrupts with [M68000::exception] and schedule the next events,
+//! and continues without returning to the application.
+//!
+//! When the CPU is stopped, the time directly advances to the next event instead of looping over the interpreter.
+//!
+//! ```
+//! use m68000::M68000;
+//! use m68000::cpu_details::Mc68000;
+//! use m68000::exception::{Exception, Vector};
+//! use m68000::scheduler::Scheduler;
+//!
+//! #[derive(Clone, Copy)]
+//! enum Event {
+//!     Timer,
+//! }
+//!
+//! let mut memory = vec![0u16; 0x8000]; // Load the program in memory here.
+//! memory[0..2].copy_from_slice(&m68000::assembler::stop(0x2000));
+//! let mut cpu = M68000::<Mc68000>::new_no_reset();
+//! cpu.regs.ssp.0 = 0x1_0000;
+//! let mut scheduler = Scheduler::new();
+//! scheduler.schedule_in(1000, Event::Timer);
+//!
+//! let frame_end = 100_000;
+//! let vector = cpu.run_scheduler(&mut memory[..], &mut scheduler, frame_end, |cpu, _, scheduler, event| match event.data {
+//!     Event::Timer => {
+//!         cpu.exception(Exception::from(Vector::Level4Interrupt));
+//!         scheduler.schedule(event.deadline + 1000, Event::Timer);
+//!     },
+//! });
+//! assert!(vector.is_none() && scheduler.time() >= frame_end);
+//! ```
+
+use crate::{CpuDetails, M68000, MemoryAccess};
+use crate::exception::Vector;
+
+use std::cmp::{Ordering, Reverse};
+use std::collections::BinaryHeap;
+
+/// An event scheduled at a given cycle.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Event<E> {
+    /// The cycle at which the event occurs.
+    pub deadline: u64,
+    /// The application-defined data of the event.
+    pub data: E,
+}
+
+/// Event in the heap. Events with the same deadline are ordered by insertion order.
+#[derive(Clone, Debug)]
+struct Entry<E> {
+    event: Event<E>,
+    sequence: u64,
+}
+
+impl<E> Entry<E> {
+    fn key(&self) -> (u64, u64) {
+        (self.event.deadline, self.sequence)
+    }
+}
+
+impl<E> PartialEq for Entry<E> {
+    fn eq(&self, other: &Self) -> bool {
+        self.key() == other.key()
+    }
+}
+
+impl<E> Eq for Entry<E> {}
+
+impl<E> PartialOrd for Entry<E> {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl<E> Ord for Entry<E> {
+    fn cmp(&self, other: &Self) -> Ordering {
+        self.key().cmp(&other.key())
+    }
+}
+
+/// Min-heap of timed events, along with the current time in cycles.
+#[derive(Clone, Debug)]
+pub struct Scheduler<E> {
+    /// The current time in cycles.
+    time: u64,
+    events: BinaryHeap<Reverse<Entry<E>>>,
+    sequence: u64,
+}
+
+impl<E> Scheduler<E> {
+    /// Creates a new scheduler at time 0 with no event.
+    pub fn new() -> Self {
+        Self::with_capacity(0)
+    }
+
+    /// Creates a new scheduler at time 0 that can contain `capacity` events without allocating.
+    pub fn with_capacity(capacity: usize) -> Self {
+        Self {
+            time: 0,
+            events: BinaryHeap::with_capacity(capacity),
+            sequence: 0,
+        }
+    }
+
+    /// Returns the current time in cycles.
+    pub fn time(&self) -> u64 {
+        self.time
+    }
+
+    /// Advances the current time by the given number of cycles, without executing anything.
+    pub fn advance(&mut self, cycles: u64) {
+        self.time += cycles;
+    }
+
+    /// Schedules an event at the given cycle. If the deadline is already passed, the event occurs as soon as possible.
+    pub fn schedule(&mut self, deadline: u64, data: E) {
+        self.events.push(Reverse(Entry { event: Event { deadline, data }, sequence: self.sequence }));
+        self.sequence += 1;
+    }
+
+    /// Schedules an event `delay` cycles after the current time.
+    pub fn schedule_in(&mut self, delay: u64, data: E) {
+        self.schedule(self.time + delay, data);
+    }
+
+    /// Returns the deadline of the nearest event if any.
+    pub fn next_deadline(&self) -> Option<u64> {
+        self.events.peek().map(|e| e.0.event.deadline)
+    }
+
+    /// Removes and returns the nearest event if its deadline is reached.
+    pub fn pop_due(&mut self) -> Option<Event<E>> {
+        if self.next_deadline()? <= self.time {
+            self.events.pop().map(|e| e.0.event)
+        } else {
+            None
+        }
+    }
+
+    /// Removes the events for which `f` returns false.
+    pub fn retain(&mut self, mut f: impl FnMut(&Event<E>) -> bool) {
+        self.events.retain(|e| f(&e.0.event));
+    }
+
+    /// Returns the number of scheduled events.
+    pub fn len(&self) -> usize {
+        self.events.len()
+    }
+
+    /// Returns true if no event is scheduled.
+    pub fn is_empty(&self) -> bool {
+        self.events.is_empty()
+    }
+
+    /// Removes all the events. The current time is not modified.
+    pub fn clear(&mut self) {
+        self.events.clear();
+    }
+}
+
+impl<E> Default for Scheduler<E> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Runs the CPU until the time of the scheduler reaches `until`, or until an exception occurs.
+    ///
+    /// Each time the deadline of an event is reached, the event is removed from the scheduler and `handler` is called
+    /// with it. The handler can request exceptions with [M68000::exception] and schedule new events.
+    /// Since instructions are not interrupted, an event may be handled a few cycles after its deadline.
+    ///
+    /// When the CPU is stopped, the time directly advances to the next event or to `until`. When it is stopped by a
+    /// [hook](crate::hooks), this method returns None immediately.
+    ///
+    /// Returns the vector of the exception that occured during the execution of an instruction if any.
+    /// In this case, the time of the scheduler includes the instruction that raised it.
+    /// To process the returned exception, call [M68000::exception] and then this method again to continue.
+    pub fn run_scheduler<M: MemoryAccess + ?Sized, E>(
+        &mut self,
+        memory: &mut M,
+        scheduler: &mut Scheduler<E>,
+        until: u64,
+        mut handler: impl FnMut(&mut Self, &mut M, &mut Scheduler<E>, Event<E>),
+    ) -> Option<Vector> {
+        loop {
+            while let Some(event) = scheduler.pop_due() {
+                handler(self, memory, scheduler, event);
+            }
+
+            if scheduler.time >= until {
+                return None;
+            }
+
+            let deadline = scheduler.next_deadline().map_or(until, |d| d.min(until));
+            if self.stop {
+                if self.hook_event().is_some() {
+                    return None;
+                }
+                self.counters.stopped_cycles += deadline - scheduler.time;
+                scheduler.time = deadline;
+                continue;
+            }
+
+            while scheduler.time < deadline {
+                let pc = self.regs.pc.0;
+                let (cycles, vector) = self.interpreter_exception(memory);
+                scheduler.time += cycles as u64;
+
+                if vector.is_some() {
+                    return vector;
+                }
+
+                if self.idle_detection.is_some() && scheduler.time < deadline {
+                    let budget = (deadline - scheduler.time).try_into().unwrap_or(usize::MAX);
+                    let (cycles, vector) = self.skip_idle_loop(memory, pc, budget);
+                    scheduler.time += cycles as u64;
+
+                    if vector.is_some() {
+                        return vector;
+                    }
+                }
+
+                if self.stop {
+                    break;
+                }
+            }
+        }
+    }
+}
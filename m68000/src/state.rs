@@ -0,0 +1,143 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Fixed-size snapshots of the CPU state, for rewinding and checkpointing.
+//!
+//! [M68000::save_state] serializes the registers, the STOP state, the current opcode and the pending exceptions
+//! in a [CpuState], a plain array of bytes with a stable little-endian layout and a version number.
+//! Saving and loading a state does not allocate, so an application can keep many of them in a preallocated buffer.
+//!
+//! The instruction cache, the memory map and the profiler are configuration of the host and are not part of the state.
+//! The memory is not part of the state either: when the application restores its memory along with the CPU state,
+//! it has to invalidate the modified range of the instruction cache (see [M68000::invalidate_instruction_cache]).
+//! [M68000::load_state] discards the [prefetch window](crate::prefetch), so the restored PC is fetched again from the
+//! memory.
+
+use crate::{CpuDetails, M68000};
+use crate::exception::PendingExceptions;
+
+use std::num::Wrapping;
+
+/// Version of the layout of the states created by this version of the library.
+pub const STATE_VERSION: u32 = 1;
+/// The size in bytes of a [CpuState].
+pub const STATE_SIZE: usize = 128;
+
+const VERSION: usize = 0;
+const D: usize = 4;
+const A: usize = D + 8 * 4;
+const USP: usize = A + 7 * 4;
+const SSP: usize = USP + 4;
+const PC: usize = SSP + 4;
+const SR: usize = PC + 4;
+const CURRENT_OPCODE: usize = SR + 2;
+const STOP: usize = CURRENT_OPCODE + 2;
+const EXCEPTIONS: usize = 88;
+
+const _: () = assert!(STOP < EXCEPTIONS && EXCEPTIONS + 4 * 8 <= STATE_SIZE);
+
+/// Serialized state of a core.
+///
+/// The bytes can be stored and loaded as-is, the unused bytes are reserved for future versions and set to 0.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Hash)]
+#[repr(transparent)]
+pub struct CpuState(pub [u8; STATE_SIZE]);
+
+impl CpuState {
+    /// Returns an empty state, which can only be used as a placeholder as it has no valid version.
+    pub const fn new() -> Self {
+        Self([0; STATE_SIZE])
+    }
+
+    /// Returns the version of the layout of this state.
+    pub fn version(&self) -> u32 {
+        self.get_u32(VERSION)
+    }
+
+    fn get_u16(&self, offset: usize) -> u16 {
+        u16::from_le_bytes([self.0[offset], self.0[offset + 1]])
+    }
+
+    fn get_u32(&self, offset: usize) -> u32 {
+        u32::from_le_bytes(self.0[offset..offset + 4].try_into().unwrap())
+    }
+
+    fn get_u64(&self, offset: usize) -> u64 {
+        u64::from_le_bytes(self.0[offset..offset + 8].try_into().unwrap())
+    }
+
+    fn set_u16(&mut self, offset: usize, value: u16) {
+        self.0[offset..offset + 2].copy_from_slice(&value.to_le_bytes());
+    }
+
+    fn set_u32(&mut self, offset: usize, value: u32) {
+        self.0[offset..offset + 4].copy_from_slice(&value.to_le_bytes());
+    }
+
+    fn set_u64(&mut self, offset: usize, value: u64) {
+        self.0[offset..offset + 8].copy_from_slice(&value.to_le_bytes());
+    }
+}
+
+impl Default for CpuState {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<CPU: CpuDetails> M68000<CPU> {
+    /// Returns a snapshot of the state of the core.
+    pub fn save_state(&self) -> CpuState {
+        let mut state = CpuState::new();
+        state.set_u32(VERSION, STATE_VERSION);
+
+        for (i, d) in self.regs.d.iter().enumerate() {
+            state.set_u32(D + i * 4, d.0);
+        }
+        for (i, a) in self.regs.a.iter().enumerate() {
+            state.set_u32(A + i * 4, a.0);
+        }
+        state.set_u32(USP, self.regs.usp.0);
+        state.set_u32(SSP, self.regs.ssp.0);
+        state.set_u32(PC, self.regs.pc.0);
+        state.set_u16(SR, self.regs.sr.into());
+
+        state.set_u16(CURRENT_OPCODE, self.current_opcode);
+        state.0[STOP] = self.stopped_by_instruction() as u8;
+        for (i, bits) in self.exceptions.bits().into_iter().enumerate() {
+            state.set_u64(EXCEPTIONS + i * 8, bits);
+        }
+
+        state
+    }
+
+    /// Restores the state of the core saved by [Self::save_state].
+    ///
+    /// If the version of the state is not supported, the core is not modified and the Err variant contains the version.
+    /// The prefetch window is discarded.
+    pub fn load_state(&mut self, state: &CpuState) -> Result<(), u32> {
+        let version = state.version();
+        if version != STATE_VERSION {
+            return Err(version);
+        }
+
+        for (i, d) in self.regs.d.iter_mut().enumerate() {
+            *d = Wrapping(state.get_u32(D + i * 4));
+        }
+        for (i, a) in self.regs.a.iter_mut().enumerate() {
+            *a = Wrapping(state.get_u32(A + i * 4));
+        }
+        self.regs.usp.0 = state.get_u32(USP);
+        self.regs.ssp.0 = state.get_u32(SSP);
+        self.regs.pc.0 = state.get_u32(PC);
+        self.regs.sr = state.get_u16(SR).into();
+
+        self.current_opcode = state.get_u16(CURRENT_OPCODE);
+        self.set_stopped_by_instruction(state.0[STOP] != 0);
+        self.exceptions = PendingExceptions::from_bits(std::array::from_fn(|i| state.get_u64(EXCEPTIONS + i * 8)));
+        self.invalidate_prefetch();
+
+        Ok(())
+    }
+}
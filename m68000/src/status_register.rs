@@ -98,14 +98,57 @@ impl StatusRegister {
         self.z || self.n && !self.v || !self.n && self.v
     }
 
-    const CONDITIONS: [fn(&Self) -> bool; 16] = [
-        Self::t,  Self::f,  Self::hi, Self::ls, Self::cc, Self::cs, Self::ne, Self::eq,
-        Self::vc, Self::vs, Self::pl, Self::mi, Self::ge, Self::lt, Self::gt, Self::le,
-    ];
+    /// Evaluates the given condition from the flags.
+    const fn evaluate_condition(&self, cc: u8) -> bool {
+        match cc & 0xF {
+            0 => self.t(),
+            1 => self.f(),
+            2 => self.hi(),
+            3 => self.ls(),
+            4 => self.cc(),
+            5 => self.cs(),
+            6 => self.ne(),
+            7 => self.eq(),
+            8 => self.vc(),
+            9 => self.vs(),
+            10 => self.pl(),
+            11 => self.mi(),
+            12 => self.ge(),
+            13 => self.lt(),
+            14 => self.gt(),
+            _ => self.le(),
+        }
+    }
+
+    /// Truth table of the conditions. Bit `NZVC` of entry `cc` is the result of the condition `cc`
+    /// when the N, Z, V and C flags have these values.
+    const CONDITIONS: [u16; 16] = {
+        let mut table = [0; 16];
+        let mut cc = 0;
+        while cc < 16 {
+            let mut flags = 0;
+            while flags < 16 {
+                let sr = StatusRegister {
+                    t: false, s: false, interrupt_mask: 0, x: false,
+                    n: flags & 8 != 0, z: flags & 4 != 0, v: flags & 2 != 0, c: flags & 1 != 0,
+                };
+                if sr.evaluate_condition(cc as u8) {
+                    table[cc] |= 1 << flags;
+                }
+                flags += 1;
+            }
+            cc += 1;
+        }
+        table
+    };
 
     /// Tests the given condition from the raw bits of conditional instructions.
+    ///
+    /// This is a look-up in a truth table indexed by the flags, so conditional instructions do not branch on each flag.
+    #[inline(always)]
     pub fn condition(&self, cc: u8) -> bool {
-        Self::CONDITIONS[cc as usize](self)
+        let flags = (self.n as u16) << 3 | (self.z as u16) << 2 | (self.v as u16) << 1 | self.c as u16;
+        Self::CONDITIONS[cc as usize & 0xF] >> flags & 1 != 0
     }
 
     /// Sets the CCR bits to the one's of the given status register. Supervisor bits are unchanged.
@@ -0,0 +1,86 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Execution trace stored as compact binary records for deferred disassembly.
+//!
+//! [M68000::trace_interpreter](crate::M68000::trace_interpreter) stores each executed [Instruction] in a
+//! [TraceRing] instead of formatting it, so tracing does not allocate.
+//! The records can be disassembled later with [Instruction::disassemble_to] in a reused buffer,
+//! for example only when a crash has to be investigated.
+
+use crate::exception::Vector;
+use crate::instruction::Instruction;
+
+/// An executed instruction.
+#[derive(Clone, Copy, Debug)]
+pub struct TraceRecord {
+    /// The instruction that has been executed. Its `pc` member is the address of the instruction.
+    pub instruction: Instruction,
+    /// The cycle count necessary to execute the instruction (and the pending exceptions processed before it).
+    pub cycles: usize,
+    /// The vector of the exception that occured during the execution if any.
+    pub exception: Option<Vector>,
+}
+
+/// Fixed-capacity ring buffer of [TraceRecord]s, which keeps the most recent records.
+#[derive(Clone, Debug)]
+pub struct TraceRing {
+    records: Vec<TraceRecord>,
+    capacity: usize,
+    /// Index of the oldest record when the ring is full.
+    head: usize,
+}
+
+impl TraceRing {
+    /// Creates a new empty ring that keeps up to `capacity` records.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `capacity` is 0.
+    pub fn new(capacity: usize) -> Self {
+        assert!(capacity > 0, "Trace ring capacity must not be 0");
+        Self {
+            records: Vec::with_capacity(capacity),
+            capacity,
+            head: 0,
+        }
+    }
+
+    /// Adds a record to the ring, overwriting the oldest one if the ring is full.
+    pub fn push(&mut self, record: TraceRecord) {
+        if self.records.len() < self.capacity {
+            self.records.push(record);
+        } else {
+            self.records[self.head] = record;
+            self.head = (self.head + 1) % self.capacity;
+        }
+    }
+
+    /// Returns the maximum number of records kept in the ring.
+    pub fn capacity(&self) -> usize {
+        self.capacity
+    }
+
+    /// Returns the number of records currently in the ring.
+    pub fn len(&self) -> usize {
+        self.records.len()
+    }
+
+    /// Returns true if the ring contains no record.
+    pub fn is_empty(&self) -> bool {
+        self.records.is_empty()
+    }
+
+    /// Removes all the records.
+    pub fn clear(&mut self) {
+        self.records.clear();
+        self.head = 0;
+    }
+
+    /// Returns an iterator over the records, from the oldest to the most recent.
+    pub fn iter(&self) -> impl Iterator<Item = &TraceRecord> {
+        let (recent, old) = self.records.split_at(self.head);
+        old.iter().chain(recent.iter())
+    }
+}
@@ -189,3 +189,31 @@ impl_integer!(i16, -0x8000);
 impl_integer!(u16, 0x8000);
 impl_integer!(i32, -0x8000_0000);
 impl_integer!(u32, 0x8000_0000);
+
+/// Low-order part of a data register, to read and write the registers in size-generic code.
+pub trait RegisterOperand : Integer {
+    /// Returns the low-order part of the given register value.
+    fn from_register(reg: u32) -> Self;
+    /// Returns the given register value with its low-order part replaced by `self`.
+    fn into_register(self, reg: u32) -> u32;
+}
+
+macro_rules! impl_register_operand {
+    ($t:ty) => {
+        impl RegisterOperand for $t {
+            #[inline(always)]
+            fn from_register(reg: u32) -> Self {
+                reg as Self
+            }
+
+            #[inline(always)]
+            fn into_register(self, reg: u32) -> u32 {
+                reg & !(<$t>::MAX as u32) | self as u32
+            }
+        }
+    };
+}
+
+impl_register_operand!(u8);
+impl_register_operand!(u16);
+impl_register_operand!(u32);
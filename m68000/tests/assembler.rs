@@ -1274,3 +1274,97 @@ fn assembler_unlk() {
         }
     }
 }
+
+#[test]
+fn assembler_builder() {
+    let mut expected = asm::r#move(Long, AM::AbsLong(0x12_3456), AM::Immediate(0x789A_BCDE));
+    expected.push(asm::moveq(3, -1));
+    expected.extend(asm::movem(MemoryToRegister, Word, AM::Ariwpo(7), 0x00FF));
+    expected.extend(asm::stop(0x2700));
+    expected.extend(asm::bra(-(expected.len() as i16 * 2 + 2)));
+
+    let mut buffer = vec![0; 2];
+    let mut builder = asm::Assembler::with_buffer(&mut buffer);
+    builder.clear();
+    let start = builder.label();
+    builder.bind(start)
+        .r#move(Long, AM::AbsLong(0x12_3456), AM::Immediate(0x789A_BCDE))
+        .moveq(3, -1)
+        .movem(MemoryToRegister, Word, AM::Ariwpo(7), 0x00FF)
+        .stop(0x2700)
+        .bra_label(start);
+    builder.finish();
+    assert_eq!(buffer, expected);
+
+    let mut array = [0; 16];
+    let mut slice = asm::SliceBuffer::new(&mut array);
+    let mut builder = asm::Assembler::with_buffer(&mut slice);
+    builder.r#move(Long, AM::AbsLong(0x12_3456), AM::Immediate(0x789A_BCDE))
+        .moveq(3, -1)
+        .movem(MemoryToRegister, Word, AM::Ariwpo(7), 0x00FF)
+        .stop(0x2700)
+        .bra(-(expected.len() as i16 * 2));
+    assert_eq!(builder.words(), expected);
+    assert_eq!(slice.len(), expected.len());
+
+    catch_unwind(|| {
+        let mut array = [0; 4];
+        asm::Assembler::with_buffer(asm::SliceBuffer::new(&mut array)).nop().r#move(Long, AM::AbsLong(0), AM::Immediate(0));
+    }).unwrap_err();
+}
+
+#[test]
+fn assembler_labels() {
+    let mut builder = asm::Assembler::new();
+    let loop_ = builder.label();
+    let far = builder.label();
+    let near = builder.label();
+    builder.bcc_label(CC::EQ, far) // 0
+        .bsr_label(near) // 2
+        .bind(loop_)
+        .nop() // 4
+        .dbcc_label(CC::F, 0, loop_) // 5
+        .bra_label(loop_) // 7
+        .bind(near)
+        .rts() // 8
+        .bind(far);
+    for _ in 0..200 {
+        builder.nop();
+    }
+    builder.bra_label(far);
+
+    let program = builder.finish();
+    assert_eq!(program[..9], [0x6700, 0x0010, 0x6100, 0x000A, 0x4E71, 0x51C8, 0xFFFC, 0x60F8, 0x4E75]);
+    assert_eq!(program[209..], asm::bra(-(200 * 2 + 2)));
+
+    let mut builder = asm::Assembler::new();
+    let label = builder.label();
+    builder.bra_label(label);
+    catch_unwind(move || builder.finish()).unwrap_err();
+
+    let mut builder = asm::Assembler::new();
+    let label = builder.label();
+    builder.bind(label);
+    catch_unwind(move || { builder.bind(label); }).unwrap_err();
+}
+
+#[test]
+fn assembler_const() {
+    const ROM: [u16; 12] = asm::ConstAssembler::new()
+        .r#move(Long, AM::AbsLong(0x12_3456), AM::Immediate(0x789A_BCDE))
+        .moveq(3, -1)
+        .movem(MemoryToRegister, Word, AM::Ariwpo(7), 0x00FF)
+        .stop(0x2700)
+        .bra_to(0)
+        .finish();
+
+    let mut expected = asm::r#move(Long, AM::AbsLong(0x12_3456), AM::Immediate(0x789A_BCDE));
+    expected.push(asm::moveq(3, -1));
+    expected.extend(asm::movem(MemoryToRegister, Word, AM::Ariwpo(7), 0x00FF));
+    expected.extend(asm::stop(0x2700));
+    expected.extend(asm::bra(-(expected.len() as i16 * 2 + 2)));
+    expected.resize(12, 0);
+    assert_eq!(ROM, expected[..]);
+
+    catch_unwind(|| asm::ConstAssembler::<1>::new().nop().nop()).unwrap_err();
+}
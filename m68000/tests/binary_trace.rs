@@ -0,0 +1,167 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that a recorded binary trace reads back the executed instructions, registers and memory accesses.
+
+use m68000::{M68000, Registers};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::binary_trace::{MemoryRecord, TraceReader, TraceWriter};
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::{Direction, Size};
+
+use std::io::{Cursor, ErrorKind};
+
+const START: u32 = 0x1000;
+const HANDLER: u32 = 0x1100;
+const DATA: u32 = 0x2000;
+
+/// 0x1000 loop: ADDQ.L #1, D0
+/// 0x1002       MOVE.L D0, (DATA).W
+/// 0x1006       MOVEM.L D0-D1, (DATA + 8).W
+/// 0x100C       DBF D1, loop
+/// 0x1010       TRAP #0
+/// 0x1012       STOP #0x2700
+///
+/// 0x1100       RTE
+fn new_cpu() -> (M68000<Mc68000>, Vec<u16>) {
+    let mut program = asm::addq(1, Size::Long, AM::Drd(0));
+    program.extend(asm::r#move(Size::Long, AM::AbsShort(DATA as u16), AM::Drd(0)));
+    program.extend(asm::movem(Direction::RegisterToMemory, Size::Long, AM::AbsShort(DATA as u16 + 8), 0b11));
+    program.extend(asm::dbcc(CC::F, 1, -(program.len() as i16 * 2 + 2)));
+    program.push(asm::trap(0));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x4000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+    memory[HANDLER as usize / 2] = asm::rte();
+    memory[0x80 / 2 + 1] = HANDLER as u16;
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 99;
+    (cpu, memory)
+}
+
+/// Records the program in a trace with the given keyframe interval,
+/// and returns the trace with the registers, cycles and disassembly of each instruction.
+fn record(interval: u32) -> (Vec<u8>, Vec<(Registers, usize, String)>) {
+    let (mut cpu, mut memory) = new_cpu();
+    let (mut expected_cpu, mut expected_memory) = new_cpu();
+    let mut expected = Vec::new();
+    let mut writer = TraceWriter::with_keyframe_interval(Vec::new(), interval);
+
+    while !cpu.stop {
+        let (cycles, vector) = cpu.record_interpreter_exception(&mut memory[..], &mut writer);
+        let (instruction, expected_cycles, expected_vector) = expected_cpu.trace_interpreter_exception(&mut expected_memory[..]);
+        assert_eq!((cycles, vector), (expected_cycles, expected_vector));
+
+        let mut dis = String::new();
+        instruction.unwrap().disassemble_to(&mut dis).unwrap();
+        expected.push((cpu.regs, cycles, dis));
+
+        if let Some(vector) = vector {
+            cpu.exception(Exception::from(vector));
+            expected_cpu.exception(Exception::from(vector));
+        }
+    }
+
+    assert_eq!(memory, expected_memory);
+    assert_eq!(writer.len(), expected.len() as u64);
+    (writer.finish().unwrap(), expected)
+}
+
+#[test]
+fn round_trip() {
+    for interval in [1, 7, 4096] {
+        let (trace, expected) = record(interval);
+        let mut reader = TraceReader::new(Cursor::new(trace)).unwrap();
+        assert_eq!(reader.len(), expected.len() as u64);
+        assert_eq!(reader.block_count(), expected.len().div_ceil(interval as usize));
+
+        for (index, (regs, cycles, dis)) in expected.iter().enumerate() {
+            let entry = reader.get(index as u64).unwrap().unwrap();
+            assert_eq!(entry.index, index as u64);
+            assert_eq!(entry.regs, *regs);
+            assert_eq!(entry.cycles, *cycles);
+
+            let mut entry_dis = String::new();
+            entry.instruction().unwrap().disassemble_to(&mut entry_dis).unwrap();
+            assert_eq!(entry_dis, *dis);
+        }
+
+        assert!(reader.get(expected.len() as u64).unwrap().is_none());
+    }
+}
+
+#[test]
+fn seek() {
+    let (trace, expected) = record(16);
+    let mut reader = TraceReader::new(Cursor::new(trace)).unwrap();
+
+    for index in (0..expected.len()).rev().step_by(5) {
+        let entry = reader.get(index as u64).unwrap().unwrap();
+        assert_eq!(entry.regs, expected[index].0);
+    }
+}
+
+#[test]
+fn memory_accesses() {
+    let (trace, _) = record(4096);
+    let mut reader = TraceReader::new(Cursor::new(trace)).unwrap();
+
+    // First MOVE.L D0, (DATA).W.
+    let entry = reader.get(1).unwrap().unwrap();
+    assert_eq!(entry.pc, 0x1002);
+    assert_eq!(entry.words(), [0x21C0, DATA as u16]);
+    assert_eq!(entry.accesses, [MemoryRecord { addr: DATA, size: Size::Long, write: true, value: Some(1) }]);
+
+    // First MOVEM.L D0-D1, (DATA + 8).W.
+    let entry = reader.get(2).unwrap().unwrap();
+    let words: Vec<_> = entry.accesses.iter().map(|access| (access.addr, access.write, access.value)).collect();
+    assert_eq!(words, [(DATA + 8, true, Some(0)), (DATA + 10, true, Some(1)), (DATA + 12, true, Some(0)), (DATA + 14, true, Some(99))]);
+
+    // TRAP #0 then RTE.
+    let trap = reader.len() - 3;
+    let entry = reader.get(trap).unwrap().unwrap();
+    assert_eq!(entry.exception, Some(Vector::Trap0Instruction));
+    assert!(entry.accesses.is_empty());
+
+    let entry = reader.get(trap + 1).unwrap().unwrap();
+    assert_eq!(entry.pc, HANDLER);
+    assert!(entry.accesses.iter().any(|access| access.addr == 0x80 && access.size == Size::Long && !access.write));
+    assert_eq!(entry.regs.pc.0, 0x1012);
+}
+
+#[test]
+fn compression() {
+    // A loop is encoded in a few bytes per instruction, and the records repeat so the blocks are compressed.
+    let (trace, expected) = record(4096);
+    assert!(trace.len() < expected.len() * 8, "{} bytes for {} instructions", trace.len(), expected.len());
+
+    // The header of the single block, after the magic.
+    let raw_len = u32::from_le_bytes(trace[20..24].try_into().unwrap());
+    let stored_len = u32::from_le_bytes(trace[24..28].try_into().unwrap());
+    assert!(stored_len * 2 < raw_len, "{stored_len} {raw_len}");
+}
+
+#[test]
+fn invalid_trace() {
+    assert!(TraceReader::new(Cursor::new(b"not a trace".to_vec())).is_err());
+
+    let (trace, _) = record(4096);
+    let mut truncated = trace.clone();
+    truncated.truncate(trace.len() - 1);
+    assert_eq!(TraceReader::new(Cursor::new(truncated)).err().unwrap().kind(), ErrorKind::InvalidData);
+
+    // Corrupted instruction count, decompressed size and stored size of the first block header.
+    for (offset, value) in [(8 + 8, u32::MAX), (8 + 12, u32::MAX), (8 + 16, u32::MAX)] {
+        let mut corrupted = trace.clone();
+        corrupted[offset..offset + 4].copy_from_slice(&value.to_le_bytes());
+        assert_eq!(TraceReader::new(Cursor::new(corrupted)).err().unwrap().kind(), ErrorKind::InvalidData);
+    }
+}
@@ -0,0 +1,172 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the control-flow recovery of the image disassembler, its index and the warming of the instruction cache.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler::{Assembler, Condition as CC};
+use m68000::code_map::{CodeEntry, CodeMap, CodeMapView, ImageDisassembler, vector_table_entries};
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::Size;
+use m68000::instruction_cache::InstructionCache;
+
+const IMAGE_LEN: usize = 0x1000;
+
+/// A ROM at address 0, and the addresses of its labels.
+struct Rom {
+    image: Vec<u8>,
+    main: u32,
+    sub: u32,
+    far_sub: u32,
+    count: u32,
+    data: u32,
+    indirect: u32,
+    handler: u32,
+    end: u32,
+}
+
+/// 0x400 far_sub:  ADDQ.L #5, D2
+///                 RTS
+///       main:     BSR sub
+///                 JSR (far_sub).L
+///                 LEA (indirect, PC), A0
+///                 MOVEQ #3, D1
+///       count:    ADDQ.L #1, D0
+///                 DBF D1, count
+///                 TRAP #0
+///                 BRA skip
+///       data:     ILLEGAL (unreachable)
+///                 MOVEQ #0x34, D2
+///                 NOP
+///       skip:     BEQ jump
+///                 STOP #0x2700
+///       jump:     JMP (A0)
+///       sub:      RTS
+///       indirect: STOP #0x2700
+///       handler:  RTE
+///       end:      dc.w 0xFFFF
+fn rom() -> Rom {
+    let mut asm = Assembler::with_buffer(vec![0; 0x200]);
+    let addr = |asm: &Assembler| asm.len() as u32 * 2;
+    let (sub, count, skip, jump, indirect) = (asm.label(), asm.label(), asm.label(), asm.label(), asm.label());
+
+    let far_sub = addr(&asm);
+    asm.addq(5, Size::Long, AM::Drd(2)).rts();
+    let main = addr(&asm);
+    asm.bsr_label(sub).jsr(AM::AbsLong(far_sub));
+    let lea = addr(&asm);
+    asm.lea(0, AM::Pciwd(0, 0)).moveq(1, 3).bind(count);
+    let count_addr = addr(&asm);
+    asm.addq(1, Size::Long, AM::Drd(0)).dbcc_label(CC::F, 1, count).trap(0).bra_label(skip);
+    let data = addr(&asm);
+    asm.illegal().moveq(2, 0x34).nop();
+    asm.bind(skip).bcc_label(CC::EQ, jump).stop(0x2700).bind(jump).jmp(AM::Ari(0)).bind(sub);
+    let sub_addr = addr(&asm);
+    asm.rts().bind(indirect);
+    let indirect_addr = addr(&asm);
+    asm.stop(0x2700);
+    let handler = addr(&asm);
+    asm.rte();
+    let end = addr(&asm);
+    asm.r#move(Size::Word, AM::Drd(0), AM::Drd(0));
+    let mut words = asm.finish();
+    *words.last_mut().unwrap() = 0xFFFF;
+
+    // Fix the displacement of the LEA.
+    words[lea as usize / 2 + 1] = (indirect_addr - lea - 2) as u16;
+    // Initial SSP, initial PC and TRAP #0 vector.
+    words[1] = IMAGE_LEN as u16;
+    words[3] = main as u16;
+    words[0x80 / 2 + 1] = handler as u16;
+
+    let mut image: Vec<u8> = words.iter().flat_map(|word| word.to_be_bytes()).collect();
+    image.resize(IMAGE_LEN, 0xFF);
+    Rom { image, main, sub: sub_addr, far_sub, count: count_addr, data, indirect: indirect_addr, handler, end }
+}
+
+#[test]
+fn control_flow() {
+    let rom = rom();
+    let entries = vector_table_entries(&rom.image, 0);
+    assert_eq!(entries, [rom.main, rom.handler]);
+
+    let code = ImageDisassembler::new(1).disassemble(&rom.image, 0, &entries);
+    for threads in [2, 7, 0] {
+        assert_eq!(ImageDisassembler::new(threads).disassemble(&rom.image, 0, &entries), code);
+    }
+
+    assert_eq!(code.get(rom.main).unwrap().flags, CodeEntry::ENTRY_POINT);
+    assert_eq!(code.get(rom.handler).unwrap().flags, CodeEntry::ENTRY_POINT);
+    assert_eq!(code.get(rom.sub).unwrap().flags, CodeEntry::CALL_TARGET);
+    assert_eq!(code.get(rom.far_sub).unwrap().flags, CodeEntry::CALL_TARGET);
+    assert_eq!(code.get(rom.count).unwrap().flags, CodeEntry::BRANCH_TARGET);
+    assert_eq!(code.get(rom.main).unwrap().len, 4); // Forward branches of the assembler use a 16-bits displacement.
+    assert_eq!(code.get(rom.main + 2), None);
+    assert_eq!(code.find(rom.main + 2), code.get(rom.main));
+
+    // The data after the BRA, the STOP only reached by JMP (A0) and the end of the image are not disassembled.
+    assert_eq!(code.data_ranges(0x400..IMAGE_LEN as u32), [rom.data..rom.data + 6, rom.indirect..rom.handler, rom.end..IMAGE_LEN as u32]);
+    assert_eq!(code.len(), 15);
+
+    let mut entries = entries;
+    entries.push(rom.indirect);
+    let code = ImageDisassembler::new(0).disassemble(&rom.image, 0, &entries);
+    assert_eq!(code.data_ranges(0x400..IMAGE_LEN as u32), [rom.data..rom.data + 6, rom.end..IMAGE_LEN as u32]);
+
+    // The image can be located anywhere.
+    assert_eq!(ImageDisassembler::new(0).disassemble(&rom.image[0x400..], 0x400, &entries), code);
+}
+
+#[test]
+fn serialized_index() {
+    let rom = rom();
+    let code = ImageDisassembler::new(0).disassemble(&rom.image, 0, &vector_table_entries(&rom.image, 0));
+
+    let mut data = Vec::new();
+    code.write_to(&mut data).unwrap();
+    assert_eq!(CodeMap::read_from(&mut &data[..]).unwrap(), code);
+
+    let view = CodeMapView::new(&data).unwrap();
+    assert_eq!(view.len(), code.len());
+    assert!(view.iter().eq(code.iter()));
+    for entry in code.iter() {
+        assert_eq!(view.get(entry.addr), Some(entry));
+        assert_eq!(view.get(entry.addr + 1), None);
+    }
+    assert_eq!(view.get(rom.data), None);
+
+    assert!(CodeMapView::new(&data[..data.len() - 1]).is_err());
+    assert!(CodeMapView::new(b"not a code map").is_err());
+}
+
+#[test]
+fn warm_instruction_cache() {
+    let rom = rom();
+    let code = ImageDisassembler::new(0).disassemble(&rom.image, 0, &vector_table_entries(&rom.image, 0));
+
+    let mut cache = InstructionCache::new();
+    cache.warm(&mut &rom.image[..], code.iter());
+    let blocks = cache.block_count();
+    assert_eq!(blocks, 12);
+    cache.warm(&mut &rom.image[..], code.iter());
+    assert_eq!(cache.block_count(), blocks);
+
+    let run = |warm: bool| {
+        let mut memory = rom.image.clone();
+        let mut cpu = M68000::<Mc68000>::new();
+        cpu.set_instruction_cache(true);
+        if warm {
+            cpu.warm_instruction_cache(&mut memory[..], code.iter());
+        }
+        while !cpu.stop {
+            cpu.cycle(&mut memory[..], 1000);
+        }
+        (cpu.regs, memory)
+    };
+
+    let (regs, memory) = run(true);
+    assert_eq!((regs.d[0].0, regs.d[2].0), (4, 5));
+    assert_eq!((regs, memory), run(false));
+}
@@ -0,0 +1,182 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the performance counters.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::counters::{Counters, MemoryCounters};
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::Size;
+use m68000::scheduler::Scheduler;
+
+const START: u32 = 0x1000;
+const TRAP_HANDLER: u32 = 0x1800;
+const BUDGET: usize = 10_000;
+
+/// START: MOVE.B (0x2000).W, D0
+///        MOVE.W D0, (0x2002).W
+///        MOVE.L (0x2004).W, D1
+///        TRAP #0
+///        MOVEQ #99, D2
+/// delay: DBF D2, delay
+///        STOP #0x2700
+fn memory() -> Vec<u16> {
+    let mut program = asm::r#move(Size::Byte, AM::Drd(0), AM::AbsShort(0x2000));
+    program.extend(asm::r#move(Size::Word, AM::AbsShort(0x2002), AM::Drd(0)));
+    program.extend(asm::r#move(Size::Long, AM::Drd(1), AM::AbsShort(0x2004)));
+    program.push(asm::trap(0));
+    program.push(asm::moveq(2, 99));
+    program.extend(asm::dbcc(CC::F, 2, -2));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x4000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+    memory[Vector::Trap0Instruction as usize * 2 + 1] = TRAP_HANDLER as u16;
+    memory[TRAP_HANDLER as usize / 2] = asm::rte();
+    memory
+}
+
+fn run(configure: impl FnOnce(&mut M68000<Mc68000>)) -> Counters {
+    let mut memory = memory();
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    configure(&mut cpu);
+
+    assert_eq!(cpu.cycle(&mut memory[..], BUDGET), BUDGET);
+    assert!(cpu.stop);
+    *cpu.counters()
+}
+
+#[test]
+fn count_program() {
+    let counters = run(|_| ());
+
+    // 3 MOVE, TRAP, RTE, MOVEQ, 100 DBF and STOP.
+    assert_eq!(counters.instructions, 107);
+    assert_eq!(counters.exceptions[Vector::Trap0Instruction as usize], 1);
+    assert_eq!(counters.total_exceptions(), 1);
+    assert_eq!(counters.cycles + counters.stopped_cycles, BUDGET as u64);
+    assert!(counters.cycles > 100 * 10);
+
+    assert_eq!(counters.memory, MemoryCounters {
+        byte_reads: 1,
+        // The instruction words and the SR popped by RTE.
+        word_reads: 2 + 2 + 2 + 1 + 1 + 1 + 100 * 2 + 2 + 1,
+        // The MOVE.L, the vector and the PC popped by RTE.
+        long_reads: 3,
+        block_reads: 0,
+        byte_writes: 0,
+        // The MOVE.W and the SR pushed by TRAP.
+        word_writes: 2,
+        long_writes: 1,
+        block_writes: 0,
+    });
+}
+
+#[test]
+fn same_counts_on_every_path() {
+    let reference = run(|_| ());
+
+    for counters in [
+        run(|cpu| cpu.set_instruction_cache(true)),
+        run(|cpu| cpu.set_prefetch(true)),
+        run(|cpu| cpu.set_idle_loop_detection(true)),
+    ] {
+        assert_eq!(counters.instructions, reference.instructions);
+        assert_eq!(counters.cycles, reference.cycles);
+        assert_eq!(counters.stopped_cycles, reference.stopped_cycles);
+        assert_eq!(counters.exceptions, reference.exceptions);
+        assert_eq!(counters.memory.long_writes, reference.memory.long_writes);
+    }
+
+    // The cached instructions are not fetched again.
+    let cached = run(|cpu| cpu.set_instruction_cache(true));
+    assert!(cached.memory.word_reads < reference.memory.word_reads);
+}
+
+#[test]
+fn reset_counters() {
+    let mut memory = memory();
+    let mut cpu = M68000::<Mc68000>::new();
+    memory[0] = 0;
+    memory[1] = 0x8000;
+    memory[3] = START as u16;
+
+    cpu.cycle(&mut memory[..], 1);
+    assert_eq!(cpu.counters().exceptions[Vector::ResetSspPc as usize], 1);
+    assert_ne!(cpu.counters().memory, MemoryCounters::default());
+
+    cpu.reset_counters();
+    assert_eq!(*cpu.counters(), Counters::default());
+    cpu.cycle(&mut memory[..], BUDGET);
+    assert_eq!(cpu.counters().exceptions[Vector::Trap0Instruction as usize], 1);
+    assert_eq!(cpu.counters().total_exceptions(), 1);
+}
+
+#[test]
+fn mapped_memory_is_not_counted() {
+    let mut memory = memory();
+    let mut ram: Vec<u8> = memory.iter().flat_map(|word| word.to_be_bytes()).collect();
+    let reference = run(|_| ());
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    unsafe { cpu.map_memory(0, ram.as_mut_ptr(), ram.len(), true); }
+
+    // Every access is served by the memory map, so the memory is never called.
+    assert_eq!(cpu.cycle(&mut [0u16; 0][..], BUDGET), BUDGET);
+    assert!(cpu.stop);
+    assert_eq!(cpu.counters().instructions, reference.instructions);
+    assert_eq!(cpu.counters().memory, MemoryCounters::default());
+
+    // Unmapped accesses are still counted.
+    cpu.unmap_memory(0, ram.len());
+    cpu.reset_counters();
+    cpu.regs.pc.0 = START;
+    cpu.stop = false;
+    cpu.cycle(&mut memory[..], BUDGET);
+    assert_eq!(cpu.counters().memory, reference.memory);
+}
+
+#[test]
+fn prefetched_words_are_not_counted() {
+    let reference = run(|_| ());
+    let counters = run(|cpu| cpu.set_prefetch(true));
+
+    // The window is filled at START, in the TRAP handler and after RTE, with one block read each.
+    // Only the SR popped by RTE is read by word.
+    assert_eq!(counters.memory, MemoryCounters {
+        word_reads: 1,
+        block_reads: 3,
+        ..reference.memory
+    });
+}
+
+#[test]
+fn stopped_in_scheduler() {
+    let reference = run(|_| ());
+
+    let mut memory = memory();
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+
+    // The time jumps to the event and then to the end while stopped.
+    let mut scheduler = Scheduler::new();
+    scheduler.schedule(BUDGET as u64 / 2, ());
+    while let Some(vector) = cpu.run_scheduler(&mut memory[..], &mut scheduler, BUDGET as u64, |_, _, _, _| ()) {
+        cpu.exception(Exception::from(vector));
+    }
+    assert_eq!(scheduler.time(), BUDGET as u64);
+
+    let counters = cpu.counters();
+    assert_eq!(counters.cycles, reference.cycles);
+    assert_eq!(counters.stopped_cycles, reference.stopped_cycles);
+}
@@ -0,0 +1,20 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the compact decoder table gives the same ISA as the flat one.
+
+use m68000::decoder::{DECODER, DECODER_BLOCK_INDEX, DECODER_BLOCK_SIZE, DECODER_BLOCKS, decode};
+use m68000::isa::Isa;
+
+#[test]
+fn compact_decoder() {
+    for opcode in 0..=u16::MAX {
+        let block = DECODER_BLOCK_INDEX[opcode as usize / DECODER_BLOCK_SIZE] as usize;
+        let isa = DECODER_BLOCKS[block][opcode as usize % DECODER_BLOCK_SIZE];
+
+        assert_eq!(isa, DECODER[opcode as usize], "{opcode:#06X}");
+        assert_eq!(decode(opcode), isa, "{opcode:#06X}");
+        assert_eq!(Isa::from(opcode), isa, "{opcode:#06X}");
+    }
+}
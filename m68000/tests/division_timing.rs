@@ -0,0 +1,104 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the data-dependent execution time of DIVS and DIVU against a step-by-step model of the division microcode.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::{CpuDetails, Mc68000, Scc68070};
+
+/// Jorge Cwik's model of the MC68000 DIVU microcode.
+fn divu_reference(mut dividend: u32, divisor: u16) -> usize {
+    let hdivisor = (divisor as u32) << 16;
+    if dividend >> 16 >= divisor as u32 {
+        return 10;
+    }
+
+    let mut mcycles = 38;
+    for _ in 0..15 {
+        let carry = (dividend as i32) < 0;
+        dividend <<= 1;
+        if carry {
+            dividend = dividend.wrapping_sub(hdivisor);
+        } else {
+            mcycles += 2;
+            if dividend >= hdivisor {
+                dividend -= hdivisor;
+                mcycles -= 1;
+            }
+        }
+    }
+    mcycles * 2
+}
+
+/// Jorge Cwik's model of the MC68000 DIVS microcode.
+fn divs_reference(dividend: i32, divisor: i16) -> usize {
+    let mut mcycles = if dividend < 0 { 7 } else { 6 };
+    if dividend.unsigned_abs() >> 16 >= divisor.unsigned_abs() as u32 {
+        return (mcycles + 2) * 2;
+    }
+
+    let mut aquot = dividend.unsigned_abs() / divisor.unsigned_abs() as u32;
+    mcycles += 55;
+    if divisor >= 0 {
+        mcycles = if dividend >= 0 { mcycles - 1 } else { mcycles + 1 };
+    }
+    for _ in 0..15 {
+        if aquot as i16 >= 0 {
+            mcycles += 1;
+        }
+        aquot <<= 1;
+    }
+    mcycles * 2
+}
+
+/// Operands on the edges of the division, and pseudo-random ones.
+fn operands() -> impl Iterator<Item = (u32, u16)> {
+    const EDGES: [u32; 10] = [0, 1, 0x7FFF, 0x8000, 0x8001, 0xFFFF, 0x1_0000, 0x7FFF_FFFF, 0x8000_0000, 0xFFFF_FFFF];
+    let edges = EDGES.into_iter().flat_map(|dividend| EDGES.into_iter().map(move |divisor| (dividend, divisor as u16)));
+
+    let mut state = 0x1234_5678_9ABC_DEF1u64;
+    let random = std::iter::repeat_with(move || {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Small dividends so most divisions do not overflow.
+        let dividend = (state as u32) >> (state >> 59);
+        (dividend, (state >> 32) as u16)
+    }).take(1_000_000);
+
+    edges.chain(random).filter(|&(_, divisor)| divisor != 0)
+}
+
+#[test]
+fn mc68000_matches_the_microcode_model() {
+    for (dividend, divisor) in operands() {
+        assert_eq!(Mc68000::divu_execution_time(dividend, divisor), divu_reference(dividend, divisor), "DIVU {dividend:#X} / {divisor:#X}");
+        assert_eq!(Mc68000::divs_execution_time(dividend, divisor), divs_reference(dividend as i32, divisor as i16), "DIVS {dividend:#X} / {divisor:#X}");
+        assert!(Mc68000::divu_execution_time(dividend, divisor) <= Mc68000::DIVU);
+        assert!(Mc68000::divs_execution_time(dividend, divisor) <= Mc68000::DIVS);
+    }
+
+    assert_eq!(Scc68070::divu_execution_time(1, 1), Scc68070::DIVU);
+    assert_eq!(Scc68070::divs_execution_time(1, 1), Scc68070::DIVS);
+}
+
+#[test]
+fn interpreter_timing() {
+    let run = |divu: bool, dividend: u32, divisor: u16| {
+        let mut program = if divu { asm::divu(0, AM::Immediate(divisor as u32)) } else { asm::divs(0, AM::Immediate(divisor as u32)) };
+        program.resize(0x100, 0);
+        let mut cpu = M68000::<Mc68000>::new_no_reset();
+        cpu.regs.d[0].0 = dividend;
+        let cycles = cpu.interpreter_exception(&mut program[..]).0;
+        (cycles, cpu.regs.d[0].0)
+    };
+
+    // The effective address calculation time of the immediate operand is 4 cycles.
+    assert_eq!(run(true, 100, 7), (4 + divu_reference(100, 7), 2 << 16 | 14));
+    assert_eq!(run(true, 0xFFFE_0001, 0xFFFF), (4 + divu_reference(0xFFFE_0001, 0xFFFF), 0xFFFF));
+    assert_eq!(run(true, 0x1_0000, 1).0, 4 + 10); // Overflow.
+    assert_eq!(run(false, -100i32 as u32, 7), (4 + divs_reference(-100, 7), (-2i16 as u16 as u32) << 16 | -14i16 as u16 as u32));
+}
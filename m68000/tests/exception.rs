@@ -0,0 +1,127 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the processing order and masking of the pending exceptions.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::{Mc68000, Scc68070};
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::{Direction, Size};
+
+const START: u32 = 0x1000;
+const LEVEL2_HANDLER: u32 = 0x2000;
+const LEVEL5_HANDLER: u32 = 0x3000;
+
+/// Returns a 64 KiB memory with the program at [START] and the level 2 and 5 interrupt handlers.
+fn load(program: &[u16], level2: &[u16], level5: &[u16]) -> Vec<u16> {
+    let mut memory = vec![0; 0x8000];
+    for (addr, code) in [(START, program), (LEVEL2_HANDLER, level2), (LEVEL5_HANDLER, level5)] {
+        let start = addr as usize / 2;
+        memory[start..start + code.len()].copy_from_slice(code);
+    }
+
+    for (vector, handler) in [(Vector::Level2Interrupt, LEVEL2_HANDLER), (Vector::Level5Interrupt, LEVEL5_HANDLER)] {
+        let index = vector as usize * 2;
+        memory[index] = (handler >> 16) as u16;
+        memory[index + 1] = handler as u16;
+    }
+
+    memory
+}
+
+fn new_cpu() -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu
+}
+
+/// Handler that shifts D0 and adds the given digit to it.
+fn digit_handler(digit: u8) -> Vec<u16> {
+    vec![
+        asm::lsr(4, Direction::Left, Size::Long, false, 0),
+        asm::addq(digit, Size::Long, AM::Drd(0))[0],
+        asm::rte(),
+    ]
+}
+
+#[test]
+fn multiple_interrupts() {
+    // MOVE.W #0x2000, SR
+    // NOP
+    // STOP #0x2700
+    let mut program = asm::movesr(AM::Immediate(0x2000));
+    program.push(asm::nop());
+    program.extend(asm::stop(0x2700));
+    let mut memory = load(&program, &digit_handler(2), &digit_handler(5));
+
+    let mut cpu = new_cpu();
+    cpu.exception(Exception::from(Vector::Level2Interrupt));
+    cpu.exception(Exception::from(Vector::Level5Interrupt));
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+
+    // The level 5 interrupt is taken first, and the level 2 one once level 5 has returned.
+    assert_eq!(cpu.regs.d[0].0, 0x52);
+}
+
+#[test]
+fn masked_interrupt() {
+    // MOVE.W #0x2200, SR ; Level 2 is still masked.
+    // ADDQ.L #1, D1
+    // MOVE.W #0x2100, SR
+    // ADDQ.L #1, D1
+    // STOP #0x2700
+    let mut program = asm::movesr(AM::Immediate(0x2200));
+    program.extend(asm::addq(1, Size::Long, AM::Drd(1)));
+    program.extend(asm::movesr(AM::Immediate(0x2100)));
+    program.extend(asm::addq(1, Size::Long, AM::Drd(1)));
+    program.extend(asm::stop(0x2700));
+
+    // MOVE.L D1, D0
+    // RTE
+    let mut handler = asm::r#move(Size::Long, AM::Drd(0), AM::Drd(1));
+    handler.push(asm::rte());
+    let mut memory = load(&program, &handler, &digit_handler(5));
+
+    let mut cpu = new_cpu();
+    cpu.exception(Exception::from(Vector::Level2Interrupt));
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+
+    assert_eq!(cpu.regs.d[0].0, 1);
+    assert_eq!(cpu.regs.d[1].0, 2);
+}
+
+#[test]
+fn on_chip_interrupts() {
+    // STOP #0x2700
+    let program = asm::stop(0x2700);
+
+    // The on-chip interrupts of the SCC68070 have the priority of the autovectored interrupts, higher than Illegal
+    // Instruction (MC68000UM 6.2.3), so their handler is executed first.
+    for interrupt in [Vector::Level5Interrupt, Vector::Level5OnChipInterrupt] {
+        let mut memory = load(&program, &digit_handler(4), &digit_handler(5));
+        for (vector, handler) in [(Vector::IllegalInstruction, LEVEL2_HANDLER), (interrupt, LEVEL5_HANDLER)] {
+            let index = vector as usize * 2;
+            memory[index] = (handler >> 16) as u16;
+            memory[index + 1] = handler as u16;
+        }
+
+        let mut cpu = M68000::<Scc68070>::new_no_reset();
+        cpu.regs.pc.0 = START;
+        cpu.regs.ssp.0 = 0x8000;
+        cpu.regs.sr = 0x2000.into();
+        cpu.exception(Exception::from(Vector::IllegalInstruction));
+        cpu.exception(Exception::from(interrupt));
+
+        let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+        assert!(vector.is_none() && cpu.stop);
+        assert_eq!(cpu.regs.d[0].0, 0x54, "{interrupt:?}");
+    }
+}
@@ -0,0 +1,90 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the determinism of the fuzzer, its reference traces and the execution of single cases.
+
+use m68000::Registers;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::exception::Vector;
+use m68000::fuzz::{CASE_WORDS, CODE, DATA, FuzzCase, FuzzTrace, Fuzzer, HANDLER};
+
+#[test]
+fn deterministic() {
+    let report = Fuzzer::new(1).run(7, 3, 2000);
+    assert_eq!(report.trace.digests.len(), 6000);
+    assert_eq!(report.trace.rounds(), 3);
+    assert_eq!(report.corpus.len(), report.coverage);
+
+    for threads in [3, 0] {
+        let other = Fuzzer::new(threads).run(7, 3, 2000);
+        assert_eq!(other.trace, report.trace);
+        assert_eq!(other.corpus, report.corpus);
+    }
+
+    assert_ne!(Fuzzer::new(0).run(8, 3, 2000).trace, report.trace);
+}
+
+#[test]
+fn coverage_and_differential() {
+    let mut fuzzer = Fuzzer::new(0);
+    let short = fuzzer.run(1, 1, 10_000);
+    let long = fuzzer.run(1, 8, 10_000);
+    assert!(long.coverage > short.coverage);
+    assert_eq!(long.trace.digests[..10_000], short.trace.digests[..]);
+    assert!(long.divergences.is_empty(), "{:#X?}", &long.divergences[..long.divergences.len().min(4)]);
+}
+
+#[test]
+fn reference_trace() {
+    let mut fuzzer = Fuzzer::new(0);
+    let mut trace = fuzzer.run(3, 2, 5000).trace;
+
+    let mut data = Vec::new();
+    trace.write_to(&mut data).unwrap();
+    assert_eq!(FuzzTrace::read_from(&mut &data[..]).unwrap(), trace);
+    assert!(FuzzTrace::read_from(&mut &data[..data.len() - 1]).is_err());
+    assert!(FuzzTrace::read_from(&mut &b"not a fuzz trace"[..]).is_err());
+
+    assert!(fuzzer.check(&trace).mismatches.is_empty());
+
+    trace.digests[1234][1] ^= 1;
+    trace.digests[7000][0] ^= 1;
+    let mismatches: Vec<usize> = fuzzer.check(&trace).mismatches.iter().map(|&(index, _)| index).collect();
+    assert_eq!(mismatches, [1234, 7000]);
+}
+
+#[test]
+fn execute_case() {
+    let mut regs = Registers::default();
+    regs.pc.0 = CODE;
+    regs.ssp.0 = 0x8000;
+    regs.sr = 0x2700.into();
+    regs.d[0].0 = 0;
+    regs.d[1].0 = 100;
+    let mut words = [0; CASE_WORDS];
+    let divu = asm::divu(1, AM::Drd(0));
+    words[..divu.len()].copy_from_slice(&divu);
+    let case = FuzzCase { regs, words };
+
+    let mut fuzzer = Fuzzer::new(1);
+    let (mc68000, scc68070) = fuzzer.execute(&case);
+    assert_eq!(mc68000.vector, Some(Vector::ZeroDivide));
+    assert_eq!(scc68070.vector, Some(Vector::ZeroDivide));
+    // The handler is a STOP.
+    assert_eq!(mc68000.regs.pc.0, HANDLER + 4);
+    assert_eq!(mc68000.regs.ssp.0, 0x8000 - 6);
+    assert!(scc68070.regs.ssp.0 < mc68000.regs.ssp.0);
+    assert_ne!(mc68000.digest(), scc68070.digest());
+
+    // The memory written by the exception has been restored.
+    assert_eq!(fuzzer.execute(&case), (mc68000, scc68070));
+
+    regs.a[0].0 = DATA;
+    let mut words = [0; CASE_WORDS];
+    words[0] = asm::moveq(3, -1);
+    let (mc68000, scc68070) = fuzzer.execute(&FuzzCase { regs, words });
+    assert_eq!((mc68000.vector, mc68000.regs.d[3].0, mc68000.regs.pc.0), (None, 0xFFFF_FFFF, CODE + 2));
+    assert_eq!(mc68000.regs, scc68070.regs);
+}
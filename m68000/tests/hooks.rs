@@ -0,0 +1,210 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the breakpoints, watchpoints, instruction hook and coverage collection.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::hooks::{HookEvent, Watchpoint};
+use m68000::instruction::Size;
+use m68000::scheduler::Scheduler;
+
+use std::sync::Arc;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+const START: u32 = 0x1000;
+const DATA: u32 = 0x2000;
+
+/// 0x1000 loop: ADDQ.L #1, D0
+/// 0x1002       MOVE.L D0, (DATA).W
+/// 0x1006       DBF D1, loop
+/// 0x100A       MOVE.L (DATA).W, D2
+/// 0x100E       STOP #0x2700
+fn load() -> Vec<u16> {
+    let mut program = asm::addq(1, Size::Long, AM::Drd(0));
+    program.extend(asm::r#move(Size::Long, AM::AbsShort(DATA as u16), AM::Drd(0)));
+    program.extend(asm::dbcc(CC::F, 1, -8));
+    program.extend(asm::r#move(Size::Long, AM::Drd(2), AM::AbsShort(DATA as u16)));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0; 0x4000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+    memory
+}
+
+fn core() -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 9;
+    cpu
+}
+
+#[test]
+fn breakpoint() {
+    for cached in [false, true] {
+        let mut memory = load();
+        let mut cpu = core();
+        cpu.set_instruction_cache(cached);
+        cpu.add_breakpoint(0x1006);
+
+        // Each iteration stops before the DBF.
+        for i in 1..=10 {
+            let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+            assert!(vector.is_none() && cpu.stop);
+            assert_eq!(cpu.hook_event(), Some(HookEvent::Breakpoint(0x1006)));
+            assert_eq!(cpu.regs.pc.0, 0x1006);
+            assert_eq!(cpu.regs.d[0].0, i);
+
+            assert_eq!(cpu.resume_from_hook(), Some(HookEvent::Breakpoint(0x1006)));
+            assert!(!cpu.stop);
+        }
+
+        cpu.remove_breakpoint(0x1006);
+        assert!(!cpu.has_breakpoint(0x1006));
+        let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+        assert!(vector.is_none() && cpu.stop);
+        assert_eq!(cpu.hook_event(), None);
+        assert_eq!(cpu.regs.d[2].0, 10);
+    }
+}
+
+#[test]
+fn breakpoint_cycles() {
+    let mut memory = load();
+    let mut cpu = core();
+    cpu.add_breakpoint(0x100A);
+
+    // The budget is not consumed while stopped by a hook.
+    let cycles = cpu.cycle(&mut memory[..], 1_000_000);
+    assert!(cycles < 1000);
+    assert_eq!(cpu.hook_event(), Some(HookEvent::Breakpoint(0x100A)));
+
+    // Interrupts stay pending until the core is resumed.
+    cpu.exception(Exception::from(Vector::Level7Interrupt));
+    assert!(cpu.stop);
+
+    // The scheduler does not fast-forward the time.
+    let mut scheduler = Scheduler::<()>::new();
+    assert_eq!(cpu.run_scheduler(&mut memory[..], &mut scheduler, 1000, |_, _, _, _| ()), None);
+    assert_eq!(scheduler.time(), 0);
+}
+
+#[test]
+fn watchpoint() {
+    for cached in [false, true] {
+        let mut memory = load();
+        let mut cpu = core();
+        cpu.set_instruction_cache(cached);
+        cpu.add_watchpoint(Watchpoint { range: DATA + 2..DATA + 3, read: false, write: true });
+
+        // The MOVE.L that writes to the watched range is executed.
+        let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+        assert!(vector.is_none());
+        assert_eq!(cpu.hook_event(), Some(HookEvent::Watchpoint { pc: 0x1002, addr: DATA + 2, write: true }));
+        assert_eq!(cpu.regs.pc.0, 0x1006);
+        assert_eq!(memory[DATA as usize / 2 + 1], 1);
+
+        cpu.clear_watchpoints();
+        cpu.add_watchpoint(Watchpoint { range: DATA..DATA + 4, read: true, write: false });
+        cpu.resume_from_hook();
+        let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+        assert!(vector.is_none());
+        assert_eq!(cpu.hook_event(), Some(HookEvent::Watchpoint { pc: 0x100A, addr: DATA, write: false }));
+        assert_eq!(cpu.regs.d[2].0, 10);
+    }
+}
+
+#[test]
+fn watchpoint_on_stop() {
+    let mut memory = load();
+    let mut cpu = core();
+    cpu.regs.pc.0 = 0x100E;
+    cpu.add_watchpoint(Watchpoint { range: 0x100E..0x1010, read: true, write: false });
+
+    // The STOP instruction is fetched and executed, then the watchpoint breaks.
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+    assert_eq!(cpu.hook_event(), Some(HookEvent::Watchpoint { pc: 0x100E, addr: 0x100E, write: false }));
+    assert_eq!(cpu.regs.pc.0, 0x1012);
+
+    // The snapshot contains the STOP state, not the break.
+    let state = cpu.save_state();
+    let mut restored = core();
+    restored.load_state(&state).unwrap();
+    assert!(restored.stop);
+
+    // Resuming keeps the core stopped by the STOP instruction, until an interrupt.
+    cpu.resume_from_hook();
+    assert!(cpu.stop);
+    let (cycles, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!((cycles, vector), (0, None));
+    assert_eq!(cpu.regs.pc.0, 0x1012);
+
+    cpu.exception(Exception::from(Vector::Level7Interrupt));
+    assert!(!cpu.stop);
+}
+
+#[test]
+fn instruction_hook() {
+    let mut memory = load();
+    let mut cpu = core();
+
+    // Break on the 5th instruction.
+    let count = Arc::new(AtomicUsize::new(0));
+    let counter = count.clone();
+    cpu.set_instruction_hook(Some(Arc::new(move |_| counter.fetch_add(1, Ordering::Relaxed) != 4)));
+
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.hook_event(), Some(HookEvent::Instruction(0x1002)));
+    assert_eq!(cpu.regs.d[0].0, 2);
+
+    // The hook is not called again on the instruction that stopped the core.
+    cpu.resume_from_hook();
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.hook_event(), None);
+    assert_eq!(count.load(Ordering::Relaxed), 10 * 3 + 2);
+
+    cpu.set_instruction_hook(None);
+}
+
+#[test]
+fn coverage() {
+    let mut memory = load();
+    let mut cpu = core();
+    cpu.regs.d[1].0 = 0;
+    cpu.set_coverage(true);
+
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    let covered: Vec<u32> = cpu.covered_addresses().collect();
+    assert_eq!(covered, [0x1000, 0x1002, 0x1006, 0x100A, 0x100E]);
+    assert!(cpu.is_covered(0x1006) && !cpu.is_covered(0x1004));
+
+    cpu.set_coverage(false);
+    assert_eq!(cpu.covered_addresses().count(), 0);
+}
+
+#[test]
+fn no_hooks() {
+    // A core with hooks registered executes the same as one without.
+    let mut results = Vec::new();
+    for hooked in [false, true] {
+        let mut memory = load();
+        let mut cpu = core();
+        if hooked {
+            cpu.add_breakpoint(0x3000);
+            cpu.add_watchpoint(Watchpoint { range: 0x3000..0x3100, read: true, write: true });
+        }
+
+        let (cycles, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+        assert!(vector.is_none() && cpu.stop);
+        results.push((cpu.regs, cycles, memory));
+    }
+
+    assert_eq!(results[0], results[1]);
+}
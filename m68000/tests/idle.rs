@@ -0,0 +1,139 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that skipping idle loops gives the same results as interpreting them.
+
+use m68000::{M68000, MemoryAccess};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::Size;
+use m68000::scheduler::Scheduler;
+
+const START: u32 = 0x1000;
+const FLAG: u32 = 0x3000;
+
+/// Memory that counts the accesses, to check that the loops are skipped.
+struct CountingMemory {
+    memory: Vec<u16>,
+    accesses: usize,
+}
+
+impl CountingMemory {
+    fn new(program: &[u16]) -> Self {
+        let mut memory = vec![0; 0x4000];
+        memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(program);
+        Self { memory, accesses: 0 }
+    }
+}
+
+impl MemoryAccess for CountingMemory {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.accesses += 1;
+        self.memory.get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.accesses += 1;
+        self.memory.get_word(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.accesses += 1;
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.accesses += 1;
+        self.memory.set_word(addr, value)
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+fn core(idle: bool) -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.set_idle_loop_detection(idle);
+    cpu
+}
+
+#[test]
+fn branch_to_self() {
+    let program = asm::bra(-2);
+
+    let mut results = Vec::new();
+    for (idle, cached) in [(false, false), (true, false), (true, true)] {
+        let mut memory = CountingMemory::new(&program);
+        let mut cpu = core(idle);
+        cpu.set_instruction_cache(cached);
+        let cycles: Vec<usize> = [1_000_003, 7, 12_345].iter().map(|&budget| cpu.cycle(&mut memory, budget)).collect();
+        results.push((cpu.regs, cycles, memory.accesses));
+    }
+
+    for result in &results[1..] {
+        assert_eq!(results[0].0, result.0);
+        assert_eq!(results[0].1, result.1);
+        assert!(result.2 < 100, "{} accesses", result.2);
+    }
+}
+
+#[test]
+fn dbcc_counter() {
+    // DBF D0, *
+    // STOP #0x2700
+    let mut program = asm::dbcc(CC::F, 0, -2).to_vec();
+    program.extend(asm::stop(0x2700));
+
+    let mut results = Vec::new();
+    for idle in [false, true] {
+        let mut memory = CountingMemory::new(&program);
+        let mut cpu = core(idle);
+        cpu.regs.d[0].0 = 0xABCD_5000;
+
+        let mut steps = Vec::new();
+        while !cpu.stop {
+            steps.push((cpu.cycle_until_exception(&mut memory, 7777), cpu.regs));
+        }
+        results.push((steps, memory.accesses));
+    }
+
+    assert_eq!(results[0].0, results[1].0);
+    assert_eq!(results[1].0.last().unwrap().1.d[0].0, 0xABCD_FFFF);
+    assert!(results[1].1 < results[0].1 / 100, "{} accesses", results[1].1);
+}
+
+#[test]
+fn polling_loop() {
+    // loop: TST.B (FLAG).W
+    //       BEQ loop
+    //       MOVEQ #1, D1
+    //       STOP #0x2700
+    let mut program = asm::tst(Size::Byte, AM::AbsShort(FLAG as u16));
+    program.extend(asm::bcc(CC::EQ, -6));
+    program.push(asm::moveq(1, 1));
+    program.extend(asm::stop(0x2700));
+
+    let mut results = Vec::new();
+    for idle in [false, true] {
+        let mut memory = CountingMemory::new(&program);
+        let mut cpu = core(idle);
+        let mut scheduler = Scheduler::new();
+        scheduler.schedule(100_001, ());
+
+        let vector = cpu.run_scheduler(&mut memory, &mut scheduler, 200_000, |_, memory, _, _| {
+            memory.memory[FLAG as usize / 2] = 0x0100;
+        });
+        assert!(vector.is_none());
+        results.push((cpu.regs, scheduler.time(), memory.accesses));
+    }
+
+    assert_eq!(results[0].0, results[1].0);
+    assert_eq!(results[0].0.d[1].0, 1);
+    assert!(results[1].0.pc.0 > START + 8);
+    assert_eq!(results[0].1, results[1].1);
+    assert!(results[1].2 < 100, "{} accesses", results[1].2);
+}
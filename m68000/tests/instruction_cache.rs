@@ -0,0 +1,128 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the instruction cache gives the same results as the uncached interpreter.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::{Direction, Size};
+
+const START: u32 = 0x1000;
+
+/// Returns a 64 KiB memory with the given program loaded at [START].
+fn load(program: &[u16]) -> Vec<u16> {
+    let mut memory = vec![0; 0x8000];
+    let start = START as usize / 2;
+    memory[start..start + program.len()].copy_from_slice(program);
+    memory
+}
+
+fn run(program: &[u16], cached: bool) -> (M68000<Mc68000>, usize) {
+    let mut memory = load(program);
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 99;
+    cpu.set_instruction_cache(cached);
+
+    let (cycles, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+    (cpu, cycles)
+}
+
+#[test]
+fn cached_loop() {
+    // loop: ADDQ.L #3, D0
+    //       ADD.L D0, D2
+    //       DBF D1, loop
+    //       STOP #0x2700
+    let mut program = asm::addq(3, Size::Long, AM::Drd(0));
+    program.extend(asm::add(2, Direction::DstReg, Size::Long, AM::Drd(0)));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let (uncached, uncached_cycles) = run(&program, false);
+    let (cached, cached_cycles) = run(&program, true);
+
+    assert_eq!(uncached.regs.d[0].0, 300);
+    assert_eq!(uncached.regs, cached.regs);
+    assert_eq!(uncached_cycles, cached_cycles);
+}
+
+#[test]
+fn self_modifying_code() {
+    // loop: MOVEQ #1, D0
+    //       ADD.L D0, D2
+    //       MOVE.W #0x7005, (START).W ; Replaces the MOVEQ #1 with MOVEQ #5.
+    //       DBF D1, loop
+    //       STOP #0x2700
+    let mut program = vec![asm::moveq(0, 1)];
+    program.extend(asm::add(2, Direction::DstReg, Size::Long, AM::Drd(0)));
+    program.extend(asm::r#move(Size::Word, AM::AbsShort(START as u16), AM::Immediate(asm::moveq(0, 5) as u32)));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let (uncached, _) = run(&program, false);
+    let (cached, _) = run(&program, true);
+
+    assert_eq!(uncached.regs.d[2].0, 1 + 99 * 5);
+    assert_eq!(uncached.regs, cached.regs);
+}
+
+#[test]
+fn external_invalidation() {
+    let mut program = vec![asm::moveq(0, 1)];
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = load(&program);
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.set_instruction_cache(true);
+
+    cpu.regs.pc.0 = START;
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.regs.d[0].0, 1);
+
+    // Modify the program outside of the core.
+    memory[START as usize / 2] = asm::moveq(0, 2);
+    cpu.invalidate_instruction_cache(START, 2);
+
+    cpu.stop = false;
+    cpu.regs.pc.0 = START;
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.regs.d[0].0, 2);
+}
+
+#[test]
+fn cycle_budget() {
+    // Checks that the block tier (with the `block-exec` feature) stops at the same instructions as the interpreter.
+    let mut program = asm::addq(3, Size::Long, AM::Drd(0));
+    program.extend(asm::add(2, Direction::DstReg, Size::Long, AM::Drd(0)));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let mut results = Vec::new();
+    for cached in [false, true] {
+        let mut memory = load(&program);
+        let mut cpu = M68000::<Mc68000>::new_no_reset();
+        cpu.regs.pc.0 = START;
+        cpu.regs.d[1].0 = 99;
+        cpu.set_instruction_cache(cached);
+
+        let mut slices = Vec::new();
+        while !cpu.stop {
+            let (cycles, vector) = cpu.cycle_until_exception(&mut memory[..], 50);
+            assert!(vector.is_none());
+            slices.push((cycles, cpu.regs));
+        }
+        results.push(slices);
+    }
+
+    assert_eq!(results[0], results[1]);
+}
@@ -0,0 +1,97 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that lockstep execution gives the same results as running each core independently.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::{Direction, Size};
+use m68000::lockstep::Lockstep;
+use m68000::pool::Job;
+
+const START: u32 = 0x1000;
+const LANES: usize = 9;
+
+/// loop: ADD.L D1, D2
+///       DBF D0, loop
+///       MOVE.L D2, (A0)
+///       STOP #0x2700
+fn memory() -> Vec<u16> {
+    let mut program = asm::add(2, Direction::DstReg, Size::Long, AM::Drd(1));
+    program.extend(asm::dbcc(CC::F, 0, -4));
+    program.extend(asm::r#move(Size::Long, AM::Ari(0), AM::Drd(2)));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0; 0x8000];
+    let start = START as usize / 2;
+    memory[start..start + program.len()].copy_from_slice(&program);
+    memory
+}
+
+/// Each lane loops a different number of times on different data, so the lanes diverge.
+fn core(lane: usize) -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[0].0 = lane as u32 * 3;
+    cpu.regs.d[1].0 = lane as u32 + 7;
+    cpu.regs.a[0].0 = 0x2000;
+    cpu
+}
+
+fn check(budget: usize) {
+    let mut cores: Vec<_> = (0..LANES).map(core).collect();
+    let mut memories: Vec<_> = (0..LANES).map(|_| memory()).collect();
+    let mut jobs: Vec<_> = cores.iter_mut().zip(memories.iter_mut()).map(|(cpu, memory)| Job::new(cpu, &mut memory[..])).collect();
+
+    let mut lockstep = Lockstep::new();
+    while jobs.iter().any(|job| !job.cpu.stop) {
+        lockstep.run(&mut jobs, budget);
+        assert!(jobs.iter().all(|job| job.exception.is_none()));
+    }
+
+    for (lane, job) in jobs.iter().enumerate() {
+        let mut cpu = core(lane);
+        let mut memory = memory();
+        let (cycles, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+
+        assert!(vector.is_none());
+        assert_eq!(job.cpu.regs, cpu.regs);
+        assert_eq!(job.cycles, cycles);
+        assert_eq!(job.memory[0x1000..0x1002], memory[0x1000..0x1002]);
+        assert_eq!(memory[0x1001] as u32, (lane as u32 * 3 + 1) * (lane as u32 + 7));
+    }
+}
+
+#[test]
+fn lockstep_run() {
+    check(usize::MAX);
+}
+
+#[test]
+fn lockstep_budget() {
+    check(50);
+}
+
+#[test]
+fn lockstep_exception() {
+    // An odd address in A0 makes the MOVE.L raise an address error in this lane only.
+    let mut cores: Vec<_> = (0..LANES).map(core).collect();
+    cores[3].regs.a[0].0 = 0x2001;
+    let mut memories: Vec<_> = (0..LANES).map(|_| memory()).collect();
+    let mut jobs: Vec<_> = cores.iter_mut().zip(memories.iter_mut()).map(|(cpu, memory)| Job::new(cpu, &mut memory[..])).collect();
+
+    Lockstep::new().run(&mut jobs, usize::MAX);
+
+    for (lane, job) in jobs.iter().enumerate() {
+        if lane == 3 {
+            assert_eq!(job.exception, Some(m68000::exception::Vector::AddressError));
+        } else {
+            assert!(job.exception.is_none() && job.cpu.stop);
+        }
+    }
+}
@@ -2,7 +2,11 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
-use m68000::MemoryAccess;
+use m68000::{M68000, MemoryAccess};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::{Direction, Size};
 
 use std::panic::catch_unwind;
 
@@ -74,3 +78,155 @@ fn memory_access_slice() {
     assert!(catch_unwind(|| [0u16; 1].set_word(2, 0).unwrap()).is_err());
     assert!(catch_unwind(|| [0u16; 1].set_long(2, 0).unwrap()).is_err());
 }
+
+/// Memory where the accesses above [SLOW_START] take [WAIT_CYCLES] extra cycles.
+struct SlowMemory {
+    memory: Vec<u16>,
+    wait_cycles: usize,
+}
+
+const SLOW_START: u32 = 0x4000;
+const WAIT_CYCLES: usize = 2;
+
+impl SlowMemory {
+    fn access(&mut self, addr: u32) {
+        if addr >= SLOW_START {
+            self.wait_cycles += WAIT_CYCLES;
+        }
+    }
+}
+
+impl MemoryAccess for SlowMemory {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.access(addr);
+        self.memory.get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.access(addr);
+        self.memory.get_word(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.access(addr);
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.access(addr);
+        self.memory.set_word(addr, value)
+    }
+
+    fn reset_instruction(&mut self) {}
+
+    fn take_wait_cycles(&mut self) -> usize {
+        std::mem::take(&mut self.wait_cycles)
+    }
+}
+
+#[test]
+fn wait_states() {
+    // MOVE.L (SLOW_START).W, (SLOW_START + 4).W
+    // STOP #0x2700
+    let mut program = asm::r#move(Size::Long, AM::AbsShort(SLOW_START as u16), AM::AbsShort(SLOW_START as u16 + 4));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x4000];
+    memory[0x1000 / 2..0x1000 / 2 + program.len()].copy_from_slice(&program);
+    let mut slow = SlowMemory { memory: memory.clone(), wait_cycles: 0 };
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = 0x1000;
+    let fast_cycles = cpu.interpreter(&mut memory[..]);
+
+    cpu.regs.pc.0 = 0x1000;
+    let slow_cycles = cpu.interpreter(&mut slow);
+
+    // 2 word reads and 2 word writes in the slow memory.
+    assert_eq!(slow_cycles, fast_cycles + 4 * WAIT_CYCLES);
+    assert_eq!(slow.wait_cycles, 0);
+}
+
+/// Memory that counts the block accesses.
+struct BlockMemory {
+    memory: Vec<u16>,
+    blocks: usize,
+}
+
+impl MemoryAccess for BlockMemory {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.memory.get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.memory.get_word(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.memory.set_word(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        self.blocks += 1;
+        self.memory.get_block(addr, data)
+    }
+
+    fn set_block(&mut self, addr: u32, data: &[u8]) -> Option<()> {
+        self.blocks += 1;
+        self.memory.set_block(addr, data)
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+fn run_movem(memory: &mut impl MemoryAccess) -> (M68000<Mc68000>, usize) {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = 0x1000;
+    cpu.regs.ssp.0 = 0x3000; // Below SLOW_START so there is no wait state.
+    for i in 0..8 {
+        cpu.regs.d[i].0 = 0x1000_0000 * i as u32 + 0x8000 + i as u32;
+    }
+    for i in 0..7 {
+        cpu.regs.a[i].0 = 0x0100_0000 * i as u32 + 0xA000 + i as u32;
+    }
+    let (cycles, vector) = cpu.loop_until_exception_stop(memory);
+    assert!(vector.is_none());
+    (cpu, cycles)
+}
+
+#[test]
+fn movem_block() {
+    // MOVEM.L D0-D7/A0-A6, -(A7)
+    // MOVEM.W (A7)+, D0-D3/A0
+    // MOVEM.L (A7), D4-D7
+    // STOP #0x2700
+    let mut program = asm::movem(Direction::RegisterToMemory, Size::Long, AM::Ariwpr(7), 0xFFFE);
+    program.extend(asm::movem(Direction::MemoryToRegister, Size::Word, AM::Ariwpo(7), 0x010F));
+    program.extend(asm::movem(Direction::MemoryToRegister, Size::Long, AM::Ari(7), 0x00F0));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x4000];
+    memory[0x1000 / 2..0x1000 / 2 + program.len()].copy_from_slice(&program);
+
+    let mut words = SlowMemory { memory: memory.clone(), wait_cycles: 0 };
+    let (word_cpu, word_cycles) = run_movem(&mut words);
+    let mut blocks = BlockMemory { memory, blocks: 0 };
+    let (block_cpu, block_cycles) = run_movem(&mut blocks);
+
+    assert_eq!(blocks.blocks, 3);
+    assert_eq!(word_cpu.regs, block_cpu.regs);
+    assert_eq!(word_cycles, block_cycles);
+    assert_eq!(words.memory, blocks.memory);
+
+    // D0 is at the lowest address, and the words are sign-extended.
+    assert_eq!(&blocks.memory[(0x3000 - 60) / 2..(0x3000 - 56) / 2], &[0x0000, 0x8000]);
+    assert_eq!(block_cpu.regs.d[0].0, 0x0000_0000);
+    assert_eq!(block_cpu.regs.d[1].0, 0xFFFF_8000);
+    assert_eq!(block_cpu.regs.a[0].0, 0x0000_2000);
+    assert_eq!(block_cpu.regs.ssp.0, 0x3000 - 60 + 10);
+    assert_eq!(block_cpu.regs.d[4].0, 0x8002_3000);
+}
@@ -0,0 +1,136 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the mapped memory is accessed directly and the other accesses go to the memory system.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::Size;
+use m68000::memory_map::PAGE_SIZE;
+
+/// ROM at page 0, RAM at page 1.
+const RAM: u32 = PAGE_SIZE;
+
+/// Loads the program in a ROM and returns it.
+fn rom(program: &[u16]) -> Vec<u8> {
+    let mut rom = vec![0; PAGE_SIZE as usize];
+    rom[0..4].copy_from_slice(&(2 * PAGE_SIZE).to_be_bytes()); // SSP at the end of RAM.
+    rom[4..8].copy_from_slice(&0x400u32.to_be_bytes());
+    for (i, word) in program.iter().enumerate() {
+        rom[0x400 + i * 2..0x402 + i * 2].copy_from_slice(&word.to_be_bytes());
+    }
+    rom
+}
+
+#[test]
+fn mapped_rom_ram() {
+    // MOVE.L #0x12345678, (RAM + 0xFFFE).L ; Crosses the end of the RAM page.
+    // MOVE.W #0xABCD, (0x100).W            ; Write to ROM goes to the memory system.
+    // MOVE.L (RAM + 0xFFFE).L, D0
+    // STOP #0x2700
+    let mut program = asm::r#move(Size::Long, AM::AbsLong(RAM + 0xFFFE), AM::Immediate(0x1234_5678));
+    program.extend(asm::r#move(Size::Word, AM::AbsShort(0x100), AM::Immediate(0xABCD)));
+    program.extend(asm::r#move(Size::Long, AM::Drd(0), AM::AbsLong(RAM + 0xFFFE)));
+    program.extend(asm::stop(0x2700));
+
+    let mut rom = rom(&program);
+    let mut ram = vec![0u8; PAGE_SIZE as usize];
+    // Only the page after the RAM is in the memory system.
+    let mut memory = vec![0u8; 3 * PAGE_SIZE as usize];
+
+    let mut cpu = M68000::<Mc68000>::new();
+    unsafe {
+        cpu.map_memory(0, rom.as_mut_ptr(), rom.len(), false);
+        cpu.map_memory(RAM, ram.as_mut_ptr(), ram.len(), true);
+    }
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+
+    assert_eq!(cpu.regs.d[0].0, 0x1234_5678);
+    assert_eq!(ram[0xFFFE..], [0x12, 0x34]);
+    assert_eq!(memory[2 * PAGE_SIZE as usize..2 * PAGE_SIZE as usize + 2], [0x56, 0x78]);
+    assert_eq!(rom[0x100..0x102], [0, 0]);
+    assert_eq!(memory[0x100..0x102], [0xAB, 0xCD]);
+    assert!(memory[RAM as usize..2 * RAM as usize].iter().all(|&b| b == 0));
+}
+
+#[test]
+fn unmapped_memory() {
+    let mut program = vec![asm::moveq(0, 1)];
+    program.extend(asm::stop(0x2700));
+    let mut rom = rom(&program);
+    let mut memory = rom.clone();
+    memory[0x400..0x402].copy_from_slice(&asm::moveq(0, 2).to_be_bytes());
+
+    let mut cpu = M68000::<Mc68000>::new();
+    unsafe { cpu.map_memory(0, rom.as_mut_ptr(), rom.len(), false); }
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.regs.d[0].0, 1);
+
+    cpu.unmap_memory(0, rom.len());
+    cpu.exception(m68000::exception::Exception::from(m68000::exception::Vector::ResetSspPc));
+    cpu.stop = false;
+    cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(cpu.regs.d[0].0, 2);
+}
+
+#[test]
+fn cloned_core() {
+    // MOVE.L #0x12345678, (RAM + 0xFFFE).L
+    // STOP #0x2700
+    let mut program = asm::r#move(Size::Long, AM::AbsLong(RAM + 0xFFFE), AM::Immediate(0x1234_5678));
+    program.extend(asm::stop(0x2700));
+
+    let rom = m68000::rom::Rom::new(rom(&program));
+    let mut ram = vec![0u8; PAGE_SIZE as usize];
+    let mut memory = vec![0u8; 3 * PAGE_SIZE as usize];
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.map_rom(0, &rom);
+    unsafe { cpu.map_memory(RAM, ram.as_mut_ptr(), ram.len(), true); }
+
+    // The clone still executes from the ROM, but does not write in the RAM buffer of the original.
+    let mut clone = cpu.clone();
+    clone.exception(m68000::exception::Exception::from(m68000::exception::Vector::ResetSspPc));
+    let (_, vector) = clone.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && clone.stop);
+
+    assert!(ram.iter().all(|&b| b == 0));
+    assert_eq!(memory[RAM as usize + 0xFFFE..RAM as usize + 0x1_0002], [0x12, 0x34, 0x56, 0x78]);
+}
+
+#[test]
+fn distant_pages() {
+    // MOVE.L (0x00FF0000).L, (0xFFFF0000).L
+    // STOP #0x2700
+    let mut program = asm::r#move(Size::Long, AM::AbsLong(0xFFFF_0000), AM::AbsLong(0x00FF_0000));
+    program.extend(asm::stop(0x2700));
+
+    let mut rom = rom(&program);
+    let mut low = vec![0u8; 4];
+    low.copy_from_slice(&0xDEAD_BEEFu32.to_be_bytes());
+    let mut high = vec![0u8; 4];
+    let mut memory = vec![0u8; 0x100];
+
+    let mut cpu = M68000::<Mc68000>::new();
+    unsafe {
+        cpu.map_memory(0, rom.as_mut_ptr(), rom.len(), false);
+        cpu.map_memory(0x00FF_0000, low.as_mut_ptr(), low.len(), false);
+        cpu.map_memory(0xFFFF_0000, high.as_mut_ptr(), high.len(), true);
+    }
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert!(vector.is_none() && cpu.stop);
+    assert_eq!(high, [0xDE, 0xAD, 0xBE, 0xEF]);
+
+    // Unmapping everything does not overflow.
+    cpu.unmap_memory(0x00FF_0000, usize::MAX);
+    cpu.regs.pc.0 = 0x400;
+    cpu.stop = false;
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory[..]);
+    assert_eq!(vector, Some(m68000::exception::Vector::AccessError));
+}
@@ -0,0 +1,152 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the time slicing of several cores sharing a memory does not depend on the threads and the slices.
+
+use m68000::{M68000, Registers};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler::{Assembler, Condition as CC};
+use m68000::counters::Counters;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::{Direction, Size};
+use m68000::multi_cpu::MultiCpu;
+
+const CODE: u32 = 0x1000;
+const HANDLER: u32 = 0x1800;
+const SHARED: u32 = 0x6000;
+const COUNTER: u32 = SHARED + 0x10;
+const LOCAL_WORDS: usize = 0x4000;
+
+/// 0x1000 loop: ADDQ.W #1, (COUNTER).W
+///              ADD.L D0, D1
+///              MOVE.L D1, (0x2000).W
+///              MOVEM.L D0-D1, (A0)   ; Half in the local memory, half in the shared memory.
+///              DBF D0, loop
+///              STOP #0x2700
+fn shared_program() -> Vec<u16> {
+    let mut asm = Assembler::with_buffer(vec![0; CODE as usize / 2]);
+    let lp = asm.label();
+    asm.bind(lp)
+        .addq(1, Size::Word, AM::AbsShort(COUNTER as u16))
+        .add(1, Direction::DstReg, Size::Long, AM::Drd(0))
+        .r#move(Size::Long, AM::AbsShort(0x2000), AM::Drd(1))
+        .movem(Direction::RegisterToMemory, Size::Long, AM::Ari(0), 0x0003)
+        .dbcc_label(CC::F, 0, lp)
+        .stop(0x2700);
+    local_memory(asm.finish())
+}
+
+/// 0x1000 loop: ADD.L D0, D1
+///              ROL.L #3, D1
+///              MOVE.L D1, (A1)+
+///              DBF D0, loop
+/// halt:        STOP #0x2000
+///              BRA halt
+///
+/// 0x1800       MOVE.W D1, (SHARED).W
+///              RTE
+fn local_program() -> Vec<u16> {
+    let mut asm = Assembler::with_buffer(vec![0; CODE as usize / 2]);
+    let lp = asm.label();
+    let halt = asm.label();
+    asm.bind(lp)
+        .add(1, Direction::DstReg, Size::Long, AM::Drd(0))
+        .ror(3, Direction::Left, Size::Long, false, 1)
+        .r#move(Size::Long, AM::Ariwpo(1), AM::Drd(1))
+        .dbcc_label(CC::F, 0, lp)
+        .bind(halt)
+        .stop(0x2000)
+        .bra_label(halt);
+    let mut words = asm.finish();
+    words.resize(HANDLER as usize / 2, 0);
+    words.extend(m68000::assembler::r#move(Size::Word, AM::AbsShort(SHARED as u16), AM::Drd(1)));
+    words.push(m68000::assembler::rte());
+    local_memory(words)
+}
+
+fn local_memory(mut words: Vec<u16>) -> Vec<u16> {
+    words.resize(LOCAL_WORDS, 0);
+    words[Vector::Level4Interrupt as usize * 2 + 1] = HANDLER as u16;
+    words
+}
+
+fn new_cpu(count: u32) -> M68000<Mc68000> {
+    let mut cpu = M68000::new_no_reset();
+    cpu.regs.pc.0 = CODE;
+    cpu.regs.ssp.0 = 0x5000;
+    cpu.regs.d[0].0 = count;
+    cpu.regs.a[0].0 = SHARED - 4;
+    cpu.regs.a[1].0 = 0x3000;
+    cpu
+}
+
+struct Board {
+    cpus: Vec<(Registers, u64, Counters)>,
+    locals: Vec<Vec<u16>>,
+    shared: Vec<u16>,
+}
+
+/// Runs two cores accessing the shared memory and one that runs alone, the later being interrupted at `interrupt`.
+fn run(threads: usize, slice: u64, interrupt: Option<u64>) -> Board {
+    let mut locals = vec![shared_program(), shared_program(), local_program()];
+    let mut shared = vec![0u16; (SHARED as usize + 0x100) / 2];
+
+    let mut board = MultiCpu::new(&mut shared[..], threads);
+    board.add_shared_range(SHARED..SHARED + 0x100);
+    board.set_quantum(100);
+    board.set_slice(slice);
+    for (memory, count) in locals.iter_mut().zip([300, 200, 500]) {
+        board.add_cpu(new_cpu(count), &mut memory[..]);
+    }
+
+    let mut interrupt = interrupt;
+    board.run(100_000, |_, time, interrupts| {
+        if interrupt.is_some_and(|at| time >= at) {
+            interrupts.request(2, Exception::from(Vector::Level4Interrupt));
+            interrupt = None;
+        }
+    });
+    assert!(board.cpus().iter().all(|cpu| cpu.time() >= 100_000 && cpu.cpu.stop));
+    assert_eq!(board.time(), 100_000);
+
+    let cpus = board.cpus().iter().map(|cpu| (cpu.cpu.regs, cpu.time(), *cpu.cpu.counters())).collect();
+    drop(board);
+    Board { cpus, locals, shared }
+}
+
+#[test]
+fn interleaving() {
+    let reference = run(1, 100, None);
+    assert_eq!(reference.shared[COUNTER as usize / 2], 301 + 201);
+    // The rolled back instructions are not counted twice.
+    assert_eq!(reference.cpus[1].2.instructions, 201 * 5 + 1);
+
+    for (threads, slice) in [(3, 100), (1, 10_000), (3, 10_000), (2, 1_000), (0, 50_000)] {
+        let board = run(threads, slice, None);
+        assert_eq!(board.cpus, reference.cpus, "{threads} threads, {slice} cycles slices");
+        assert_eq!(board.locals, reference.locals, "{threads} threads, {slice} cycles slices");
+        assert_eq!(board.shared, reference.shared, "{threads} threads, {slice} cycles slices");
+    }
+}
+
+#[test]
+fn interrupts() {
+    let reference = run(0, 10_000, None);
+    assert_eq!(reference.shared[SHARED as usize / 2], 0);
+
+    // The local core finished its loop before the interrupt, and stopped again after the handler.
+    let board = run(0, 10_000, Some(60_000));
+    assert_eq!(board.shared[SHARED as usize / 2], board.cpus[2].0.d[1].0 as u16);
+    assert_eq!(board.cpus[2].0.pc, reference.cpus[2].0.pc);
+    assert_eq!(board.cpus[2].0.ssp, reference.cpus[2].0.ssp);
+    assert_eq!(board.cpus[..2], reference.cpus[..2]);
+
+    // With interrupts the execution depends on the slice length, but not on the number of threads.
+    for threads in [1, 3] {
+        let threaded = run(threads, 10_000, Some(60_000));
+        assert_eq!(threaded.cpus, board.cpus, "{threads} threads");
+        assert_eq!(threaded.shared, board.shared, "{threads} threads");
+    }
+}
@@ -0,0 +1,79 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the batch runner with jobs sharing the same ROM.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::Vector;
+use m68000::instruction::Size;
+use m68000::pool::{Job, M68000Pool};
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+const JOBS: usize = 37;
+
+/// loop: ADDQ.L #1, D0
+///       TRAP #0
+///       BRA loop
+fn rom() -> Vec<u16> {
+    let mut program = asm::addq(1, Size::Long, AM::Drd(0));
+    program.push(asm::trap(0));
+    program.extend(asm::bra(-6));
+
+    let mut rom = vec![0u16; 0x1000];
+    rom[..program.len()].copy_from_slice(&program);
+    rom
+}
+
+fn run(threads: usize) {
+    let rom = rom();
+    let mut cores: Vec<M68000<Mc68000>> = (0..JOBS).map(|_| M68000::new_no_reset()).collect();
+    let mut memories: Vec<&[u16]> = (0..JOBS).map(|_| &rom[..]).collect();
+    let mut jobs: Vec<_> = cores.iter_mut().zip(memories.iter_mut()).map(|(cpu, memory)| Job::new(cpu, memory)).collect();
+
+    // Each job runs until D0 reaches its index.
+    M68000Pool::new(threads).run(&mut jobs, |i, job, vector| {
+        assert_eq!(vector, Some(Vector::Trap0Instruction));
+        job.cpu.regs.d[0].0 <= i as u32
+    });
+
+    for (i, job) in jobs.iter().enumerate() {
+        assert_eq!(job.cpu.regs.d[0].0, i as u32 + 1);
+        assert_eq!(job.exception, Some(Vector::Trap0Instruction));
+        assert!(job.cycles > 0);
+    }
+}
+
+#[test]
+fn single_thread() {
+    run(1);
+}
+
+#[test]
+fn multi_thread() {
+    run(4);
+    run(0);
+}
+
+#[test]
+fn stop_finishes_job() {
+    let rom = asm::stop(0x2700);
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    let mut memory = &rom[..];
+
+    let calls = AtomicUsize::new(0);
+    let mut jobs = [Job::new(&mut cpu, &mut memory)];
+    M68000Pool::new(2).run(&mut jobs, |_, _, vector| {
+        assert!(vector.is_none());
+        calls.fetch_add(1, Ordering::Relaxed);
+        true
+    });
+
+    assert!(jobs[0].cpu.stop);
+    assert_eq!(jobs[0].exception, None);
+    assert_eq!(calls.into_inner(), 1);
+}
@@ -0,0 +1,210 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the prefetch window executes the same as direct fetches with fewer memory accesses.
+
+use m68000::{M68000, MemoryAccess};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::{Mc68000, Scc68070};
+use m68000::exception::Vector;
+use m68000::instruction::Size;
+use m68000::lockstep::Lockstep;
+use m68000::pool::Job;
+
+const START: u32 = 0x1000;
+
+/// Memory that counts the calls made to it.
+#[derive(Clone, Default)]
+struct Counting {
+    memory: Vec<u8>,
+    reads: usize,
+}
+
+impl MemoryAccess for Counting {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.reads += 1;
+        self.memory.get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        self.reads += 1;
+        self.memory.get_word(addr)
+    }
+
+    fn get_long(&mut self, addr: u32) -> Option<u32> {
+        self.reads += 1;
+        self.memory.get_long(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.memory.set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        self.memory.set_word(addr, value)
+    }
+
+    fn get_block(&mut self, addr: u32, data: &mut [u8]) -> Option<()> {
+        self.reads += 1;
+        self.memory.get_block(addr, data)
+    }
+
+    fn reset_instruction(&mut self) {}
+}
+
+fn load(program: &[u16], size: usize) -> Counting {
+    let mut memory = vec![0; size];
+    let program: Vec<u8> = program.iter().flat_map(|word| word.to_be_bytes()).collect();
+    memory[START as usize..START as usize + program.len()].copy_from_slice(&program);
+    Counting { memory, reads: 0 }
+}
+
+/// A loop of register and immediate instructions, with no data access.
+fn register_loop() -> Vec<u16> {
+    let mut program = Vec::new();
+    program.extend(asm::addi(Size::Long, AM::Drd(0), 0x1234_5678));
+    program.extend(asm::addq(1, Size::Word, AM::Drd(1)));
+    program.extend(asm::r#move(Size::Word, AM::Drd(2), AM::Immediate(0x55)));
+    program.extend(asm::eor(0, Size::Long, AM::Drd(3)));
+    program.push(asm::moveq(4, -3));
+    program.extend(asm::dbcc(CC::F, 5, -(program.len() as i16 * 2 + 2)));
+    program.extend(asm::stop(0x2700));
+    program
+}
+
+fn run(memory: &mut Counting, prefetch: bool) -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.set_prefetch(prefetch);
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[5].0 = 99;
+    let (_, vector) = cpu.loop_until_exception_stop(memory);
+    assert!(vector.is_none() && cpu.stop);
+    cpu
+}
+
+#[test]
+fn prefetch_accesses() {
+    let mut direct = load(&register_loop(), 0x10000);
+    let direct_cpu = run(&mut direct, false);
+
+    let mut prefetched = load(&register_loop(), 0x10000);
+    let prefetched_cpu = run(&mut prefetched, true);
+
+    assert_eq!(direct_cpu.regs, prefetched_cpu.regs);
+    assert!(prefetched.reads * 2 < direct.reads, "{} {}", prefetched.reads, direct.reads);
+}
+
+#[test]
+fn self_modifying_code() {
+    // MOVE.W #0x7042, (0x1008).W writes MOVEQ #0x42, D0 over the second NOP.
+    let mut program = asm::r#move(Size::Word, AM::AbsShort(0x1008), AM::Immediate(0x7042));
+    program.push(asm::nop());
+    program.push(asm::nop());
+    program.extend(asm::stop(0x2700));
+    assert_eq!(program.len(), 7);
+
+    let mut memory = load(&program, 0x10000);
+    let cpu = run(&mut memory, true);
+    assert_eq!(cpu.regs.d[0].0, 0x42);
+}
+
+/// NOP, then MOVE.W #0x7005, (0x100A).W writes MOVEQ #5, D0 over MOVEQ #1, D0.
+fn self_modifying_program() -> Vec<u16> {
+    let mut program = vec![asm::nop()];
+    program.extend(asm::r#move(Size::Word, AM::AbsShort(0x100A), AM::Immediate(0x7005)));
+    program.push(asm::nop());
+    program.push(asm::moveq(0, 1));
+    program.extend(asm::stop(0x2700));
+    assert_eq!(program.len(), 8);
+    program
+}
+
+#[test]
+fn self_modifying_code_traced() {
+    let mut memory = load(&self_modifying_program(), 0x10000);
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.set_prefetch(true);
+    cpu.regs.pc.0 = START;
+
+    // The NOP fills the window, the write made by the traced MOVE has to invalidate it.
+    cpu.interpreter_exception(&mut memory);
+    let (instruction, _, vector) = cpu.trace_interpreter_exception(&mut memory);
+    assert_eq!((instruction.unwrap().pc, vector), (START + 2, None));
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory);
+    assert!(vector.is_none() && cpu.stop);
+    assert_eq!(cpu.regs.d[0].0, 5);
+}
+
+#[test]
+fn self_modifying_code_lockstep() {
+    let mut memory = load(&self_modifying_program(), 0x10000);
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.set_prefetch(true);
+    cpu.regs.pc.0 = START;
+
+    // The NOP fills the window, the write made by the lockstep MOVE has to invalidate it.
+    cpu.interpreter_exception(&mut memory);
+    let mut jobs = [Job::new(&mut cpu, &mut memory)];
+    Lockstep::new().run(&mut jobs, 1);
+    assert_eq!(jobs[0].cpu.regs.pc.0, START + 8);
+
+    let (_, vector) = cpu.loop_until_exception_stop(&mut memory);
+    assert!(vector.is_none() && cpu.stop);
+    assert_eq!(cpu.regs.d[0].0, 5);
+}
+
+#[test]
+fn end_of_memory() {
+    // The window reaches past the end of the memory, the error occurs when the PC reaches it.
+    let mut program = vec![asm::nop(); (0x1010 - START as usize) / 2 - 1];
+    program.extend(asm::addq(1, Size::Long, AM::Drd(0)));
+
+    let mut results = Vec::new();
+    for prefetch in [false, true] {
+        let mut memory = load(&program, 0x1010);
+        let mut cpu = M68000::<Mc68000>::new_no_reset();
+        cpu.set_prefetch(prefetch);
+        cpu.regs.pc.0 = START;
+        let (cycles, vector) = cpu.loop_until_exception_stop(&mut memory);
+        assert_eq!(vector, Some(Vector::AccessError));
+        assert_eq!(cpu.regs.d[0].0, 1);
+        results.push((cpu.regs, cycles));
+    }
+
+    assert_eq!(results[0], results[1]);
+}
+
+#[test]
+fn long_frame_irc() {
+    // MOVE.W (0x1_0001), D0 triggers an address error, the word after the instruction is pushed as IRC when it is in the
+    // prefetch window. Without the window the memory is not read and the opcode is pushed as placeholder.
+    for prefetch in [false, true] {
+        let mut program = asm::r#move(Size::Word, AM::Drd(0), AM::AbsLong(0x1_0001));
+        program.extend(asm::r#move(Size::Word, AM::Drd(1), AM::Immediate(0xCAFE)));
+        let mut memory = load(&program, 0x20000);
+
+        let mut cpu = M68000::<Scc68070>::new_no_reset();
+        cpu.set_prefetch(prefetch);
+        cpu.regs.pc.0 = START;
+        cpu.regs.ssp.0 = 0x8000;
+        let (_, vector) = cpu.interpreter_exception(&mut memory);
+        assert_eq!(vector, Some(Vector::AddressError));
+
+        cpu.exception(vector.unwrap().into());
+        let reads = memory.reads;
+        cpu.interpreter_exception(&mut memory);
+        let irc = if prefetch { program[3] } else { program[0] };
+        assert_eq!(memory.memory[0x7FFC..0x7FFE], irc.to_be_bytes()); // IRC
+        assert_eq!(memory.memory[0x7FFA..0x7FFC], program[0].to_be_bytes()); // IR
+
+        if !prefetch {
+            // The vector, then ORI.B #0, D0 at address 0.
+            assert_eq!(memory.reads - reads, 3);
+        }
+    }
+}
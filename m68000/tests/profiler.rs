@@ -0,0 +1,71 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the counters of the profiler. Run with `--features profiler`.
+
+#![cfg(feature = "profiler")]
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::Vector;
+use m68000::instruction::Size;
+use m68000::isa::Isa;
+use m68000::profiler::Profile;
+
+const START: u32 = 0x1000;
+const TRAP_HANDLER: u32 = 0x2000;
+
+#[test]
+fn profile_loop() {
+    // loop: ADDQ.L #1, D0
+    //       TRAP #0
+    //       DBF D1, loop
+    //       STOP #0x2700
+    let mut program = asm::addq(1, Size::Long, AM::Drd(0));
+    program.push(asm::trap(0));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x8000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+    memory[Vector::Trap0Instruction as usize * 2 + 1] = TRAP_HANDLER as u16;
+    memory[TRAP_HANDLER as usize / 2] = asm::rte();
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 9;
+    cpu.set_profiler(true);
+
+    let mut cycles = 0;
+    while !cpu.stop {
+        cycles += cpu.interpreter(&mut memory[..]);
+    }
+
+    let profile = cpu.profile().unwrap();
+    assert_eq!(profile.isa[Isa::Addq as usize].count, 10);
+    assert_eq!(profile.isa[Isa::Addq as usize].cycles, 10 * 8);
+    assert_eq!(profile.isa[Isa::Trap as usize].count, 10);
+    assert_eq!(profile.isa[Isa::Rte as usize].count, 10);
+    assert_eq!(profile.isa[Isa::Stop as usize].count, 1);
+    assert_eq!(profile.vectors[Vector::Trap0Instruction as usize], 10);
+    assert_eq!(profile.total().count, 41);
+
+    let loop_bucket = profile.pc[Profile::pc_bucket(START)];
+    let handler_bucket = profile.pc[Profile::pc_bucket(TRAP_HANDLER)];
+    assert_eq!(loop_bucket.count, 31);
+    assert_eq!(handler_bucket.count, 10);
+    // The exception processing times are not counted.
+    assert!(loop_bucket.cycles + handler_bucket.cycles < cycles as u64);
+    let hottest = profile.hottest_pc(3);
+    assert_eq!(hottest.len(), 2);
+    assert!(hottest[0].1.cycles >= hottest[1].1.cycles);
+
+    cpu.reset_profile();
+    assert_eq!(cpu.profile().unwrap().total().count, 0);
+}
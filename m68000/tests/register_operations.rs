@@ -0,0 +1,61 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the register to register MOVE, ADD, SUB and CMP handlers of the interpreter give the same results
+//! as the generic execution used by the instruction cache.
+
+use m68000::M68000;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::Vector;
+use m68000::isa::Isa;
+
+const START: u32 = 0x1000;
+
+const REGISTERS: [[u32; 8]; 3] = [
+    [0, 1, 0x7F, 0x80, 0x7FFF, 0x8000, 0x7FFF_FFFF, 0x8000_0000],
+    [0xFFFF_FFFF, 0x1234_5678, 0x0000_FF00, 0x00FF_00FF, 0xFF00_FF00, 0x8000_8080, 5, 0xDEAD_BEEF],
+    [0x0101_0101; 8],
+];
+
+fn run(opcode: u16, registers: &[u32; 8], x: bool, cached: bool) -> (M68000<Mc68000>, usize, Option<Vector>) {
+    let mut memory = vec![0u16; 0x8000];
+    memory[START as usize / 2] = opcode;
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    for i in 0..8 {
+        cpu.regs.d[i].0 = registers[i];
+        cpu.regs.a[i.min(6)].0 = registers[7 - i];
+    }
+    cpu.regs.sr.x = x;
+    cpu.set_instruction_cache(cached);
+
+    let (cycles, vector) = cpu.interpreter_exception(&mut memory[..]);
+    (cpu, cycles, vector)
+}
+
+#[test]
+fn register_operations() {
+    let mut count = 0;
+    for opcode in 0..=u16::MAX {
+        if !matches!(Isa::from(opcode), Isa::Add | Isa::Cmp | Isa::Move | Isa::Sub) || opcode & 0o070 > 0o010 {
+            continue;
+        }
+        count += 1;
+
+        for registers in &REGISTERS {
+            for x in [false, true] {
+                let (fast, fast_cycles, fast_vector) = run(opcode, registers, x, false);
+                let (cached, cached_cycles, cached_vector) = run(opcode, registers, x, true);
+
+                assert_eq!(fast.regs, cached.regs, "{opcode:#06X}");
+                assert_eq!(fast_cycles, cached_cycles, "{opcode:#06X}");
+                assert_eq!(fast_vector, cached_vector, "{opcode:#06X}");
+            }
+        }
+    }
+
+    assert!(count > 2000);
+}
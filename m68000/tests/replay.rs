@@ -0,0 +1,203 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that replaying the recorded inputs reproduces the execution without the peripherals.
+
+use m68000::{M68000, MemoryAccess};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::{Direction, Size};
+use m68000::replay::{InputLog, InputPlayer, InputRecorder, ReplayPosition};
+use m68000::state::CpuState;
+
+const START: u32 = 0x1000;
+const HANDLER: u32 = 0x1100;
+const DATA: u32 = 0x2000;
+const MMIO: u32 = 0x7000;
+
+/// RAM with a counter peripheral at MMIO, which has wait states.
+#[derive(Clone)]
+struct System {
+    ram: Vec<u16>,
+    /// None when the peripheral is not emulated, accessing it panics.
+    counter: Option<u16>,
+    wait_cycles: usize,
+}
+
+impl System {
+    /// 0x1000 loop: MOVE.W (MMIO).W, D1
+    /// 0x1004       ADD.W D1, D0
+    /// 0x1006       MOVE.W D0, (DATA).W
+    /// 0x100A       BRA loop
+    ///
+    /// 0x1100       ADDQ.L #1, D2
+    /// 0x1102       MOVE.W D0, (MMIO).W
+    /// 0x1106       RTE
+    fn new(counter: Option<u16>) -> Self {
+        let mut program = asm::r#move(Size::Word, AM::Drd(1), AM::AbsShort(MMIO as u16));
+        program.extend(asm::add(0, Direction::DstReg, Size::Word, AM::Drd(1)));
+        program.extend(asm::r#move(Size::Word, AM::AbsShort(DATA as u16), AM::Drd(0)));
+        program.extend(asm::bra(-(program.len() as i16 * 2 + 2)));
+
+        let mut handler = asm::addq(1, Size::Long, AM::Drd(2));
+        handler.extend(asm::r#move(Size::Word, AM::AbsShort(MMIO as u16), AM::Drd(0)));
+        handler.push(asm::rte());
+
+        let mut ram = vec![0; 0x4000];
+        ram[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+        ram[HANDLER as usize / 2..HANDLER as usize / 2 + handler.len()].copy_from_slice(&handler);
+        ram[Vector::Level2Interrupt as usize * 2 + 1] = HANDLER as u16;
+        Self { ram, counter, wait_cycles: 0 }
+    }
+
+    fn mmio(&mut self) -> &mut u16 {
+        self.counter.as_mut().expect("the peripheral is not emulated")
+    }
+}
+
+impl MemoryAccess for System {
+    fn get_byte(&mut self, addr: u32) -> Option<u8> {
+        self.ram[..].get_byte(addr)
+    }
+
+    fn get_word(&mut self, addr: u32) -> Option<u16> {
+        if addr == MMIO {
+            self.wait_cycles += 6;
+            let counter = self.mmio();
+            *counter = counter.wrapping_mul(5).wrapping_add(3);
+            return Some(*counter);
+        }
+        self.ram[..].get_word(addr)
+    }
+
+    fn set_byte(&mut self, addr: u32, value: u8) -> Option<()> {
+        self.ram[..].set_byte(addr, value)
+    }
+
+    fn set_word(&mut self, addr: u32, value: u16) -> Option<()> {
+        if addr == MMIO {
+            *self.mmio() ^= value;
+            return Some(());
+        }
+        self.ram[..].set_word(addr, value)
+    }
+
+    fn reset_instruction(&mut self) {}
+
+    fn take_wait_cycles(&mut self) -> usize {
+        std::mem::take(&mut self.wait_cycles)
+    }
+}
+
+fn new_cpu() -> M68000<Mc68000> {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.sr = 0x2000.into();
+    cpu
+}
+
+/// Runs the system with the peripheral for a few irregular slices and interrupts,
+/// and returns the recorder, a snapshot of the middle of the recording and the core and the system at its end.
+fn record() -> (InputRecorder, (ReplayPosition, CpuState, System), (M68000<Mc68000>, System)) {
+    let mut cpu = new_cpu();
+    let mut system = System::new(Some(1));
+    let mut recorder = InputRecorder::new();
+    recorder.add_mmio_range(MMIO..MMIO + 2);
+
+    let mut middle = None;
+    for i in 0..40 {
+        recorder.cycle(&mut cpu, &mut system, 50 + i * 7 % 31);
+        if i % 3 == 0 {
+            recorder.exception(&mut cpu, Exception::from(Vector::Level2Interrupt));
+        }
+        if i == 20 {
+            middle = Some((recorder.position(), cpu.save_state(), system.clone()));
+        }
+    }
+
+    (recorder, middle.unwrap(), (cpu, system))
+}
+
+fn replay(player: &mut InputPlayer, cpu: &mut M68000<Mc68000>, system: &mut System, end: u64) {
+    while player.position().time() < end {
+        let remaining = end - player.position().time();
+        player.cycle(cpu, system, remaining.min(100) as usize);
+    }
+}
+
+#[test]
+fn replay_from_boot() {
+    let (recorder, _, (expected_cpu, expected_system)) = record();
+    let end = recorder.position().time();
+    assert_eq!(expected_cpu.regs.d[2].0, 13); // The last interrupt is still pending.
+
+    let mut cpu = new_cpu();
+    let mut system = System::new(None);
+    let mut player = InputPlayer::new(recorder.into_log());
+    player.add_mmio_range(MMIO..MMIO + 2);
+    replay(&mut player, &mut cpu, &mut system, end);
+
+    assert!(!player.diverged());
+    assert!(player.is_finished());
+    assert_eq!(player.position().time(), end);
+    assert_eq!(cpu.regs, expected_cpu.regs);
+    assert_eq!(system.ram, expected_system.ram);
+}
+
+#[test]
+fn replay_from_snapshot() {
+    let (recorder, (position, state, mut system), (expected_cpu, expected_system)) = record();
+    let end = recorder.position().time();
+
+    let mut cpu = new_cpu();
+    cpu.load_state(&state).unwrap();
+    system.counter = None;
+    let mut player = InputPlayer::with_position(recorder.into_log(), position);
+    player.add_mmio_range(MMIO..MMIO + 2);
+    replay(&mut player, &mut cpu, &mut system, end);
+
+    assert!(!player.diverged());
+    assert_eq!(cpu.regs, expected_cpu.regs);
+    assert_eq!(system.ram, expected_system.ram);
+}
+
+#[test]
+fn serialized_log() {
+    let (recorder, _, (expected_cpu, _)) = record();
+    let end = recorder.position().time();
+
+    let mut data = Vec::new();
+    recorder.log().write_to(&mut data).unwrap();
+    let log = InputLog::read_from(&mut &data[..]).unwrap();
+    assert_eq!(&log, recorder.log());
+    assert!(data.len() < (recorder.log().reads.len() + recorder.log().wait_cycles.len()) * 5);
+
+    let mut cpu = new_cpu();
+    let mut system = System::new(None);
+    let mut player = InputPlayer::new(log);
+    player.add_mmio_range(MMIO..MMIO + 2);
+    replay(&mut player, &mut cpu, &mut system, end);
+    assert_eq!(cpu.regs, expected_cpu.regs);
+
+    assert!(InputLog::read_from(&mut &data[..data.len() - 1]).is_err());
+}
+
+#[test]
+fn divergence() {
+    let (recorder, _, _) = record();
+    let end = recorder.position().time();
+
+    // A different program reads the peripheral at a different address.
+    let mut cpu = new_cpu();
+    let mut system = System::new(None);
+    system.ram[START as usize / 2 + 1] = MMIO as u16 + 2;
+    let mut player = InputPlayer::new(recorder.into_log());
+    player.add_mmio_range(MMIO..MMIO + 4);
+    replay(&mut player, &mut cpu, &mut system, end);
+
+    assert!(player.diverged());
+}
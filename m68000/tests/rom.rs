@@ -0,0 +1,110 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the ROM images shared by several cores, accessed directly or through the memory map.
+
+use m68000::{M68000, MemoryAccess};
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::Vector;
+use m68000::instruction::Size;
+use m68000::rom::Rom;
+
+const ROM_START: u32 = 0x1_0000;
+
+/// MOVE.L (0x10).W, D0
+/// MOVE.L D0, (0x2000).W
+/// STOP #0x2700
+fn rom() -> Rom {
+    let mut program = asm::r#move(Size::Long, AM::Drd(0), AM::AbsShort(0x10));
+    program.extend(asm::r#move(Size::Long, AM::AbsShort(0x2000), AM::Drd(0)));
+    program.extend(asm::stop(0x2700));
+
+    let mut data: Vec<u8> = program.iter().flat_map(|word| word.to_be_bytes()).collect();
+    data.resize(0x10, 0);
+    data.extend([0xDE, 0xAD, 0xBE, 0xEF]);
+    Rom::from(data)
+}
+
+#[test]
+fn rom_memory_access() {
+    let mut rom = rom();
+    assert_eq!(rom.get_long(0x10), Some(0xDEAD_BEEF));
+    assert_eq!(rom.get_word(0x12), Some(0xBEEF));
+    assert_eq!(rom.get_long(0x12), None);
+    assert_eq!(rom.set_word(0x10, 0), None);
+
+    // The last byte of an odd-length image is not a whole word.
+    let mut odd = Rom::from(vec![0x12, 0x34, 0x56]);
+    assert_eq!(odd.get_word(0), Some(0x1234));
+    assert_eq!(odd.get_byte(2), Some(0x56));
+    assert_eq!(odd.get_word(2), None);
+    assert_eq!(odd.get_word(u32::MAX), None);
+
+    // The write to the ROM raises an access error.
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    let (_, vector) = cpu.loop_until_exception_stop(&mut rom);
+    assert_eq!(vector, Some(Vector::AccessError));
+    assert_eq!(cpu.regs.d[0].0, 0xDEAD_BEEF);
+}
+
+#[test]
+fn mapped_rom() {
+    let rom = rom();
+
+    let mut results = Vec::new();
+    for _ in 0..3 {
+        let mut cpu = M68000::<Mc68000>::new_no_reset();
+        cpu.regs.pc.0 = ROM_START;
+        cpu.map_rom(ROM_START, &rom);
+
+        // The ROM is not copied, and its data is read at its mapped address.
+        let mut ram = vec![0u8; 0x2_0000];
+        ram[0x10..0x14].copy_from_slice(&[0x12, 0x34, 0x56, 0x78]);
+        let (_, vector) = cpu.loop_until_exception_stop(&mut ram[..]);
+        assert!(vector.is_none() && cpu.stop);
+        assert_eq!(ram[0x2000..0x2004], [0x12, 0x34, 0x56, 0x78]);
+
+        // Writes to the ROM are forwarded to the memory system.
+        let store = asm::r#move(Size::Long, AM::AbsLong(ROM_START + 0x10), AM::Drd(0));
+        let store: Vec<u8> = store.iter().flat_map(|word| word.to_be_bytes()).collect();
+        ram[0x100..0x100 + store.len()].copy_from_slice(&store);
+        cpu.regs.pc.0 = 0x100;
+        cpu.stop = false;
+        cpu.regs.d[0].0 = 0xCAFE_0000;
+        cpu.interpreter(&mut ram[..]);
+        assert_eq!(ram[0x1_0010..0x1_0014], [0xCA, 0xFE, 0x00, 0x00]);
+        assert_eq!(rom.as_bytes()[0x10..0x14], [0xDE, 0xAD, 0xBE, 0xEF]);
+
+        results.push(cpu);
+    }
+
+    // The memory map keeps the image until it is unmapped.
+    drop(rom);
+    let cpu = &mut results[0];
+    cpu.regs.pc.0 = ROM_START;
+    cpu.stop = false;
+    let mut ram = vec![0u8; 0x2_0000];
+    ram[0x10..0x14].copy_from_slice(&[0x9A, 0xBC, 0xDE, 0xF0]);
+    ram[ROM_START as usize..ROM_START as usize + 2].copy_from_slice(&asm::illegal().to_be_bytes());
+    let (_, vector) = cpu.loop_until_exception_stop(&mut ram[..]);
+    assert!(vector.is_none() && cpu.stop);
+    assert_eq!(ram[0x2000..0x2004], [0x9A, 0xBC, 0xDE, 0xF0]);
+
+    // Once unmapped, the program is read from the memory system.
+    cpu.unmap_memory(ROM_START, 0x1_0000);
+    cpu.regs.pc.0 = ROM_START;
+    cpu.stop = false;
+    let (_, vector) = cpu.loop_until_exception_stop(&mut ram[..]);
+    assert_eq!(vector, Some(Vector::IllegalInstruction));
+}
+
+#[test]
+fn shared_rom() {
+    let rom = rom();
+    let clone = rom.clone();
+    assert!(rom.ptr_eq(&clone));
+    assert_eq!(rom.as_bytes().as_ptr(), clone.as_bytes().as_ptr());
+}
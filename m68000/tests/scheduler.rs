@@ -0,0 +1,72 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks the event scheduler and the STOP fast-forward.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::Size;
+use m68000::scheduler::Scheduler;
+
+const START: u32 = 0x1000;
+const HANDLER: u32 = 0x2000;
+const PERIOD: u64 = 1000;
+
+#[test]
+fn timer_interrupts() {
+    // loop: STOP #0x2000
+    //       BRA loop
+    // handler: ADDQ.L #1, D0
+    //          RTE
+    let mut program = asm::stop(0x2000).to_vec();
+    program.extend(asm::bra(-6));
+    let mut handler = asm::addq(1, Size::Long, AM::Drd(0));
+    handler.push(asm::rte());
+
+    let mut memory = vec![0u16; 0x8000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+    memory[HANDLER as usize / 2..HANDLER as usize / 2 + handler.len()].copy_from_slice(&handler);
+    memory[Vector::Level4Interrupt as usize * 2 + 1] = HANDLER as u16;
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+
+    let mut scheduler = Scheduler::with_capacity(1);
+    scheduler.schedule(PERIOD, ());
+    let mut events = 0;
+
+    let vector = cpu.run_scheduler(&mut memory[..], &mut scheduler, 100 * PERIOD, |cpu, _, scheduler, event| {
+        assert!(scheduler.time() >= event.deadline);
+        events += 1;
+        cpu.exception(Exception::from(Vector::Level4Interrupt));
+        scheduler.schedule(event.deadline + PERIOD, ());
+    });
+
+    assert!(vector.is_none());
+    assert_eq!(scheduler.time(), 100 * PERIOD);
+    assert_eq!(events, 100);
+    // The last interrupt is pending at the end of the run and woke the CPU up.
+    assert_eq!(cpu.regs.d[0].0, 99);
+    assert!(!cpu.stop);
+    assert_eq!(scheduler.next_deadline(), Some(101 * PERIOD));
+}
+
+#[test]
+fn event_order() {
+    let mut scheduler = Scheduler::new();
+    scheduler.schedule(20, 'c');
+    scheduler.schedule(10, 'a');
+    scheduler.schedule(10, 'b');
+
+    assert!(scheduler.pop_due().is_none());
+    scheduler.advance(20);
+    assert_eq!(scheduler.pop_due().unwrap().data, 'a');
+    assert_eq!(scheduler.pop_due().unwrap().data, 'b');
+    assert_eq!(scheduler.pop_due().unwrap().data, 'c');
+    assert!(scheduler.is_empty());
+}
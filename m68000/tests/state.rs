@@ -0,0 +1,73 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that restoring a saved state resumes the execution identically.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::exception::{Exception, Vector};
+use m68000::instruction::{Direction, Size};
+use m68000::state::{CpuState, STATE_VERSION};
+
+const START: u32 = 0x1000;
+
+#[test]
+fn rewind() {
+    // loop: ADDQ.L #3, D0
+    //       ADD.L D0, D2
+    //       DBF D1, loop
+    //       STOP #0x2700
+    let mut program = asm::addq(3, Size::Long, AM::Drd(0));
+    program.extend(asm::add(2, Direction::DstReg, Size::Long, AM::Drd(0)));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x8000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 99;
+
+    for _ in 0..50 {
+        cpu.interpreter(&mut memory[..]);
+    }
+    cpu.exception(Exception::from(Vector::Trap0Instruction));
+    let state = cpu.save_state();
+    assert_eq!(state.version(), STATE_VERSION);
+
+    let (first_cycles, _) = cpu.loop_until_exception_stop(&mut memory[..]);
+    let first = cpu.regs;
+    assert!(cpu.stop);
+
+    cpu.load_state(&state).unwrap();
+    assert!(!cpu.stop);
+    assert_eq!(cpu.save_state(), state);
+    let (second_cycles, _) = cpu.loop_until_exception_stop(&mut memory[..]);
+
+    assert_eq!(cpu.regs, first);
+    assert_eq!(second_cycles, first_cycles);
+
+    // A stopped core stays stopped once restored.
+    let stopped = cpu.save_state();
+    let mut other = M68000::<Mc68000>::new();
+    other.load_state(&stopped).unwrap();
+    assert!(other.stop);
+    assert_eq!(other.regs, first);
+    assert_eq!(other.interpreter(&mut memory[..]), 0);
+}
+
+#[test]
+fn unsupported_version() {
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.d[0].0 = 1;
+
+    assert_eq!(cpu.load_state(&CpuState::new()), Err(0));
+    assert_eq!(cpu.regs.d[0].0, 1);
+}
@@ -0,0 +1,67 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+//! Checks that the trace interpreter records the same instructions as the disassembler interpreter.
+
+use m68000::M68000;
+use m68000::addressing_modes::AddressingMode as AM;
+use m68000::assembler as asm;
+use m68000::assembler::Condition as CC;
+use m68000::cpu_details::Mc68000;
+use m68000::instruction::{Direction, Size};
+use m68000::trace::TraceRing;
+
+const START: u32 = 0x1000;
+
+fn new_cpu() -> (M68000<Mc68000>, Vec<u16>) {
+    // loop: ADDQ.L #3, D0
+    //       ADD.L D0, D2
+    //       DBF D1, loop
+    //       STOP #0x2700
+    let mut program = asm::addq(3, Size::Long, AM::Drd(0));
+    program.extend(asm::add(2, Direction::DstReg, Size::Long, AM::Drd(0)));
+    let disp = -(program.len() as i16 * 2 + 2);
+    program.extend(asm::dbcc(CC::F, 1, disp));
+    program.extend(asm::stop(0x2700));
+
+    let mut memory = vec![0u16; 0x8000];
+    memory[START as usize / 2..START as usize / 2 + program.len()].copy_from_slice(&program);
+
+    let mut cpu = M68000::<Mc68000>::new_no_reset();
+    cpu.regs.pc.0 = START;
+    cpu.regs.ssp.0 = 0x8000;
+    cpu.regs.d[1].0 = 9;
+    (cpu, memory)
+}
+
+#[test]
+fn trace_ring() {
+    let (mut dis_cpu, mut dis_memory) = new_cpu();
+    let mut expected = Vec::new();
+    while !dis_cpu.stop {
+        let (pc, dis, cycles) = dis_cpu.disassembler_interpreter(&mut dis_memory[..]);
+        expected.push((pc, dis, cycles));
+    }
+
+    let (mut cpu, mut memory) = new_cpu();
+    let mut ring = TraceRing::new(8);
+    while !cpu.stop {
+        cpu.trace_interpreter(&mut memory[..], &mut ring);
+    }
+
+    assert_eq!(cpu.regs, dis_cpu.regs);
+    assert_eq!(ring.len(), 8);
+
+    // The ring keeps the most recent records, in execution order.
+    let mut buffer = String::new();
+    for (record, (pc, dis, cycles)) in ring.iter().zip(&expected[expected.len() - 8..]) {
+        buffer.clear();
+        record.instruction.disassemble_to(&mut buffer).unwrap();
+        assert_eq!(record.instruction.pc, *pc);
+        assert_eq!(&buffer, dis);
+        assert_eq!(record.instruction.to_string(), *dis);
+        assert_eq!(record.cycles, *cycles);
+        assert!(record.exception.is_none());
+    }
+}